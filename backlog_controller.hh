@@ -135,6 +135,30 @@ class flush_controller : public backlog_controller {
     {}
 };
 
+// memtable to cache CPU controller.
+//
+// The backlog is the memory of memtables which flushes have already written to sstables, but
+// which is not yet moved into the cache, relative to the dirty memory threshold. That memory is
+// only released once it is in the cache, so if moving it there lags behind writing the sstables,
+// requests get throttled on dirty memory even though the disk keeps up.
+//
+// Below a tenth of the threshold, the quota is constant, as the static shares used to be. It then
+// grows up to qmax at half of the threshold, so that the cache update keeps pace with the flushes.
+// Moving data into the cache does no I/O, so only the CPU shares are controlled.
+class cache_update_controller : public backlog_controller {
+protected:
+    virtual void update_controller(float shares) override {
+        _scheduling_group.set_shares(shares);
+    }
+public:
+    cache_update_controller(seastar::scheduling_group sg, std::chrono::milliseconds interval, std::function<float()> current_backlog)
+        : backlog_controller(sg, default_priority_class(), std::move(interval),
+          std::vector<backlog_controller::control_point>({{0.0, 200}, {0.1, 200}, {0.5, 1000}}),
+          std::move(current_backlog)
+        )
+    {}
+};
+
 class compaction_controller : public backlog_controller {
 public:
     static constexpr unsigned normalization_factor = 30;
@@ -158,6 +158,7 @@ class cache_flat_mutation_reader final : public flat_mutation_reader::impl {
         , _next_row(*_schema, *_snp)
     {
         clogger.trace("csm {}: table={}.{}", this, _schema->ks_name(), _schema->cf_name());
+        limit_partition_readahead(_read_context->slice());
         push_mutation_fragment(partition_start(std::move(dk), _snp->partition_tombstone()));
     }
     cache_flat_mutation_reader(const cache_flat_mutation_reader&) = delete;
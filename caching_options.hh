@@ -36,17 +36,26 @@ class caching_options {
     // this (and maybe we shouldn't)
     static constexpr auto default_key = "ALL";
     static constexpr auto default_row = "ALL";
+    // Partitions read on a cache miss are admitted to the cache: "ALL" of them,
+    // or, while the cache is evicting, only those which were read "FREQUENT"ly
+    // of late, so that scans don't push the working set out of the cache.
+    static constexpr auto default_admission = "ALL";
 
     sstring _key_cache;
     sstring _row_cache;
     bool _enabled = true;
-    caching_options(sstring k, sstring r, bool enabled)
-        : _key_cache(k), _row_cache(r), _enabled(enabled)
+    sstring _admission = default_admission;
+    caching_options(sstring k, sstring r, bool enabled, sstring admission = default_admission)
+        : _key_cache(k), _row_cache(r), _enabled(enabled), _admission(admission)
     {
         if ((k != "ALL") && (k != "NONE")) {
             throw exceptions::configuration_exception("Invalid key value: " + k); 
         }
 
+        if ((admission != "ALL") && (admission != "FREQUENT")) {
+            throw exceptions::configuration_exception("Invalid admission value: " + admission);
+        }
+
         if ((r == "ALL") || (r == "NONE")) {
             return;
         } else {
@@ -66,12 +75,19 @@ class caching_options {
         return _enabled;
     }
 
+    bool frequent_admission() const {
+        return _admission == "FREQUENT";
+    }
+
     std::map<sstring, sstring> to_map() const {
         std::map<sstring, sstring> res = {{ "keys", _key_cache },
                 { "rows_per_partition", _row_cache }};
         if (!_enabled) {
             res.insert({"enabled", "false"});
         }
+        if (_admission != default_admission) {
+            res.insert({"admission", _admission});
+        }
         return res;
     }
 
@@ -88,6 +104,7 @@ class caching_options {
         sstring k = default_key;
         sstring r = default_row;
         bool e = true;
+        sstring a = default_admission;
 
         for (auto& p : map) {
             if (p.first == "keys") {
@@ -96,11 +113,13 @@ class caching_options {
                 r = p.second;
             } else if (p.first == "enabled") {
                 e = p.second == "true";
+            } else if (p.first == "admission") {
+                a = p.second;
             } else {
                 throw exceptions::configuration_exception(format("Invalid caching option: {}", p.first));
             }
         }
-        return caching_options(k, r, e);
+        return caching_options(k, r, e, a);
     }
 
     static caching_options from_sstring(const sstring& str) {
@@ -109,7 +128,7 @@ class caching_options {
 
     bool operator==(const caching_options& other) const {
         return _key_cache == other._key_cache && _row_cache == other._row_cache
-            && _enabled == other._enabled;
+            && _enabled == other._enabled && _admission == other._admission;
     }
     bool operator!=(const caching_options& other) const {
         return !(*this == other);
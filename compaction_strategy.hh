@@ -44,6 +44,7 @@ class sstable;
 class sstable_set;
 struct compaction_descriptor;
 struct resharding_descriptor;
+struct foreign_sstable_open_info;
 
 using reader_consumer = noncopyable_function<future<> (flat_mutation_reader)>;
 
@@ -148,6 +149,23 @@ class compaction_strategy {
     // SSTables that can be added into a single job.
     compaction_descriptor get_reshaping_job(std::vector<shared_sstable> input, schema_ptr schema, const ::io_priority_class& iop, reshape_mode mode);
 
+    // Returns the descriptor used to reshard the input SSTables, which all belong to the same
+    // resharding group (see resharding_group()). The strategy chooses the level and maximum size
+    // of the output, so that the resharded SSTables are emitted in their final layout, instead of
+    // landing in the lowest tier and having to be recompacted right after resharding.
+    // whole_group tells whether the input is the entire group, or only one of the jobs the group
+    // was split into, in which case the outputs of the jobs may overlap each other.
+    compaction_descriptor get_resharding_job(std::vector<shared_sstable> input, const ::io_priority_class& iop, bool whole_group);
+
+    // SSTables are only resharded together with SSTables of the same group. For example, leveled
+    // strategy groups SSTables by level, so that the output of a resharding job is a run that can
+    // be placed directly into the level of its input.
+    //
+    // Group 0 is the lowest tier, which has no layout to preserve. The SSTables of any other group
+    // keep their layout only if the group is resharded whole, so such a group is never spread
+    // across shards.
+    uint32_t resharding_group(const shared_sstable& sst) const;
+    uint32_t resharding_group(const foreign_sstable_open_info& info) const;
 };
 
 // Creates a compaction_strategy object from one of the strategies available.
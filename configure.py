@@ -317,11 +317,13 @@ scylla_tests = set([
     'test/boost/filtering_test',
     'test/boost/flat_mutation_reader_test',
     'test/boost/flush_queue_test',
+    'test/boost/frequency_sketch_test',
     'test/boost/fragmented_temporary_buffer_test',
     'test/boost/frozen_mutation_test',
     'test/boost/gossip_test',
     'test/boost/gossiping_property_file_snitch_test',
     'test/boost/hash_test',
+    'test/boost/hint_replay_test',
     'test/boost/idl_test',
     'test/boost/input_stream_test',
     'test/boost/json_cql_query_test',
@@ -359,6 +361,7 @@ scylla_tests = set([
     'test/boost/range_tombstone_list_test',
     'test/boost/reusable_buffer_test',
     'test/boost/restrictions_test',
+    'test/boost/result_cache_test',
     'test/boost/role_manager_test',
     'test/boost/row_cache_test',
     'test/boost/schema_change_test',
@@ -414,6 +417,7 @@ scylla_tests = set([
     'test/perf/perf_bptree',
     'test/perf/perf_row_cache_update',
     'test/perf/perf_simple_query',
+    'test/perf/perf_filtered_query',
     'test/perf/perf_sstable',
     'test/unit/lsa_async_eviction_test',
     'test/unit/lsa_sync_eviction_test',
@@ -553,6 +557,7 @@ scylla_core = (['database.cc',
                 'sstables/mp_row_consumer.cc',
                 'sstables/sstables.cc',
                 'sstables/sstables_manager.cc',
+                'sstables/partition_locator.cc',
                 'sstables/mx/writer.cc',
                 'sstables/sstable_version.cc',
                 'sstables/compress.cc',
@@ -594,6 +599,7 @@ scylla_core = (['database.cc',
                 'cql3/maps.cc',
                 'cql3/values.cc',
                 'cql3/expr/expression.cc',
+                'cql3/expr/batch_evaluator.cc',
                 'cql3/functions/user_function.cc',
                 'cql3/functions/functions.cc',
                 'cql3/functions/aggregate_fcts.cc',
@@ -656,6 +662,8 @@ scylla_core = (['database.cc',
                 'service/priority_manager.cc',
                 'service/migration_manager.cc',
                 'service/storage_proxy.cc',
+                'service/replica_selector.cc',
+                'service/hedged_read.cc',
                 'service/paxos/proposal.cc',
                 'service/paxos/prepare_response.cc',
                 'service/paxos/paxos_state.cc',
@@ -665,6 +673,7 @@ scylla_core = (['database.cc',
                 'cql3/column_specification.cc',
                 'cql3/constants.cc',
                 'cql3/query_processor.cc',
+                'cql3/result_cache.cc',
                 'cql3/query_options.cc',
                 'cql3/single_column_relation.cc',
                 'cql3/token_relation.cc',
@@ -676,6 +685,7 @@ scylla_core = (['database.cc',
                 'cql3/selection/selectable.cc',
                 'cql3/selection/selector_factories.cc',
                 'cql3/selection/selection.cc',
+                'cql3/selection/partial_aggregates.cc',
                 'cql3/selection/selector.cc',
                 'cql3/restrictions/statement_restrictions.cc',
                 'cql3/result_set.cc',
@@ -693,12 +703,14 @@ scylla_core = (['database.cc',
                 'db/data_listeners.cc',
                 'db/hints/manager.cc',
                 'db/hints/resource_manager.cc',
+                'db/hints/send_window.cc',
                 'db/config.cc',
                 'db/extensions.cc',
                 'db/heat_load_balance.cc',
                 'db/large_data_handler.cc',
                 'db/marshal/type_parser.cc',
                 'db/batchlog_manager.cc',
+                'db/row_cache_saver.cc',
                 'db/view/view.cc',
                 'db/view/view_update_generator.cc',
                 'db/view/row_locking.cc',
@@ -711,6 +723,7 @@ scylla_core = (['database.cc',
                 'utils/bloom_filter.cc',
                 'utils/bloom_calculations.cc',
                 'utils/rate_limiter.cc',
+                'utils/frequency_sketch.cc',
                 'utils/file_lock.cc',
                 'utils/dynamic_bitset.cc',
                 'utils/managed_bytes.cc',
@@ -763,6 +776,7 @@ scylla_core = (['database.cc',
                 'streaming/stream_request.cc',
                 'streaming/stream_summary.cc',
                 'streaming/stream_transfer_task.cc',
+                'streaming/stream_sstable_files.cc',
                 'streaming/stream_receive_task.cc',
                 'streaming/stream_plan.cc',
                 'streaming/progress_info.cc',
@@ -966,6 +980,7 @@ pure_boost_tests = set([
     'test/boost/dynamic_bitset_test',
     'test/boost/enum_option_test',
     'test/boost/enum_set_test',
+    'test/boost/frequency_sketch_test',
     'test/boost/idl_test',
     'test/boost/json_test',
     'test/boost/keys_test',
@@ -1042,6 +1057,7 @@ deps['test/boost/allocation_strategy_test'] = ['test/boost/allocation_strategy_t
 deps['test/boost/log_heap_test'] = ['test/boost/log_heap_test.cc']
 deps['test/boost/estimated_histogram_test'] = ['test/boost/estimated_histogram_test.cc']
 deps['test/boost/anchorless_list_test'] = ['test/boost/anchorless_list_test.cc']
+deps['test/boost/frequency_sketch_test'] = ['test/boost/frequency_sketch_test.cc', 'utils/frequency_sketch.cc']
 deps['test/perf/perf_fast_forward'] += ['release.cc']
 deps['test/perf/perf_simple_query'] += ['release.cc']
 deps['test/boost/meta_test'] = ['test/boost/meta_test.cc']
@@ -394,6 +394,7 @@ selectStatement returns [std::unique_ptr<raw::select_statement> expr]
         bool allow_filtering = false;
         bool is_json = false;
         bool bypass_cache = false;
+        bool filtered_cache_admission = false;
     }
     : K_SELECT (
                 ( K_JSON { is_json = true; } )?
@@ -407,9 +408,11 @@ selectStatement returns [std::unique_ptr<raw::select_statement> expr]
       ( K_PER K_PARTITION K_LIMIT rows=intValue { per_partition_limit = rows; } )?
       ( K_LIMIT rows=intValue { limit = rows; } )?
       ( K_ALLOW K_FILTERING  { allow_filtering = true; } )?
-      ( K_BYPASS K_CACHE { bypass_cache = true; })?
+      ( K_BYPASS K_CACHE { bypass_cache = true; }
+      | K_FILTER K_CACHE K_ADMISSION { filtered_cache_admission = true; }
+      )?
       {
-          auto params = make_lw_shared<raw::select_statement::parameters>(std::move(orderings), is_distinct, allow_filtering, is_json, bypass_cache);
+          auto params = make_lw_shared<raw::select_statement::parameters>(std::move(orderings), is_distinct, allow_filtering, is_json, bypass_cache, filtered_cache_admission);
           $expr = std::make_unique<raw::select_statement>(std::move(cf), std::move(params),
             std::move(sclause), std::move(wclause), std::move(limit), std::move(per_partition_limit),
             std::move(gbcolumns));
@@ -1757,6 +1760,8 @@ basic_unreserved_keyword returns [sstring str]
         | K_JSON
         | K_CACHE
         | K_BYPASS
+        | K_FILTER
+        | K_ADMISSION
         | K_LIKE
         | K_PER
         | K_PARTITION
@@ -1905,6 +1910,8 @@ K_EMPTY:       E M P T Y;
 
 K_BYPASS:      B Y P A S S;
 K_CACHE:       C A C H E;
+K_FILTER:      F I L T E R;
+K_ADMISSION:   A D M I S S I O N;
 
 K_PER:         P E R;
 K_PARTITION:   P A R T I T I O N;
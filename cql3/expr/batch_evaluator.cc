@@ -0,0 +1,350 @@
+/*
+ * Copyright (C) 2020 ScyllaDB
+ */
+
+/*
+ * This file is part of Scylla.
+ *
+ * Scylla is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Affero General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Scylla is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Scylla.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "batch_evaluator.hh"
+
+#include <array>
+#include <functional>
+#include <boost/range/algorithm/sort.hpp>
+#include <boost/range/algorithm/unique.hpp>
+#include <seastar/core/byteorder.hh>
+
+#include "cql3/lists.hh"
+#include "types.hh"
+
+namespace cql3 {
+
+namespace expr {
+
+std::optional<row_batch::value_kind> row_batch::kind_of(const abstract_type& type) {
+    const abstract_type* t = type.is_reversed() ? type.underlying_type().get() : &type;
+    if (t == int32_type.get() || t == long_type.get() || t == timestamp_type.get()) {
+        return value_kind::integer;
+    }
+    if (t == utf8_type.get() || t == ascii_type.get() || t == bytes_type.get()) {
+        return value_kind::string;
+    }
+    return std::nullopt;
+}
+
+row_batch::row_batch(const std::vector<const column_definition*>& columns) {
+    _columns.reserve(columns.size());
+    for (auto def : columns) {
+        _columns.push_back(column{def, *kind_of(*def->type), {}, {}, {}});
+    }
+}
+
+// Decodes a serialized integer, or returns std::nullopt if the value isn't one.
+static std::optional<int64_t> decode_integer(bytes_view v) {
+    switch (v.size()) {
+    case sizeof(int32_t):
+        return read_be<int32_t>(reinterpret_cast<const char*>(v.data()));
+    case sizeof(int64_t):
+        return read_be<int64_t>(reinterpret_cast<const char*>(v.data()));
+    default:
+        return std::nullopt;
+    }
+}
+
+void row_batch::set_value(size_t column, bytes_view value) {
+    auto& c = _columns[column];
+    if (c.kind == value_kind::integer) {
+        auto v = decode_integer(value);
+        c.states.push_back(v ? present : empty);
+        c.integers.push_back(v.value_or(0));
+    } else {
+        c.states.push_back(present);
+        c.strings.emplace_back(value.begin(), value.end());
+    }
+}
+
+void row_batch::set_null(size_t column) {
+    auto& c = _columns[column];
+    c.states.push_back(null);
+    if (c.kind == value_kind::integer) {
+        c.integers.push_back(0);
+    } else {
+        c.strings.emplace_back();
+    }
+}
+
+void row_batch::set_ignored(size_t column) {
+    set_null(column);
+    _columns[column].states.back() = ignored;
+}
+
+struct batch_evaluator::kernel {
+    size_t column;
+    oper_t op;
+    // The result for a row, indexed by the row's cell_state. The entry for
+    // present cells is only used when the result doesn't depend on the value,
+    // e.g. when comparing with null.
+    std::array<uint8_t, 4> results;
+    bool constant = false;
+    // The right-hand side value, or the sorted values for IN.
+    std::vector<int64_t> integers;
+    std::vector<bytes> strings;
+    // For LIKE. When the pattern is a plain prefix followed by '%',
+    // strings[0] holds the prefix instead.
+    std::optional<like_matcher> matcher;
+};
+
+batch_evaluator::batch_evaluator() = default;
+batch_evaluator::batch_evaluator(batch_evaluator&&) noexcept = default;
+batch_evaluator::~batch_evaluator() = default;
+
+// Binds the right-hand side of IN to its values, dropping nulls.
+static std::optional<std::vector<bytes>> bind_in_values(term& rhs, const query_options& options) {
+    std::vector<bytes> values;
+    if (auto dv = dynamic_cast<lists::delayed_value*>(&rhs)) {
+        for (auto&& t : dv->get_elements()) {
+            if (auto v = to_bytes_opt(t->bind_and_get(options))) {
+                values.push_back(std::move(*v));
+            }
+        }
+    } else if (auto mkr = dynamic_cast<lists::marker*>(&rhs)) {
+        if (auto list = static_pointer_cast<lists::value>(mkr->bind(options))) {
+            for (auto&& v : list->get_elements()) {
+                if (v) {
+                    values.push_back(*v);
+                }
+            }
+        }
+    } else {
+        return std::nullopt;
+    }
+    return values;
+}
+
+// Returns the prefix if the pattern only matches strings starting with it.
+static std::optional<bytes> like_prefix(bytes_view pattern) {
+    if (pattern.empty() || pattern.back() != '%') {
+        return std::nullopt;
+    }
+    auto prefix = pattern.substr(0, pattern.size() - 1);
+    if (std::any_of(prefix.begin(), prefix.end(), [] (int8_t c) { return c == '%' || c == '_' || c == '\\'; })) {
+        return std::nullopt;
+    }
+    return bytes(prefix.begin(), prefix.end());
+}
+
+// The result of comparing an empty value of a fixed-size type, which sorts before anything else.
+static uint8_t empty_value_result(oper_t op) {
+    return op == oper_t::NEQ || op == oper_t::LT || op == oper_t::LTE;
+}
+
+std::optional<batch_evaluator> batch_evaluator::compile(
+        const std::vector<std::pair<const column_definition*, const expression*>>& restrictions,
+        const query_options& options) {
+    batch_evaluator ev;
+    for (auto&& [cdef, restriction] : restrictions) {
+        auto kind = row_batch::kind_of(*cdef->type);
+        if (!kind) {
+            return std::nullopt;
+        }
+        const size_t column = ev._columns.size();
+        ev._columns.push_back(cdef);
+
+        auto add_constant = [&] (oper_t op, bool value) {
+            ev._kernels.push_back(kernel{column, op, {value, value, value, 1}, true});
+        };
+        auto add_kernel = [&] (const binary_operator& opr) {
+            auto col = std::get_if<column_value>(&opr.lhs);
+            if (!col || col->sub || col->col != cdef) {
+                return false;
+            }
+            kernel k{column, opr.op, {opr.op == oper_t::NEQ, 0, empty_value_result(opr.op), 1}};
+            std::vector<bytes> values;
+            switch (opr.op) {
+            case oper_t::EQ:
+            case oper_t::NEQ:
+            case oper_t::LT:
+            case oper_t::LTE:
+            case oper_t::GT:
+            case oper_t::GTE:
+            case oper_t::LIKE: {
+                auto v = to_bytes_opt(opr.rhs->bind_and_get(options));
+                if (!v) {
+                    // Comparisons with null are false, so != null is always true.
+                    add_constant(opr.op, opr.op == oper_t::NEQ);
+                    return true;
+                }
+                values.push_back(std::move(*v));
+                break;
+            }
+            case oper_t::IN: {
+                auto in_values = bind_in_values(*opr.rhs, options);
+                if (!in_values) {
+                    return false;
+                }
+                if (in_values->empty()) {
+                    add_constant(opr.op, false);
+                    return true;
+                }
+                values = std::move(*in_values);
+                break;
+            }
+            default:
+                return false;
+            }
+
+            if (opr.op == oper_t::LIKE) {
+                if (*kind != row_batch::value_kind::string || !cdef->type->is_string()) {
+                    return false;
+                }
+                if (auto prefix = like_prefix(values[0])) {
+                    k.strings.push_back(std::move(*prefix));
+                } else {
+                    k.matcher.emplace(values[0]);
+                }
+            } else if (*kind == row_batch::value_kind::integer) {
+                for (auto& v : values) {
+                    auto i = decode_integer(v);
+                    if (!i) {
+                        return false;
+                    }
+                    k.integers.push_back(*i);
+                }
+                boost::sort(k.integers);
+                k.integers.erase(boost::unique(k.integers).end(), k.integers.end());
+            } else {
+                k.strings = std::move(values);
+                boost::sort(k.strings, [] (const bytes& a, const bytes& b) { return compare_unsigned(a, b) < 0; });
+                k.strings.erase(boost::unique(k.strings).end(), k.strings.end());
+            }
+            ev._kernels.push_back(std::move(k));
+            return true;
+        };
+
+        std::function<bool(const expression&)> add = [&] (const expression& e) {
+            return std::visit(overloaded_functor{
+                [&] (bool v) {
+                    if (!v) {
+                        add_constant(oper_t::EQ, false);
+                    }
+                    return true;
+                },
+                [&] (const conjunction& conj) {
+                    return std::all_of(conj.children.begin(), conj.children.end(), add);
+                },
+                [&] (const binary_operator& opr) {
+                    return add_kernel(opr);
+                },
+            }, e);
+        };
+        if (!add(*restriction)) {
+            return std::nullopt;
+        }
+    }
+    return ev;
+}
+
+template <typename Predicate>
+static void apply(std::vector<uint8_t>& selected, const std::vector<row_batch::cell_state>& states,
+        const std::array<uint8_t, 4>& results, Predicate&& pred) {
+    const size_t n = selected.size();
+    for (size_t i = 0; i < n; ++i) {
+        selected[i] &= states[i] == row_batch::present ? uint8_t(pred(i)) : results[states[i]];
+    }
+}
+
+// Below this many values, IN is checked with a linear scan rather than a binary search.
+static constexpr size_t in_linear_scan_limit = 8;
+
+static void apply_integer(std::vector<uint8_t>& selected, const row_batch::column& c, oper_t op,
+        const std::array<uint8_t, 4>& results, const std::vector<int64_t>& rhs) {
+    const int64_t* values = c.integers.data();
+    const int64_t v = rhs[0];
+    switch (op) {
+    case oper_t::EQ: return apply(selected, c.states, results, [&] (size_t i) { return values[i] == v; });
+    case oper_t::NEQ: return apply(selected, c.states, results, [&] (size_t i) { return values[i] != v; });
+    case oper_t::LT: return apply(selected, c.states, results, [&] (size_t i) { return values[i] < v; });
+    case oper_t::LTE: return apply(selected, c.states, results, [&] (size_t i) { return values[i] <= v; });
+    case oper_t::GT: return apply(selected, c.states, results, [&] (size_t i) { return values[i] > v; });
+    case oper_t::GTE: return apply(selected, c.states, results, [&] (size_t i) { return values[i] >= v; });
+    case oper_t::IN:
+        if (rhs.size() <= in_linear_scan_limit) {
+            return apply(selected, c.states, results, [&] (size_t i) {
+                return std::find(rhs.begin(), rhs.end(), values[i]) != rhs.end();
+            });
+        }
+        return apply(selected, c.states, results, [&] (size_t i) {
+            return std::binary_search(rhs.begin(), rhs.end(), values[i]);
+        });
+    default:
+        throw std::logic_error(format("Unexpected operator {} in batch evaluation", op));
+    }
+}
+
+static void apply_string(std::vector<uint8_t>& selected, const row_batch::column& c, oper_t op,
+        const std::array<uint8_t, 4>& results, const std::vector<bytes>& rhs, const std::optional<like_matcher>& matcher) {
+    const bytes* values = c.strings.data();
+    auto cmp = [&] (size_t i) { return compare_unsigned(values[i], rhs[0]); };
+    switch (op) {
+    case oper_t::EQ: return apply(selected, c.states, results, [&] (size_t i) { return values[i] == rhs[0]; });
+    case oper_t::NEQ: return apply(selected, c.states, results, [&] (size_t i) { return values[i] != rhs[0]; });
+    case oper_t::LT: return apply(selected, c.states, results, [&] (size_t i) { return cmp(i) < 0; });
+    case oper_t::LTE: return apply(selected, c.states, results, [&] (size_t i) { return cmp(i) <= 0; });
+    case oper_t::GT: return apply(selected, c.states, results, [&] (size_t i) { return cmp(i) > 0; });
+    case oper_t::GTE: return apply(selected, c.states, results, [&] (size_t i) { return cmp(i) >= 0; });
+    case oper_t::IN: {
+        auto less = [] (const bytes& a, const bytes& b) { return compare_unsigned(a, b) < 0; };
+        if (rhs.size() <= in_linear_scan_limit) {
+            return apply(selected, c.states, results, [&] (size_t i) {
+                return std::find(rhs.begin(), rhs.end(), values[i]) != rhs.end();
+            });
+        }
+        return apply(selected, c.states, results, [&] (size_t i) {
+            return std::binary_search(rhs.begin(), rhs.end(), values[i], less);
+        });
+    }
+    case oper_t::LIKE:
+        if (matcher) {
+            return apply(selected, c.states, results, [&] (size_t i) { return (*matcher)(values[i]); });
+        }
+        return apply(selected, c.states, results, [&, prefix = bytes_view(rhs[0])] (size_t i) {
+            return values[i].size() >= prefix.size() && std::equal(prefix.begin(), prefix.end(), values[i].begin());
+        });
+    default:
+        throw std::logic_error(format("Unexpected operator {} in batch evaluation", op));
+    }
+}
+
+std::vector<uint8_t> batch_evaluator::evaluate(const row_batch& batch) const {
+    std::vector<uint8_t> selected(batch.size(), 1);
+    for (auto& k : _kernels) {
+        auto& c = batch.columns()[k.column];
+        if (k.constant) {
+            for (size_t i = 0; i < selected.size(); ++i) {
+                selected[i] &= k.results[c.states[i]];
+            }
+        } else if (c.kind == row_batch::value_kind::integer) {
+            apply_integer(selected, c, k.op, k.results, k.integers);
+        } else {
+            apply_string(selected, c, k.op, k.results, k.strings, k.matcher);
+        }
+    }
+    return selected;
+}
+
+} // namespace expr
+
+} // namespace cql3
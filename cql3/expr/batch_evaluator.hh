@@ -0,0 +1,124 @@
+/*
+ * Copyright (C) 2020 ScyllaDB
+ */
+
+/*
+ * This file is part of Scylla.
+ *
+ * Scylla is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Affero General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Scylla is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Scylla.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#pragma once
+
+#include <optional>
+#include <vector>
+
+#include "bytes.hh"
+#include "cql3/expr/expression.hh"
+#include "utils/like_matcher.hh"
+
+namespace cql3 {
+
+namespace expr {
+
+/// Values of a page of rows, decoded into a vector per column.
+///
+/// Rows are appended one at a time, with a value (or the lack of one) for each
+/// column of the batch, in the order of the columns passed to the constructor.
+class row_batch {
+public:
+    /// How a cell is to be treated by the evaluator.
+    enum cell_state : uint8_t {
+        null = 0,    ///< Missing value, satisfies no comparison.
+        present = 1,
+        empty = 2,   ///< Empty value of a fixed-size type, which sorts before all others.
+        ignored = 3, ///< The column isn't checked for this row, e.g. a regular column of a partition without rows.
+    };
+    enum class value_kind { integer, string };
+
+    struct column {
+        const column_definition* def;
+        value_kind kind;
+        std::vector<cell_state> states;
+        /// Values of integer columns, sign-extended to 64 bits.
+        std::vector<int64_t> integers;
+        std::vector<bytes> strings;
+    };
+private:
+    std::vector<column> _columns;
+    size_t _size = 0;
+public:
+    explicit row_batch(const std::vector<const column_definition*>& columns);
+
+    size_t size() const {
+        return _size;
+    }
+    const std::vector<column>& columns() const {
+        return _columns;
+    }
+
+    /// Starts the next row. All columns have to be set before the next call.
+    void new_row() {
+        ++_size;
+    }
+    void set_value(size_t column, bytes_view value);
+    void set_null(size_t column);
+    void set_ignored(size_t column);
+
+    /// Returns the kind of values of columns of the type, or std::nullopt
+    /// if the type isn't supported.
+    static std::optional<value_kind> kind_of(const abstract_type& type);
+};
+
+/// Evaluates the restrictions of a filtering query on a whole page of rows at once.
+///
+/// The restrictions are bound to the query options once, and each comparison is then
+/// applied to all values of its column, with a loop specialized for the column's type
+/// and the operator. The result is a selection vector with a 1 for each row
+/// satisfying all restrictions, and a 0 otherwise.
+///
+/// Only single-column comparisons (=, !=, <, <=, >, >=, IN and LIKE) on integer,
+/// timestamp and string columns are supported. The semantics are those of
+/// is_satisfied_by().
+class batch_evaluator {
+    struct kernel;
+    std::vector<const column_definition*> _columns;
+    std::vector<kernel> _kernels;
+private:
+    batch_evaluator();
+public:
+    batch_evaluator(batch_evaluator&&) noexcept;
+    ~batch_evaluator();
+
+    /// Compiles the restrictions, given as pairs of a column and the expression restricting it.
+    /// Returns std::nullopt if any of them can't be evaluated in batch.
+    static std::optional<batch_evaluator> compile(
+            const std::vector<std::pair<const column_definition*, const expression*>>& restrictions,
+            const query_options& options);
+
+    /// The columns which rows of the batch must contain, in order.
+    const std::vector<const column_definition*>& columns() const {
+        return _columns;
+    }
+
+    row_batch make_batch() const {
+        return row_batch(_columns);
+    }
+
+    std::vector<uint8_t> evaluate(const row_batch& batch) const;
+};
+
+} // namespace expr
+
+} // namespace cql3
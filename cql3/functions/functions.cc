@@ -66,6 +66,16 @@ void functions::clear_functions() noexcept {
     functions::_declared = init();
 }
 
+std::vector<function_name> functions::non_pure_function_names() {
+    std::vector<function_name> names;
+    for (auto&& [name, fun] : _declared) {
+        if (!fun->is_pure()) {
+            names.push_back(name);
+        }
+    }
+    return names;
+}
+
 std::unordered_multimap<function_name, shared_ptr<function>>
 functions::init() noexcept {
     // It is possible that this function will fail with a
@@ -92,6 +92,8 @@ class functions {
     static declared_t::iterator find_iter(const function_name& name, const std::vector<data_type>& arg_types);
     static shared_ptr<function> find(const function_name& name, const std::vector<data_type>& arg_types);
     static void clear_functions() noexcept;
+    // Names of the functions whose result isn't determined by their arguments, like now().
+    static std::vector<function_name> non_pure_function_names();
     static void add_function(shared_ptr<function>);
     static void replace_function(shared_ptr<function>);
     static void remove_function(const function_name& name, const std::vector<data_type>& arg_types);
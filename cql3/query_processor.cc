@@ -46,6 +46,7 @@
 #include "cql3/CqlParser.hpp"
 #include "cql3/error_collector.hh"
 #include "cql3/statements/batch_statement.hh"
+#include "cql3/statements/select_statement.hh"
 #include "cql3/util.hh"
 #include "cql3/untyped_result_set.hh"
 #include "db/config.hh"
@@ -97,7 +98,8 @@ query_processor::query_processor(service::storage_proxy& proxy, database& db, se
         , _authorized_prepared_cache(std::min(std::chrono::milliseconds(_db.get_config().permissions_validity_in_ms()),
                                               std::chrono::duration_cast<std::chrono::milliseconds>(prepared_statements_cache::entry_expiry)),
                                      std::chrono::milliseconds(_db.get_config().permissions_update_interval_in_ms()),
-                                     mcfg.authorized_prepared_cache_size, authorized_prepared_statements_cache_log) {
+                                     mcfg.authorized_prepared_cache_size, authorized_prepared_statements_cache_log)
+        , _result_cache(mcfg.result_cache_size) {
     namespace sm = seastar::metrics;
     namespace stm = statements;
     using clevel = db::consistency_level;
@@ -461,12 +463,18 @@ query_processor::query_processor(service::storage_proxy& proxy, database& db, se
             });
 
     _mnotifier.register_listener(_migration_subscriber.get());
+    if (_result_cache.enabled()) {
+        _db.data_listeners().install(&_result_cache);
+    }
 }
 
 query_processor::~query_processor() {
 }
 
 future<> query_processor::stop() {
+    if (_db.data_listeners().exists(&_result_cache)) {
+        _db.data_listeners().uninstall(&_result_cache);
+    }
     return _mnotifier.unregister_listener(_migration_subscriber.get()).then([this] {
         return _authorized_prepared_cache.stop().finally([this] { return _prepared_cache.stop(); });
     });
@@ -506,6 +514,16 @@ query_processor::execute_prepared(
         bool needs_authorization) {
 
     ::shared_ptr<cql_statement> statement = prepared->statement;
+    // Computed before authorization, which consumes the cache key.
+    std::optional<bytes> result_key;
+    std::optional<dht::decorated_key> result_partition;
+    auto select = dynamic_pointer_cast<statements::select_statement>(statement);
+    if (_result_cache.enabled() && select) {
+        result_partition = select->get_cacheable_partition(options);
+        if (result_partition) {
+            result_key = result_cache::make_key(cache_key, options);
+        }
+    }
     future<> fut = make_ready_future<>();
     if (needs_authorization) {
         fut = statement->check_access(_proxy, query_state.get_client_state()).then([this, &query_state, prepared = std::move(prepared), cache_key = std::move(cache_key)] () mutable {
@@ -516,8 +534,30 @@ query_processor::execute_prepared(
     }
     log.trace("execute_prepared: \"{}\"", statement->raw_cql_statement);
 
-    return fut.then([this, statement = std::move(statement), &query_state, &options] () mutable {
-        return process_authorized_statement(std::move(statement), query_state, options);
+    if (!result_key) {
+        return fut.then([this, statement = std::move(statement), &query_state, &options] () mutable {
+            return process_authorized_statement(std::move(statement), query_state, options);
+        });
+    }
+    return fut.then([this, select = std::move(select), &query_state, &options,
+            result_key = std::move(*result_key), result_partition = std::move(*result_partition)] () mutable {
+        if (auto rs = _result_cache.get(result_key, *select->get_schema())) {
+            tracing::trace(query_state.get_trace_state(), "Result served from the coordinator result cache");
+            ++_stats.queries_by_cl[size_t(options.get_consistency())];
+            return make_ready_future<::shared_ptr<result_message>>(
+                    ::make_shared<result_message::rows>(result(std::move(rs))));
+        }
+        auto generation = _result_cache.generation(result_partition.token());
+        return process_authorized_statement(select, query_state, options).then([this, select, generation,
+                result_key = std::move(result_key), result_partition = std::move(result_partition)] (::shared_ptr<result_message> msg) mutable {
+            if (auto rows = dynamic_pointer_cast<result_message::rows>(msg)) {
+                auto& rs = rows->rs().result_set();
+                if (!rs.get_metadata().paging_state()) {
+                    _result_cache.put(std::move(result_key), *select->get_schema(), std::move(result_partition), rs, generation);
+                }
+            }
+            return msg;
+        });
     });
 }
 
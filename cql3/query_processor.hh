@@ -50,6 +50,7 @@
 
 #include "cql3/prepared_statements_cache.hh"
 #include "cql3/authorized_prepared_statements_cache.hh"
+#include "cql3/result_cache.hh"
 #include "cql3/query_options.hh"
 #include "cql3/statements/prepared_statement.hh"
 #include "exceptions/exceptions.hh"
@@ -108,6 +109,7 @@ class query_processor {
     struct memory_config {
         size_t prepared_statment_cache_size = 0;
         size_t authorized_prepared_cache_size = 0;
+        size_t result_cache_size = 0;
     };
 
 private:
@@ -131,6 +133,7 @@ class query_processor {
 
     prepared_statements_cache _prepared_cache;
     authorized_prepared_statements_cache _authorized_prepared_cache;
+    result_cache _result_cache;
 
     // A map for prepared statements used internally (which we don't want to mix with user statement, in particular we
     // don't bother with expiration on those.
@@ -161,6 +164,10 @@ class query_processor {
         return _cql_config;
     }
 
+    const result_cache& get_result_cache() const {
+        return _result_cache;
+    }
+
     service::storage_proxy& proxy() {
         return _proxy;
     }
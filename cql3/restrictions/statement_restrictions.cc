@@ -216,6 +216,7 @@ statement_restrictions::statement_restrictions(database& db,
 
     // At this point, the select statement if fully constructed, but we still have a few things to validate
     process_partition_key_restrictions(has_queriable_pk_index, for_view, allow_filtering);
+    prepare_single_partition_key();
 
     // Some but not all of the partition key columns have been specified;
     // hence we need turn these restrictions into index expressions.
@@ -490,7 +491,52 @@ void statement_restrictions::process_clustering_columns_restrictions(bool has_qu
     }
 }
 
+void statement_restrictions::prepare_single_partition_key() {
+    auto pk_restrictions = dynamic_pointer_cast<single_column_partition_key_restrictions>(_partition_key_restrictions);
+    if (!pk_restrictions || pk_restrictions->size() != _schema->partition_key_size()
+            || pk_restrictions->needs_filtering(*_schema)) {
+        return;
+    }
+    std::vector<::shared_ptr<term>> terms;
+    terms.reserve(_schema->partition_key_size());
+    for (auto&& [def, r] : pk_restrictions->restrictions()) {
+        auto op = std::get_if<expr::binary_operator>(&r->expression);
+        if (!op || op->op != expr::oper_t::EQ || !op->rhs) {
+            return;
+        }
+        terms.push_back(op->rhs);
+    }
+    _partition_key_terms = std::move(terms);
+}
+
+dht::decorated_key statement_restrictions::get_single_partition_key(const query_options& options) const {
+    auto bind_component = [&] (size_t i) {
+        const auto b = _partition_key_terms[i]->bind_and_get(options);
+        if (!b) {
+            throw exceptions::invalid_request_exception(format("Invalid null value for partition key part {}",
+                    _schema->partition_key_columns()[i].name_as_text()));
+        }
+        return to_bytes(b);
+    };
+    auto key = [&] {
+        if (_partition_key_terms.size() == 1) {
+            return partition_key::from_single_value(*_schema, bind_component(0));
+        }
+        std::vector<bytes> components;
+        components.reserve(_partition_key_terms.size());
+        for (size_t i = 0; i < _partition_key_terms.size(); ++i) {
+            components.push_back(bind_component(i));
+        }
+        return partition_key::from_exploded(*_schema, std::move(components));
+    }();
+    auto token = dht::get_token(*_schema, key);
+    return dht::decorated_key(std::move(token), std::move(key));
+}
+
 dht::partition_range_vector statement_restrictions::get_partition_key_ranges(const query_options& options) const {
+    if (is_single_partition_key()) {
+        return {dht::partition_range::make_singular(get_single_partition_key(options))};
+    }
     if (_partition_key_restrictions->empty()) {
         return {dht::partition_range::make_open_ended_both_sides()};
     }
@@ -513,6 +559,58 @@ std::vector<query::clustering_range> statement_restrictions::get_clustering_boun
     return _clustering_columns_restrictions->bounds_ranges(options);
 }
 
+static bool can_filter_on_replica(const expr::binary_operator& op) {
+    auto col = std::get_if<expr::column_value>(&op.lhs);
+    if (!col || col->sub) {
+        return false;
+    }
+    switch (op.op) {
+    case expr::oper_t::EQ:
+    case expr::oper_t::LT:
+    case expr::oper_t::LTE:
+    case expr::oper_t::GT:
+    case expr::oper_t::GTE:
+    case expr::oper_t::IN:
+        return true;
+    default:
+        return false;
+    }
+}
+
+std::vector<query::column_filter> statement_restrictions::get_column_filters(const query_options& options) const {
+    std::vector<query::column_filter> filters;
+    for (auto&& [cdef, restriction] : _nonprimary_key_restrictions->restrictions()) {
+        if (!cdef->is_regular() || !cdef->is_atomic() || cdef->is_counter()) {
+            continue;
+        }
+        expr::conjunction pushed;
+        auto add = [&] (const expr::expression& e) {
+            if (auto op = std::get_if<expr::binary_operator>(&e); op && can_filter_on_replica(*op)) {
+                pushed.children.push_back(*op);
+            }
+        };
+        if (auto conj = std::get_if<expr::conjunction>(&restriction->expression)) {
+            std::for_each(conj->children.begin(), conj->children.end(), add);
+        } else {
+            add(restriction->expression);
+        }
+        if (pushed.children.empty()) {
+            continue;
+        }
+        auto values = expr::possible_lhs_values(cdef, std::move(pushed), options);
+        if (auto list = std::get_if<expr::value_list>(&values)) {
+            filters.push_back(query::column_filter{cdef->id, std::move(*list), {}});
+        } else {
+            auto& range = std::get<nonwrapping_range<bytes>>(values);
+            if (!range.start() && !range.end()) {
+                continue;
+            }
+            filters.push_back(query::column_filter{cdef->id, std::nullopt, std::move(range)});
+        }
+    }
+    return filters;
+}
+
 bool statement_restrictions::need_filtering() const {
     uint32_t number_of_restricted_columns_for_indexing = 0;
     for (auto&& restrictions : _index_restrictions) {
@@ -102,6 +102,14 @@ class statement_restrictions {
      */
     bool _is_key_range = false;
 
+    /**
+     * The terms binding each partition key component, in schema order, if all of them
+     * are restricted by an equality. Computed once, when the statement is prepared, so
+     * that executing a single-partition statement builds its key straight from the bound
+     * values instead of walking the restrictions.
+     */
+    std::vector<::shared_ptr<term>> _partition_key_terms;
+
 public:
     /**
      * Creates a new empty <code>StatementRestrictions</code>.
@@ -161,6 +169,19 @@ class statement_restrictions {
         return _is_key_range;
     }
 
+    /**
+     * Checks if the partition key is fully restricted by equalities, so that the query
+     * always targets exactly one partition.
+     */
+    bool is_single_partition_key() const {
+        return !_partition_key_terms.empty();
+    }
+
+    /**
+     * Returns the partition key bound by the options. May only be called if is_single_partition_key().
+     */
+    dht::decorated_key get_single_partition_key(const query_options& options) const;
+
     /**
      * Checks if the secondary index need to be queried.
      *
@@ -213,6 +234,8 @@ class statement_restrictions {
 private:
     void process_partition_key_restrictions(bool has_queriable_index, bool for_view, bool allow_filtering);
 
+    void prepare_single_partition_key();
+
     /**
      * Returns the partition key components that are not restricted.
      * @return the partition key components that are not restricted.
@@ -396,6 +419,13 @@ class statement_restrictions {
      */
     bool need_filtering() const;
 
+    /**
+     * Binds the restrictions on regular columns which replicas can evaluate on their own,
+     * see query::column_filter. Restrictions which are also satisfied by a missing value,
+     * or which need the whole collection, are left out and only evaluated by the coordinator.
+     */
+    std::vector<query::column_filter> get_column_filters(const query_options& options) const;
+
     void validate_secondary_index_selections(bool selects_only_static_columns);
 
     /**
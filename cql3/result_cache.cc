@@ -0,0 +1,277 @@
+/*
+ * Copyright (C) 2020 ScyllaDB
+ */
+
+/*
+ * This file is part of Scylla.
+ *
+ * Scylla is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Affero General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Scylla is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU Affero General Public License
+ * along with Scylla.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <seastar/core/metrics.hh>
+
+#include "cql3/result_cache.hh"
+#include "cql3/query_options.hh"
+#include "bytes_ostream.hh"
+#include "frozen_mutation.hh"
+#include "schema.hh"
+#include "types.hh"
+#include "utils/small_vector.hh"
+
+namespace cql3 {
+
+// Don't let a single result take more than this fraction of the cache.
+static constexpr size_t max_entry_fraction = 16;
+
+// Keeps the reclaimer away while the cache is being modified or iterated.
+class reclaim_blocker {
+    bool& _blocked;
+public:
+    explicit reclaim_blocker(bool& blocked) noexcept : _blocked(blocked) {
+        _blocked = true;
+    }
+    ~reclaim_blocker() {
+        _blocked = false;
+    }
+};
+
+result_cache::entry::entry(bytes k, const schema& s, dht::decorated_key dk, lowres_clock::time_point exp, const result_set& rs)
+        : key(std::move(k))
+        , table_id(s.id())
+        , schema_version(s.version())
+        , partition(std::move(dk))
+        , expiry(exp)
+        , result_metadata(::make_shared<metadata>(rs.get_metadata()))
+        , rows(rs.rows().begin(), rs.rows().end()) {
+    // The key is stored twice, here and in the index.
+    memory_usage = sizeof(entry) + 2 * key.size() + partition.key().representation().size();
+    for (auto& row : rows) {
+        memory_usage += sizeof(row) + row.capacity() * sizeof(bytes_opt);
+        for (auto& cell : row) {
+            memory_usage += cell ? cell->size() : 0;
+        }
+    }
+}
+
+result_cache::result_cache(size_t max_memory)
+        : _max_memory(max_memory)
+        , _reclaimer([this] (seastar::memory::reclaimer::request r) { return reclaim(r); }, memory::reclaimer_scope::sync) {
+    namespace sm = seastar::metrics;
+    _metrics.add_group("result_cache", {
+        sm::make_derive("hits", _stats.hits,
+                sm::description("Counts the SELECTs served from the coordinator result cache.")),
+        sm::make_derive("misses", _stats.misses,
+                sm::description("Counts the cacheable SELECTs which weren't found in the coordinator result cache.")),
+        sm::make_derive("insertions", _stats.insertions,
+                sm::description("Counts the results inserted into the coordinator result cache.")),
+        sm::make_derive("invalidations", _stats.invalidations,
+                sm::description("Counts the results removed from the coordinator result cache because of writes to their partitions.")),
+        sm::make_derive("evictions", _stats.evictions,
+                sm::description("Counts the results evicted from the coordinator result cache to free memory, or because they expired.")),
+        sm::make_gauge("entries", [this] { return _entries.size(); },
+                sm::description("Holds the number of results in the coordinator result cache.")),
+        sm::make_gauge("bytes", [this] { return _memory; },
+                sm::description("Holds the memory used by the coordinator result cache.")),
+    });
+}
+
+result_cache::~result_cache() {
+    reclaim_blocker blocker(_reclaim_blocked);
+    while (!_lru.empty()) {
+        evict(_lru.front());
+    }
+}
+
+bytes result_cache::make_key(const prepared_cache_key_type& id, const query_options& options) {
+    bytes_ostream out;
+    auto write_int = [&out] (auto v) {
+        out.write(reinterpret_cast<const char*>(&v), sizeof(v));
+    };
+    const auto& [cql_id, thrift_id] = id.key();
+    write_int(uint32_t(cql_id.size()));
+    out.write(cql_id);
+    write_int(thrift_id);
+    write_int(uint8_t(options.get_consistency()));
+    write_int(options.get_page_size());
+    write_int(options.get_cql_serialization_format().protocol_version());
+    write_int(uint32_t(options.get_values_count()));
+    for (size_t i = 0; i < options.get_values_count(); ++i) {
+        auto value = options.get_value_at(i);
+        if (!value) {
+            write_int(int32_t(value.is_null() ? -1 : -2));
+            continue;
+        }
+        write_int(int32_t(value->size_bytes()));
+        for (bytes_view fragment : *value) {
+            out.write(fragment);
+        }
+    }
+    return to_bytes(out.linearize());
+}
+
+void result_cache::evict(entry& e) noexcept {
+    auto [begin, end] = _by_token.equal_range(e.partition.token());
+    for (auto it = begin; it != end; ++it) {
+        if (it->second == &e) {
+            _by_token.erase(it);
+            break;
+        }
+    }
+    _lru.erase(_lru.iterator_to(e));
+    _memory -= e.memory_usage;
+    // Destroys e.
+    _entries.erase(e.key);
+}
+
+memory::reclaiming_result result_cache::reclaim(seastar::memory::reclaimer::request r) noexcept {
+    if (_reclaim_blocked || _lru.empty()) {
+        return memory::reclaiming_result::reclaimed_nothing;
+    }
+    size_t reclaimed = 0;
+    while (!_lru.empty() && reclaimed < r.bytes_to_reclaim) {
+        auto& e = _lru.front();
+        reclaimed += e.memory_usage;
+        evict(e);
+        ++_stats.evictions;
+    }
+    return memory::reclaiming_result::reclaimed_something;
+}
+
+std::unique_ptr<result_set> result_cache::get(const bytes& key, const schema& s) {
+    auto it = _entries.find(key);
+    if (it == _entries.end()) {
+        ++_stats.misses;
+        return nullptr;
+    }
+    reclaim_blocker blocker(_reclaim_blocked);
+    auto& e = *it->second;
+    if (e.schema_version != s.version() || e.expiry <= lowres_clock::now()) {
+        evict(e);
+        ++_stats.evictions;
+        ++_stats.misses;
+        return nullptr;
+    }
+    _lru.erase(_lru.iterator_to(e));
+    _lru.push_back(e);
+    ++_stats.hits;
+
+    auto rs = std::make_unique<result_set>(::make_shared<metadata>(*e.result_metadata));
+    for (auto& row : e.rows) {
+        rs->add_row(row);
+    }
+    return rs;
+}
+
+void result_cache::put(bytes key, const schema& s, dht::decorated_key partition, const result_set& rs, generation_type generation) {
+    auto ttl = s.result_cache_ttl();
+    if (!ttl || generation != this->generation(partition.token()) || !enabled() || !rs.expiry()) {
+        return;
+    }
+    auto expiry = lowres_clock::now() + *ttl;
+    if (*rs.expiry() != gc_clock::time_point::max()) {
+        // Expiry has the granularity of gc_clock, so the cells may already be gone a
+        // little before.
+        auto now = gc_clock::now();
+        if (*rs.expiry() <= now + gc_clock::duration(1)) {
+            return;
+        }
+        expiry = std::min(expiry, lowres_clock::now() + std::chrono::duration_cast<lowres_clock::duration>(*rs.expiry() - now - gc_clock::duration(1)));
+    }
+    auto e = std::make_unique<entry>(std::move(key), s, std::move(partition), expiry, rs);
+    if (e->memory_usage > _max_memory / max_entry_fraction) {
+        return;
+    }
+
+    reclaim_blocker blocker(_reclaim_blocked);
+    if (auto it = _entries.find(e->key); it != _entries.end()) {
+        evict(*it->second);
+    }
+    while (!_lru.empty() && _memory + e->memory_usage > _max_memory) {
+        evict(_lru.front());
+        ++_stats.evictions;
+    }
+    try {
+        auto& ref = *e;
+        auto token = ref.partition.token();
+        _by_token.emplace(token, &ref);
+        try {
+            _entries.emplace(ref.key, std::move(e));
+        } catch (...) {
+            auto [begin, end] = _by_token.equal_range(token);
+            for (auto it = begin; it != end; ++it) {
+                if (it->second == &ref) {
+                    _by_token.erase(it);
+                    break;
+                }
+            }
+            throw;
+        }
+        _lru.push_back(ref);
+        _memory += ref.memory_usage;
+        ++_stats.insertions;
+    } catch (...) {
+        // Not caching the result is fine.
+    }
+}
+
+void result_cache::on_write(const schema_ptr& s, const frozen_mutation& m) {
+    if (!s->result_cache_ttl()) {
+        return;
+    }
+    auto dk = m.decorated_key(*s);
+    ++_generations[generation_bucket(dk.token())];
+    if (_entries.empty()) {
+        return;
+    }
+    reclaim_blocker blocker(_reclaim_blocked);
+    utils::small_vector<entry*, 4> invalidated;
+    auto [begin, end] = _by_token.equal_range(dk.token());
+    for (auto it = begin; it != end; ++it) {
+        auto& e = *it->second;
+        if (e.table_id == s->id() && e.partition.key().equal(*s, dk.key())) {
+            invalidated.push_back(&e);
+        }
+    }
+    for (auto e : invalidated) {
+        evict(*e);
+        ++_stats.invalidations;
+    }
+}
+
+void result_cache::on_invalidate(const schema_ptr& s, const dht::partition_range& range) {
+    if (!s->result_cache_ttl()) {
+        return;
+    }
+    // Rare enough to go over all entries, and all generations.
+    for (auto& generation : _generations) {
+        ++generation;
+    }
+    if (_entries.empty()) {
+        return;
+    }
+    reclaim_blocker blocker(_reclaim_blocked);
+    dht::ring_position_comparator cmp(*s);
+    std::vector<entry*> invalidated;
+    for (auto& e : _lru) {
+        if (e.table_id == s->id() && range.contains(dht::ring_position(e.partition), cmp)) {
+            invalidated.push_back(&e);
+        }
+    }
+    for (auto e : invalidated) {
+        evict(*e);
+        ++_stats.invalidations;
+    }
+}
+
+}
@@ -0,0 +1,147 @@
+/*
+ * Copyright (C) 2020 ScyllaDB
+ */
+
+/*
+ * This file is part of Scylla.
+ *
+ * Scylla is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Affero General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Scylla is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU Affero General Public License
+ * along with Scylla.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#pragma once
+
+#include <array>
+#include <unordered_map>
+#include <boost/intrusive/list.hpp>
+
+#include <seastar/core/memory.hh>
+#include <seastar/core/metrics_registration.hh>
+
+#include "bytes.hh"
+#include "db/data_listeners.hh"
+#include "dht/i_partitioner.hh"
+#include "utils/UUID.hh"
+#include "cql3/result_set.hh"
+#include "cql3/prepared_statements_cache.hh"
+
+namespace cql3 {
+
+class query_options;
+
+/// Coordinator-side cache of the results of prepared single-partition SELECTs,
+/// for the tables which opt in with the `result_cache_ttl_in_ms` option.
+///
+/// Results are keyed by the prepared statement id and the bound values, along
+/// with the options affecting the result. They are only cached on the shard
+/// owning the partition, which is the shard applying all writes to it on this
+/// node, so that the cache, as a data listener, sees and invalidates them
+/// synchronously once they are applied. Sstables added by streaming, repair or
+/// a load, and truncates, invalidate the results of the affected range. Writes
+/// which never reach the node are bounded by the table's TTL, after which
+/// entries expire. Results holding expiring cells expire with the first of
+/// them.
+///
+/// The cache is bounded by its memory limit, evicting the least recently used
+/// entries, and gives memory back to the seastar allocator when it runs low.
+class result_cache : public db::data_listener {
+public:
+    struct stats {
+        uint64_t hits = 0;
+        uint64_t misses = 0;
+        uint64_t insertions = 0;
+        uint64_t invalidations = 0;
+        uint64_t evictions = 0;
+    };
+    // Incremented on every write to a partition of a table using the cache, and on every
+    // invalidation of its data. A result read before the write may be stale, so it is only
+    // inserted if the generation of its partition didn't change. Partitions share the
+    // generations of their token's bucket, so that they don't have to be kept for each of
+    // them, at the cost of failing some insertions needlessly.
+    using generation_type = uint64_t;
+private:
+    struct entry {
+        boost::intrusive::list_member_hook<> lru_link;
+        bytes key;
+        utils::UUID table_id;
+        table_schema_version schema_version;
+        dht::decorated_key partition;
+        lowres_clock::time_point expiry;
+        ::shared_ptr<metadata> result_metadata;
+        std::vector<std::vector<bytes_opt>> rows;
+        size_t memory_usage;
+
+        entry(bytes k, const schema& s, dht::decorated_key dk, lowres_clock::time_point exp, const result_set& rs);
+    };
+    using lru_type = boost::intrusive::list<entry,
+        boost::intrusive::member_hook<entry, boost::intrusive::list_member_hook<>, &entry::lru_link>,
+        boost::intrusive::constant_time_size<false>>;
+
+    size_t _max_memory;
+    size_t _memory = 0;
+    std::unordered_map<bytes, std::unique_ptr<entry>> _entries;
+    std::unordered_multimap<dht::token, entry*> _by_token;
+    // Least recently used at the front.
+    lru_type _lru;
+    static constexpr size_t generation_buckets = 1024;
+    std::array<generation_type, generation_buckets> _generations{};
+    // Set while the containers are being modified, when reclaiming from them isn't safe.
+    bool _reclaim_blocked = false;
+    stats _stats;
+    seastar::memory::reclaimer _reclaimer;
+    seastar::metrics::metric_groups _metrics;
+private:
+    static size_t generation_bucket(const dht::token& t) {
+        return uint64_t(t.raw()) % generation_buckets;
+    }
+    void evict(entry& e) noexcept;
+    memory::reclaiming_result reclaim(seastar::memory::reclaimer::request r) noexcept;
+public:
+    explicit result_cache(size_t max_memory);
+    ~result_cache();
+
+    // Builds the key of the result of the prepared statement with the options.
+    static bytes make_key(const prepared_cache_key_type& id, const query_options& options);
+
+    generation_type generation(const dht::token& t) const {
+        return _generations[generation_bucket(t)];
+    }
+
+    bool enabled() const {
+        return _max_memory != 0;
+    }
+
+    // Returns a copy of the cached result, or nullptr if there is none, or it is
+    // no longer valid for the schema.
+    std::unique_ptr<result_set> get(const bytes& key, const schema& s);
+
+    // Caches the complete result of reading the partition, unless a write to the partition
+    // was applied since generation() returned the given generation for its token. The result
+    // expires after the table's TTL, or when its cells do, if earlier.
+    void put(bytes key, const schema& s, dht::decorated_key partition, const result_set& rs, generation_type generation);
+
+    virtual void on_write(const schema_ptr& s, const frozen_mutation& m) override;
+    virtual void on_invalidate(const schema_ptr& s, const dht::partition_range& range) override;
+
+    size_t memory_usage() const {
+        return _memory;
+    }
+    size_t size() const {
+        return _entries.size();
+    }
+    const stats& get_stats() const {
+        return _stats;
+    }
+};
+
+}
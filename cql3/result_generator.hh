@@ -36,8 +36,13 @@ class result_generator {
     template<typename Visitor>
     class query_result_visitor {
         const schema& _schema;
+        // The partition key outlives the call which passes it, since it is used
+        // for the rows of the partition, so its components are copied. The
+        // clustering key is only used while it is being visited, so views of its
+        // components are enough, kept in a vector reused across rows so that
+        // visiting a page doesn't allocate per row.
         std::vector<bytes> _partition_key;
-        std::vector<bytes> _clustering_key;
+        std::vector<bytes_view> _clustering_key;
         uint64_t _partition_row_count = 0;
         uint64_t _total_row_count = 0;
         Visitor& _visitor;
@@ -66,8 +71,11 @@ class result_generator {
 
         void accept_new_row(const clustering_key& key, query::result_row_view static_row,
                             query::result_row_view row) {
-            _clustering_key = key.explode(_schema);
+            for (bytes_view c : key.components(_schema)) {
+                _clustering_key.push_back(c);
+            }
             accept_new_row(static_row, row);
+            _clustering_key.clear();
         }
         void accept_new_row(query::result_row_view static_row, query::result_row_view row) {
             auto static_row_iterator = static_row.iterator();
@@ -80,7 +88,7 @@ class result_generator {
                     break;
                 case column_kind::clustering_key:
                     if (_clustering_key.size() > def->component_index()) {
-                        _visitor.accept_value(query::result_bytes_view(bytes_view(_clustering_key[def->component_index()])));
+                        _visitor.accept_value(query::result_bytes_view(_clustering_key[def->component_index()]));
                     } else {
                         _visitor.accept_value({});
                     }
@@ -116,6 +124,67 @@ class result_generator {
 
         uint64_t rows_read() const { return _total_row_count; }
     };
+
+    class expiry_visitor {
+        const selection::selection& _selection;
+        uint64_t _partition_row_count = 0;
+        std::optional<gc_clock::time_point> _expiry;
+    private:
+        void update(gc_clock::time_point expiry) {
+            if (!_expiry || expiry < *_expiry) {
+                _expiry = expiry;
+            }
+        }
+        // Returns whether the row has any of the selected cells of the given kind.
+        bool accept_cells(const query::result_row_view& row, column_kind kind) {
+            auto i = row.iterator();
+            bool has_cells = false;
+            for (auto&& def : _selection.get_columns()) {
+                if (def->kind != kind) {
+                    continue;
+                }
+                if (def->is_multi_cell()) {
+                    if (i.next_collection_cell()) {
+                        // The expiry of the elements isn't sent.
+                        has_cells = true;
+                        update(gc_clock::time_point::min());
+                    }
+                } else if (auto cell = i.next_atomic_cell()) {
+                    has_cells = true;
+                    if (auto e = cell->expiry()) {
+                        update(*e);
+                    }
+                }
+            }
+            return has_cells;
+        }
+    public:
+        explicit expiry_visitor(const selection::selection& select) : _selection(select) { }
+
+        void accept_new_partition(const partition_key& key, uint64_t row_count) {
+            accept_new_partition(row_count);
+        }
+        void accept_new_partition(uint64_t row_count) {
+            _partition_row_count = row_count;
+        }
+        void accept_new_row(const clustering_key& key, query::result_row_view static_row, query::result_row_view row) {
+            accept_new_row(static_row, row);
+        }
+        void accept_new_row(query::result_row_view static_row, query::result_row_view row) {
+            // A row without selected cells may be alive thanks to its row marker, or to
+            // cells which weren't selected, and their expiry isn't sent.
+            if (!accept_cells(row, column_kind::regular_column)) {
+                update(gc_clock::time_point::min());
+            }
+        }
+        void accept_partition_end(const query::result_row_view& static_row) {
+            if (!accept_cells(static_row, column_kind::static_column) && _partition_row_count == 0) {
+                update(gc_clock::time_point::min());
+            }
+        }
+
+        gc_clock::time_point expiry() const { return _expiry.value_or(gc_clock::time_point::max()); }
+    };
 public:
     result_generator() = default;
 
@@ -134,6 +203,18 @@ class result_generator {
         query::result_view::consume(*_result, _command->slice, v);
         _stats->rows_read += v.rows_read();
     }
+
+    // The earliest expiry of the cells of the result (see result_set::expiry()):
+    // gc_clock::time_point::max() if none of them expires, and min() if the result
+    // may change at any time, because it holds data whose expiry isn't sent.
+    std::optional<gc_clock::time_point> expiry() const {
+        if (!_command->slice.options.contains<query::partition_slice::option::send_expiry>()) {
+            return std::nullopt;
+        }
+        expiry_visitor v(*_selection);
+        query::result_view::consume(*_result, _command->slice, v);
+        return v.expiry();
+    }
 };
 
 }
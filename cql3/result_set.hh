@@ -44,6 +44,7 @@
 #include <deque>
 #include <vector>
 #include "enum_set.hh"
+#include "gc_clock.hh"
 #include "service/pager/paging_state.hh"
 
 #include "query-result-reader.hh"
@@ -169,6 +170,7 @@ concept ResultVisitor = requires(Visitor& visitor) {
 class result_set {
     ::shared_ptr<metadata> _metadata;
     std::deque<std::vector<bytes_opt>> _rows;
+    std::optional<gc_clock::time_point> _expiry;
 
     friend class result;
 public:
@@ -203,6 +205,16 @@ class result_set {
     // Returns a range of rows. A row is a range of bytes_opt.
     const std::deque<std::vector<bytes_opt>>& rows() const;
 
+    // The earliest time at which the result may change because of expiring data. Only
+    // known for results of queries which asked for the expiry of cells (send_expiry),
+    // and built straight from the result of the replicas (see result_generator::expiry()).
+    const std::optional<gc_clock::time_point>& expiry() const {
+        return _expiry;
+    }
+    void set_expiry(std::optional<gc_clock::time_point> expiry) {
+        _expiry = expiry;
+    }
+
     template<typename Visitor>
     requires ResultVisitor<Visitor>
     void visit(Visitor&& visitor) const {
@@ -264,6 +276,7 @@ class result {
         auto builder = result_set::builder(make_shared<cql3::metadata>(*_metadata));
         _result_generator.visit(builder);
         auto tmp_rs = std::make_unique<cql3::result_set>(std::move(builder).get_result_set());
+        tmp_rs->set_expiry(_result_generator.expiry());
         _result_set.swap(tmp_rs);
         return *_result_set;
     }
@@ -101,6 +101,14 @@ abstract_function_selector::new_factory(shared_ptr<functions::function> fun, sha
         virtual bool is_aggregate_selector_factory() const override {
             return _fun->is_aggregate() || _factories->contains_only_aggregate_functions();
         }
+
+        virtual shared_ptr<functions::function> get_function() const override {
+            return _fun;
+        }
+
+        virtual const selector_factories* get_argument_factories() const override {
+            return _factories.get();
+        }
     };
 
     return make_shared<fun_selector_factory>(std::move(fun), std::move(factories));
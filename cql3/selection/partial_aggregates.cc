@@ -0,0 +1,304 @@
+/*
+ * Copyright (C) 2020 ScyllaDB
+ */
+
+/*
+ * This file is part of Scylla.
+ *
+ * Scylla is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Affero General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Scylla is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU Affero General Public License
+ * along with Scylla.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "cql3/selection/partial_aggregates.hh"
+#include "cql3/selection/selector_factories.hh"
+#include "cql3/functions/aggregate_function.hh"
+#include "cql3/functions/aggregate_fcts.hh"
+#include "exceptions/exceptions.hh"
+#include "schema.hh"
+
+namespace cql3 {
+
+namespace selection {
+
+using kind = abstract_type::kind;
+
+// Types whose values are ordered by abstract_type::less(), as replicas compare them,
+// the same way as by the min() and max() functions.
+static bool can_compare_serialized(const abstract_type& type) {
+    switch (type.get_kind()) {
+    case kind::byte:
+    case kind::short_kind:
+    case kind::int32:
+    case kind::long_kind:
+    case kind::ascii:
+    case kind::utf8:
+    case kind::timestamp:
+    case kind::simple_date:
+    case kind::time:
+        return true;
+    default:
+        return false;
+    }
+}
+
+static bool can_sum(const abstract_type& type) {
+    switch (type.get_kind()) {
+    case kind::byte:
+    case kind::short_kind:
+    case kind::int32:
+    case kind::long_kind:
+        return true;
+    default:
+        return false;
+    }
+}
+
+static std::optional<query::group_aggregate_kind> aggregate_kind_of(const functions::function& fun) {
+    using functions::function_name;
+    using agg = query::group_aggregate_kind;
+    static const std::pair<function_name, agg> kinds[] = {
+        {function_name::native_function(functions::aggregate_fcts::COUNT_ROWS_FUNCTION_NAME), agg::count_rows},
+        {function_name::native_function("count"), agg::count},
+        {function_name::native_function("min"), agg::min},
+        {function_name::native_function("max"), agg::max},
+        {function_name::native_function("sum"), agg::sum},
+    };
+    if (!fun.is_aggregate() || !fun.is_native()) {
+        return std::nullopt;
+    }
+    for (auto& [name, k] : kinds) {
+        if (fun.name() == name) {
+            return k;
+        }
+    }
+    return std::nullopt;
+}
+
+partial_aggregates::partial_aggregates(query::group_by_spec spec, std::vector<output> outputs, size_t column_count)
+    : _spec(std::move(spec))
+    , _outputs(std::move(outputs))
+    , _column_count(column_count)
+{ }
+
+std::optional<partial_aggregates> partial_aggregates::make(const schema& s, const selection& sel,
+        const std::vector<size_t>& group_by_cell_indices) {
+    auto factories = sel.get_factories();
+    if (!factories || !sel.is_aggregate() || s.has_static_columns()) {
+        return std::nullopt;
+    }
+    const auto& columns = sel.get_columns();
+
+    query::group_by_spec spec{0, {}};
+    for (auto i : group_by_cell_indices) {
+        if (columns[i]->is_clustering_key()) {
+            spec.clustering_prefix_length = std::max(spec.clustering_prefix_length, uint32_t(columns[i]->component_index() + 1));
+        }
+    }
+    // Values of the selected key columns are taken from the grouped rows, so they
+    // must be the same for all rows of a group.
+    auto is_grouped_column = [&] (const column_definition& def) {
+        return def.is_partition_key() || (def.is_clustering_key() && def.component_index() < spec.clustering_prefix_length);
+    };
+
+    std::vector<output> outputs;
+    for (auto&& f : *factories) {
+        if (auto idx = f->get_selected_column_index()) {
+            if (!is_grouped_column(*columns[*idx])) {
+                return std::nullopt;
+            }
+            outputs.push_back(output{idx});
+            continue;
+        }
+        auto fun = dynamic_pointer_cast<functions::aggregate_function>(f->get_function());
+        auto args = f->get_argument_factories();
+        if (!fun || !args) {
+            return std::nullopt;
+        }
+        auto k = aggregate_kind_of(*fun);
+        if (!k) {
+            return std::nullopt;
+        }
+        std::vector<::shared_ptr<selector::factory>> arg_factories(args->begin(), args->end());
+        output out{std::nullopt, spec.aggregates.size(), fun, nullptr};
+        if (*k == query::group_aggregate_kind::count_rows) {
+            if (!arg_factories.empty()) {
+                return std::nullopt;
+            }
+            spec.aggregates.push_back(query::group_aggregate{*k, 0});
+        } else {
+            if (arg_factories.size() != 1) {
+                return std::nullopt;
+            }
+            auto idx = arg_factories[0]->get_selected_column_index();
+            if (!idx) {
+                return std::nullopt;
+            }
+            const column_definition& def = *columns[*idx];
+            if (!def.is_regular() || def.is_counter() || def.type->is_multi_cell()) {
+                return std::nullopt;
+            }
+            if ((*k == query::group_aggregate_kind::min || *k == query::group_aggregate_kind::max) && !can_compare_serialized(*def.type)) {
+                return std::nullopt;
+            }
+            if (*k == query::group_aggregate_kind::sum && !can_sum(*def.type)) {
+                return std::nullopt;
+            }
+            spec.aggregates.push_back(query::group_aggregate{*k, def.id});
+            out.type = def.type;
+        }
+        outputs.push_back(std::move(out));
+    }
+    if (spec.aggregates.empty()) {
+        return std::nullopt;
+    }
+    return partial_aggregates(std::move(spec), std::move(outputs), columns.size());
+}
+
+template <typename T>
+static bytes narrow_sum(__int128 sum) {
+    T ret = static_cast<T>(sum);
+    if (static_cast<__int128>(ret) != sum) {
+        throw exceptions::overflow_error_exception("Sum overflow. Values should be casted to a wider type.");
+    }
+    return data_type_for<T>()->decompose(ret);
+}
+
+static bytes narrow_sum(const abstract_type& type, __int128 sum) {
+    switch (type.get_kind()) {
+    case kind::byte: return narrow_sum<int8_t>(sum);
+    case kind::short_kind: return narrow_sum<int16_t>(sum);
+    case kind::int32: return narrow_sum<int32_t>(sum);
+    case kind::long_kind: return narrow_sum<int64_t>(sum);
+    default:
+        throw std::logic_error(format("Unexpected type of a partial sum: {}", type.name()));
+    }
+}
+
+namespace {
+
+class partial_aggregates_selectors : public selectors {
+    struct state {
+        bytes_opt value;
+        bool first = true;
+        int64_t count = 0;
+        __int128 sum = 0;
+        std::unique_ptr<functions::aggregate_function::aggregate> aggregate;
+    };
+    const query::group_by_spec& _spec;
+    const std::vector<partial_aggregates::output>& _outputs;
+    const size_t _column_count;
+    std::vector<state> _states;
+public:
+    partial_aggregates_selectors(const query::group_by_spec& spec, const std::vector<partial_aggregates::output>& outputs, size_t column_count)
+            : _spec(spec)
+            , _outputs(outputs)
+            , _column_count(column_count)
+            , _states(outputs.size()) {
+        for (size_t i = 0; i < _outputs.size(); ++i) {
+            if (_outputs[i].function) {
+                _states[i].aggregate = _outputs[i].function->new_aggregate();
+            }
+        }
+    }
+
+    virtual bool requires_thread() const override {
+        return false;
+    }
+
+    virtual bool is_aggregate() const override {
+        return true;
+    }
+
+    virtual void add_input_row(cql_serialization_format sf, result_set_builder& rs) override {
+        auto& row = *rs.current;
+        for (size_t i = 0; i < _outputs.size(); ++i) {
+            auto& out = _outputs[i];
+            auto& st = _states[i];
+            if (out.column_index) {
+                if (st.first) {
+                    st.value = row[*out.column_index];
+                    st.first = false;
+                }
+                continue;
+            }
+            auto& v = row[_column_count + out.aggregate_index];
+            switch (_spec.aggregates[out.aggregate_index].kind) {
+            case query::group_aggregate_kind::count_rows:
+            case query::group_aggregate_kind::count:
+                if (v) {
+                    st.count += value_cast<int64_t>(long_type->deserialize(*v));
+                }
+                break;
+            case query::group_aggregate_kind::min:
+            case query::group_aggregate_kind::max:
+                // The min (max) of the partial mins (maxes) is what the function computes.
+                st.aggregate->add_input(sf, {v});
+                break;
+            case query::group_aggregate_kind::sum:
+                if (v) {
+                    st.sum += query::deserialize_group_sum(*v);
+                }
+                break;
+            }
+        }
+    }
+
+    virtual std::vector<bytes_opt> get_output_row(cql_serialization_format sf) override {
+        std::vector<bytes_opt> output_row;
+        output_row.reserve(_outputs.size());
+        for (size_t i = 0; i < _outputs.size(); ++i) {
+            auto& out = _outputs[i];
+            auto& st = _states[i];
+            if (out.column_index) {
+                output_row.emplace_back(st.value);
+                continue;
+            }
+            switch (_spec.aggregates[out.aggregate_index].kind) {
+            case query::group_aggregate_kind::count_rows:
+            case query::group_aggregate_kind::count:
+                output_row.emplace_back(long_type->decompose(st.count));
+                break;
+            case query::group_aggregate_kind::min:
+            case query::group_aggregate_kind::max:
+                output_row.emplace_back(st.aggregate->compute(sf));
+                break;
+            case query::group_aggregate_kind::sum:
+                output_row.emplace_back(narrow_sum(*out.type, st.sum));
+                break;
+            }
+        }
+        return output_row;
+    }
+
+    virtual void reset() override {
+        for (auto& st : _states) {
+            st.value = {};
+            st.first = true;
+            st.count = 0;
+            st.sum = 0;
+            if (st.aggregate) {
+                st.aggregate->reset();
+            }
+        }
+    }
+};
+
+}
+
+std::unique_ptr<selectors> partial_aggregates::new_selectors() const {
+    return std::make_unique<partial_aggregates_selectors>(_spec, _outputs, _column_count);
+}
+
+}
+
+}
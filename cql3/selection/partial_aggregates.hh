@@ -0,0 +1,84 @@
+/*
+ * Copyright (C) 2020 ScyllaDB
+ */
+
+/*
+ * This file is part of Scylla.
+ *
+ * Scylla is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Affero General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Scylla is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU Affero General Public License
+ * along with Scylla.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#pragma once
+
+#include <optional>
+#include <vector>
+
+#include "query-request.hh"
+#include "cql3/selection/selection.hh"
+
+namespace cql3 {
+
+namespace functions {
+class aggregate_function;
+}
+
+namespace selection {
+
+/// Describes how replicas can aggregate each group of rows of an aggregate query,
+/// so that they send a single row of partial aggregates for the group instead of
+/// its rows, and how the coordinator merges these rows into the final results.
+///
+/// Groups are the rows sharing the GROUP BY columns, or the rows of a partition if
+/// there is no GROUP BY. Rows of the same group may come in several pages, or from
+/// several replicas, but they come one after the other, so the coordinator merges
+/// them as it goes, the same way as it aggregates the rows themselves.
+///
+/// Only selections made of the grouped key columns, and of count(*), count(),
+/// min() and max() of regular columns, and sum() of integer regular columns are
+/// supported, on tables without static columns.
+class partial_aggregates {
+public:
+    struct output {
+        /// Set if the selector returns a grouped column: its index in the selection.
+        std::optional<uint32_t> column_index;
+        /// Otherwise, the selector returns an aggregate: its index in spec().aggregates,
+        /// the original function and the type of the aggregated column.
+        size_t aggregate_index = 0;
+        ::shared_ptr<functions::aggregate_function> function;
+        data_type type;
+    };
+private:
+    query::group_by_spec _spec;
+    std::vector<output> _outputs;
+    size_t _column_count;
+public:
+    partial_aggregates(query::group_by_spec spec, std::vector<output> outputs, size_t column_count);
+
+    /// Returns std::nullopt if the selection can't be computed from partial aggregates.
+    static std::optional<partial_aggregates> make(const schema& s, const selection& sel,
+            const std::vector<size_t>& group_by_cell_indices);
+
+    const query::group_by_spec& spec() const {
+        return _spec;
+    }
+
+    /// Creates selectors computing the output rows of the selection from the rows
+    /// of partial aggregates. The rows of the result_set_builder hold the values of
+    /// the selection's columns, followed by the partial aggregates.
+    std::unique_ptr<selectors> new_selectors() const;
+};
+
+}
+
+}
@@ -45,6 +45,8 @@
 
 #include "cql3/selection/selection.hh"
 #include "cql3/selection/selector_factories.hh"
+#include "cql3/selection/partial_aggregates.hh"
+#include "cql3/expr/batch_evaluator.hh"
 #include "cql3/result_set.hh"
 #include "cql3/query_options.hh"
 #include "cql3/restrictions/multi_column_restriction.hh"
@@ -175,6 +177,10 @@ class selection_with_processing : public selection {
     virtual bool is_aggregate() const override {
         return _factories->does_aggregation();
     }
+
+    virtual const selector_factories* get_factories() const override {
+        return _factories.get();
+    }
 protected:
     class selectors_with_processing : public selectors {
     private:
@@ -279,12 +285,13 @@ selection::collect_metadata(const schema& schema, const std::vector<::shared_ptr
 }
 
 result_set_builder::result_set_builder(const selection& s, gc_clock::time_point now, cql_serialization_format sf,
-                                       std::vector<size_t> group_by_cell_indices)
+                                       std::vector<size_t> group_by_cell_indices, const partial_aggregates* partials)
     : _result_set(std::make_unique<result_set>(::make_shared<metadata>(*(s.get_result_metadata()))))
-    , _selectors(s.new_selectors())
+    , _selectors(partials ? partials->new_selectors() : s.new_selectors())
     , _group_by_cell_indices(std::move(group_by_cell_indices))
     , _last_group(_group_by_cell_indices.size())
     , _group_began(false)
+    , _partial_aggregates(partials)
     , _now(now)
     , _cql_serialization_format(sf)
 {
@@ -296,6 +303,10 @@ result_set_builder::result_set_builder(const selection& s, gc_clock::time_point
     }
 }
 
+size_t result_set_builder::partial_aggregates_count() const {
+    return _partial_aggregates ? _partial_aggregates->spec().aggregates.size() : 0;
+}
+
 void result_set_builder::add_empty() {
     current->emplace_back();
     if (!_timestamps.empty()) {
@@ -416,6 +427,10 @@ bool result_set_builder::restrictions_filter::do_filter(const selection& selecti
         return false;
     }
 
+    if (_batch_matches) {
+        return (*_batch_matches)[_batch_row];
+    }
+
     auto clustering_columns_restrictions = _restrictions->get_clustering_columns_restrictions();
     if (dynamic_pointer_cast<cql3::restrictions::multi_column_restriction>(clustering_columns_restrictions)) {
         clustering_key_prefix ckey = clustering_key_prefix::from_exploded(clustering_key);
@@ -426,7 +441,7 @@ bool result_set_builder::restrictions_filter::do_filter(const selection& selecti
 
     auto static_row_iterator = static_row.iterator();
     auto row_iterator = row ? std::optional<query::result_row_view::iterator_type>(row->iterator()) : std::nullopt;
-    auto non_pk_restrictions_map = _restrictions->get_non_pk_restriction();
+    const auto& non_pk_restrictions_map = _restrictions->get_non_pk_restriction();
     for (auto&& cdef : selection.get_columns()) {
         switch (cdef->kind) {
         case column_kind::static_column:
@@ -452,7 +467,7 @@ bool result_set_builder::restrictions_filter::do_filter(const selection& selecti
             if (_skip_pk_restrictions) {
                 continue;
             }
-            auto partition_key_restrictions_map = _restrictions->get_single_column_partition_key_restrictions();
+            const auto& partition_key_restrictions_map = _restrictions->get_single_column_partition_key_restrictions();
             auto restr_it = partition_key_restrictions_map.find(cdef);
             if (restr_it == partition_key_restrictions_map.end()) {
                 continue;
@@ -469,7 +484,7 @@ bool result_set_builder::restrictions_filter::do_filter(const selection& selecti
             if (_skip_ck_restrictions) {
                 continue;
             }
-            auto clustering_key_restrictions_map = _restrictions->get_single_column_clustering_key_restrictions();
+            const auto& clustering_key_restrictions_map = _restrictions->get_single_column_clustering_key_restrictions();
             auto restr_it = clustering_key_restrictions_map.find(cdef);
             if (restr_it == clustering_key_restrictions_map.end()) {
                 continue;
@@ -497,6 +512,9 @@ bool result_set_builder::restrictions_filter::operator()(const selection& select
                                                          const query::result_row_view& static_row,
                                                          const query::result_row_view* row) const {
     const bool accepted = do_filter(selection, partition_key, clustering_key, static_row, row);
+    if (_batch_matches) {
+        ++_batch_row;
+    }
     if (!accepted) {
         ++_rows_dropped;
     } else {
@@ -510,6 +528,166 @@ bool result_set_builder::restrictions_filter::operator()(const selection& select
     return accepted;
 }
 
+namespace {
+
+// Decodes the values of the columns of a batch_evaluator for each row a
+// result_set_builder::visitor would pass to its filter, in the same order.
+class batch_decoder {
+    const selection& _selection;
+    const schema& _schema;
+    expr::row_batch& _batch;
+    // The batch column of each selected column, if any.
+    std::vector<std::optional<size_t>> _batch_columns;
+    std::vector<bytes> _partition_key;
+    std::vector<bytes> _clustering_key;
+    uint64_t _row_count = 0;
+private:
+    void set_cell(std::optional<size_t> column, const column_definition& def, query::result_row_view::iterator_type& it) {
+        if (def.type->is_multi_cell()) {
+            it.next_collection_cell();
+            if (column) {
+                _batch.set_null(*column);
+            }
+            return;
+        }
+        auto cell = it.next_atomic_cell();
+        if (!column) {
+            return;
+        }
+        if (cell) {
+            cell->value().with_linearized([&] (bytes_view v) {
+                _batch.set_value(*column, v);
+            });
+        } else {
+            _batch.set_null(*column);
+        }
+    }
+    void set_key_component(std::optional<size_t> column, const std::vector<bytes>& key, size_t component) {
+        if (!column) {
+            return;
+        }
+        if (component < key.size()) {
+            _batch.set_value(*column, key[component]);
+        } else {
+            _batch.set_null(*column);
+        }
+    }
+    void add_row(const query::result_row_view& static_row, const query::result_row_view* row) {
+        static const std::vector<bytes> no_key;
+        _batch.new_row();
+        auto static_row_iterator = static_row.iterator();
+        auto row_iterator = row ? std::optional<query::result_row_view::iterator_type>(row->iterator()) : std::nullopt;
+        const auto& columns = _selection.get_columns();
+        for (size_t i = 0; i < columns.size(); ++i) {
+            const auto& def = *columns[i];
+            const auto column = _batch_columns[i];
+            switch (def.kind) {
+            case column_kind::partition_key:
+                set_key_component(column, _partition_key, def.component_index());
+                break;
+            case column_kind::clustering_key:
+                set_key_component(column, row ? _clustering_key : no_key, def.component_index());
+                break;
+            case column_kind::static_column:
+                set_cell(column, def, static_row_iterator);
+                break;
+            case column_kind::regular_column:
+                if (row_iterator) {
+                    set_cell(column, def, *row_iterator);
+                } else if (column) {
+                    _batch.set_ignored(*column);
+                }
+                break;
+            default:
+                break;
+            }
+        }
+    }
+public:
+    batch_decoder(const selection& selection, const schema& schema, const expr::batch_evaluator& evaluator, expr::row_batch& batch)
+        : _selection(selection)
+        , _schema(schema)
+        , _batch(batch)
+    {
+        const auto& batch_columns = evaluator.columns();
+        for (auto&& def : _selection.get_columns()) {
+            auto it = std::find(batch_columns.begin(), batch_columns.end(), def);
+            _batch_columns.push_back(it == batch_columns.end() ? std::nullopt : std::optional<size_t>(it - batch_columns.begin()));
+        }
+    }
+
+    void accept_new_partition(const partition_key& key, uint64_t row_count) {
+        _partition_key = key.explode(_schema);
+        _row_count = row_count;
+    }
+    void accept_new_partition(uint64_t row_count) {
+        _row_count = row_count;
+    }
+    void accept_new_row(const clustering_key& key, const query::result_row_view& static_row, const query::result_row_view& row) {
+        _clustering_key = key.explode(_schema);
+        add_row(static_row, &row);
+    }
+    void accept_new_row(const query::result_row_view& static_row, const query::result_row_view& row) {
+        add_row(static_row, &row);
+    }
+    void accept_partition_end(const query::result_row_view& static_row) {
+        if (_row_count == 0) {
+            add_row(static_row, nullptr);
+        }
+    }
+};
+
+}
+
+void result_set_builder::restrictions_filter::evaluate_batch(const query::result& results, const query::partition_slice& slice,
+        const selection& selection) {
+    _batch_matches.reset();
+    if (dynamic_pointer_cast<cql3::restrictions::multi_column_restriction>(_restrictions->get_clustering_columns_restrictions())) {
+        return;
+    }
+    // The same restrictions as do_filter() checks, in the same order.
+    std::vector<std::pair<const column_definition*, const expr::expression*>> batch_restrictions;
+    for (auto&& cdef : selection.get_columns()) {
+        const restrictions::single_column_restrictions::restrictions_map* map = nullptr;
+        switch (cdef->kind) {
+        case column_kind::static_column:
+        case column_kind::regular_column:
+            map = &_restrictions->get_non_pk_restriction();
+            break;
+        case column_kind::partition_key:
+            if (!_skip_pk_restrictions) {
+                map = &_restrictions->get_single_column_partition_key_restrictions();
+            }
+            break;
+        case column_kind::clustering_key:
+            if (!_skip_ck_restrictions) {
+                map = &_restrictions->get_single_column_clustering_key_restrictions();
+            }
+            break;
+        default:
+            break;
+        }
+        if (!map) {
+            continue;
+        }
+        auto it = map->find(cdef);
+        if (it != map->end()) {
+            batch_restrictions.emplace_back(cdef, &it->second->expression);
+        }
+    }
+    if (batch_restrictions.empty()) {
+        return;
+    }
+    auto evaluator = expr::batch_evaluator::compile(batch_restrictions, _options);
+    if (!evaluator) {
+        return;
+    }
+    auto batch = evaluator->make_batch();
+    query::result_view::consume(results, slice, batch_decoder(selection, *_schema, *evaluator, batch));
+    _batch_matches = evaluator->evaluate(batch);
+    _batch_row = 0;
+}
+
 void result_set_builder::restrictions_filter::reset(const partition_key* key) {
     _current_partition_key_does_not_match = false;
     _current_static_row_does_not_match = false;
@@ -63,6 +63,7 @@ class statement_restrictions;
 namespace selection {
 
 class selector_factories;
+class partial_aggregates;
 
 class selectors {
 public:
@@ -204,6 +205,13 @@ class selection {
 
     virtual std::unique_ptr<selectors> new_selectors() const = 0;
 
+    /**
+     * Returns the factories of the selectors of this selection, or nullptr if it returns the columns as they are.
+     */
+    virtual const selector_factories* get_factories() const {
+        return nullptr;
+    }
+
     /**
      * Returns a range of CQL3 columns this selection needs.
      */
@@ -255,6 +263,8 @@ class result_set_builder {
     const std::vector<size_t> _group_by_cell_indices; ///< Indices in \c current of cells holding GROUP BY values.
     std::vector<bytes_opt> _last_group; ///< Previous row's group: all of GROUP BY column values.
     bool _group_began; ///< Whether a group began being formed.
+    /// Set when replicas aggregate the rows of each group, and the rows received hold partial aggregates.
+    const partial_aggregates* _partial_aggregates;
 public:
     std::optional<std::vector<bytes_opt>> current;
 private:
@@ -298,6 +308,10 @@ class result_set_builder {
         mutable uint64_t _rows_fetched_for_last_partition;
         mutable std::optional<partition_key> _last_pkey;
         mutable bool _is_first_partition_on_page = true;
+        // Whether the restrictions are satisfied, for each row the filter is going
+        // to be called for, if they were evaluated in batch by evaluate_batch().
+        std::optional<std::vector<uint8_t>> _batch_matches;
+        mutable size_t _batch_row = 0;
     public:
         explicit restrictions_filter(::shared_ptr<restrictions::statement_restrictions> restrictions,
                 const query_options& options,
@@ -311,12 +325,16 @@ class result_set_builder {
         uint64_t get_rows_dropped() const {
             return _rows_dropped;
         }
+        // Evaluates the restrictions for all rows of the page at once, if they can
+        // be evaluated in batch. Must be called before the filter is used to consume
+        // the same page.
+        void evaluate_batch(const query::result& results, const query::partition_slice& slice, const selection& selection);
     private:
         bool do_filter(const selection& selection, const std::vector<bytes>& pk, const std::vector<bytes>& ck, const query::result_row_view& static_row, const query::result_row_view* row) const;
     };
 
     result_set_builder(const selection& s, gc_clock::time_point now, cql_serialization_format sf,
-                       std::vector<size_t> group_by_cell_indices = {});
+                       std::vector<size_t> group_by_cell_indices = {}, const partial_aggregates* partials = nullptr);
     void add_empty();
     void add(bytes_opt value);
     void add(const column_definition& def, const query::result_atomic_cell_view& c);
@@ -324,6 +342,7 @@ class result_set_builder {
     void new_row();
     std::unique_ptr<result_set> build();
     api::timestamp_type timestamp_of(size_t idx);
+    size_t partial_aggregates_count() const;
     int32_t ttl_of(size_t idx);
 
     // Implements ResultVisitor concept from query.hh
@@ -344,7 +363,7 @@ class result_set_builder {
             , _schema(s)
             , _selection(selection)
             , _row_count(0)
-            , _filter(filter)
+            , _filter(std::move(filter))
         {}
         visitor(visitor&&) = default;
 
@@ -389,6 +408,10 @@ class result_set_builder {
                 return;
             }
             _builder.new_row();
+            if (_builder._partial_aggregates) {
+                add_partial_aggregates(row_iterator);
+                return;
+            }
             for (auto&& def : _selection.get_columns()) {
                 switch (def->kind) {
                 case column_kind::partition_key:
@@ -413,8 +436,26 @@ class result_set_builder {
             }
         }
 
+        // The row holds the partial aggregates of a group, see partial_aggregates.
+        // They follow the values of the selection's key columns in the builder's row.
+        void add_partial_aggregates(query::result_row_view::iterator_type& i) {
+            for (auto&& def : _selection.get_columns()) {
+                if (def->is_partition_key()) {
+                    _builder.add(_partition_key[def->component_index()]);
+                } else if (def->is_clustering_key() && _clustering_key.size() > def->component_index()) {
+                    _builder.add(_clustering_key[def->component_index()]);
+                } else {
+                    _builder.add({});
+                }
+            }
+            for (size_t n = _builder.partial_aggregates_count(); n > 0; --n) {
+                auto cell = i.next_atomic_cell();
+                _builder.add(cell ? bytes_opt(cell->value().linearize()) : bytes_opt());
+            }
+        }
+
         uint64_t accept_partition_end(const query::result_row_view& static_row) {
-            if (_row_count == 0) {
+            if (_row_count == 0 && !_builder._partial_aggregates) {
                 if (!_filter(_selection, _partition_key, _clustering_key, static_row, nullptr)) {
                     return _filter.get_rows_dropped();
                 }
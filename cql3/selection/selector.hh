@@ -41,6 +41,7 @@
 
 #pragma once
 
+#include <optional>
 #include <vector>
 #include "cql3/assignment_testable.hh"
 #include "types.hh"
@@ -49,9 +50,14 @@
 
 namespace cql3 {
 
+namespace functions {
+class function;
+}
+
 namespace selection {
 
 class result_set_builder;
+class selector_factories;
 
 /**
  * A <code>selector</code> is used to convert the data returned by the storage engine into the data requested by the
@@ -195,6 +201,28 @@ class selector::factory {
      * @return the selector output type
      */
     virtual data_type get_return_type() const = 0;
+
+    /**
+     * Returns the index of the column of the selection whose value is returned, unchanged, by the selector
+     * instances created by this factory, if there is one.
+     */
+    virtual std::optional<uint32_t> get_selected_column_index() const {
+        return std::nullopt;
+    }
+
+    /**
+     * Returns the function applied by the selector instances created by this factory, if any.
+     */
+    virtual shared_ptr<functions::function> get_function() const {
+        return nullptr;
+    }
+
+    /**
+     * Returns the factories of the arguments of the function returned by get_function(), if any.
+     */
+    virtual const selector_factories* get_argument_factories() const {
+        return nullptr;
+    }
 };
 
 }
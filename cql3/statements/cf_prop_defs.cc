@@ -58,6 +58,7 @@ const sstring cf_prop_defs::KW_READREPAIRCHANCE = "read_repair_chance";
 const sstring cf_prop_defs::KW_DCLOCALREADREPAIRCHANCE = "dclocal_read_repair_chance";
 const sstring cf_prop_defs::KW_GCGRACESECONDS = "gc_grace_seconds";
 const sstring cf_prop_defs::KW_PAXOSGRACESECONDS = "paxos_grace_seconds";
+const sstring cf_prop_defs::KW_RESULTCACHETTL = "result_cache_ttl_in_ms";
 const sstring cf_prop_defs::KW_MINCOMPACTIONTHRESHOLD = "min_threshold";
 const sstring cf_prop_defs::KW_MAXCOMPACTIONTHRESHOLD = "max_threshold";
 const sstring cf_prop_defs::KW_CACHING = "caching";
@@ -106,7 +107,8 @@ void cf_prop_defs::validate(const database& db, const schema::extensions_map& sc
         KW_GCGRACESECONDS, KW_CACHING, KW_DEFAULT_TIME_TO_LIVE,
         KW_MIN_INDEX_INTERVAL, KW_MAX_INDEX_INTERVAL, KW_SPECULATIVE_RETRY,
         KW_BF_FP_CHANCE, KW_MEMTABLE_FLUSH_PERIOD, KW_COMPACTION,
-        KW_COMPRESSION, KW_CRC_CHECK_CHANCE, KW_ID, KW_PAXOSGRACESECONDS
+        KW_COMPRESSION, KW_CRC_CHECK_CHANCE, KW_ID, KW_PAXOSGRACESECONDS,
+        KW_RESULTCACHETTL
     });
     static std::set<sstring> obsolete_keywords({
         sstring("index_interval"),
@@ -157,6 +159,7 @@ void cf_prop_defs::validate(const database& db, const schema::extensions_map& sc
     }
 
     validate_minimum_int(KW_DEFAULT_TIME_TO_LIVE, 0, DEFAULT_DEFAULT_TIME_TO_LIVE);
+    validate_minimum_int(KW_RESULTCACHETTL, 0, 0);
 
     auto min_index_interval = get_int(KW_MIN_INDEX_INTERVAL, DEFAULT_MIN_INDEX_INTERVAL);
     auto max_index_interval = get_int(KW_MAX_INDEX_INTERVAL, DEFAULT_MAX_INDEX_INTERVAL);
@@ -200,6 +203,10 @@ int32_t cf_prop_defs::get_paxos_grace_seconds() const {
     return get_int(KW_PAXOSGRACESECONDS, DEFAULT_GC_GRACE_SECONDS);
 }
 
+int32_t cf_prop_defs::get_result_cache_ttl() const {
+    return get_int(KW_RESULTCACHETTL, 0);
+}
+
 std::optional<utils::UUID> cf_prop_defs::get_id() const {
     auto id = get_simple(KW_ID);
     if (id) {
@@ -255,6 +262,10 @@ void cf_prop_defs::apply_to_builder(schema_builder& builder, schema::extensions_
         builder.set_paxos_grace_seconds(get_paxos_grace_seconds());
     }
 
+    if (has_property(KW_RESULTCACHETTL)) {
+        builder.set_result_cache_ttl(get_result_cache_ttl());
+    }
+
     std::optional<sstring> tmp_value = {};
     if (has_property(KW_COMPACTION)) {
         if (get_compaction_options().contains(KW_MINCOMPACTIONTHRESHOLD)) {
@@ -65,6 +65,7 @@ class cf_prop_defs : public property_definitions {
     static const sstring KW_DCLOCALREADREPAIRCHANCE;
     static const sstring KW_GCGRACESECONDS;
     static const sstring KW_PAXOSGRACESECONDS;
+    static const sstring KW_RESULTCACHETTL;
     static const sstring KW_MINCOMPACTIONTHRESHOLD;
     static const sstring KW_MAXCOMPACTIONTHRESHOLD;
     static const sstring KW_CACHING;
@@ -119,6 +120,7 @@ class cf_prop_defs : public property_definitions {
     int32_t get_default_time_to_live() const;
     int32_t get_gc_grace_seconds() const;
     int32_t get_paxos_grace_seconds() const;
+    int32_t get_result_cache_ttl() const;
     std::optional<utils::UUID> get_id() const;
 
     void apply_to_builder(schema_builder& builder, schema::extensions_map schema_extensions);
@@ -264,7 +264,7 @@ modification_statement::create_clustering_ranges(const query_options& options, c
 
 dht::partition_range_vector
 modification_statement::build_partition_keys(const query_options& options, const json_cache_opt& json_cache) const {
-    auto keys = _restrictions->get_partition_key_restrictions()->bounds_ranges(options);
+    auto keys = _restrictions->get_partition_key_ranges(options);
     for (auto const& k : keys) {
         validation::validate_cql_key(*s, *k.start()->value().key());
     }
@@ -44,6 +44,7 @@
 
 #include "transport/messages/result_message.hh"
 #include "cql3/functions/as_json_function.hh"
+#include "cql3/functions/functions.hh"
 #include "cql3/selection/selection.hh"
 #include "cql3/util.hh"
 #include "cql3/restrictions/single_column_primary_key_restrictions.hh"
@@ -59,6 +60,7 @@
 #include "db/timeout_clock.hh"
 #include "db/consistency_level_validations.hh"
 #include "database.hh"
+#include "db/config.hh"
 #include <boost/algorithm/cxx11/any_of.hpp>
 
 bool is_system_keyspace(const sstring& name);
@@ -88,12 +90,14 @@ select_statement::parameters::parameters(orderings_type orderings,
                                          bool is_distinct,
                                          bool allow_filtering,
                                          bool is_json,
-                                         bool bypass_cache)
+                                         bool bypass_cache,
+                                         bool filtered_cache_admission)
     : _orderings{std::move(orderings)}
     , _is_distinct{is_distinct}
     , _allow_filtering{allow_filtering}
     , _is_json{is_json}
     , _bypass_cache{bypass_cache}
+    , _filtered_cache_admission{filtered_cache_admission}
 { }
 
 bool select_statement::parameters::is_distinct() const {
@@ -112,6 +116,10 @@ bool select_statement::parameters::bypass_cache() const {
     return _bypass_cache;
 }
 
+bool select_statement::parameters::filtered_cache_admission() const {
+    return _filtered_cache_admission;
+}
+
 select_statement::parameters::orderings_type const& select_statement::parameters::orderings() const {
     return _orderings;
 }
@@ -154,6 +162,20 @@ select_statement::select_statement(schema_ptr schema,
     _opts.set_if<query::partition_slice::option::bypass_cache>(_parameters->bypass_cache());
     _opts.set_if<query::partition_slice::option::distinct>(_parameters->is_distinct());
     _opts.set_if<query::partition_slice::option::reversed>(_is_reversed);
+    for (auto&& col : _selection->get_columns()) {
+        if (col->is_static()) {
+            _static_columns.push_back(col->id);
+        } else if (col->is_regular()) {
+            _regular_columns.push_back(col->id);
+        }
+    }
+    if (!_parameters->is_distinct() && !_parameters->is_json() && !_per_partition_limit
+            && !_restrictions->need_filtering() && !needs_post_query_ordering()) {
+        _partial_aggregates = selection::partial_aggregates::make(*_schema, *_selection, *_group_by_cell_indices);
+    }
+    _uses_non_pure_functions = boost::algorithm::any_of(functions::functions::non_pure_function_names(), [this] (const functions::function_name& name) {
+        return select_statement::uses_function(name.keyspace, name.name);
+    });
 }
 
 bool select_statement::uses_function(const sstring& ks_name, const sstring& function_name) const {
@@ -205,26 +227,9 @@ const sstring& select_statement::column_family() const {
 query::partition_slice
 select_statement::make_partition_slice(const query_options& options) const
 {
-    query::column_id_vector static_columns;
-    query::column_id_vector regular_columns;
-
-    if (_selection->contains_static_columns()) {
-        static_columns.reserve(_selection->get_column_count());
-    }
-
-    regular_columns.reserve(_selection->get_column_count());
-
-    for (auto&& col : _selection->get_columns()) {
-        if (col->is_static()) {
-            static_columns.push_back(col->id);
-        } else if (col->is_regular()) {
-            regular_columns.push_back(col->id);
-        }
-    }
-
     if (_parameters->is_distinct()) {
         return query::partition_slice({ query::clustering_range::make_open_ended_both_sides() },
-            std::move(static_columns), {}, _opts, nullptr, options.get_cql_serialization_format());
+            _static_columns, {}, _opts, nullptr, options.get_cql_serialization_format());
     }
 
     auto bounds =_restrictions->get_clustering_bounds(options);
@@ -240,7 +245,47 @@ select_statement::make_partition_slice(const query_options& options) const
         ++_stats.reverse_queries;
     }
     return query::partition_slice(std::move(bounds),
-        std::move(static_columns), std::move(regular_columns), _opts, nullptr, options.get_cql_serialization_format(), get_per_partition_limit(options));
+        _static_columns, _regular_columns, _opts, nullptr, options.get_cql_serialization_format(), get_per_partition_limit(options));
+}
+
+query::partition_slice
+select_statement::make_partition_slice(service::storage_proxy& proxy, const query_options& options) const {
+    auto slice = make_partition_slice(options);
+    if (_restrictions->need_filtering() && proxy.features().cluster_supports_replica_filtering()) {
+        slice.set_column_filters(_restrictions->get_column_filters(options));
+    }
+    auto filtered_cache_admission = _parameters->filtered_cache_admission()
+            || (_range_scan && proxy.get_db().local().get_config().cache_admission_filter_range_scans());
+    if (filtered_cache_admission && proxy.features().cluster_supports_filtered_cache_admission()) {
+        slice.options.set<query::partition_slice::option::filtered_cache_admission>();
+    }
+    if (get_cacheable_partition(options)) {
+        // The coordinator result cache doesn't keep the result past the expiry of its cells.
+        slice.options.set<query::partition_slice::option::send_expiry>();
+    }
+    return slice;
+}
+
+std::optional<dht::decorated_key> select_statement::get_cacheable_partition(const query_options& options) const {
+    // Only plain selections of a whole single partition read are cached: their result
+    // is returned in a single page, and only depends on the time of the query through
+    // the expiry of its cells, which is sent along for them (see make_partition_slice())
+    // and bounds the lifetime of the cached result.
+    // The key of the cached result only holds the bound values, so the statement
+    // may not compute other values when executed, as non-pure functions do.
+    if (!_schema->result_cache_ttl() || _schema->is_counter() || !_restrictions->is_single_partition_key()
+            || _restrictions->need_filtering() || _restrictions->uses_secondary_indexing()
+            || !_selection->is_trivial() || _uses_non_pure_functions || _parameters->bypass_cache() || options.get_paging_state()
+            || db::is_serial_consistency(options.get_consistency())) {
+        return std::nullopt;
+    }
+    auto key = _restrictions->get_single_partition_key(options);
+    // Writes to the partition are applied on its shard, which is where they invalidate
+    // the cached results.
+    if (dht::shard_of(*_schema, key.token()) != this_shard_id()) {
+        return std::nullopt;
+    }
+    return key;
 }
 
 uint64_t select_statement::do_get_limit(const query_options& options, ::shared_ptr<term> limit, uint64_t default_limit) const {
@@ -319,7 +364,7 @@ select_statement::do_execute(service::storage_proxy& proxy,
     _stats.select_partition_range_scan += _range_scan;
     _stats.select_partition_range_scan_no_bypass_cache += _range_scan_no_bypass_cache;
 
-    auto slice = make_partition_slice(options);
+    auto slice = make_partition_slice(proxy, options);
     auto command = ::make_lw_shared<query::read_command>(
             _schema->id(),
             _schema->version(),
@@ -369,6 +414,11 @@ select_statement::do_execute(service::storage_proxy& proxy,
     }
 
     command->slice.options.set<query::partition_slice::option::allow_short_read>();
+    const selection::partial_aggregates* partials = nullptr;
+    if (aggregate && _partial_aggregates && proxy.features().cluster_supports_replica_grouping()) {
+        command->slice.set_group_by(_partial_aggregates->spec());
+        partials = &*_partial_aggregates;
+    }
     auto timeout_duration = options.get_timeout_config().*get_timeout_config_selector();
     auto p = service::pager::query_pagers::pager(_schema, _selection,
             state, options, command, std::move(key_ranges), restrictions_need_filtering ? _restrictions : nullptr);
@@ -376,7 +426,7 @@ select_statement::do_execute(service::storage_proxy& proxy,
     if (aggregate || nonpaged_filtering) {
         return do_with(
                 cql3::selection::result_set_builder(*_selection, now,
-                        options.get_cql_serialization_format(), *_group_by_cell_indices),
+                        options.get_cql_serialization_format(), *_group_by_cell_indices, partials),
                 [this, p, page_size, now, timeout_duration, restrictions_need_filtering](auto& builder) {
                     return do_until([p] {return p->is_exhausted();},
                             [p, &builder, page_size, now, timeout_duration] {
@@ -484,7 +534,7 @@ generate_base_key_from_index_pk(const partition_key& index_pk, const std::option
 lw_shared_ptr<query::read_command>
 indexed_table_select_statement::prepare_command_for_base_query(service::storage_proxy& proxy, const query_options& options,
         service::query_state& state, gc_clock::time_point now, bool use_paging) const {
-    auto slice = make_partition_slice(options);
+    auto slice = make_partition_slice(proxy, options);
     if (use_paging) {
         slice.options.set<query::partition_slice::option::allow_short_read>();
         slice.options.set<query::partition_slice::option::send_partition_key>();
@@ -738,9 +788,11 @@ select_statement::process_results(foreign_ptr<lw_shared_ptr<query::result>> resu
             if (restrictions_need_filtering) {
                 results->ensure_counts();
                 _stats.filtered_rows_read_total += *results->row_count();
+                auto filter = cql3::selection::result_set_builder::restrictions_filter(_restrictions, options, cmd->get_row_limit(), _schema, cmd->slice.partition_row_limit());
+                filter.evaluate_batch(*results, cmd->slice, *_selection);
                 query::result_view::consume(*results, cmd->slice,
                         cql3::selection::result_set_builder::visitor(builder, *_schema,
-                                *_selection, cql3::selection::result_set_builder::restrictions_filter(_restrictions, options, cmd->get_row_limit(), _schema, cmd->slice.partition_row_limit())));
+                                *_selection, std::move(filter)));
             } else {
                 query::result_view::consume(*results, cmd->slice,
                         cql3::selection::result_set_builder::visitor(builder, *_schema,
@@ -998,8 +1050,10 @@ indexed_table_select_statement::do_execute(service::storage_proxy& proxy,
                 auto consume_results = [this, &builder, &options, &internal_options, restrictions_need_filtering] (foreign_ptr<lw_shared_ptr<query::result>> results, lw_shared_ptr<query::read_command> cmd) {
                     if (restrictions_need_filtering) {
                         _stats.filtered_rows_read_total += *results->row_count();
+                        auto filter = cql3::selection::result_set_builder::restrictions_filter(_restrictions, options, cmd->get_row_limit(), _schema, cmd->slice.partition_row_limit());
+                        filter.evaluate_batch(*results, cmd->slice, *_selection);
                         query::result_view::consume(*results, cmd->slice, cql3::selection::result_set_builder::visitor(builder, *_schema, *_selection,
-                                cql3::selection::result_set_builder::restrictions_filter(_restrictions, options, cmd->get_row_limit(), _schema, cmd->slice.partition_row_limit())));
+                                std::move(filter)));
                     } else {
                         query::result_view::consume(*results, cmd->slice, cql3::selection::result_set_builder::visitor(builder, *_schema, *_selection));
                     }
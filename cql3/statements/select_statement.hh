@@ -46,6 +46,7 @@
 #include "cql3/cql_statement.hh"
 #include "cql3/selection/selection.hh"
 #include "cql3/selection/raw_selector.hh"
+#include "cql3/selection/partial_aggregates.hh"
 #include "cql3/restrictions/statement_restrictions.hh"
 #include "cql3/result_set.hh"
 #include "exceptions/unrecognized_entity_exception.hh"
@@ -92,8 +93,16 @@ class select_statement : public cql_statement {
     ordering_comparator_type _ordering_comparator;
 
     query::partition_slice::option_set _opts;
+    // Columns of the partition slice, which only depend on the selection.
+    query::column_id_vector _static_columns;
+    query::column_id_vector _regular_columns;
+    // Set if replicas can aggregate the groups of rows of the query.
+    std::optional<selection::partial_aggregates> _partial_aggregates;
     cql_stats& _stats;
     const ks_selector _ks_sel;
+    // Set if the statement calls a function whose result isn't determined by
+    // its arguments, like now(), so that its result can't be cached.
+    bool _uses_non_pure_functions = false;
     bool _range_scan = false;
     bool _range_scan_no_bypass_cache = false;
 protected :
@@ -142,11 +151,20 @@ protected :
     const sstring& column_family() const;
 
     query::partition_slice make_partition_slice(const query_options& options) const;
+    // Like make_partition_slice(options), but also asks replicas to evaluate
+    // the filtering restrictions they can, if the cluster supports it.
+    query::partition_slice make_partition_slice(service::storage_proxy& proxy, const query_options& options) const;
 
     ::shared_ptr<restrictions::statement_restrictions> get_restrictions() const;
 
     bool has_group_by() const { return _group_by_cell_indices && !_group_by_cell_indices->empty(); }
 
+    const schema_ptr& get_schema() const { return _schema; }
+
+    // Returns the partition read by the statement with these options, if its
+    // result may be served from the coordinator result cache (see cql3::result_cache).
+    std::optional<dht::decorated_key> get_cacheable_partition(const query_options& options) const;
+
 protected:
     uint64_t do_get_limit(const query_options& options, ::shared_ptr<term> limit, uint64_t default_limit) const;
     uint64_t get_limit(const query_options& options) const {
@@ -181,6 +181,11 @@ database::database(const db::config& cfg, database_config dbcfg, service::migrat
         }
         return backlog;
     }))
+    , _memtable_to_cache_controller(dbcfg.memtable_to_cache_scheduling_group, 50ms, [this, limit = float(_dirty_memory_manager.throttle_threshold())] {
+        // Real dirty memory which is not virtual dirty was written by flushes, and is released as it is moved into the cache.
+        auto written = float(_dirty_memory_manager.real_dirty_memory()) - float(_dirty_memory_manager.virtual_dirty_memory());
+        return std::max(written, 0.0f) / limit;
+    })
     , _read_concurrency_sem(max_count_concurrent_reads,
         max_memory_concurrent_reads(),
         "_read_concurrency_sem",
@@ -222,6 +227,7 @@ database::database(const db::config& cfg, database_config dbcfg, service::migrat
     , _token_metadata(tm)
 {
     local_schema_registry().init(*this); // TODO: we're never unbound.
+    _user_sstables_manager->get_partition_locator().set_memory_limit(size_t(_cfg.sstable_partition_locator_memory_in_mb()) << 20);
     setup_metrics();
 
     _row_cache_tracker.set_compaction_scheduling_group(dbcfg.memory_compaction_scheduling_group);
@@ -379,6 +385,9 @@ database::setup_metrics() {
         sm::make_derive("total_writes_timedout", _stats->total_writes_timedout,
                        sm::description("Counts write operations failed due to a timeout. A positive value is a sign of storage being overloaded.")),
 
+        sm::make_derive("counter_updates_batched", _stats->counter_updates_batched,
+                       sm::description("Counts counter updates merged into a pending update of the same partition, and applied with it.")),
+
         sm::make_derive("total_reads", _stats->total_reads,
                        sm::description("Counts the total number of successful reads on this shard.")),
 
@@ -412,6 +421,19 @@ database::setup_metrics() {
         sm::make_gauge("querier_cache_population", _querier_cache.get_stats().population,
                        sm::description("The number of entries currently in the querier cache.")),
 
+        sm::make_gauge("partition_locator_memory", [this] { return _user_sstables_manager->get_partition_locator().memory_used(); },
+                       sm::description("Holds the amount of memory used by the partition-to-sstable locator index.")),
+
+        sm::make_gauge("partition_locator_sstables", [this] { return _user_sstables_manager->get_partition_locator().get_stats().indexed_sstables; },
+                       sm::description("Holds the number of sstables indexed by the partition-to-sstable locator.")),
+
+        sm::make_derive("partition_locator_rejected_sstables", [this] { return _user_sstables_manager->get_partition_locator().get_stats().rejected_sstables; },
+                       sm::description("Counts sstables which were not indexed by the partition-to-sstable locator because of its memory limit. "
+                                       "Reads of these sstables fall back to probing their filters.")),
+
+        sm::make_derive("partition_locator_lookups", [this] { return _user_sstables_manager->get_partition_locator().get_stats().lookups; },
+                       sm::description("Counts lookups in the partition-to-sstable locator.")),
+
         sm::make_derive("sstable_read_queue_overloads", _stats->sstable_read_queue_overloaded,
                        sm::description("Counts the number of times the sstable read queue was overloaded. "
                                        "A non-zero value indicates that we have to drop read requests because they arrive faster than we can serve them.")),
@@ -498,6 +520,14 @@ database::setup_metrics() {
         sm::make_derive("short_mutation_queries", _stats->short_mutation_queries,
                        sm::description("The rate of mutation queries that returned less rows than requested due to result size limiting.")),
 
+        sm::make_derive("filtered_rows_read", _stats->filtered_rows_read,
+                       sm::description("Counts the rows read by data queries which had their filtering restrictions evaluated on this shard. "
+                                       "See filtered_rows_dropped for how many of them were left out of the results.")),
+
+        sm::make_derive("filtered_rows_dropped", _stats->filtered_rows_dropped,
+                       sm::description("Counts the rows read by data queries with filtering restrictions, which did not match them "
+                                       "and were left out of the results sent to the coordinator.")),
+
         sm::make_derive("multishard_query_unpopped_fragments", _stats->multishard_query_unpopped_fragments,
                        sm::description("The total number of fragments that were extracted from the shard reader but were unconsumed by the query and moved back into the reader.")),
 
@@ -930,6 +960,7 @@ keyspace::make_column_family_config(const schema& s, const database& db) const {
     cfg.enable_cache = _config.enable_cache;
     cfg.enable_dangerous_direct_import_of_cassandra_counters = _config.enable_dangerous_direct_import_of_cassandra_counters;
     cfg.compaction_enforce_min_threshold = _config.compaction_enforce_min_threshold;
+    cfg.memtable_flush_parallelism = _config.memtable_flush_parallelism;
     cfg.dirty_memory_manager = _config.dirty_memory_manager;
     cfg.streaming_dirty_memory_manager = _config.streaming_dirty_memory_manager;
     cfg.streaming_read_concurrency_semaphore = _config.streaming_read_concurrency_semaphore;
@@ -1186,9 +1217,10 @@ compare_atomic_cell_for_merge(atomic_cell_view left, atomic_cell_view right) {
 
 future<std::tuple<lw_shared_ptr<query::result>, cache_temperature>>
 database::query(schema_ptr s, const query::read_command& cmd, query::result_options opts, const dht::partition_range_vector& ranges,
-                tracing::trace_state_ptr trace_state, db::timeout_clock::time_point timeout) {
+                tracing::trace_state_ptr trace_state, db::timeout_clock::time_point timeout, abort_source* as) {
     column_family& cf = find_column_family(cmd.cf_id);
-    auto class_config = query::query_class_config{.semaphore = get_reader_concurrency_semaphore(), .max_memory_for_unlimited_query = *cmd.max_result_size};
+    auto class_config = query::query_class_config{.semaphore = get_reader_concurrency_semaphore(), .max_memory_for_unlimited_query = *cmd.max_result_size,
+            .abort = as};
     query::querier_cache_context cache_ctx(_querier_cache, cmd.query_uuid, cmd.is_first_page);
     return _data_query_stage(&cf,
             std::move(s),
@@ -1199,19 +1231,28 @@ database::query(schema_ptr s, const query::read_command& cmd, query::result_opti
             std::move(trace_state),
             seastar::ref(get_result_memory_limiter()),
             timeout,
-            std::move(cache_ctx)).then_wrapped([this, s = _stats, hit_rate = cf.get_global_cache_hit_rate(), op = cf.read_in_progress()] (auto f) {
+            std::move(cache_ctx)).then_wrapped([this, &cmd, s = _stats, hit_rate = cf.get_global_cache_hit_rate(), op = cf.read_in_progress()] (auto f) {
         if (f.failed()) {
             ++s->total_reads_failed;
             return make_exception_future<std::tuple<lw_shared_ptr<query::result>, cache_temperature>>(f.get_exception());
         } else {
             ++s->total_reads;
             auto result = f.get0();
+            account_filtered_rows(cmd.slice, *result);
             s->short_data_queries += bool(result->is_short_read());
             return make_ready_future<std::tuple<lw_shared_ptr<query::result>, cache_temperature>>(std::tuple(std::move(result), hit_rate));
         }
     });
 }
 
+void database::account_filtered_rows(const query::partition_slice& slice, const query::result& result) {
+    if (slice.column_filters().empty() || !result.row_count()) {
+        return;
+    }
+    _stats->filtered_rows_read += *result.row_count();
+    _stats->filtered_rows_dropped += result.filtered_out_row_count();
+}
+
 future<std::tuple<reconcilable_result, cache_temperature>>
 database::query_mutations(schema_ptr s, const query::read_command& cmd, const dht::partition_range& range,
                           tracing::trace_state_ptr trace_state, db::timeout_clock::time_point timeout) {
@@ -1319,9 +1360,8 @@ std::ostream& operator<<(std::ostream& out, const database& db) {
     return out;
 }
 
-future<mutation> database::do_apply_counter_update(column_family& cf, const frozen_mutation& fm, schema_ptr m_schema,
-                                                   db::timeout_clock::time_point timeout,tracing::trace_state_ptr trace_state) {
-    auto m = fm.unfreeze(m_schema);
+future<mutation> database::do_apply_counter_update(column_family& cf, mutation m, db::timeout_clock::time_point timeout,
+                                                   tracing::trace_state_ptr trace_state) {
     m.upgrade(cf.schema());
 
     // prepare partition slice
@@ -1376,6 +1416,46 @@ future<mutation> database::do_apply_counter_update(column_family& cf, const froz
     });
 }
 
+// The first update of a partition waits for the end of the window, and then
+// applies the updates merged into it in the meantime, which wait for it.
+// Merging sums the deltas of each counter, so the merged update is applied
+// with a single lock, read and commit log write. All the updates of the batch
+// get the resulting counter shards, which are replicated as many times;
+// that's idempotent, counter shards are merged by their logical clock.
+future<mutation> database::apply_counter_update_batched(column_family& cf, mutation m, std::chrono::microseconds window,
+                                                        db::timeout_clock::time_point timeout, tracing::trace_state_ptr trace_state) {
+    m.upgrade(cf.schema());
+    auto& batches = cf.get_counter_update_batches();
+    auto it = batches.find(m.decorated_key());
+    if (it != batches.end()) {
+        auto& batch = *it->second;
+        tracing::trace(trace_state, "Merging counter update into a pending one");
+        if (batch.update.schema() != m.schema()) {
+            batch.update.upgrade(m.schema());
+        }
+        batch.update.apply(std::move(m));
+        batch.timeout = std::max(batch.timeout, timeout);
+        ++_stats->counter_updates_batched;
+        return batch.applied.get_shared_future();
+    }
+    auto batch = make_lw_shared<column_family::counter_update_batch>(std::move(m), timeout);
+    batches.emplace(batch->update.decorated_key(), batch);
+    tracing::trace(trace_state, "Waiting for more counter updates of the partition");
+    return sleep(window).then([this, &cf, batch, trace_state = std::move(trace_state), op = cf.write_in_progress()] () mutable {
+        cf.get_counter_update_batches().erase(batch->update.decorated_key());
+        return do_apply_counter_update(cf, std::move(batch->update), batch->timeout, std::move(trace_state)).then_wrapped([batch] (future<mutation> f) {
+            if (f.failed()) {
+                auto ex = f.get_exception();
+                batch->applied.set_exception(ex);
+                return make_exception_future<mutation>(std::move(ex));
+            }
+            auto m = f.get0();
+            batch->applied.set_value(m);
+            return make_ready_future<mutation>(std::move(m));
+        });
+    });
+}
+
 future<> dirty_memory_manager::shutdown() {
     _db_shutdown_requested = true;
     _should_flush.signal();
@@ -1485,10 +1565,11 @@ void dirty_memory_manager::start_reclaiming() noexcept {
 future<> database::apply_in_memory(const frozen_mutation& m, schema_ptr m_schema, db::rp_handle&& h, db::timeout_clock::time_point timeout) {
     auto& cf = find_column_family(m.column_family_id());
 
-    data_listeners().on_write(m_schema, m);
-
     return cf.dirty_memory_region_group().run_when_memory_available([this, &m, m_schema = std::move(m_schema), h = std::move(h), &cf]() mutable {
         cf.apply(m, m_schema, std::move(h));
+        // After the apply, so that a listener invalidating what it derived from the data
+        // can't be followed by a read which still sees the old data.
+        data_listeners().on_write(m_schema, m);
     }, timeout);
 }
 
@@ -1510,7 +1591,11 @@ future<mutation> database::apply_counter_update(schema_ptr s, const frozen_mutat
     }
     try {
         auto& cf = find_column_family(m.column_family_id());
-        return do_apply_counter_update(cf, m, s, timeout, std::move(trace_state));
+        auto window = std::chrono::microseconds(_cfg.counter_update_batching_window_in_us());
+        if (window.count()) {
+            return apply_counter_update_batched(cf, m.unfreeze(s), window, timeout, std::move(trace_state));
+        }
+        return do_apply_counter_update(cf, m.unfreeze(s), timeout, std::move(trace_state));
     } catch (no_such_column_family&) {
         dblog.error("Attempting to mutate non-existent table {}", m.column_family_id());
         throw;
@@ -1647,6 +1732,7 @@ database::make_keyspace_config(const keyspace_metadata& ksm) {
     }
     cfg.enable_dangerous_direct_import_of_cassandra_counters = _cfg.enable_dangerous_direct_import_of_cassandra_counters();
     cfg.compaction_enforce_min_threshold = _cfg.compaction_enforce_min_threshold;
+    cfg.memtable_flush_parallelism = _cfg.memtable_flush_parallelism;
     cfg.dirty_memory_manager = &_dirty_memory_manager;
     cfg.streaming_dirty_memory_manager = &_streaming_dirty_memory_manager;
     cfg.streaming_read_concurrency_semaphore = &_streaming_concurrency_sem;
@@ -1797,6 +1883,8 @@ database::stop() {
         return _streaming_dirty_memory_manager.shutdown();
     }).then([this] {
         return _memtable_controller.shutdown();
+    }).then([this] {
+        return _memtable_to_cache_controller.shutdown();
     });
 }
 
@@ -375,6 +375,9 @@ class table : public enable_lw_shared_from_this<table> {
         bool enable_commitlog = true;
         bool enable_incremental_backups = false;
         utils::updateable_value<bool> compaction_enforce_min_threshold{false};
+        utils::updateable_value<uint32_t> memtable_flush_parallelism{1};
+        // Memtables smaller than that per sstable are not split for flushing.
+        size_t min_split_flush_size = 32 << 20;
         bool enable_dangerous_direct_import_of_cassandra_counters = false;
         ::dirty_memory_manager* dirty_memory_manager = &default_dirty_memory_manager;
         ::dirty_memory_manager* streaming_dirty_memory_manager = &default_dirty_memory_manager;
@@ -472,6 +475,20 @@ class table : public enable_lw_shared_from_this<table> {
     std::vector<view_ptr> _views;
 
     std::unique_ptr<cell_locker> _counter_cell_locks; // Memory-intensive; allocate only when needed.
+public:
+    // Counter updates of a partition, merged while they wait for the end of the
+    // batching window. See database::apply_counter_update().
+    struct counter_update_batch {
+        mutation update;
+        db::timeout_clock::time_point timeout;
+        shared_promise<mutation> applied;
+
+        counter_update_batch(mutation m, db::timeout_clock::time_point t)
+            : update(std::move(m)), timeout(t) { }
+    };
+    using counter_update_batches = std::map<dht::decorated_key, lw_shared_ptr<counter_update_batch>, dht::decorated_key::less_comparator>;
+private:
+    counter_update_batches _counter_update_batches;
     void set_metrics();
     seastar::metrics::metric_groups _metrics;
 
@@ -510,6 +527,9 @@ class table : public enable_lw_shared_from_this<table> {
     db_clock::time_point _truncated_at = db_clock::time_point::min();
 
     bool _is_bootstrap_or_replace = false;
+
+    // Tells the data listeners that data in the range changed without a write.
+    void notify_invalidated(const dht::partition_range& range);
 public:
     future<> add_sstable_and_update_cache(sstables::shared_sstable sst);
     future<> move_sstables_from_staging(std::vector<sstables::shared_sstable>);
@@ -536,10 +556,11 @@ class table : public enable_lw_shared_from_this<table> {
     void notify_bootstrap_or_replace_end() {
         _is_bootstrap_or_replace = false;
     }
-private:
+
     bool cache_enabled() const {
         return _config.enable_cache && _schema->caching_options().enabled();
     }
+private:
     void update_stats_for_new_sstable(uint64_t disk_space_used_by_sstable) noexcept;
     // Adds new sstable to the set of sstables
     // Doesn't update the cache. The cache must be synchronized in order for reads to see
@@ -554,7 +575,9 @@ class table : public enable_lw_shared_from_this<table> {
     lw_shared_ptr<memtable> new_memtable();
     future<stop_iteration> try_flush_memtable_to_sstable(lw_shared_ptr<memtable> memt, sstable_write_permit&& permit);
     // Caller must keep m alive.
-    future<> update_cache(lw_shared_ptr<memtable> m, sstables::shared_sstable sst);
+    future<> update_cache(lw_shared_ptr<memtable> m, std::vector<sstables::shared_sstable> ssts);
+    // Returns the token ranges to flush the memtable into separate sstables.
+    dht::partition_range_vector flush_ranges(const memtable& mt) const;
     struct merge_comparator;
 
     // update the sstable generation, making sure that new new sstables don't overwrite this one.
@@ -686,6 +709,11 @@ class table : public enable_lw_shared_from_this<table> {
     flat_mutation_reader make_streaming_reader(schema_ptr schema,
             const dht::partition_range_vector& ranges) const;
 
+    // Like the above, but reads sstables from the given set instead of the
+    // current sstable set of the table.
+    flat_mutation_reader make_streaming_reader(schema_ptr schema,
+            const dht::partition_range_vector& ranges, lw_shared_ptr<sstables::sstable_set> sstables) const;
+
     // Single range overload.
     flat_mutation_reader make_streaming_reader(schema_ptr schema, const dht::partition_range& range,
             const query::partition_slice& slice,
@@ -724,6 +752,10 @@ class table : public enable_lw_shared_from_this<table> {
 
     future<std::vector<locked_cell>> lock_counter_cells(const mutation& m, db::timeout_clock::time_point timeout);
 
+    counter_update_batches& get_counter_update_batches() {
+        return _counter_update_batches;
+    }
+
     logalloc::occupancy_stats occupancy() const;
 private:
     table(schema_ptr schema, config cfg, db::commitlog* cl, compaction_manager&, cell_locker_stats& cl_stats, cache_tracker& row_cache_tracker);
@@ -1128,6 +1160,7 @@ class keyspace {
         bool enable_cache = true;
         bool enable_incremental_backups = false;
         utils::updateable_value<bool> compaction_enforce_min_threshold{false};
+        utils::updateable_value<uint32_t> memtable_flush_parallelism{1};
         bool enable_dangerous_direct_import_of_cassandra_counters = false;
         ::dirty_memory_manager* dirty_memory_manager = &default_dirty_memory_manager;
         ::dirty_memory_manager* streaming_dirty_memory_manager = &default_dirty_memory_manager;
@@ -1254,6 +1287,7 @@ class database {
         uint64_t total_writes = 0;
         uint64_t total_writes_failed = 0;
         uint64_t total_writes_timedout = 0;
+        uint64_t counter_updates_batched = 0;
         uint64_t total_reads = 0;
         uint64_t total_reads_failed = 0;
         uint64_t sstable_read_queue_overloaded = 0;
@@ -1261,6 +1295,10 @@ class database {
         uint64_t short_data_queries = 0;
         uint64_t short_mutation_queries = 0;
 
+        // Rows read by data queries with column filters, and those of them left out of the results.
+        uint64_t filtered_rows_read = 0;
+        uint64_t filtered_rows_dropped = 0;
+
         uint64_t multishard_query_unpopped_fragments = 0;
         uint64_t multishard_query_unpopped_bytes = 0;
         uint64_t multishard_query_failed_reader_stops = 0;
@@ -1278,6 +1316,7 @@ class database {
 
     database_config _dbcfg;
     flush_controller _memtable_controller;
+    cache_update_controller _memtable_to_cache_controller;
 
     reader_concurrency_semaphore _read_concurrency_sem;
     reader_concurrency_semaphore _streaming_concurrency_sem;
@@ -1362,8 +1401,10 @@ class database {
     future<> apply_with_commitlog(schema_ptr, column_family&, utils::UUID, const frozen_mutation&, db::timeout_clock::time_point timeout, db::commitlog::force_sync sync);
     future<> apply_with_commitlog(column_family& cf, const mutation& m, db::timeout_clock::time_point timeout);
 
-    future<mutation> do_apply_counter_update(column_family& cf, const frozen_mutation& fm, schema_ptr m_schema, db::timeout_clock::time_point timeout,
+    future<mutation> do_apply_counter_update(column_family& cf, mutation m, db::timeout_clock::time_point timeout,
                                              tracing::trace_state_ptr trace_state);
+    future<mutation> apply_counter_update_batched(column_family& cf, mutation m, std::chrono::microseconds window,
+                                                  db::timeout_clock::time_point timeout, tracing::trace_state_ptr trace_state);
 
     template<typename Future>
     Future update_write_metrics(Future&& f);
@@ -1460,7 +1501,9 @@ class database {
     unsigned shard_of(const frozen_mutation& m);
     future<std::tuple<lw_shared_ptr<query::result>, cache_temperature>> query(schema_ptr, const query::read_command& cmd, query::result_options opts,
                                                                   const dht::partition_range_vector& ranges, tracing::trace_state_ptr trace_state,
-                                                                  db::timeout_clock::time_point timeout);
+                                                                  db::timeout_clock::time_point timeout, abort_source* as = nullptr);
+    // Updates the statistics of the rows read and left out by replicas evaluating the column filters of the slice.
+    void account_filtered_rows(const query::partition_slice& slice, const query::result& result);
     future<std::tuple<reconcilable_result, cache_temperature>> query_mutations(schema_ptr, const query::read_command& cmd, const dht::partition_range& range,
                                                 tracing::trace_state_ptr trace_state, db::timeout_clock::time_point timeout);
     // Apply the mutation atomically.
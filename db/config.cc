@@ -195,6 +195,8 @@ db::config::config(std::shared_ptr<db::extensions> exts)
         "true: auto-adjust memtable shares for flush processes")
     , memtable_flush_static_shares(this, "memtable_flush_static_shares", value_status::Used, 0,
         "If set to higher than 0, ignore the controller's output and set the memtable shares statically. Do not set this unless you know what you are doing and suspect a problem in the controller. This option will be retired when the controller reaches more maturity")
+    , memtable_flush_parallelism(this, "memtable_flush_parallelism", liveness::LiveUpdate, value_status::Used, 1,
+        "Maximum number of sstables a memtable flush is split into by token range, and written in parallel. Each sstable gets at least 32 MB of the memtable, so small memtables are not split. The sstables of a flush don't overlap, and form a single run.")
     , compaction_static_shares(this, "compaction_static_shares", value_status::Used, 0,
         "If set to higher than 0, ignore the controller's output and set the compaction shares statically. Do not set this unless you know what you are doing and suspect a problem in the controller. This option will be retired when the controller reaches more maturity")
     , compaction_enforce_min_threshold(this, "compaction_enforce_min_threshold", liveness::LiveUpdate, value_status::Used, false,
@@ -230,7 +232,7 @@ db::config::config(std::shared_ptr<db::extensions> exts)
         "The directory where hints files are stored if hinted handoff is enabled.")
     , view_hints_directory(this, "view_hints_directory", value_status::Used, "",
         "The directory where materialized-view updates are stored while a view replica is unreachable.")
-    , saved_caches_directory(this, "saved_caches_directory", value_status::Unused, "",
+    , saved_caches_directory(this, "saved_caches_directory", value_status::Used, "",
         "The directory location where table key and row caches are stored.")
     /* Commonly used properties */
     /* Properties most frequently used when configuring Scylla. */
@@ -444,12 +446,12 @@ db::config::config(std::shared_ptr<db::extensions> exts)
     , key_cache_size_in_mb(this, "key_cache_size_in_mb", value_status::Unused, 100,
         "A global cache setting for tables. It is the maximum size of the key cache in memory. To disable set to 0.\n"
         "Related information: nodetool setcachecapacity.")
-    , row_cache_keys_to_save(this, "row_cache_keys_to_save", value_status::Unused, 0,
-        "Number of keys from the row cache to save.")
+    , row_cache_keys_to_save(this, "row_cache_keys_to_save", value_status::Used, 100000,
+        "Number of keys of the most frequently read partitions of each table saved by each shard. (0: all)")
     , row_cache_size_in_mb(this, "row_cache_size_in_mb", value_status::Unused, 0,
         "Maximum size of the row cache in memory. Row cache can save more time than key_cache_size_in_mb, but is space-intensive because it contains the entire row. Use the row cache only for hot rows or static rows. If you reduce the size, you may not get you hottest keys loaded on start up.")
-    , row_cache_save_period(this, "row_cache_save_period", value_status::Unused, 0,
-        "Duration in seconds that rows are saved in cache. Caches are saved to saved_caches_directory.")
+    , row_cache_save_period(this, "row_cache_save_period", value_status::Used, 0,
+        "Interval in seconds at which the keys of the most frequently read partitions of the row cache are saved to saved_caches_directory. The saved partitions are read back into the cache in the background on startup. (0: disabled)")
     , memory_allocator(this, "memory_allocator", value_status::Invalid, "NativeAllocator",
         "The off-heap memory allocator. In addition to caches, this property affects storage engine meta data. Supported values:\n"
         "\tNativeAllocator\n"
@@ -465,6 +467,8 @@ db::config::config(std::shared_ptr<db::extensions> exts)
         "Duration after which Cassandra should save the counter cache (keys only). Caches are saved to saved_caches_directory.")
     , counter_cache_keys_to_save(this, "counter_cache_keys_to_save", value_status::Unused, 0,
         "Number of keys from the counter cache to save. When disabled all keys are saved.")
+    , counter_update_batching_window_in_us(this, "counter_update_batching_window_in_us", liveness::LiveUpdate, value_status::Used, 0,
+        "The time in microseconds during which the updates of a counter partition received by its leader replica are merged, so that they are applied with a single read of the counter. Each update is acknowledged once the merged update is written to the commit log. Trades the latency of counter updates for the throughput of frequently updated counters. (0: disabled)")
     /* Tombstone settings */
     /* When executing a scan, within or across a partition, tombstones must be kept in memory to allow returning them to the coordinator. The coordinator uses them to ensure other replicas know about the deleted rows. Workloads that generate numerous tombstones may cause performance problems and exhaust the server heap. See Cassandra anti-patterns: Queues and queue-like datasets. Adjust these thresholds only if you understand the impact and want to scan more tombstones. Additionally, you can adjust these thresholds at runtime using the StorageServiceMBean. */
     /* Related information: Cassandra anti-patterns: Queues and queue-like datasets */
@@ -510,6 +514,8 @@ db::config::config(std::shared_ptr<db::extensions> exts)
         "\tall: All traffic is compressed.\n"
         "\tdc : Traffic between data centers is compressed.\n"
         "\tnone : No compression.")
+    , internode_compression_for_streaming(this, "internode_compression_for_streaming", value_status::Used, "",
+        "Controls whether streaming, repair and hint replay traffic between nodes is compressed. Takes the same values as internode_compression, which is used when this is empty.")
     , inter_dc_tcp_nodelay(this, "inter_dc_tcp_nodelay", value_status::Used, false,
         "Enable or disable tcp_nodelay for inter-data center communication. When disabled larger, but fewer, network packets are sent. This reduces overhead from the TCP protocol itself. However, if cross data-center responses are blocked, it will increase latency.")
     , streaming_socket_timeout_in_ms(this, "streaming_socket_timeout_in_ms", value_status::Unused, 0,
@@ -563,6 +569,10 @@ db::config::config(std::shared_ptr<db::extensions> exts)
         "\tYour own RPC server: You must provide a fully-qualified class name of an o.a.c.t.TServerFactory that can create a server instance.")
     , cache_hit_rate_read_balancing(this, "cache_hit_rate_read_balancing", value_status::Used, true,
         "This boolean controls whether the replicas for read query will be choosen based on cache hit ratio")
+    , adaptive_replica_selection(this, "adaptive_replica_selection", liveness::LiveUpdate, value_status::Used, false,
+        "This boolean controls whether the replicas for read query will be ordered, within each datacenter, by their observed latency and read queue length, so that reads avoid overloaded replicas")
+    , hedged_reads_budget_percent(this, "hedged_reads_budget_percent", liveness::LiveUpdate, value_status::Used, 0,
+        "Enables hedged reads for CL=ONE and CL=LOCAL_ONE reads when greater than 0. The speculative request of a hedged read is only sent if the number of speculative requests stays below this percentage of reads, and the request which loses the race is cancelled on its replica. Set to 0 to let speculative retry send extra requests without a limit, and let them complete.")
     /* Advanced fault detection settings */
     /* Settings to handle poorly performing or failing nodes. */
     , dynamic_snitch_badness_threshold(this, "dynamic_snitch_badness_threshold", value_status::Unused, 0,
@@ -670,6 +680,9 @@ db::config::config(std::shared_ptr<db::extensions> exts)
         "The SSL port for encrypted communication. Unused unless enabled in encryption_options.")
     , enable_in_memory_data_store(this, "enable_in_memory_data_store", value_status::Used, false, "Enable in memory mode (system tables are always persisted)")
     , enable_cache(this, "enable_cache", value_status::Used, true, "Enable cache")
+    , cache_admission_filter_range_scans(this, "cache_admission_filter_range_scans", liveness::LiveUpdate, value_status::Used, false,
+        "Let partition range scans populate the row cache, once it is full, only with partitions which were read frequently of late, "
+        "as if their table had caching = {'admission': 'FREQUENT'}. Keeps one-off full scans from evicting the working set.")
     , enable_commitlog(this, "enable_commitlog", value_status::Used, true, "Enable commitlog")
     , volatile_system_keyspace_for_testing(this, "volatile_system_keyspace_for_testing", value_status::Used, false, "Don't persist system keyspace - testing only!")
     , api_port(this, "api_port", value_status::Used, 10000, "Http Rest API port")
@@ -686,6 +699,8 @@ db::config::config(std::shared_ptr<db::extensions> exts)
     , replace_address_first_boot(this, "replace_address_first_boot", value_status::Used, "", "Like replace_address option, but if the node has been bootstrapped successfully it will be ignored. Same as -Dcassandra.replace_address_first_boot.")
     , override_decommission(this, "override_decommission", value_status::Used, false, "Set true to force a decommissioned node to join the cluster")
     , enable_repair_based_node_ops(this, "enable_repair_based_node_ops", liveness::LiveUpdate, value_status::Used, true, "Set true to use enable repair based node operations instead of streaming based")
+    , enable_sstable_file_streaming(this, "enable_sstable_file_streaming", liveness::LiveUpdate, value_status::Used, false, "Set true to stream whole SSTables as files, instead of mutation fragments, when an SSTable is fully contained in the streamed ranges and the peer has the same shard layout")
+    , stream_fragment_batch_size_in_kb(this, "stream_fragment_batch_size_in_kb", liveness::LiveUpdate, value_status::Used, 128, "Coalesce streamed mutation fragments into batches of up to this size before sending them, so that they are framed and compressed together. Set to 0 to send fragments one by one")
     , ring_delay_ms(this, "ring_delay_ms", value_status::Used, 30 * 1000, "Time a node waits to hear from other nodes before joining the ring in milliseconds. Same as -Dcassandra.ring_delay_ms in cassandra.")
     , shadow_round_ms(this, "shadow_round_ms", value_status::Used, 300 * 1000, "The maximum gossip shadow round time. Can be used to reduce the gossip feature check time during node boot up.")
     , fd_max_interval_ms(this, "fd_max_interval_ms", value_status::Used, 2 * 1000, "The maximum failure_detector interval time in milliseconds. Interval larger than the maximum will be ignored. Larger cluster may need to increase the default.")
@@ -701,6 +716,8 @@ db::config::config(std::shared_ptr<db::extensions> exts)
     , prometheus_address(this, "prometheus_address", value_status::Used, "0.0.0.0", "Prometheus listening address")
     , prometheus_prefix(this, "prometheus_prefix", value_status::Used, "scylla", "Set the prefix of the exported Prometheus metrics. Changing this will break Scylla's dashboard compatibility, do not change unless you know what you are doing.")
     , abort_on_lsa_bad_alloc(this, "abort_on_lsa_bad_alloc", value_status::Used, false, "Abort when allocation in LSA region fails")
+    , lsa_huge_pages(this, "lsa_huge_pages", value_status::Used, false, "Back LSA memory with transparent huge pages, and allocate segments so that those of a region share them, to reduce TLB misses when accessing the cache and memtables. With --hugepages, all memory is backed by huge pages already, and only the grouping of segments applies.")
+    , lsa_background_reclaim_segments(this, "lsa_background_reclaim_segments", value_status::Used, 64, "Amount of free memory, in LSA segments of 128 KiB, to keep ahead of allocations by compacting and evicting in the background, so that allocations rarely have to do it synchronously. Free memory of the shard and free LSA segments both count towards it, so nothing is evicted while memory is free. 0 disables background reclaim.")
     , murmur3_partitioner_ignore_msb_bits(this, "murmur3_partitioner_ignore_msb_bits", value_status::Used, 12, "Number of most siginificant token bits to ignore in murmur3 partitioner; increase for very large clusters")
     , virtual_dirty_soft_limit(this, "virtual_dirty_soft_limit", value_status::Used, 0.6, "Soft limit of virtual dirty memory expressed as a portion of the hard limit")
     , sstable_summary_ratio(this, "sstable_summary_ratio", value_status::Used, 0.0005, "Enforces that 1 byte of summary is written for every N (2000 by default) "
@@ -712,6 +729,9 @@ db::config::config(std::shared_ptr<db::extensions> exts)
         " Performance is affected to some extent as a result. Useful to help debugging problems that may arise at another layers.")
     , enable_sstable_key_validation(this, "enable_sstable_key_validation", value_status::Used, ENABLE_SSTABLE_KEY_VALIDATION, "Enable validation of partition and clustering keys monotonicity"
         " Performance is affected to some extent as a result. Useful to help debugging problems that may arise at another layers.")
+    , sstable_partition_locator_memory_in_mb(this, "sstable_partition_locator_memory_in_mb", value_status::Used, 0, "Memory, per shard, of the index mapping partition keys to the sstables which contain them. "
+        "When set, single-partition reads find their sstables with one lookup in this index, instead of probing the bloom filter of every sstable overlapping the key. "
+        "Sstables which don't fit in the limit are read as if the index didn't exist. 0 disables the index")
     , cpu_scheduler(this, "cpu_scheduler", value_status::Used, true, "Enable cpu scheduling")
     , view_building(this, "view_building", value_status::Used, true, "Enable view building; should only be set to false when the node is experience issues due to view building")
     , enable_sstables_mc_format(this, "enable_sstables_mc_format", value_status::Used, true, "Enable SSTables 'mc' format to be used as the default file format")
@@ -120,6 +120,7 @@ class config : public utils::config_file {
     named_value<double> background_writer_scheduling_quota;
     named_value<bool> auto_adjust_flush_quota;
     named_value<float> memtable_flush_static_shares;
+    named_value<uint32_t> memtable_flush_parallelism;
     named_value<float> compaction_static_shares;
     named_value<bool> compaction_enforce_min_threshold;
     named_value<sstring> cluster_name;
@@ -200,6 +201,7 @@ class config : public utils::config_file {
     named_value<uint32_t> counter_cache_size_in_mb;
     named_value<uint32_t> counter_cache_save_period;
     named_value<uint32_t> counter_cache_keys_to_save;
+    named_value<uint32_t> counter_update_batching_window_in_us;
     named_value<uint32_t> tombstone_warn_threshold;
     named_value<uint32_t> tombstone_failure_threshold;
     named_value<uint32_t> range_request_timeout_in_ms;
@@ -213,6 +215,7 @@ class config : public utils::config_file {
     named_value<uint32_t> internode_send_buff_size_in_bytes;
     named_value<uint32_t> internode_recv_buff_size_in_bytes;
     named_value<sstring> internode_compression;
+    named_value<sstring> internode_compression_for_streaming;
     named_value<bool> inter_dc_tcp_nodelay;
     named_value<uint32_t> streaming_socket_timeout_in_ms;
     named_value<bool> start_native_transport;
@@ -232,6 +235,8 @@ class config : public utils::config_file {
     named_value<uint32_t> rpc_send_buff_size_in_bytes;
     named_value<sstring> rpc_server_type;
     named_value<bool> cache_hit_rate_read_balancing;
+    named_value<bool> adaptive_replica_selection;
+    named_value<double> hedged_reads_budget_percent;
     named_value<double> dynamic_snitch_badness_threshold;
     named_value<uint32_t> dynamic_snitch_reset_interval_in_ms;
     named_value<uint32_t> dynamic_snitch_update_interval_in_ms;
@@ -257,6 +262,7 @@ class config : public utils::config_file {
     named_value<uint32_t> ssl_storage_port;
     named_value<bool> enable_in_memory_data_store;
     named_value<bool> enable_cache;
+    named_value<bool> cache_admission_filter_range_scans;
     named_value<bool> enable_commitlog;
     named_value<bool> volatile_system_keyspace_for_testing;
     named_value<uint16_t> api_port;
@@ -273,6 +279,8 @@ class config : public utils::config_file {
     named_value<sstring> replace_address_first_boot;
     named_value<bool> override_decommission;
     named_value<bool> enable_repair_based_node_ops;
+    named_value<bool> enable_sstable_file_streaming;
+    named_value<uint32_t> stream_fragment_batch_size_in_kb;
     named_value<uint32_t> ring_delay_ms;
     named_value<uint32_t> shadow_round_ms;
     named_value<uint32_t> fd_max_interval_ms;
@@ -288,6 +296,8 @@ class config : public utils::config_file {
     named_value<sstring> prometheus_address;
     named_value<sstring> prometheus_prefix;
     named_value<bool> abort_on_lsa_bad_alloc;
+    named_value<bool> lsa_huge_pages;
+    named_value<size_t> lsa_background_reclaim_segments;
     named_value<unsigned> murmur3_partitioner_ignore_msb_bits;
     named_value<double> virtual_dirty_soft_limit;
     named_value<double> sstable_summary_ratio;
@@ -296,6 +306,7 @@ class config : public utils::config_file {
     named_value<bool> enable_keyspace_column_family_metrics;
     named_value<bool> enable_sstable_data_integrity_check;
     named_value<bool> enable_sstable_key_validation;
+    named_value<uint32_t> sstable_partition_locator_memory_in_mb;
     named_value<bool> cpu_scheduler;
     named_value<bool> view_building;
     named_value<bool> enable_sstables_mc_format;
@@ -57,6 +57,12 @@ void data_listeners::on_write(const schema_ptr& s, const frozen_mutation& m) {
     }
 }
 
+void data_listeners::on_invalidate(const schema_ptr& s, const dht::partition_range& range) {
+    for (auto&& li : _listeners) {
+        li->on_invalidate(s, range);
+    }
+}
+
 toppartitions_item_key::operator sstring() const {
     std::ostringstream oss;
     oss << key.key().with_schema(*schema);
@@ -40,10 +40,14 @@ namespace db {
 
 class data_listener {
 public:
-    // Invoked for each write, with partition granularity.
+    // Invoked for each write, with partition granularity, once it is applied to the memtable.
     // The schema_ptr passed is the one which corresponds to the incoming mutation, not the current schema of the table.
     virtual void on_write(const schema_ptr&, const frozen_mutation&) { }
 
+    // Invoked when data of the table in the range changed without a write, once the change is visible to reads.
+    // This happens when sstables are added by streaming, repair or a load, and when the table is truncated.
+    virtual void on_invalidate(const schema_ptr&, const dht::partition_range&) { }
+
     // Invoked for each query (both data query and mutation query) when a mutation reader is created.
     // Paging queries may invoke this once for a page, or less often, depending on whether they hit in the querier cache or not.
     //
@@ -71,6 +75,7 @@ class data_listeners {
     flat_mutation_reader on_read(const schema_ptr& s, const dht::partition_range& range,
             const query::partition_slice& slice, flat_mutation_reader&& rd);
     void on_write(const schema_ptr& s, const frozen_mutation& m);
+    void on_invalidate(const schema_ptr& s, const dht::partition_range& range);
 
     bool exists(data_listener* listener) const;
     bool empty() const { return _listeners.empty(); }
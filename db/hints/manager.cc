@@ -38,6 +38,7 @@
 #include "service/priority_manager.hh"
 #include "database.hh"
 #include "service_permit.hh"
+#include "db/hints/segment_replay.hh"
 
 using namespace std::literals::chrono_literals;
 
@@ -697,11 +698,18 @@ future<> manager::end_point_hints_manager::sender::send_one_mutation(frozen_muta
     return do_send_one_mutation(std::move(m), natural_endpoints);
 }
 
-future<> manager::end_point_hints_manager::sender::send_one_hint(lw_shared_ptr<send_one_file_ctx> ctx_ptr, fragmented_temporary_buffer buf, db::replay_position rp, gc_clock::duration secs_since_file_mod, const sstring& fname) {
+future<> manager::end_point_hints_manager::sender::send_one_hint(lw_shared_ptr<send_one_file_ctx> ctx_ptr, fragmented_temporary_buffer buf, db::replay_position rp, gc_clock::duration secs_since_file_mod) {
     ctx_ptr->last_attempted_rp = rp;
-    return _resource_manager.get_send_units_for(buf.size_bytes()).then([this, secs_since_file_mod, &fname, buf = std::move(buf), rp, ctx_ptr] (auto units) mutable {
-        // Future is waited on indirectly in `send_one_file()` (via `ctx_ptr->file_send_gate`).
-        (void)with_gate(ctx_ptr->file_send_gate, [this, secs_since_file_mod, &fname, buf = std::move(buf), rp, ctx_ptr] () mutable {
+    auto buf_size = buf.size_bytes();
+    return _send_window.get_units().then([this, buf_size] (auto window_units) {
+        return _resource_manager.get_send_units_for(buf_size).then([window_units = std::move(window_units)] (auto units) mutable {
+            return make_ready_future<std::tuple<semaphore_units<>, semaphore_units<named_semaphore::exception_factory>>>(std::make_tuple(std::move(window_units), std::move(units)));
+        });
+    }).then([this, secs_since_file_mod, buf = std::move(buf), rp, ctx_ptr] (auto all_units) mutable {
+        auto window_units = std::move(std::get<0>(all_units));
+        auto units = std::move(std::get<1>(all_units));
+        // Future is waited on indirectly in `finish_sending_one_file()` (via `ctx_ptr->file_send_gate`).
+        (void)with_gate(ctx_ptr->file_send_gate, [this, secs_since_file_mod, buf = std::move(buf), rp, ctx_ptr] () mutable {
             try {
                 auto m = this->get_mutation(ctx_ptr, buf);
                 gc_clock::duration gc_grace_sec = m.s->gc_grace_seconds();
@@ -714,10 +722,13 @@ future<> manager::end_point_hints_manager::sender::send_one_hint(lw_shared_ptr<s
                     return make_ready_future<>();
                 }
 
-                return this->send_one_mutation(std::move(m)).then([this, rp, ctx_ptr] {
+                auto start = clock::now();
+                return this->send_one_mutation(std::move(m)).then([this, rp, ctx_ptr, start] {
                     ++this->shard_stats().sent;
-                }).handle_exception([this, ctx_ptr, rp] (auto eptr) {
+                    on_hint_send_complete(true, clock::now() - start);
+                }).handle_exception([this, ctx_ptr, rp, start] (auto eptr) {
                     manager_logger.trace("send_one_hint(): failed to send to {}: {}", end_point_key(), eptr);
+                    on_hint_send_complete(false, clock::now() - start);
                     ctx_ptr->on_hint_send_failure(rp);
                 });
 
@@ -729,20 +740,26 @@ future<> manager::end_point_hints_manager::sender::send_one_hint(lw_shared_ptr<s
                 manager_logger.debug("send_hints(): no_such_keyspace: {}", e.what());
                 ++this->shard_stats().discarded;
             } catch (no_column_mapping& e) {
-                manager_logger.debug("send_hints(): {} at {}: {}", fname, rp, e.what());
+                manager_logger.debug("send_hints(): {} at {}: {}", ctx_ptr->fname, rp, e.what());
                 ++this->shard_stats().discarded;
             } catch (...) {
-                manager_logger.debug("send_hints(): unexpected error in file {} at {}: {}", fname, rp, std::current_exception());
+                manager_logger.debug("send_hints(): unexpected error in file {} at {}: {}", ctx_ptr->fname, rp, std::current_exception());
                 ctx_ptr->on_hint_send_failure(rp);
             }
             return make_ready_future<>();
-        }).finally([units = std::move(units), ctx_ptr] {});
+        }).finally([window_units = std::move(window_units), units = std::move(units), ctx_ptr] {});
     }).handle_exception([this, ctx_ptr, rp] (auto eptr) {
         manager_logger.trace("send_one_file(): Hmmm. Something bad had happend: {}", eptr);
         ctx_ptr->on_hint_send_failure(rp);
     });
 }
 
+void manager::end_point_hints_manager::sender::on_hint_send_complete(bool success, clock::duration latency) noexcept {
+    if (_send_window.on_send_complete(success, latency, clock::now())) {
+        manager_logger.trace("send window for {} changed to {}", end_point_key(), _send_window.size());
+    }
+}
+
 void manager::end_point_hints_manager::sender::send_one_file_ctx::on_hint_send_failure(db::replay_position rp) noexcept {
     segment_replay_failed = true;
     if (!first_failed_rp || rp < *first_failed_rp) {
@@ -751,13 +768,17 @@ void manager::end_point_hints_manager::sender::send_one_file_ctx::on_hint_send_f
 }
 
 // runs in a seastar::async context
-bool manager::end_point_hints_manager::sender::send_one_file(const sstring& fname) {
+lw_shared_ptr<manager::end_point_hints_manager::sender::send_one_file_ctx>
+manager::end_point_hints_manager::sender::start_sending_one_file(const sstring& fname, bool resume) {
     timespec last_mod = get_last_file_modification(fname).get0();
     gc_clock::duration secs_since_file_mod = std::chrono::seconds(last_mod.tv_sec);
-    lw_shared_ptr<send_one_file_ctx> ctx_ptr = make_lw_shared<send_one_file_ctx>(_last_schema_ver_to_column_mapping);
+    lw_shared_ptr<send_one_file_ctx> ctx_ptr = resume
+            ? make_lw_shared<send_one_file_ctx>(fname, _last_schema_ver_to_column_mapping)
+            : make_lw_shared<send_one_file_ctx>(fname);
+    auto start_pos = resume ? _last_not_complete_rp.pos : 0;
 
     try {
-        commitlog::read_log_file(fname, manager::FILENAME_PREFIX, service::get_local_streaming_priority(), [this, secs_since_file_mod, &fname, ctx_ptr] (commitlog::buffer_and_replay_position buf_rp) mutable {
+        commitlog::read_log_file(fname, manager::FILENAME_PREFIX, service::get_local_streaming_priority(), [this, secs_since_file_mod, ctx_ptr] (commitlog::buffer_and_replay_position buf_rp) mutable {
             auto&& [buf, rp] = buf_rp;
             // Check that we can still send the next hint. Don't try to send it if the destination host
             // is DOWN or if we have already failed to send some of the previous hints.
@@ -771,10 +792,10 @@ bool manager::end_point_hints_manager::sender::send_one_file(const sstring& fnam
                 return make_ready_future<>();
             }
 
-            return flush_maybe().finally([this, ctx_ptr, buf = std::move(buf), rp, secs_since_file_mod, &fname] () mutable {
-                return send_one_hint(std::move(ctx_ptr), std::move(buf), rp, secs_since_file_mod, fname);
+            return flush_maybe().finally([this, ctx_ptr, buf = std::move(buf), rp, secs_since_file_mod] () mutable {
+                return send_one_hint(std::move(ctx_ptr), std::move(buf), rp, secs_since_file_mod);
             });
-        }, _last_not_complete_rp.pos, &_db.extensions()).get();
+        }, start_pos, &_db.extensions()).get();
     } catch (db::commitlog::segment_error& ex) {
         manager_logger.error("{}: {}. Dropping...", fname, ex.what());
         ctx_ptr->segment_replay_failed = false;
@@ -784,12 +805,19 @@ bool manager::end_point_hints_manager::sender::send_one_file(const sstring& fnam
         ctx_ptr->segment_replay_failed = true;
     }
 
+    return ctx_ptr;
+}
+
+// runs in a seastar::async context
+bool manager::end_point_hints_manager::sender::finish_sending_one_file(lw_shared_ptr<send_one_file_ctx> ctx_ptr, bool resumed) {
+    const sstring& fname = ctx_ptr->fname;
+
     // wait till all background hints sending is complete
     ctx_ptr->file_send_gate.close().get();
 
     // If we are draining ignore failures and drop the segment even if we failed to send it.
     if (draining() && ctx_ptr->segment_replay_failed) {
-        manager_logger.trace("send_one_file(): we are draining so we are going to delete the segment anyway");
+        manager_logger.trace("finish_sending_one_file(): we are draining so we are going to delete the segment anyway");
         ctx_ptr->segment_replay_failed = false;
     }
 
@@ -798,8 +826,13 @@ bool manager::end_point_hints_manager::sender::send_one_file(const sstring& fnam
         // If some hints failed to be sent, first_failed_rp will tell the position of first such hint.
         // If there was an error thrown by read_log_file function itself, we will retry sending from
         // the last entry that was successfully read from commitlog (last_attempted_rp).
-        _last_not_complete_rp = ctx_ptr->first_failed_rp.value_or(ctx_ptr->last_attempted_rp.value_or(_last_not_complete_rp));
-        manager_logger.trace("send_one_file(): error while sending hints from {}, last RP is {}", fname, _last_not_complete_rp);
+        auto start_rp = resumed ? _last_not_complete_rp : replay_position();
+        _last_not_complete_rp = ctx_ptr->first_failed_rp.value_or(ctx_ptr->last_attempted_rp.value_or(start_rp));
+        if (!resumed) {
+            // This segment is going to be resumed in the next iteration, so remember the column mappings seen so far.
+            _last_schema_ver_to_column_mapping = std::move(ctx_ptr->own_schema_ver_to_column_mapping);
+        }
+        manager_logger.trace("finish_sending_one_file(): error while sending hints from {}, last RP is {}", fname, _last_not_complete_rp);
         return false;
     }
 
@@ -812,7 +845,7 @@ bool manager::end_point_hints_manager::sender::send_one_file(const sstring& fnam
     // clear the replay position - we are going to send the next segment...
     _last_not_complete_rp = replay_position();
     _last_schema_ver_to_column_mapping.clear();
-    manager_logger.trace("send_one_file(): segment {} was sent in full and deleted", fname);
+    manager_logger.trace("finish_sending_one_file(): segment {} was sent in full and deleted", fname);
     return true;
 }
 
@@ -821,17 +854,31 @@ void manager::end_point_hints_manager::sender::send_hints_maybe() noexcept {
     using namespace std::literals::chrono_literals;
     manager_logger.trace("send_hints(): going to send hints to {}, we have {} segment to replay", end_point_key(), _segments_to_replay.size());
 
-    int replayed_segments_count = 0;
+    struct segment_replayer {
+        using context_ptr = lw_shared_ptr<send_one_file_ctx>;
+        sender& s;
 
-    try {
-        while (replay_allowed() && have_segments()) {
-            if (!send_one_file(*_segments_to_replay.begin())) {
-                break;
-            }
-            _segments_to_replay.pop_front();
-            ++replayed_segments_count;
+        bool replay_allowed() {
+            return s.replay_allowed();
+        }
+        context_ptr start(const sstring& fname, bool resume) {
+            return s.start_sending_one_file(fname, resume);
         }
+        bool should_stop_reading(const context_ptr& ctx_ptr) {
+            // No point in reading further segments unless we are draining, in which case failures are ignored.
+            return ctx_ptr->segment_replay_failed && !s.draining();
+        }
+        bool finish(context_ptr ctx_ptr, bool resumed) {
+            return s.finish_sending_one_file(std::move(ctx_ptr), resumed);
+        }
+        void abandon(context_ptr ctx_ptr) {
+            ctx_ptr->file_send_gate.close().get();
+        }
+    } replayer{*this};
 
+    size_t replayed_segments_count = 0;
+    try {
+        replayed_segments_count = replay_segments_in_order(_segments_to_replay, max_segments_in_flight, replayer);
     // Ignore exceptions, we will retry sending this file from where we left off the next time.
     // Exceptions are not expected here during the regular operation, so just log them.
     } catch (...) {
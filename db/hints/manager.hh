@@ -40,6 +40,7 @@
 #include "utils/loading_shared_values.hh"
 #include "utils/fragmented_temporary_buffer.hh"
 #include "db/hints/resource_manager.hh"
+#include "db/hints/send_window.hh"
 
 namespace service {
 class storage_service;
@@ -97,9 +98,19 @@ class manager : public service::endpoint_lifecycle_subscriber {
                 state::draining>>;
 
             struct send_one_file_ctx {
-                send_one_file_ctx(std::unordered_map<table_schema_version, column_mapping>& last_schema_ver_to_column_mapping)
-                    : schema_ver_to_column_mapping(last_schema_ver_to_column_mapping)
+                send_one_file_ctx(sstring fname, std::unordered_map<table_schema_version, column_mapping>& last_schema_ver_to_column_mapping)
+                    : fname(std::move(fname))
+                    , schema_ver_to_column_mapping(last_schema_ver_to_column_mapping)
                 {}
+                explicit send_one_file_ctx(sstring fname)
+                    : fname(std::move(fname))
+                    , schema_ver_to_column_mapping(own_schema_ver_to_column_mapping)
+                {}
+                const sstring fname;
+                // Column mappings are only written once per segment, so segments replayed in parallel
+                // need their own mappings. Only the first segment in the replay queue, which may be
+                // resumed from the middle, uses the mappings remembered by the sender.
+                std::unordered_map<table_schema_version, column_mapping> own_schema_ver_to_column_mapping;
                 std::unordered_map<table_schema_version, column_mapping>& schema_ver_to_column_mapping;
                 seastar::gate file_send_gate;
                 std::optional<db::replay_position> first_failed_rp;
@@ -109,9 +120,14 @@ class manager : public service::endpoint_lifecycle_subscriber {
                 void on_hint_send_failure(db::replay_position rp) noexcept;
             };
 
+            // The number of segments read while hints from the previous ones are still in flight.
+            static constexpr size_t max_segments_in_flight = 4;
+
         private:
             std::list<sstring> _segments_to_replay;
             replay_position _last_not_complete_rp;
+            // Hints to a single end point are sent with an adaptive concurrency (see send_window).
+            send_window _send_window{resource_manager::max_hints_send_queue_length};
             std::unordered_map<table_schema_version, column_mapping> _last_schema_ver_to_column_mapping;
             state_set _state;
             future<> _stopped;
@@ -198,17 +214,34 @@ class manager : public service::endpoint_lifecycle_subscriber {
             /// \param buf buffer representing the hint
             /// \param rp replay position of this hint in the file (see commitlog for more details on "replay position")
             /// \param secs_since_file_mod last modification time stamp (in seconds since Epoch) of the current hints file
-            /// \param fname name of the hints file this hint was read from
             /// \return future that resolves when next hint may be sent
-            future<> send_one_hint(lw_shared_ptr<send_one_file_ctx> ctx_ptr, fragmented_temporary_buffer buf, db::replay_position rp, gc_clock::duration secs_since_file_mod, const sstring& fname);
+            future<> send_one_hint(lw_shared_ptr<send_one_file_ctx> ctx_ptr, fragmented_temporary_buffer buf, db::replay_position rp, gc_clock::duration secs_since_file_mod);
+
+            /// \brief Adjust the send window according to the outcome of a single hint send.
+            ///
+            /// \param success TRUE if the hint was sent successfully
+            /// \param latency time it took to send the hint
+            void on_hint_send_complete(bool success, clock::duration latency) noexcept;
 
-            /// \brief Send all hint from a single file and delete it after it has been successfully sent.
-            /// Send all hints from the given file. If we failed to send the current segment we will pick up in the next
-            /// iteration from where we left in this one.
+            /// \brief Read all hints from a single file and start sending them.
+            ///
+            /// Returns once the whole file has been read, while its hints may still be in flight. The sending is completed
+            /// by finish_sending_one_file(), which allows reading the next segments while hints of the previous ones are
+            /// still being sent.
             ///
             /// \param fname file to send
+            /// \param resume TRUE if the file is the first one in the replay queue and should be resumed from where we left
+            ///               it in the previous iteration
+            /// \return the file sending context
+            lw_shared_ptr<send_one_file_ctx> start_sending_one_file(const sstring& fname, bool resume);
+
+            /// \brief Wait for all hints of a file to be sent and delete it after it has been successfully sent.
+            /// If we failed to send the current segment we will pick up in the next iteration from where we left in this one.
+            ///
+            /// \param ctx_ptr the context returned by start_sending_one_file()
+            /// \param resumed TRUE if the file was started with resume == TRUE
             /// \return TRUE if file has been successfully sent
-            bool send_one_file(const sstring& fname);
+            bool finish_sending_one_file(lw_shared_ptr<send_one_file_ctx> ctx_ptr, bool resumed);
 
             /// \brief Checks if we can still send hints.
             /// \return TRUE if the destination Node is either ALIVE or has left the NORMAL state (e.g. has been decommissioned).
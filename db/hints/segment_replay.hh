@@ -0,0 +1,110 @@
+/*
+ * Copyright (C) 2020 ScyllaDB
+ */
+
+/*
+ * This file is part of Scylla.
+ *
+ * Scylla is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Affero General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Scylla is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Scylla.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#pragma once
+
+#include <concepts>
+#include <deque>
+#include <list>
+#include <seastar/core/sstring.hh>
+#include "seastarx.hh"
+
+namespace db {
+namespace hints {
+
+template <typename Replayer>
+concept SegmentReplayer = requires (Replayer r, const sstring& segment, typename Replayer::context_ptr ctx, bool resume) {
+    { r.replay_allowed() } -> std::same_as<bool>;
+    { r.start(segment, resume) } -> std::same_as<typename Replayer::context_ptr>;
+    { r.should_stop_reading(ctx) } -> std::same_as<bool>;
+    { r.finish(std::move(ctx), resume) } -> std::same_as<bool>;
+    { r.abandon(std::move(ctx)) } -> std::same_as<void>;
+};
+
+/// \brief Replays the segments of the queue, reading up to max_in_flight of them while the hints of the previous
+/// ones are still in flight.
+///
+/// Segments are completed in order, and the ones replayed in full are removed from the front of the queue, so that
+/// a failure leaves the failed segment at the front, to be resumed from where it was left. The segments following a
+/// failed one are abandoned, and are going to be replayed from their beginning.
+///
+/// The replayer provides the steps of a single segment replay:
+///  - start(segment, resume) reads the segment and starts sending its hints; resume is TRUE for the segment at the
+///    front of the queue, which may have been partially replayed before;
+///  - should_stop_reading(ctx) tells if reading the following segments is pointless;
+///  - finish(ctx, resumed) waits for the hints of the segment and returns TRUE if it was replayed in full;
+///  - abandon(ctx) waits for the hints of a segment which is going to be replayed again.
+///
+/// Must be called in a seastar thread.
+///
+/// \return the number of segments replayed in full
+template <typename Replayer>
+requires SegmentReplayer<Replayer>
+size_t replay_segments_in_order(std::list<sstring>& segments, size_t max_in_flight, Replayer& replayer) {
+    using context_ptr = typename Replayer::context_ptr;
+
+    size_t replayed = 0;
+    // Segments that have been read in full but whose hints may still be in flight, in replay order.
+    std::deque<context_ptr> in_flight;
+    auto next_segment = segments.begin();
+    bool failed = false;
+
+    auto finish_oldest = [&] {
+        auto ctx = std::move(in_flight.front());
+        in_flight.pop_front();
+        if (failed) {
+            replayer.abandon(std::move(ctx));
+            return;
+        }
+        if (!replayer.finish(std::move(ctx), replayed == 0)) {
+            failed = true;
+            return;
+        }
+        segments.pop_front();
+        ++replayed;
+    };
+
+    try {
+        while (!failed && replayer.replay_allowed() && next_segment != segments.end()) {
+            bool resume = in_flight.empty() && replayed == 0;
+            in_flight.push_back(replayer.start(*next_segment++, resume));
+            if (replayer.should_stop_reading(in_flight.back())) {
+                // Wait for what's in flight and retry later.
+                break;
+            }
+            if (in_flight.size() >= max_in_flight) {
+                finish_oldest();
+            }
+        }
+        while (!in_flight.empty()) {
+            finish_oldest();
+        }
+    } catch (...) {
+        for (auto& ctx : in_flight) {
+            replayer.abandon(std::move(ctx));
+        }
+        throw;
+    }
+    return replayed;
+}
+
+}
+}
@@ -0,0 +1,57 @@
+/*
+ * Copyright (C) 2020 ScyllaDB
+ */
+
+/*
+ * This file is part of Scylla.
+ *
+ * Scylla is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Affero General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Scylla is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Scylla.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <algorithm>
+#include "db/hints/send_window.hh"
+
+namespace db {
+namespace hints {
+
+send_window::send_window(size_t max_size)
+    : _max_size(std::max(max_size, initial_size))
+{}
+
+bool send_window::on_send_complete(bool success, clock::duration latency, clock::time_point now) noexcept {
+    if (success && latency <= latency_target) {
+        if (_size < _max_size && ++_successes >= _size) {
+            _successes = 0;
+            ++_size;
+            _sem.signal(1);
+            return true;
+        }
+        return false;
+    }
+
+    // Hints that were sent before the previous decrease still carry the old window, don't react to them twice.
+    if (now - _last_decrease_tp < latency_target) {
+        return false;
+    }
+    _last_decrease_tp = now;
+    _successes = 0;
+    auto new_size = std::max(min_size, _size / 2);
+    _sem.consume(_size - new_size);
+    bool changed = new_size != _size;
+    _size = new_size;
+    return changed;
+}
+
+}
+}
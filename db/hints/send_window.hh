@@ -0,0 +1,81 @@
+/*
+ * Copyright (C) 2020 ScyllaDB
+ */
+
+/*
+ * This file is part of Scylla.
+ *
+ * Scylla is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Affero General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Scylla is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Scylla.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#pragma once
+
+#include <chrono>
+#include <cstddef>
+#include <seastar/core/lowres_clock.hh>
+#include <seastar/core/semaphore.hh>
+#include "seastarx.hh"
+
+namespace db {
+namespace hints {
+
+/// \brief Adaptive limit of the number of hints in flight to a single end point.
+///
+/// The window grows by one hint per window of hints sent within latency_target (additive increase), and is
+/// halved when a hint fails to be sent or is sent too slowly (multiplicative decrease). It is decreased at most
+/// once per latency_target, since the hints sent before a decrease still reflect the old window.
+class send_window {
+public:
+    using clock = seastar::lowres_clock;
+
+    static constexpr size_t min_size = 4;
+    static constexpr size_t initial_size = 16;
+    static constexpr std::chrono::milliseconds latency_target = std::chrono::milliseconds(200);
+
+private:
+    const size_t _max_size;
+    size_t _size = initial_size;
+    size_t _successes = 0;
+    seastar::semaphore _sem{initial_size};
+    clock::time_point _last_decrease_tp;
+
+public:
+    explicit send_window(size_t max_size);
+
+    /// \brief Waits for a free slot in the window for a single hint.
+    future<semaphore_units<>> get_units() {
+        return seastar::get_units(_sem, 1);
+    }
+
+    /// \brief Adjusts the window according to the outcome of a single hint send.
+    ///
+    /// \param success TRUE if the hint was sent successfully
+    /// \param latency time it took to send the hint
+    /// \param now the current time
+    /// \return TRUE if the size of the window changed
+    bool on_send_complete(bool success, clock::duration latency, clock::time_point now) noexcept;
+
+    size_t size() const noexcept {
+        return _size;
+    }
+
+    /// \brief The number of hints that may be sent without waiting, negative if the window was decreased below
+    /// the number of hints in flight.
+    ssize_t available() const noexcept {
+        return _sem.available_units();
+    }
+};
+
+}
+}
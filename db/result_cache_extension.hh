@@ -0,0 +1,76 @@
+/*
+ * Copyright 2020 ScyllaDB
+ */
+/*
+ * This file is part of Scylla.
+ *
+ * Scylla is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Affero General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Scylla is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU Affero General Public License
+ * along with Scylla.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#pragma once
+
+#pragma once
+
+#include "serializer.hh"
+#include "schema.hh"
+
+extern logging::logger dblog;
+
+namespace db {
+
+/**
+ * \brief Schema extension which represents `result_cache_ttl_in_ms` per-table option.
+ *
+ * A positive value opts the table into the coordinator result cache (see
+ * cql3::result_cache), and bounds how long a cached result may be served.
+ * Writes applied on the node invalidate the cached results of the written
+ * partitions immediately, but writes which never reach this node (e.g. to
+ * partitions it isn't a replica of) are only observed once the TTL expires.
+ */
+class result_cache_extension : public schema_extension {
+    int32_t _ttl_ms;
+public:
+    static constexpr auto NAME = "result_cache_ttl_in_ms";
+
+    result_cache_extension() = default;
+
+    explicit result_cache_extension(int32_t ttl_ms)
+        : _ttl_ms(ttl_ms)
+    {}
+
+    explicit result_cache_extension(const std::map<sstring, sstring>& map) {
+        on_internal_error(dblog, "Cannot create result_cache_extension from map");
+    }
+
+    explicit result_cache_extension(bytes b) : _ttl_ms(deserialize(b))
+    {}
+
+    explicit result_cache_extension(const sstring& s)
+        : _ttl_ms(std::stoi(s))
+    {}
+
+    bytes serialize() const override {
+        return ser::serialize_to_buffer<bytes>(_ttl_ms);
+    }
+
+    static int32_t deserialize(const bytes_view& buffer) {
+        return ser::deserialize_from_buffer(buffer, boost::type<int32_t>());
+    }
+
+    int32_t get_ttl_ms() const {
+        return _ttl_ms;
+    }
+};
+
+} // namespace db
@@ -0,0 +1,290 @@
+/*
+ * Copyright (C) 2020 ScyllaDB
+ */
+
+/*
+ * This file is part of Scylla.
+ *
+ * Scylla is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Affero General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Scylla is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU Affero General Public License
+ * along with Scylla.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <seastar/core/fstream.hh>
+#include <seastar/core/metrics.hh>
+#include <seastar/core/seastar.hh>
+#include <seastar/core/sleep.hh>
+#include <seastar/core/thread.hh>
+
+#include <charconv>
+
+#include "db/row_cache_saver.hh"
+#include "database.hh"
+#include "lister.hh"
+#include "locator/abstract_replication_strategy.hh"
+#include "log.hh"
+#include "serializer.hh"
+#include "serializer_impl.hh"
+#include "service/priority_manager.hh"
+#include "utils/disk-error-handler.hh"
+
+static logging::logger rcslogger("row_cache_saver");
+
+namespace db {
+
+// Bounds the part of a wide partition which is read into the cache on warm-up.
+static constexpr size_t max_warmup_fragments_per_partition = 1000;
+
+row_cache_saver::row_cache_saver(database& db, config cfg)
+        : _db(db)
+        , _cfg(std::move(cfg)) {
+    setup_metrics();
+}
+
+void row_cache_saver::setup_metrics() {
+    namespace sm = seastar::metrics;
+    _metrics.add_group("cache", {
+        sm::make_gauge("warmup_partitions_pending", sm::description("number of saved partitions which are yet to be read into the cache on startup"), _stats.warmup_partitions_pending),
+        sm::make_derive("warmup_partitions_loaded", sm::description("number of saved partitions read into the cache on startup"), _stats.warmup_partitions_loaded),
+        sm::make_gauge("saved_partitions", sm::description("number of partition keys saved by the last save of the cache"), _stats.saved_partitions),
+    });
+}
+
+std::vector<lw_shared_ptr<table>> row_cache_saver::tables_to_save() const {
+    std::vector<lw_shared_ptr<table>> tables;
+    for (auto& [id, t] : _db.get_column_families()) {
+        // Tables of local keyspaces are small, and read only by the node itself.
+        auto& ks = _db.find_keyspace(t->schema()->ks_name());
+        if (ks.get_replication_strategy().get_type() != locator::replication_strategy_type::local && t->cache_enabled()) {
+            tables.push_back(t);
+        }
+    }
+    return tables;
+}
+
+sstring row_cache_saver::file_prefix(const schema& s) const {
+    return format("{}-{}-{}-", s.ks_name(), s.cf_name(), s.id());
+}
+
+static future<std::vector<bytes>> read_keys(sstring path) {
+    return with_file(open_checked_file_dma(general_disk_error_handler, path, open_flags::ro), [path] (file& f) {
+        return f.size().then([&f, path] (uint64_t size) {
+            return f.dma_read_exactly<char>(0, size).then([path, size] (temporary_buffer<char> buf) {
+                if (buf.size() != size) {
+                    throw std::runtime_error(format("Short read of {}", path));
+                }
+                return ser::deserialize_from_buffer(buf, boost::type<std::vector<bytes>>());
+            });
+        });
+    });
+}
+
+// Must be called in a thread.
+static void write_keys(sstring dir, sstring name, const std::vector<bytes>& keys) {
+    auto buf = ser::serialize_to_buffer<bytes>(keys);
+    auto path = dir + "/" + name;
+    auto tmp_path = path + ".tmp";
+    file f = open_checked_file_dma(general_disk_error_handler, tmp_path, open_flags::wo | open_flags::create | open_flags::truncate).get0();
+    auto out = make_file_output_stream(std::move(f)).get0();
+    std::exception_ptr ex;
+    try {
+        out.write(reinterpret_cast<const char*>(buf.data()), buf.size()).get();
+        out.flush().get();
+    } catch (...) {
+        ex = std::current_exception();
+    }
+    out.close().get();
+    if (ex) {
+        std::rethrow_exception(ex);
+    }
+    // Replace the previous file only once the new one is complete.
+    io_check(rename_file, tmp_path, path).get();
+    io_check(sync_directory, dir).get();
+}
+
+future<> row_cache_saver::start() {
+    if (_cfg.save_period == std::chrono::seconds(0)) {
+        _warmed_up.set_value();
+        return make_ready_future<>();
+    }
+    thread_attributes attr;
+    attr.sched_group = _db.get_streaming_scheduling_group();
+    _started = seastar::async(std::move(attr), [this] {
+        try {
+            warm_up();
+        } catch (...) {
+            rcslogger.warn("Failed to warm up the cache: {}", std::current_exception());
+        }
+        _stats.warmup_partitions_pending = 0;
+        _warmed_up.set_value();
+        while (!_as.abort_requested()) {
+            try {
+                sleep_abortable(_cfg.save_period, _as).get();
+            } catch (seastar::sleep_aborted&) {
+                break;
+            }
+            try {
+                save();
+            } catch (...) {
+                rcslogger.warn("Failed to save the cache: {}", std::current_exception());
+            }
+        }
+    });
+    return make_ready_future<>();
+}
+
+future<> row_cache_saver::stop() {
+    abort();
+    return std::move(_started);
+}
+
+void row_cache_saver::abort() noexcept {
+    if (!_as.abort_requested()) {
+        _as.request_abort();
+    }
+}
+
+void row_cache_saver::warm_up() {
+    std::vector<sstring> files;
+    lister::scan_dir(_cfg.directory, { directory_entry_type::regular }, [&files] (fs::path dir, directory_entry de) {
+        files.push_back(de.name);
+        return make_ready_future<>();
+    }).get();
+
+    std::vector<std::pair<lw_shared_ptr<table>, std::vector<dht::decorated_key>>> tables;
+    for (auto& t : tables_to_save()) {
+        auto s = t->schema();
+        auto prefix = file_prefix(*s);
+        std::vector<dht::decorated_key> keys;
+        for (auto& name : files) {
+            std::string_view n(name);
+            if (!n.starts_with(prefix) || !n.ends_with(".keys")) {
+                continue;
+            }
+            std::vector<bytes> saved;
+            try {
+                saved = read_keys(_cfg.directory + "/" + name).get0();
+            } catch (...) {
+                rcslogger.warn("Failed to read saved cache keys from {}: {}", name, std::current_exception());
+                continue;
+            }
+            for (auto& k : saved) {
+                auto dk = dht::decorate_key(*s, partition_key::from_bytes(k));
+                if (dht::shard_of(*s, dk.token()) == this_shard_id()) {
+                    keys.push_back(std::move(dk));
+                }
+                thread::maybe_yield();
+            }
+        }
+        _stats.warmup_partitions_pending += keys.size();
+        tables.emplace_back(t, std::move(keys));
+    }
+
+    for (auto& [t, keys] : tables) {
+        auto s = t->schema();
+        rcslogger.debug("Reading {} saved partitions of {}.{} into the cache", keys.size(), s->ks_name(), s->cf_name());
+        for (size_t i = 0; i < keys.size(); ++i) {
+            if (_as.abort_requested()) {
+                return;
+            }
+            try {
+                populate(*t, keys[i]);
+            } catch (...) {
+                // The table was dropped most likely.
+                rcslogger.warn("Failed to read saved partitions of {}.{}: {}", s->ks_name(), s->cf_name(), std::current_exception());
+                _stats.warmup_partitions_pending -= keys.size() - i;
+                break;
+            }
+            --_stats.warmup_partitions_pending;
+            ++_stats.warmup_partitions_loaded;
+        }
+    }
+    rcslogger.info("Read {} saved partitions into the cache", _stats.warmup_partitions_loaded);
+}
+
+void row_cache_saver::populate(table& t, const dht::decorated_key& dk) {
+    auto s = t.schema();
+    auto pr = dht::partition_range::make_singular(dk);
+    auto reader = t.make_reader(s, t.streaming_read_concurrency_semaphore().make_permit(), pr, s->full_slice(),
+            service::get_local_streaming_priority());
+    size_t fragments = 0;
+    reader.consume_pausable([&fragments] (mutation_fragment) {
+        return stop_iteration(++fragments == max_warmup_fragments_per_partition);
+    }, db::no_timeout).get();
+}
+
+void row_cache_saver::save() {
+    uint64_t saved = 0;
+    for (auto& t : tables_to_save()) {
+        if (_as.abort_requested()) {
+            return;
+        }
+        auto keys = t->get_row_cache().get_hottest_keys(_cfg.keys_to_save).get0();
+        std::vector<bytes> serialized;
+        serialized.reserve(keys.size());
+        for (auto& dk : keys) {
+            serialized.push_back(to_bytes(dk.key().representation()));
+        }
+        write_keys(_cfg.directory, format("{}{}.keys", file_prefix(*t->schema()), this_shard_id()), serialized);
+        saved += keys.size();
+    }
+    if (this_shard_id() == 0) {
+        remove_stale_files();
+    }
+    _stats.saved_partitions = saved;
+    rcslogger.debug("Saved {} partition keys of the cache", saved);
+}
+
+// Files of the shards which no longer exist, after the number of shards was
+// reduced, or of tables which were dropped, or aren't saved anymore, would be
+// read on each start otherwise.
+void row_cache_saver::remove_stale_files() {
+    std::vector<sstring> prefixes;
+    for (auto& t : tables_to_save()) {
+        prefixes.push_back(file_prefix(*t->schema()));
+    }
+    std::vector<sstring> stale;
+    lister::scan_dir(_cfg.directory, { directory_entry_type::regular }, [&] (fs::path dir, directory_entry de) {
+        std::string_view n(de.name);
+        if (!n.ends_with(".keys")) {
+            return make_ready_future<>();
+        }
+        n.remove_suffix(std::string_view(".keys").size());
+        auto shard_pos = n.rfind('-');
+        if (shard_pos == std::string_view::npos) {
+            return make_ready_future<>();
+        }
+        auto shard_str = n.substr(shard_pos + 1);
+        unsigned shard = 0;
+        auto [end, ec] = std::from_chars(shard_str.data(), shard_str.data() + shard_str.size(), shard);
+        if (ec != std::errc() || end != shard_str.data() + shard_str.size()) {
+            return make_ready_future<>();
+        }
+        auto table_prefix = n.substr(0, shard_pos + 1);
+        auto known = std::any_of(prefixes.begin(), prefixes.end(), [table_prefix] (const sstring& p) {
+            return table_prefix == std::string_view(p);
+        });
+        if (shard >= smp::count || !known) {
+            stale.push_back(de.name);
+        }
+        return make_ready_future<>();
+    }).get();
+    for (auto& name : stale) {
+        rcslogger.debug("Removing stale saved cache keys file {}", name);
+        io_check(remove_file, _cfg.directory + "/" + name).get();
+    }
+    if (!stale.empty()) {
+        io_check(sync_directory, _cfg.directory).get();
+    }
+}
+
+}
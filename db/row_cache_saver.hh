@@ -0,0 +1,108 @@
+/*
+ * Copyright (C) 2020 ScyllaDB
+ */
+
+/*
+ * This file is part of Scylla.
+ *
+ * Scylla is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Affero General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Scylla is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU Affero General Public License
+ * along with Scylla.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#pragma once
+
+#include <chrono>
+#include <vector>
+
+#include <seastar/core/abort_source.hh>
+#include <seastar/core/future.hh>
+#include <seastar/core/metrics_registration.hh>
+#include <seastar/core/shared_future.hh>
+#include <seastar/core/sstring.hh>
+
+#include "database_fwd.hh"
+#include "dht/i_partitioner.hh"
+#include "seastarx.hh"
+
+namespace db {
+
+/// Saves the keys of the most frequently read partitions of the row cache of
+/// each table, periodically, and reads them back into the cache on startup,
+/// so that the cache doesn't have to warm up from scratch after a restart.
+///
+/// Each shard saves the keys of its cache into its own file, in the saved
+/// caches directory, and loads the keys it owns from the files of all shards,
+/// so that the keys survive a change of the number of shards. Files left by
+/// shards which no longer exist, or by dropped tables, are removed on save.
+///
+/// The partitions are read at the priority of streaming, hottest first. The
+/// keys are saved only once the warm-up is done, so that a restart during the
+/// warm-up doesn't lose the keys which weren't loaded yet.
+///
+/// The warm-up reads are cache misses, so the hit rates of the tables are
+/// only meaningful once it's done, see wait_for_warm_up().
+class row_cache_saver {
+public:
+    struct config {
+        sstring directory;
+        // No keys are saved nor loaded if zero.
+        std::chrono::seconds save_period;
+        // Maximum number of keys saved for each table, all if zero.
+        size_t keys_to_save;
+    };
+
+    struct stats {
+        uint64_t warmup_partitions_pending = 0;
+        uint64_t warmup_partitions_loaded = 0;
+        uint64_t saved_partitions = 0;
+    };
+private:
+    database& _db;
+    config _cfg;
+    stats _stats;
+    seastar::abort_source _as;
+    shared_promise<> _warmed_up;
+    future<> _started = make_ready_future<>();
+    seastar::metrics::metric_groups _metrics;
+private:
+    void setup_metrics();
+    std::vector<lw_shared_ptr<table>> tables_to_save() const;
+    sstring file_prefix(const schema&) const;
+    // Must be called in a thread.
+    void warm_up();
+    void populate(table&, const dht::decorated_key&);
+    void save();
+    // Must be called in a thread.
+    void remove_stale_files();
+public:
+    row_cache_saver(database& db, config cfg);
+
+    future<> start();
+    future<> stop();
+
+    // Stops warming up the cache and saving it, without waiting. Lets services
+    // waiting for the warm-up be stopped before this one.
+    void abort() noexcept;
+
+    // Resolves once the saved partitions of this shard are read into the cache,
+    // or the warm-up failed or was aborted.
+    future<> wait_for_warm_up() {
+        return _warmed_up.get_shared_future();
+    }
+
+    const stats& get_stats() const {
+        return _stats;
+    }
+};
+
+}
@@ -229,21 +229,36 @@ collect_all_shared_sstables(sharded<sstables::sstable_directory>& dir) {
 }
 
 // Given a vector of shared sstables to be resharded, distribute it among all shards.
-// The vector is first sorted to make sure that we are moving the biggest SSTables first.
+// SSTables of a resharding group other than 0 (e.g. a level of leveled strategy) are kept
+// together and handed to a single shard, since a group resharded in pieces by several shards
+// would produce overlapping output. The resulting units are sorted to make sure that we are
+// moving the biggest ones first.
 //
 // Returns a reshard_shard_descriptor per shard indicating the work that each shard has to do.
 future<std::vector<reshard_shard_descriptor>>
-distribute_reshard_jobs(sstables::sstable_directory::sstable_info_vector source) {
-    return do_with(std::move(source), std::vector<reshard_shard_descriptor>(smp::count),
-            [] (sstables::sstable_directory::sstable_info_vector& source, std::vector<reshard_shard_descriptor>& destinations) mutable {
-        std::sort(source.begin(), source.end(), [] (const sstables::foreign_sstable_open_info& a, const sstables::foreign_sstable_open_info& b) {
-            // Sort on descending SSTable sizes.
-            return a.uncompressed_data_size > b.uncompressed_data_size;
-        });
-        return do_for_each(source, [&destinations] (sstables::foreign_sstable_open_info& info) mutable {
-            auto shard_it = boost::min_element(destinations, std::mem_fn(&reshard_shard_descriptor::total_size_smaller));
-            shard_it->uncompressed_data_size += info.uncompressed_data_size;
-            shard_it->info_vec.push_back(std::move(info));
+distribute_reshard_jobs(sstables::sstable_directory::sstable_info_vector source, sstables::compaction_strategy cs) {
+    return do_with(std::move(source), std::move(cs), std::unordered_map<uint32_t, reshard_shard_descriptor>(), std::vector<reshard_shard_descriptor>(),
+            std::vector<reshard_shard_descriptor>(smp::count),
+            [] (sstables::sstable_directory::sstable_info_vector& source, sstables::compaction_strategy& cs, std::unordered_map<uint32_t, reshard_shard_descriptor>& groups,
+                    std::vector<reshard_shard_descriptor>& units, std::vector<reshard_shard_descriptor>& destinations) mutable {
+        return do_for_each(source, [&cs, &groups, &units] (sstables::foreign_sstable_open_info& info) mutable {
+            auto group = cs.resharding_group(info);
+            auto& unit = group ? groups[group] : units.emplace_back();
+            unit.uncompressed_data_size += info.uncompressed_data_size;
+            unit.info_vec.push_back(std::move(info));
+        }).then([&groups, &units, &destinations] () mutable {
+            for (auto& unit : groups | boost::adaptors::map_values) {
+                units.push_back(std::move(unit));
+            }
+            std::sort(units.begin(), units.end(), [] (const reshard_shard_descriptor& a, const reshard_shard_descriptor& b) {
+                // Sort on descending sizes.
+                return a.uncompressed_data_size > b.uncompressed_data_size;
+            });
+            return do_for_each(units, [&destinations] (reshard_shard_descriptor& unit) mutable {
+                auto shard_it = boost::min_element(destinations, std::mem_fn(&reshard_shard_descriptor::total_size_smaller));
+                shard_it->uncompressed_data_size += unit.uncompressed_data_size;
+                std::move(unit.info_vec.begin(), unit.info_vec.end(), std::back_inserter(shard_it->info_vec));
+            });
         }).then([&destinations] () mutable {
             return make_ready_future<std::vector<reshard_shard_descriptor>>(std::move(destinations));
         });
@@ -281,13 +296,14 @@ future<> run_resharding_jobs(sharded<sstables::sstable_directory>& dir, std::vec
 
 // Global resharding function. Done in two parts:
 //  - The first part spreads the foreign_sstable_open_info across shards so that all of them are
-//    resharding about the same amount of data
+//    resharding about the same amount of data, keeping each resharding group on a single shard
 //  - The second part calls each shard's distributed object to reshard the SSTables they were
 //    assigned.
 future<>
 distributed_loader::reshard(sharded<sstables::sstable_directory>& dir, sharded<database>& db, sstring ks_name, sstring table_name, sstables::compaction_sstable_creator_fn creator) {
-    return collect_all_shared_sstables(dir).then([] (sstables::sstable_directory::sstable_info_vector all_jobs) mutable {
-        return distribute_reshard_jobs(std::move(all_jobs));
+    return collect_all_shared_sstables(dir).then([&db, ks_name, table_name] (sstables::sstable_directory::sstable_info_vector all_jobs) mutable {
+        auto& table = db.local().find_column_family(ks_name, table_name);
+        return distribute_reshard_jobs(std::move(all_jobs), table.get_compaction_strategy());
     }).then([&dir, &db, ks_name, table_name, creator = std::move(creator)] (std::vector<reshard_shard_descriptor> destinations) mutable {
         return run_resharding_jobs(dir, std::move(destinations), db, ks_name, table_name, std::move(creator));
     });
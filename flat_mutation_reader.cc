@@ -25,7 +25,7 @@
 #include "clustering_ranges_walker.hh"
 #include "schema_upgrader.hh"
 #include <algorithm>
-#include <stack>
+#include <deque>
 
 #include <boost/range/adaptor/transformed.hpp>
 #include <seastar/util/defer.hh>
@@ -49,6 +49,7 @@ void flat_mutation_reader::impl::forward_buffer_to(const position_in_partition&
     }), _buffer.end());
 
     _buffer_size = compute_buffer_size(*_schema, _buffer);
+    _buffered_partition_rows = 0;
 }
 
 void flat_mutation_reader::impl::clear_buffer_to_next_partition() {
@@ -58,143 +59,191 @@ void flat_mutation_reader::impl::clear_buffer_to_next_partition() {
     _buffer.erase(_buffer.begin(), next_partition_start);
 
     _buffer_size = compute_buffer_size(*_schema, _buffer);
+    _buffered_partition_rows = 0;
 }
 
-flat_mutation_reader make_reversing_reader(flat_mutation_reader& original, query::max_result_size max_size) {
-    class partition_reversing_mutation_reader final : public flat_mutation_reader::impl {
-        flat_mutation_reader* _source;
-        range_tombstone_list _range_tombstones;
-        std::stack<mutation_fragment> _mutation_fragments;
-        mutation_fragment_opt _partition_end;
-        size_t _stack_size = 0;
-        const query::max_result_size _max_size;
-        bool _below_soft_limit = true;
-    private:
-        stop_iteration emit_partition() {
-            auto emit_range_tombstone = [&] {
-                auto it = std::prev(_range_tombstones.tombstones().end());
-                auto& rt = *it;
-                _range_tombstones.tombstones().erase(it);
-                auto rt_owner = alloc_strategy_unique_ptr<range_tombstone>(&rt);
-                push_mutation_fragment(mutation_fragment(std::move(rt)));
-            };
-            position_in_partition::less_compare cmp(*_schema);
-            while (!_mutation_fragments.empty() && !is_buffer_full()) {
-                auto& mf = _mutation_fragments.top();
-                if (!_range_tombstones.empty() && !cmp(_range_tombstones.tombstones().rbegin()->end_position(), mf.position())) {
-                    emit_range_tombstone();
-                } else {
-                    _stack_size -= mf.memory_usage(*_schema);
-                    push_mutation_fragment(std::move(mf));
-                    _mutation_fragments.pop();
-                }
-            }
-            while (!_range_tombstones.empty() && !is_buffer_full()) {
+void flat_mutation_reader::impl::limit_partition_readahead(const query::partition_slice& slice, uint64_t row_limit) {
+    // Same limit as the one the mutation_compactor applies to partitions.
+    auto partition_row_limit = slice.options.contains(query::partition_slice::option::distinct) ? 1 : slice.partition_row_limit();
+    max_buffered_partition_rows = std::min(partition_row_limit, row_limit);
+    _partition_rows_readahead = max_buffered_partition_rows;
+}
+
+namespace {
+
+class partition_reversing_mutation_reader final : public flat_mutation_reader::impl {
+    flat_mutation_reader* _source;
+    range_tombstone_list _range_tombstones;
+    // The last clustering rows of the partition, in ascending order.
+    std::deque<mutation_fragment> _rows;
+    mutation_fragment_opt _partition_end;
+    size_t _rows_size = 0;
+    // Memory used by the range tombstones applied to _range_tombstones and not emitted
+    // yet. Only an estimate, as the list merges and splits them.
+    size_t _range_tombstones_size = 0;
+    const query::max_result_size _max_size;
+    bool _below_soft_limit = true;
+    std::optional<partition_key> _key;
+    // Rows before the ones in _rows were dropped to stay below the hard limit.
+    bool _rows_dropped = false;
+private:
+    void emit_range_tombstone() {
+        auto it = std::prev(_range_tombstones.tombstones().end());
+        auto& rt = *it;
+        _range_tombstones.tombstones().erase(it);
+        auto rt_owner = alloc_strategy_unique_ptr<range_tombstone>(&rt);
+        _range_tombstones_size = _range_tombstones.empty() ? 0 : _range_tombstones_size - std::min(_range_tombstones_size, rt.memory_usage(*_schema));
+        push_mutation_fragment(mutation_fragment(std::move(rt)));
+    }
+    stop_iteration emit_partition() {
+        position_in_partition::less_compare cmp(*_schema);
+        while (!_rows.empty() && !is_buffer_full()) {
+            auto& mf = _rows.back();
+            if (!_range_tombstones.empty() && !cmp(_range_tombstones.tombstones().rbegin()->end_position(), mf.position())) {
                 emit_range_tombstone();
+            } else {
+                _rows_size -= mf.memory_usage(*_schema);
+                push_mutation_fragment(std::move(mf));
+                _rows.pop_back();
             }
-            if (is_buffer_full()) {
+        }
+        if (is_buffer_full()) {
+            return stop_iteration::yes;
+        }
+        if (_rows_dropped) {
+            // The consumer wants more than the rows we could keep. Let it
+            // consume what was emitted first, it may not need more.
+            if (!is_buffer_empty()) {
                 return stop_iteration::yes;
             }
-            push_mutation_fragment(std::move(*std::exchange(_partition_end, std::nullopt)));
-            return stop_iteration::no;
+            throw std::runtime_error(fmt::format(
+                    "Memory usage of reversed read exceeds hard limit of {} (configured via max_memory_for_unlimited_query_hard_limit), while reading partition {}",
+                    _max_size.hard_limit,
+                    _key->with_schema(*_schema)));
         }
-        future<stop_iteration> consume_partition_from_source(db::timeout_clock::time_point timeout) {
-            if (_source->is_buffer_empty()) {
-                if (_source->is_end_of_stream()) {
-                    _end_of_stream = true;
-                    return make_ready_future<stop_iteration>(stop_iteration::yes);
-                }
-                return _source->fill_buffer(timeout).then([] { return stop_iteration::no; });
-            }
-            while (!_source->is_buffer_empty() && !is_buffer_full()) {
-                auto mf = _source->pop_mutation_fragment();
-                if (mf.is_partition_start() || mf.is_static_row()) {
-                    push_mutation_fragment(std::move(mf));
-                } else if (mf.is_end_of_partition()) {
-                    _partition_end = std::move(mf);
-                    if (emit_partition()) {
-                        return make_ready_future<stop_iteration>(stop_iteration::yes);
-                    }
-                } else if (mf.is_range_tombstone()) {
-                    _range_tombstones.apply(*_schema, std::move(mf.as_range_tombstone()));
-                } else {
-                    _mutation_fragments.emplace(std::move(mf));
-                    _stack_size += _mutation_fragments.top().memory_usage(*_schema);
-                    if (_stack_size > _max_size.hard_limit || (_stack_size > _max_size.soft_limit && _below_soft_limit)) {
-                        const partition_key* key = nullptr;
-                        auto it = buffer().end();
-                        --it;
-                        if (it->is_partition_start()) {
-                            key = &it->as_partition_start().key().key();
-                        } else {
-                            --it;
-                            key = &it->as_partition_start().key().key();
-                        }
-
-                        if (_stack_size > _max_size.hard_limit) {
-                            throw std::runtime_error(fmt::format(
-                                    "Memory usage of reversed read exceeds hard limit of {} (configured via max_memory_for_unlimited_query_hard_limit), while reading partition {}",
-                                    _max_size.hard_limit,
-                                    key->with_schema(*_schema)));
-                        } else {
-                            fmr_logger.warn(
-                                    "Memory usage of reversed read exceeds soft limit of {} (configured via max_memory_for_unlimited_query_soft_limit), while reading partition {}",
-                                    _max_size.soft_limit,
-                                    key->with_schema(*_schema));
-                            _below_soft_limit = false;
-                        }
-                    }
-                }
+        while (!_range_tombstones.empty() && !is_buffer_full()) {
+            emit_range_tombstone();
+        }
+        if (is_buffer_full()) {
+            return stop_iteration::yes;
+        }
+        push_mutation_fragment(std::move(*std::exchange(_partition_end, std::nullopt)));
+        _key.reset();
+        return stop_iteration::no;
+    }
+    void check_soft_limit() {
+        if (_rows_size + _range_tombstones_size > _max_size.soft_limit && _below_soft_limit) {
+            fmr_logger.warn(
+                    "Memory usage of reversed read exceeds soft limit of {} (configured via max_memory_for_unlimited_query_soft_limit), while reading partition {}",
+                    _max_size.soft_limit,
+                    _key->with_schema(*_schema));
+            _below_soft_limit = false;
+        }
+    }
+    void add_row(mutation_fragment mf) {
+        _rows.emplace_back(std::move(mf));
+        _rows_size += _rows.back().memory_usage(*_schema);
+        // Only the last rows are kept, the read fails if the consumer gets to
+        // the dropped ones.
+        while (_rows_size + _range_tombstones_size > _max_size.hard_limit && _rows.size() > 1) {
+            _rows_size -= _rows.front().memory_usage(*_schema);
+            _rows.pop_front();
+            _rows_dropped = true;
+        }
+        check_soft_limit();
+    }
+    void add_range_tombstone(range_tombstone rt) {
+        _range_tombstones_size += rt.memory_usage(*_schema);
+        _range_tombstones.apply(*_schema, std::move(rt));
+        // Unlike rows, tombstones can't be dropped, as they may cover rows which are
+        // still to be emitted.
+        if (_range_tombstones_size > _max_size.hard_limit) {
+            throw std::runtime_error(fmt::format(
+                    "Memory usage of range tombstones of reversed read exceeds hard limit of {} (configured via max_memory_for_unlimited_query_hard_limit), while reading partition {}",
+                    _max_size.hard_limit,
+                    _key->with_schema(*_schema)));
+        }
+        check_soft_limit();
+    }
+    future<stop_iteration> consume_partition_from_source(db::timeout_clock::time_point timeout) {
+        if (_source->is_buffer_empty()) {
+            if (_source->is_end_of_stream()) {
+                _end_of_stream = true;
+                return make_ready_future<stop_iteration>(stop_iteration::yes);
             }
-            return make_ready_future<stop_iteration>(is_buffer_full());
+            return _source->fill_buffer(timeout).then([] { return stop_iteration::no; });
         }
-    public:
-        explicit partition_reversing_mutation_reader(flat_mutation_reader& mr, query::max_result_size max_size)
-            : flat_mutation_reader::impl(mr.schema())
-            , _source(&mr)
-            , _range_tombstones(*_schema)
-            , _max_size(max_size)
-        { }
-
-        virtual future<> fill_buffer(db::timeout_clock::time_point timeout) override {
-            return repeat([&, timeout] {
-                if (_partition_end) {
-                    // We have consumed full partition from source, now it is
-                    // time to emit it.
-                    auto stop = emit_partition();
-                    if (stop) {
-                        return make_ready_future<stop_iteration>(stop_iteration::yes);
-                    }
+        while (!_source->is_buffer_empty() && !is_buffer_full()) {
+            auto mf = _source->pop_mutation_fragment();
+            if (mf.is_partition_start() || mf.is_static_row()) {
+                if (mf.is_partition_start()) {
+                    _key = mf.as_partition_start().key().key();
                 }
-                return consume_partition_from_source(timeout);
-            });
+                push_mutation_fragment(std::move(mf));
+            } else if (mf.is_end_of_partition()) {
+                _partition_end = std::move(mf);
+                if (emit_partition()) {
+                    return make_ready_future<stop_iteration>(stop_iteration::yes);
+                }
+            } else if (mf.is_range_tombstone()) {
+                add_range_tombstone(std::move(mf.as_range_tombstone()));
+            } else {
+                add_row(std::move(mf));
+            }
         }
+        return make_ready_future<stop_iteration>(is_buffer_full());
+    }
+public:
+    partition_reversing_mutation_reader(flat_mutation_reader& mr, query::max_result_size max_size)
+        : flat_mutation_reader::impl(mr.schema())
+        , _source(&mr)
+        , _range_tombstones(*_schema)
+        , _max_size(max_size)
+    { }
 
-        virtual void next_partition() override {
-            clear_buffer_to_next_partition();
-            if (is_buffer_empty() && !is_end_of_stream()) {
-                while (!_mutation_fragments.empty()) {
-                    _stack_size -= _mutation_fragments.top().memory_usage(*_schema);
-                    _mutation_fragments.pop();
+    virtual future<> fill_buffer(db::timeout_clock::time_point timeout) override {
+        return repeat([&, timeout] {
+            if (_partition_end) {
+                // We have consumed full partition from source, now it is
+                // time to emit it.
+                auto stop = emit_partition();
+                if (stop) {
+                    return make_ready_future<stop_iteration>(stop_iteration::yes);
                 }
-                _range_tombstones.clear();
-                _partition_end = std::nullopt;
-                _source->next_partition();
             }
-        }
+            return consume_partition_from_source(timeout);
+        });
+    }
 
-        virtual future<> fast_forward_to(const dht::partition_range&, db::timeout_clock::time_point) override {
-            return make_exception_future<>(make_backtraced_exception_ptr<std::bad_function_call>());
+    virtual void next_partition() override {
+        clear_buffer_to_next_partition();
+        if (is_buffer_empty() && !is_end_of_stream()) {
+            _rows.clear();
+            _rows_size = 0;
+            _rows_dropped = false;
+            _key.reset();
+            _range_tombstones.clear();
+            _range_tombstones_size = 0;
+            _partition_end = std::nullopt;
+            _source->next_partition();
         }
+    }
 
-        virtual future<> fast_forward_to(position_range, db::timeout_clock::time_point) override {
-            return make_exception_future<>(make_backtraced_exception_ptr<std::bad_function_call>());
-        }
-        virtual size_t buffer_size() const override {
-            return flat_mutation_reader::impl::buffer_size() + _source->buffer_size();
-        }
-    };
+    virtual future<> fast_forward_to(const dht::partition_range&, db::timeout_clock::time_point) override {
+        return make_exception_future<>(make_backtraced_exception_ptr<std::bad_function_call>());
+    }
 
+    virtual future<> fast_forward_to(position_range, db::timeout_clock::time_point) override {
+        return make_exception_future<>(make_backtraced_exception_ptr<std::bad_function_call>());
+    }
+    virtual size_t buffer_size() const override {
+        return flat_mutation_reader::impl::buffer_size() + _source->buffer_size();
+    }
+};
+
+}
+
+flat_mutation_reader make_reversing_reader(flat_mutation_reader& original, query::max_result_size max_size) {
     return make_flat_mutation_reader<partition_reversing_mutation_reader>(original, max_size);
 }
 
@@ -83,8 +83,13 @@ class flat_mutation_reader final {
         circular_buffer<mutation_fragment> _buffer;
         size_t _buffer_size = 0;
         bool _consume_done = false;
+        // Clustering rows of the current partition pushed since the buffer was last
+        // empty, and how many of them fill the buffer, see limit_partition_readahead().
+        uint64_t _buffered_partition_rows = 0;
+        uint64_t _partition_rows_readahead = std::numeric_limits<uint64_t>::max();
     protected:
         size_t max_buffer_size_in_bytes = 8 * 1024;
+        uint64_t max_buffered_partition_rows = std::numeric_limits<uint64_t>::max();
         bool _end_of_stream = false;
         schema_ptr _schema;
         friend class flat_mutation_reader;
@@ -93,11 +98,28 @@ class flat_mutation_reader final {
         void push_mutation_fragment(Args&&... args) {
             seastar::memory::on_alloc_point(); // for exception safety tests
             _buffer.emplace_back(std::forward<Args>(args)...);
-            _buffer_size += _buffer.back().memory_usage(*_schema);
+            auto& mf = _buffer.back();
+            _buffer_size += mf.memory_usage(*_schema);
+            if (mf.is_clustering_row()) {
+                ++_buffered_partition_rows;
+            } else if (mf.is_partition_start()) {
+                _buffered_partition_rows = 0;
+                _partition_rows_readahead = max_buffered_partition_rows;
+            }
         }
         void clear_buffer() {
             _buffer.erase(_buffer.begin(), _buffer.end());
             _buffer_size = 0;
+            _buffered_partition_rows = 0;
+        }
+        // Called when the consumer took all of the buffer. If it holds rows of a partition
+        // the consumer didn't leave, twice as many of them are read ahead the next time.
+        void on_buffer_drained() {
+            if (_buffered_partition_rows) {
+                _buffered_partition_rows = 0;
+                _partition_rows_readahead = _partition_rows_readahead > std::numeric_limits<uint64_t>::max() / 2
+                        ? std::numeric_limits<uint64_t>::max() : _partition_rows_readahead * 2;
+            }
         }
         void forward_buffer_to(const position_in_partition& pos);
         void clear_buffer_to_next_partition();
@@ -120,12 +142,28 @@ class flat_mutation_reader final {
 
         bool is_end_of_stream() const { return _end_of_stream; }
         bool is_buffer_empty() const { return _buffer.empty(); }
-        bool is_buffer_full() const { return _buffer_size >= max_buffer_size_in_bytes; }
+        bool is_buffer_full() const {
+            return _buffer_size >= max_buffer_size_in_bytes
+                    || (_buffered_partition_rows >= _partition_rows_readahead && !_buffer.empty());
+        }
+
+        // Stops reading ahead the rows of a partition once the buffer holds as many rows
+        // as the slice can return from it, so that a consumer which is done with the
+        // partition at that point can skip to the next one without the rest being read.
+        // Rows may be dead, so each time the buffer is drained without the consumer
+        // leaving the partition, twice as many rows are read ahead.
+        // row_limit is the number of rows the consumer can take in total, which bounds
+        // how many rows a single partition can return as well.
+        void limit_partition_readahead(const query::partition_slice& slice,
+                uint64_t row_limit = std::numeric_limits<uint64_t>::max());
 
         mutation_fragment pop_mutation_fragment() {
             auto mf = std::move(_buffer.front());
             _buffer.pop_front();
             _buffer_size -= mf.memory_usage(*_schema);
+            if (_buffer.empty()) {
+                on_buffer_drained();
+            }
             return mf;
         }
 
@@ -287,10 +325,12 @@ class flat_mutation_reader final {
 
         circular_buffer<mutation_fragment> detach_buffer() {
             _buffer_size = 0;
+            on_buffer_drained();
             return std::exchange(_buffer, {});
         }
 
         void move_buffer_content_to(impl& other) {
+            on_buffer_drained();
             if (other._buffer.empty()) {
                 std::swap(_buffer, other._buffer);
                 other._buffer_size = std::exchange(_buffer_size, 0);
@@ -446,6 +486,9 @@ class flat_mutation_reader final {
     void set_max_buffer_size(size_t size) {
         _impl->max_buffer_size_in_bytes = size;
     }
+    void limit_partition_readahead(const query::partition_slice& slice, uint64_t row_limit = std::numeric_limits<uint64_t>::max()) {
+        _impl->limit_partition_readahead(slice, row_limit);
+    }
     // Resolves with a pointer to the next fragment in the stream without consuming it from the stream,
     // or nullptr if there are no more fragments.
     // The returned pointer is invalidated by any other non-const call to this object.
@@ -723,11 +766,13 @@ make_generating_reader(schema_ptr s, std::function<future<mutation_fragment_opt>
 ///     reversing reader is in use.
 /// \param max_size the maximum amount of memory the reader is allowed to use
 ///     for reversing and conversely the maximum size of the results. The
-///     reverse reader reads entire partitions into memory, before reversing
-///     them. Since partitions can be larger than the available memory, we need
-///     to enforce a limit on memory consumption. When reaching the soft limit
-///     a warning will be logged. When reaching the hard limit the read will be
-///     aborted.
+///     reverse reader reads entire partitions before reversing them. Since
+///     partitions can be larger than the available memory, it only keeps the
+///     last rows of a partition, up to the hard limit. When reaching the soft
+///     limit a warning will be logged. When the consumer gets past the rows
+///     kept, the read will be aborted. Range tombstones can't be dropped, so
+///     they are all kept until the end of the partition, and count against
+///     the limits too. The read is aborted if they alone reach the hard limit.
 ///
 /// FIXME: reversing should be done in the sstable layer, see #1413.
 flat_mutation_reader
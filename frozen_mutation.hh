@@ -128,3 +128,8 @@ class frozen_mutation_fragment {
 
 frozen_mutation_fragment freeze(const schema& s, const mutation_fragment& mf);
 
+// Packs several frozen fragments into one, so that they can be sent as a single
+// frame. The result can only be unpacked with unpack_frozen_mutation_fragments().
+frozen_mutation_fragment pack_frozen_mutation_fragments(const std::vector<frozen_mutation_fragment>& fragments);
+std::vector<frozen_mutation_fragment> unpack_frozen_mutation_fragments(const frozen_mutation_fragment& batch);
+
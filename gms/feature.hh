@@ -142,6 +142,12 @@ extern const std::string_view HINTED_HANDOFF_SEPARATE_CONNECTION;
 extern const std::string_view LWT;
 extern const std::string_view PER_TABLE_PARTITIONERS;
 extern const std::string_view PER_TABLE_CACHING;
+extern const std::string_view STREAM_SSTABLE_FILES;
+extern const std::string_view STREAM_FRAGMENT_BATCHES;
+extern const std::string_view REPLICA_FILTERING;
+extern const std::string_view REPLICA_GROUPING;
+extern const std::string_view READ_CANCEL;
+extern const std::string_view FILTERED_CACHE_ADMISSION;
 
 }
 
@@ -57,6 +57,12 @@ constexpr std::string_view features::HINTED_HANDOFF_SEPARATE_CONNECTION = "HINTE
 constexpr std::string_view features::LWT = "LWT";
 constexpr std::string_view features::PER_TABLE_PARTITIONERS = "PER_TABLE_PARTITIONERS";
 constexpr std::string_view features::PER_TABLE_CACHING = "PER_TABLE_CACHING";
+constexpr std::string_view features::STREAM_SSTABLE_FILES = "STREAM_SSTABLE_FILES";
+constexpr std::string_view features::STREAM_FRAGMENT_BATCHES = "STREAM_FRAGMENT_BATCHES";
+constexpr std::string_view features::REPLICA_FILTERING = "REPLICA_FILTERING";
+constexpr std::string_view features::REPLICA_GROUPING = "REPLICA_GROUPING";
+constexpr std::string_view features::READ_CANCEL = "READ_CANCEL";
+constexpr std::string_view features::FILTERED_CACHE_ADMISSION = "FILTERED_CACHE_ADMISSION";
 
 static logging::logger logger("features");
 
@@ -92,7 +98,13 @@ feature_service::feature_service(feature_config cfg) : _config(cfg)
         , _hinted_handoff_separate_connection(*this, features::HINTED_HANDOFF_SEPARATE_CONNECTION)
         , _lwt_feature(*this, features::LWT)
         , _per_table_partitioners_feature(*this, features::PER_TABLE_PARTITIONERS)
-        , _per_table_caching_feature(*this, features::PER_TABLE_CACHING) {
+        , _per_table_caching_feature(*this, features::PER_TABLE_CACHING)
+        , _stream_sstable_files_feature(*this, features::STREAM_SSTABLE_FILES)
+        , _stream_fragment_batches_feature(*this, features::STREAM_FRAGMENT_BATCHES)
+        , _replica_filtering_feature(*this, features::REPLICA_FILTERING)
+        , _replica_grouping_feature(*this, features::REPLICA_GROUPING)
+        , _read_cancel_feature(*this, features::READ_CANCEL)
+        , _filtered_cache_admission_feature(*this, features::FILTERED_CACHE_ADMISSION) {
 }
 
 feature_config feature_config_from_db_config(db::config& cfg, std::set<sstring> disabled) {
@@ -190,6 +202,12 @@ std::set<std::string_view> feature_service::known_feature_set() {
         gms::features::MD_SSTABLE,
         gms::features::UDF,
         gms::features::CDC,
+        gms::features::STREAM_SSTABLE_FILES,
+        gms::features::STREAM_FRAGMENT_BATCHES,
+        gms::features::REPLICA_FILTERING,
+        gms::features::REPLICA_GROUPING,
+        gms::features::READ_CANCEL,
+        gms::features::FILTERED_CACHE_ADMISSION,
     };
 
     for (const sstring& s : _config._disabled_features) {
@@ -281,6 +299,12 @@ void feature_service::enable(const std::set<std::string_view>& list) {
         std::ref(_lwt_feature),
         std::ref(_per_table_partitioners_feature),
         std::ref(_per_table_caching_feature),
+        std::ref(_stream_sstable_files_feature),
+        std::ref(_stream_fragment_batches_feature),
+        std::ref(_replica_filtering_feature),
+        std::ref(_replica_grouping_feature),
+        std::ref(_read_cancel_feature),
+        std::ref(_filtered_cache_admission_feature),
     })
     {
         if (list.contains(f.name())) {
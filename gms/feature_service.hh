@@ -104,6 +104,12 @@ class feature_service final {
     gms::feature _lwt_feature;
     gms::feature _per_table_partitioners_feature;
     gms::feature _per_table_caching_feature;
+    gms::feature _stream_sstable_files_feature;
+    gms::feature _stream_fragment_batches_feature;
+    gms::feature _replica_filtering_feature;
+    gms::feature _replica_grouping_feature;
+    gms::feature _read_cancel_feature;
+    gms::feature _filtered_cache_admission_feature;
 
 public:
     bool cluster_supports_range_tombstones() const {
@@ -220,6 +226,30 @@ class feature_service final {
     bool cluster_supports_lwt() const {
         return bool(_lwt_feature);
     }
+
+    bool cluster_supports_stream_sstable_files() const {
+        return bool(_stream_sstable_files_feature);
+    }
+
+    bool cluster_supports_stream_fragment_batches() const {
+        return bool(_stream_fragment_batches_feature);
+    }
+
+    bool cluster_supports_replica_filtering() const {
+        return bool(_replica_filtering_feature);
+    }
+
+    bool cluster_supports_replica_grouping() const {
+        return bool(_replica_grouping_feature);
+    }
+
+    bool cluster_supports_read_cancel() const {
+        return bool(_read_cancel_feature);
+    }
+
+    bool cluster_supports_filtered_cache_admission() const {
+        return bool(_filtered_cache_admission_feature);
+    }
 };
 
 } // namespace gms
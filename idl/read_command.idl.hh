@@ -30,6 +30,30 @@ class specific_ranges {
     std::vector<nonwrapping_range<clustering_key_prefix>> ranges();
 };
 
+struct column_filter {
+    uint32_t id;
+    std::optional<std::vector<bytes>> values;
+    nonwrapping_range<bytes> range;
+};
+
+enum class group_aggregate_kind : uint8_t {
+    count_rows,
+    count,
+    min,
+    max,
+    sum,
+};
+
+struct group_aggregate {
+    query::group_aggregate_kind kind;
+    uint32_t id;
+};
+
+struct group_by_spec {
+    uint32_t clustering_prefix_length;
+    std::vector<query::group_aggregate> aggregates;
+};
+
 class partition_slice {
     std::vector<nonwrapping_range<clustering_key_prefix>> default_row_ranges();
     utils::small_vector<uint32_t, 8> static_columns;
@@ -39,6 +63,8 @@ class partition_slice {
     cql_serialization_format cql_format();
     uint32_t partition_row_limit_low_bits() [[version 1.3]] = std::numeric_limits<uint32_t>::max();
     uint32_t partition_row_limit_high_bits() [[version 4.3]] = 0;
+    std::vector<query::column_filter> column_filters() [[version 4.4]];
+    std::optional<query::group_by_spec> group_by() [[version 4.4]];
 };
 
 struct max_result_size {
@@ -56,6 +56,13 @@ enum class stream_mutation_fragments_cmd : uint8_t {
     error,
     mutation_fragment_data,
     end_of_stream,
+    mutation_fragment_batch,
+};
+
+enum class stream_sstable_files_cmd : uint8_t {
+    error,
+    component_data,
+    end_of_stream,
 };
 
 }
@@ -160,6 +160,13 @@ class intrusive_set_external_comparator final {
             algo::node_traits::get_parent(_value_traits.to_node_ptr(e)));
         return *boost::intrusive::get_parent_from_member(header_ptr, &intrusive_set_external_comparator::_header);
     }
+    // Returns container of e, which must be linked.
+    // Takes time logarithmic in the size of the container.
+    static intrusive_set_external_comparator& container_of(Elem& e) {
+        auto header_ptr = static_cast<intrusive_set_external_comparator_member_hook*>(
+            algo::get_header(_value_traits.to_node_ptr(e)));
+        return *boost::intrusive::get_parent_from_member(header_ptr, &intrusive_set_external_comparator::_header);
+    }
     static bool is_root(Elem& e) {
         auto node = _value_traits.to_node_ptr(e);
         auto e_parent = algo::node_traits::get_parent(node);
@@ -68,6 +68,7 @@
 #include <seastar/core/abort_on_ebadf.hh>
 
 #include "db/view/view_update_generator.hh"
+#include "db/row_cache_saver.hh"
 #include "service/cache_hitrate_calculator.hh"
 #include "sstables/compaction_manager.hh"
 #include "sstables/sstables.hh"
@@ -85,6 +86,7 @@
 #include "alternator/tags_extension.hh"
 #include "alternator/rmw_operation.hh"
 #include "db/paxos_grace_seconds_extension.hh"
+#include "db/result_cache_extension.hh"
 
 namespace fs = std::filesystem;
 
@@ -449,6 +451,7 @@ int main(int ac, char** av) {
     ext->add_schema_extension<alternator::tags_extension>(alternator::tags_extension::NAME);
     ext->add_schema_extension<cdc::cdc_extension>(cdc::cdc_extension::NAME);
     ext->add_schema_extension<db::paxos_grace_seconds_extension>(db::paxos_grace_seconds_extension::NAME);
+    ext->add_schema_extension<db::result_cache_extension>(db::result_cache_extension::NAME);
 
     auto cfg = make_lw_shared<db::config>(ext);
     auto init = app.get_options_description().add_options();
@@ -773,6 +776,14 @@ int main(int ac, char** av) {
             } else if (compress_what == "dc") {
                 mscfg.compress = netw::messaging_service::compress_what::dc;
             }
+            sstring compress_streaming_what = cfg->internode_compression_for_streaming();
+            if (compress_streaming_what == "all") {
+                mscfg.compress_streaming = netw::messaging_service::compress_what::all;
+            } else if (compress_streaming_what == "dc") {
+                mscfg.compress_streaming = netw::messaging_service::compress_what::dc;
+            } else if (compress_streaming_what == "none") {
+                mscfg.compress_streaming = netw::messaging_service::compress_what::none;
+            }
 
             if (!cfg->inter_dc_tcp_nodelay()) {
                 mscfg.tcp_nodelay = netw::messaging_service::tcp_nodelay_what::local;
@@ -883,7 +894,8 @@ int main(int ac, char** av) {
                 mm.stop().get();
             });
             supervisor::notify("starting query processor");
-            cql3::query_processor::memory_config qp_mcfg = {memory::stats().total_memory() / 256, memory::stats().total_memory() / 2560};
+            cql3::query_processor::memory_config qp_mcfg = {memory::stats().total_memory() / 256, memory::stats().total_memory() / 2560,
+                    memory::stats().total_memory() / 256};
             qp.start(std::ref(proxy), std::ref(db), std::ref(mm_notifier), qp_mcfg, std::ref(cql_config)).get();
             // #293 - do not stop anything
             // engine().at_exit([&qp] { return qp.stop(); });
@@ -986,6 +998,21 @@ int main(int ac, char** av) {
                     cf.trigger_compaction();
                 }
             }).get();
+
+            // Starts reading the saved partitions into the cache in the background,
+            // once the commit log is replayed.
+            supervisor::notify("starting row cache saver");
+            static sharded<db::row_cache_saver> row_cache_saver;
+            db::row_cache_saver::config rcs_cfg;
+            rcs_cfg.directory = cfg->saved_caches_directory();
+            rcs_cfg.save_period = std::chrono::seconds(cfg->row_cache_save_period());
+            rcs_cfg.keys_to_save = cfg->row_cache_keys_to_save();
+            row_cache_saver.start(std::ref(db), rcs_cfg).get();
+            row_cache_saver.invoke_on_all(&db::row_cache_saver::start).get();
+            auto stop_row_cache_saver = defer_verbose_shutdown("row cache saver", [] {
+                row_cache_saver.stop().get();
+            });
+
             api::set_server_gossip(ctx).get();
             api::set_server_snitch(ctx).get();
             api::set_server_storage_proxy(ctx).get();
@@ -1127,12 +1154,22 @@ int main(int ac, char** av) {
 
             supervisor::notify("starting cf cache hit rate calculator");
             cf_cache_hitrate_calculator.start(std::ref(db)).get();
+            // The hit rates are held back until the saved partitions are read into the
+            // cache, as the misses of the warm-up would be advertised for a while after.
+            auto cache_hitrate_calculator_started = row_cache_saver.invoke_on_all([] (db::row_cache_saver& rcs) {
+                return rcs.wait_for_warm_up();
+            }).then([&cf_cache_hitrate_calculator] {
+                cf_cache_hitrate_calculator.local().run_on(this_shard_id());
+            });
             auto stop_cache_hitrate_calculator = defer_verbose_shutdown("cf cache hit rate calculator",
-                    [&cf_cache_hitrate_calculator] {
+                    [&cf_cache_hitrate_calculator, &cache_hitrate_calculator_started] {
+                        row_cache_saver.invoke_on_all([] (db::row_cache_saver& rcs) {
+                            rcs.abort();
+                        }).get();
+                        cache_hitrate_calculator_started.get();
                         return cf_cache_hitrate_calculator.stop().get();
                     }
             );
-            cf_cache_hitrate_calculator.local().run_on(this_shard_id());
 
             supervisor::notify("starting view update backlog broker");
             static sharded<service::view_update_backlog_broker> view_backlog_broker;
@@ -1292,14 +1329,23 @@ int main(int ac, char** av) {
                 }).get();
             }
 
-            smp::invoke_on_all([&cfg] {
+            smp::invoke_on_all([&cfg, &dbcfg] {
                 logalloc::tracker::config st_cfg;
                 st_cfg.defragment_on_idle = cfg->defragment_memory_on_idle();
                 st_cfg.abort_on_lsa_bad_alloc = cfg->abort_on_lsa_bad_alloc();
                 st_cfg.lsa_reclamation_step = cfg->lsa_reclamation_step();
+                st_cfg.lsa_huge_pages = cfg->lsa_huge_pages();
+                st_cfg.lsa_background_reclaim_segments = cfg->lsa_background_reclaim_segments();
+                st_cfg.background_reclaim_scheduling_group = dbcfg.memory_compaction_scheduling_group;
                 logalloc::shard_tracker().configure(st_cfg);
             }).get();
 
+            auto stop_lsa_background_reclaim = defer_verbose_shutdown("LSA background reclaim", [] {
+                smp::invoke_on_all([] {
+                    return logalloc::shard_tracker().stop();
+                }).get();
+            });
+
             seastar::set_abort_on_ebadf(cfg->abort_on_ebadf());
             api::set_server_done(ctx).get();
             supervisor::notify("serving");
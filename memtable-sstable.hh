@@ -45,6 +45,16 @@ write_memtable_to_sstable(memtable& mt,
         sstables::sstable_writer_config& cfg,
         const io_priority_class& pc = default_priority_class());
 
+// Writes the partitions of the memtable in the range.
+future<>
+write_memtable_to_sstable(memtable& mt,
+        sstables::shared_sstable sst,
+        sstables::write_monitor& mon,
+        sstables::sstable_writer_config& cfg,
+        const io_priority_class& pc,
+        const dht::partition_range& range,
+        uint64_t estimated_partitions);
+
 future<>
 write_memtable_to_sstable(memtable& mt,
         sstables::shared_sstable sst,
@@ -574,9 +574,9 @@ class flush_reader final : public flat_mutation_reader::impl, private iterator_r
     flat_mutation_reader_opt _partition_reader;
     flush_memory_accounter _flushed_memory;
 public:
-    flush_reader(schema_ptr s, lw_shared_ptr<memtable> m)
+    flush_reader(schema_ptr s, lw_shared_ptr<memtable> m, const dht::partition_range& range)
         : impl(s)
-        , iterator_reader(std::move(s), m, query::full_partition_range)
+        , iterator_reader(std::move(s), m, range)
         , _flushed_memory(*m)
     {}
     flush_reader(const flush_reader&) = delete;
@@ -685,9 +685,11 @@ memtable::make_flat_reader(schema_ptr s,
         auto rd = make_partition_snapshot_flat_reader(snp_schema, std::move(dk), std::move(cr), std::move(snp), digest_requested,
                                                       *this, _read_section, shared_from_this(), fwd);
         rd.upgrade_schema(s);
+        rd.limit_partition_readahead(slice);
         return rd;
     } else {
         auto res = make_flat_mutation_reader<scanning_reader>(std::move(s), shared_from_this(), std::move(permit), range, slice, pc, fwd_mr);
+        res.limit_partition_readahead(slice);
         if (fwd == streamed_mutation::forwarding::yes) {
             return make_forwardable(std::move(res));
         } else {
@@ -697,13 +699,13 @@ memtable::make_flat_reader(schema_ptr s,
 }
 
 flat_mutation_reader
-memtable::make_flush_reader(schema_ptr s, const io_priority_class& pc) {
+memtable::make_flush_reader(schema_ptr s, const io_priority_class& pc, const dht::partition_range& range) {
     if (group()) {
-        return make_flat_mutation_reader<flush_reader>(s, shared_from_this());
+        return make_flat_mutation_reader<flush_reader>(s, shared_from_this(), range);
     } else {
         auto& full_slice = s->full_slice();
         return make_flat_mutation_reader<scanning_reader>(std::move(s), shared_from_this(), std::nullopt,
-            query::full_partition_range, full_slice, pc, mutation_reader::forwarding::no);
+            range, full_slice, pc, mutation_reader::forwarding::no);
     }
 }
 
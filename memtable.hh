@@ -251,11 +251,17 @@ class memtable final : public enable_lw_shared_from_this<memtable>, private loga
         return make_flat_reader(s, std::move(permit), range, full_slice);
     }
 
-    flat_mutation_reader make_flush_reader(schema_ptr, const io_priority_class& pc);
+    // The range must be alive as long as the reader.
+    flat_mutation_reader make_flush_reader(schema_ptr, const io_priority_class& pc,
+            const dht::partition_range& range = query::full_partition_range);
 
     mutation_source as_data_source();
 
     bool empty() const { return partitions.empty(); }
+    // Returns true if there are no partitions in the range.
+    bool empty(const dht::partition_range& range) const {
+        return slice(range).empty();
+    }
     void mark_flushed(mutation_source) noexcept;
     bool is_flushed() const;
     void on_detach_from_region_group() noexcept;
@@ -97,6 +97,7 @@
 #include "flat_mutation_reader.hh"
 #include "streaming/stream_manager.hh"
 #include "streaming/stream_mutation_fragments_cmd.hh"
+#include "streaming/stream_sstable_files_cmd.hh"
 #include "locator/snitch_base.hh"
 
 namespace netw {
@@ -313,7 +314,7 @@ future<> messaging_service::start_listen() {
 void messaging_service::do_start_listen() {
     bool listen_to_bc = _cfg.listen_on_broadcast_address && _cfg.ip != utils::fb_utilities::get_broadcast_address();
     rpc::server_options so;
-    if (_cfg.compress != compress_what::none) {
+    if (_cfg.compress != compress_what::none || (_cfg.compress_streaming && *_cfg.compress_streaming != compress_what::none)) {
         so.compressor_factory = &compressor_factory;
     }
     so.load_balancing_algorithm = server_socket::load_balancing_algorithm::port;
@@ -474,6 +475,7 @@ static constexpr unsigned do_get_rpc_client_idx(messaging_verb verb) {
     case messaging_verb::REPLICATION_FINISHED:
     case messaging_verb::REPAIR_CHECKSUM_RANGE:
     case messaging_verb::STREAM_MUTATION_FRAGMENTS:
+    case messaging_verb::STREAM_SSTABLE_FILES:
     case messaging_verb::REPAIR_ROW_LEVEL_START:
     case messaging_verb::REPAIR_ROW_LEVEL_STOP:
     case messaging_verb::REPAIR_GET_FULL_ROW_HASHES:
@@ -494,6 +496,7 @@ static constexpr unsigned do_get_rpc_client_idx(messaging_verb verb) {
     case messaging_verb::READ_DATA:
     case messaging_verb::READ_MUTATION_DATA:
     case messaging_verb::READ_DIGEST:
+    case messaging_verb::READ_CANCEL:
     case messaging_verb::GOSSIP_DIGEST_ACK:
     case messaging_verb::DEFINITIONS_UPDATE:
     case messaging_verb::TRUNCATE:
@@ -525,6 +528,13 @@ static constexpr std::array<uint8_t, static_cast<size_t>(messaging_verb::LAST)>
 
 static std::array<uint8_t, static_cast<size_t>(messaging_verb::LAST)> s_rpc_client_idx_table = make_rpc_client_idx_table();
 
+// The verbs sent over the streaming connection, which is compressed according to
+// internode_compression_for_streaming. Besides streaming and repair, these are
+// hints, which are replayed in the background as well.
+static bool is_streaming_verb(messaging_verb verb) {
+    return s_rpc_client_idx_table[static_cast<size_t>(verb)] == 1;
+}
+
 unsigned
 messaging_service::get_rpc_client_idx(messaging_verb verb) const {
     auto idx = s_rpc_client_idx_table[static_cast<size_t>(verb)];
@@ -660,12 +670,13 @@ shared_ptr<messaging_service::rpc_protocol_client_wrapper> messaging_service::ge
                         != snitch_ptr->get_rack(utils::fb_utilities::get_broadcast_address());
     }();
 
-    auto must_compress = [&id, this] {
-        if (_cfg.compress == compress_what::none) {
+    auto must_compress = [&id, verb, this] {
+        auto compress = is_streaming_verb(verb) && _cfg.compress_streaming ? *_cfg.compress_streaming : _cfg.compress;
+        if (compress == compress_what::none) {
             return false;
         }
 
-        if (_cfg.compress == compress_what::dc) {
+        if (compress == compress_what::dc) {
             auto& snitch_ptr = locator::i_endpoint_snitch::get_local_snitch_ptr();
             return snitch_ptr->get_datacenter(id.addr)
                             != snitch_ptr->get_datacenter(utils::fb_utilities::get_broadcast_address());
@@ -793,6 +804,35 @@ future<> messaging_service::unregister_stream_mutation_fragments() {
     return unregister_handler(messaging_verb::STREAM_MUTATION_FRAGMENTS);
 }
 
+rpc::sink<int32_t> messaging_service::make_sink_for_stream_sstable_files(rpc::source<sstring, bytes, streaming::stream_sstable_files_cmd>& source) {
+    return source.make_sink<netw::serializer, int32_t>();
+}
+
+future<std::tuple<rpc::sink<sstring, bytes, streaming::stream_sstable_files_cmd>, rpc::source<int32_t>>>
+messaging_service::make_sink_and_source_for_stream_sstable_files(utils::UUID plan_id, utils::UUID schema_id, utils::UUID cf_id, unsigned dst_shard, sstring sstable_version, streaming::stream_reason reason, msg_addr id) {
+    using value_type = std::tuple<rpc::sink<sstring, bytes, streaming::stream_sstable_files_cmd>, rpc::source<int32_t>>;
+    if (is_shutting_down()) {
+        return make_exception_future<value_type>(rpc::closed_error());
+    }
+    auto rpc_client = get_rpc_client(messaging_verb::STREAM_SSTABLE_FILES, id);
+    return rpc_client->make_stream_sink<netw::serializer, sstring, bytes, streaming::stream_sstable_files_cmd>().then([this, plan_id, schema_id, cf_id, dst_shard, sstable_version = std::move(sstable_version), reason, rpc_client] (rpc::sink<sstring, bytes, streaming::stream_sstable_files_cmd> sink) mutable {
+        auto rpc_handler = rpc()->make_client<rpc::source<int32_t> (utils::UUID, utils::UUID, utils::UUID, unsigned, sstring, streaming::stream_reason, rpc::sink<sstring, bytes, streaming::stream_sstable_files_cmd>)>(messaging_verb::STREAM_SSTABLE_FILES);
+        return rpc_handler(*rpc_client, plan_id, schema_id, cf_id, dst_shard, sstable_version, reason, sink).then_wrapped([sink, rpc_client] (future<rpc::source<int32_t>> source) mutable {
+            return (source.failed() ? sink.close() : make_ready_future<>()).then([sink = std::move(sink), source = std::move(source)] () mutable {
+                return make_ready_future<value_type>(value_type(std::move(sink), std::move(source.get0())));
+            });
+        });
+    });
+}
+
+void messaging_service::register_stream_sstable_files(std::function<future<rpc::sink<int32_t>> (const rpc::client_info& cinfo, UUID plan_id, UUID schema_id, UUID cf_id, unsigned dst_shard, sstring sstable_version, streaming::stream_reason reason, rpc::source<sstring, bytes, streaming::stream_sstable_files_cmd> source)>&& func) {
+    register_handler(this, messaging_verb::STREAM_SSTABLE_FILES, std::move(func));
+}
+
+future<> messaging_service::unregister_stream_sstable_files() {
+    return unregister_handler(messaging_verb::STREAM_SSTABLE_FILES);
+}
+
 template<class SinkType, class SourceType>
 future<std::tuple<rpc::sink<SinkType>, rpc::source<SourceType>>>
 do_make_sink_source(messaging_verb verb, uint32_t repair_meta_id, shared_ptr<messaging_service::rpc_protocol_client_wrapper> rpc_client, std::unique_ptr<messaging_service::rpc_protocol_wrapper>& rpc) {
@@ -1131,14 +1171,14 @@ future<> messaging_service::send_mutation_failed(msg_addr id, unsigned shard, re
     return send_message_oneway(this, messaging_verb::MUTATION_FAILED, std::move(id), shard, std::move(response_id), num_failed, std::move(backlog));
 }
 
-void messaging_service::register_read_data(std::function<future<rpc::tuple<foreign_ptr<lw_shared_ptr<query::result>>, cache_temperature>> (const rpc::client_info&, rpc::opt_time_point t, query::read_command cmd, ::compat::wrapping_partition_range pr, rpc::optional<query::digest_algorithm> oda)>&& func) {
+void messaging_service::register_read_data(std::function<future<rpc::tuple<foreign_ptr<lw_shared_ptr<query::result>>, cache_temperature, uint32_t>> (const rpc::client_info&, rpc::opt_time_point t, query::read_command cmd, ::compat::wrapping_partition_range pr, rpc::optional<query::digest_algorithm> oda, rpc::optional<utils::UUID> read_id)>&& func) {
     register_handler(this, netw::messaging_verb::READ_DATA, std::move(func));
 }
 future<> messaging_service::unregister_read_data() {
     return unregister_handler(netw::messaging_verb::READ_DATA);
 }
-future<rpc::tuple<query::result, rpc::optional<cache_temperature>>> messaging_service::send_read_data(msg_addr id, clock_type::time_point timeout, const query::read_command& cmd, const dht::partition_range& pr, query::digest_algorithm da) {
-    return send_message_timeout<future<rpc::tuple<query::result, rpc::optional<cache_temperature>>>>(this, messaging_verb::READ_DATA, std::move(id), timeout, cmd, pr, da);
+future<rpc::tuple<query::result, rpc::optional<cache_temperature>, rpc::optional<uint32_t>>> messaging_service::send_read_data(msg_addr id, clock_type::time_point timeout, const query::read_command& cmd, const dht::partition_range& pr, query::digest_algorithm da, utils::UUID read_id) {
+    return send_message_timeout<future<rpc::tuple<query::result, rpc::optional<cache_temperature>, rpc::optional<uint32_t>>>>(this, messaging_verb::READ_DATA, std::move(id), timeout, cmd, pr, da, read_id);
 }
 
 void messaging_service::register_get_schema_version(std::function<future<frozen_schema>(unsigned, table_schema_version)>&& func) {
@@ -1161,24 +1201,34 @@ future<utils::UUID> messaging_service::send_schema_check(msg_addr dst) {
     return send_message<utils::UUID>(this, netw::messaging_verb::SCHEMA_CHECK, dst);
 }
 
-void messaging_service::register_read_mutation_data(std::function<future<rpc::tuple<foreign_ptr<lw_shared_ptr<reconcilable_result>>, cache_temperature>> (const rpc::client_info&, rpc::opt_time_point t, query::read_command cmd, ::compat::wrapping_partition_range pr)>&& func) {
+void messaging_service::register_read_mutation_data(std::function<future<rpc::tuple<foreign_ptr<lw_shared_ptr<reconcilable_result>>, cache_temperature, uint32_t>> (const rpc::client_info&, rpc::opt_time_point t, query::read_command cmd, ::compat::wrapping_partition_range pr)>&& func) {
     register_handler(this, netw::messaging_verb::READ_MUTATION_DATA, std::move(func));
 }
 future<> messaging_service::unregister_read_mutation_data() {
     return unregister_handler(netw::messaging_verb::READ_MUTATION_DATA);
 }
-future<rpc::tuple<reconcilable_result, rpc::optional<cache_temperature>>> messaging_service::send_read_mutation_data(msg_addr id, clock_type::time_point timeout, const query::read_command& cmd, const dht::partition_range& pr) {
-    return send_message_timeout<future<rpc::tuple<reconcilable_result, rpc::optional<cache_temperature>>>>(this, messaging_verb::READ_MUTATION_DATA, std::move(id), timeout, cmd, pr);
+future<rpc::tuple<reconcilable_result, rpc::optional<cache_temperature>, rpc::optional<uint32_t>>> messaging_service::send_read_mutation_data(msg_addr id, clock_type::time_point timeout, const query::read_command& cmd, const dht::partition_range& pr) {
+    return send_message_timeout<future<rpc::tuple<reconcilable_result, rpc::optional<cache_temperature>, rpc::optional<uint32_t>>>>(this, messaging_verb::READ_MUTATION_DATA, std::move(id), timeout, cmd, pr);
 }
 
-void messaging_service::register_read_digest(std::function<future<rpc::tuple<query::result_digest, api::timestamp_type, cache_temperature>> (const rpc::client_info&, rpc::opt_time_point timeout, query::read_command cmd, ::compat::wrapping_partition_range pr, rpc::optional<query::digest_algorithm> oda)>&& func) {
+void messaging_service::register_read_digest(std::function<future<rpc::tuple<query::result_digest, api::timestamp_type, cache_temperature, uint32_t>> (const rpc::client_info&, rpc::opt_time_point timeout, query::read_command cmd, ::compat::wrapping_partition_range pr, rpc::optional<query::digest_algorithm> oda, rpc::optional<utils::UUID> read_id)>&& func) {
     register_handler(this, netw::messaging_verb::READ_DIGEST, std::move(func));
 }
 future<> messaging_service::unregister_read_digest() {
     return unregister_handler(netw::messaging_verb::READ_DIGEST);
 }
-future<rpc::tuple<query::result_digest, rpc::optional<api::timestamp_type>, rpc::optional<cache_temperature>>> messaging_service::send_read_digest(msg_addr id, clock_type::time_point timeout, const query::read_command& cmd, const dht::partition_range& pr, query::digest_algorithm da) {
-    return send_message_timeout<future<rpc::tuple<query::result_digest, rpc::optional<api::timestamp_type>, rpc::optional<cache_temperature>>>>(this, netw::messaging_verb::READ_DIGEST, std::move(id), timeout, cmd, pr, da);
+future<rpc::tuple<query::result_digest, rpc::optional<api::timestamp_type>, rpc::optional<cache_temperature>, rpc::optional<uint32_t>>> messaging_service::send_read_digest(msg_addr id, clock_type::time_point timeout, const query::read_command& cmd, const dht::partition_range& pr, query::digest_algorithm da, utils::UUID read_id) {
+    return send_message_timeout<future<rpc::tuple<query::result_digest, rpc::optional<api::timestamp_type>, rpc::optional<cache_temperature>, rpc::optional<uint32_t>>>>(this, netw::messaging_verb::READ_DIGEST, std::move(id), timeout, cmd, pr, da, read_id);
+}
+
+void messaging_service::register_read_cancel(std::function<future<rpc::no_wait_type> (const rpc::client_info&, utils::UUID read_id)>&& func) {
+    register_handler(this, netw::messaging_verb::READ_CANCEL, std::move(func));
+}
+future<> messaging_service::unregister_read_cancel() {
+    return unregister_handler(netw::messaging_verb::READ_CANCEL);
+}
+future<> messaging_service::send_read_cancel(msg_addr id, utils::UUID read_id) {
+    return send_message_oneway(this, messaging_verb::READ_CANCEL, std::move(id), read_id);
 }
 
 // Wrapper for TRUNCATE
@@ -38,6 +38,8 @@
 #include "view_info.hh"
 #include "mutation_cleaner.hh"
 #include <seastar/core/execution_stage.hh>
+#include <seastar/core/abort_source.hh>
+#include <seastar/core/align.hh>
 #include "types/map.hh"
 #include "compaction_garbage_collector.hh"
 #include "utils/exceptions.hh"
@@ -848,6 +850,28 @@ static void get_compacted_row_slice(const schema& s,
     }
 }
 
+// Returns true iff the cells satisfy all the column filters of the slice.
+// The row is expected to be compacted.
+static bool matches_column_filters(const schema& s, const query::partition_slice& slice, const row& cells) {
+    return std::all_of(slice.column_filters().begin(), slice.column_filters().end(), [&] (const query::column_filter& f) {
+        if (f.id >= s.regular_columns_count()) {
+            return true;
+        }
+        const atomic_cell_or_collection* cell = cells.find_cell(f.id);
+        if (!cell) {
+            return false;
+        }
+        auto&& def = s.regular_column_at(f.id);
+        if (!def.is_atomic() || def.is_counter()) {
+            return true;
+        }
+        auto c = cell->as_atomic_cell(def);
+        return c.is_live() && c.value().with_linearized([&] (bytes_view value) {
+            return f.matches(*def.type, value);
+        });
+    });
+}
+
 bool has_any_live_data(const schema& s, column_kind kind, const row& cells, tombstone tomb = tombstone(),
                        gc_clock::time_point now = gc_clock::time_point::min()) {
     bool any_live = false;
@@ -901,34 +925,50 @@ mutation_partition::query_compacted(query::result::partition_writer& pw, const s
             .start_rows();
 
     uint64_t row_count = 0;
+    // See mutation_querier::consume_end_of_stream().
+    const clustering_key_prefix* last_filtered_out_key = nullptr;
 
     auto is_reversed = slice.options.contains(query::partition_slice::option::reversed);
     auto send_ck = slice.options.contains(query::partition_slice::option::send_clustering_key);
+    auto write_row = [&] (const clustering_key_prefix& key, auto&& write_cells) {
+        auto cells_wr = [&] {
+            if (send_ck) {
+                return rows_wr.add().write_key(key).start_cells().start_cells();
+            } else {
+                return rows_wr.add().skip_key().start_cells().start_cells();
+            }
+        }();
+        write_cells(cells_wr);
+        std::move(cells_wr).end_cells().end_cells().end_qr_clustered_row();
+    };
+    static const query::column_id_vector no_columns;
     for_each_row(s, query::clustering_range::make_open_ended_both_sides(), is_reversed, [&] (const rows_entry& e) {
         if (e.dummy()) {
             return stop_iteration::no;
         }
         auto& row = e.row();
         auto row_tombstone = tombstone_for_row(s, e);
+        const bool is_live = row.is_live(s);
+        const bool filtered_out = is_live && !slice.column_filters().empty() && !matches_column_filters(s, slice, row.cells());
 
         if (pw.requested_digest()) {
             pw.digest().feed_hash(e.key(), s);
             pw.digest().feed_hash(row_tombstone);
             max_ts.update(row_tombstone.tomb().timestamp);
-            pw.digest().feed_hash(row.cells(), s, column_kind::regular_column, slice.regular_columns, max_ts);
+            pw.digest().feed_hash(row.cells(), s, column_kind::regular_column, filtered_out ? no_columns : slice.regular_columns, max_ts);
         }
 
-        if (row.is_live(s)) {
-            if (pw.requested_result()) {
-                auto cells_wr = [&] {
-                    if (send_ck) {
-                        return rows_wr.add().write_key(e.key()).start_cells().start_cells();
-                    } else {
-                        return rows_wr.add().skip_key().start_cells().start_cells();
-                    }
-                }();
-                get_compacted_row_slice(s, slice, column_kind::regular_column, row.cells(), slice.regular_columns, cells_wr);
-                std::move(cells_wr).end_cells().end_cells().end_qr_clustered_row();
+        if (is_live) {
+            if (filtered_out) {
+                ++pw.filtered_out_row_count();
+                last_filtered_out_key = &e.key();
+            } else {
+                last_filtered_out_key = nullptr;
+                if (pw.requested_result()) {
+                    write_row(e.key(), [&] (auto& cells_wr) {
+                        get_compacted_row_slice(s, slice, column_kind::regular_column, row.cells(), slice.regular_columns, cells_wr);
+                    });
+                }
             }
             ++row_count;
             if (--limit == 0) {
@@ -953,6 +993,13 @@ mutation_partition::query_compacted(query::result::partition_writer& pw, const s
                     || !has_any_live_data(s, column_kind::static_column, static_row().get()))) {
         pw.retract();
     } else {
+        if (last_filtered_out_key && pw.requested_result()) {
+            write_row(*last_filtered_out_key, [&] (auto& cells_wr) {
+                for (size_t i = 0; i < slice.regular_columns.size(); ++i) {
+                    cells_wr.add().skip();
+                }
+            });
+        }
         pw.row_count() += row_count ? : 1;
         pw.partition_count() += 1;
         std::move(rows_wr).end_rows().end_qr_partition();
@@ -1212,6 +1259,7 @@ row::apply_monotonically(const column_definition& column, atomic_cell_or_collect
     auto id = column.id;
     if (_type == storage_type::vector && id < max_vector_size) {
         if (id >= _storage.vector.v.size()) {
+            grow_vector(id);
             _storage.vector.v.resize(id);
             _storage.vector.v.emplace_back(std::move(value), std::move(hash));
             _storage.vector.present.set(id);
@@ -1245,6 +1293,7 @@ row::append_cell(column_id id, atomic_cell_or_collection value) {
         if (_storage.vector.v.size() > id) {
             on_internal_error(mplog, format("Attempted to append cell#{} to row already having {} cells", id, _storage.vector.v.size()));
         }
+        grow_vector(id);
         _storage.vector.v.resize(id);
         _storage.vector.v.emplace_back(cell_and_hash{std::move(value), cell_hash_opt()});
         _storage.vector.present.set(id);
@@ -1619,11 +1668,27 @@ void row::reserve(column_id last_column)
         if (last_column >= max_vector_size) {
             vector_to_set();
         } else {
-            _storage.vector.v.reserve(last_column);
+            _storage.vector.v.reserve(last_column + 1);
         }
     }
 }
 
+// Rows live in memtables and cache for a long time, and most of them are
+// narrow, so the slack left by the generic doubling of managed_vector, which
+// starts at InternalSize + 8 slots, ends up being a large part of the memory
+// used by their cells. Grow by half instead, in steps of 4 slots, and never
+// past max_vector_size, beyond which the row switches to the set anyway.
+void row::grow_vector(column_id id)
+{
+    auto& v = _storage.vector.v;
+    if (id < v.capacity()) {
+        return;
+    }
+    size_t capacity = std::max<size_t>(id + 1, v.capacity() + v.capacity() / 2);
+    capacity = std::min(align_up(capacity, size_t(4)), max_vector_size);
+    v.reserve(capacity);
+}
+
 template<typename Func>
 auto row::with_both_ranges(const row& other, Func&& func) const {
     if (_type == storage_type::vector) {
@@ -1975,10 +2040,14 @@ class mutation_querier {
     ser::qr_partition__static_row__cells<bytes_ostream> _static_cells_wr;
     bool _live_data_in_static_row{};
     uint64_t _live_clustering_rows = 0;
+    // The key of the last consumed row, if it failed the column filters of the slice.
+    std::optional<clustering_key_prefix> _last_filtered_out_key;
     std::optional<ser::qr_partition__rows<bytes_ostream>> _rows_wr;
 private:
     void query_static_row(const row& r, tombstone current_tombstone);
     void prepare_writers();
+    template<typename RowsWriter, typename WriteCells>
+    stop_iteration write_row(RowsWriter& rows_wr, const clustering_key_prefix& key, WriteCells&& write_cells);
 public:
     mutation_querier(const schema& s, query::result::partition_writer pw,
                      query::result_memory_accounter& memory_accounter);
@@ -2042,47 +2111,61 @@ void mutation_querier::prepare_writers() {
     }
 }
 
+template<typename RowsWriter, typename WriteCells>
+stop_iteration mutation_querier::write_row(RowsWriter& rows_wr, const clustering_key_prefix& key, WriteCells&& write_cells) {
+    const query::partition_slice& slice = _pw.slice();
+    auto start = rows_wr._out.size();
+    auto cells_wr = [&] {
+        if (slice.options.contains(query::partition_slice::option::send_clustering_key)) {
+            return rows_wr.add().write_key(key).start_cells().start_cells();
+        } else {
+            return rows_wr.add().skip_key().start_cells().start_cells();
+        }
+    }();
+    write_cells(cells_wr);
+    std::move(cells_wr).end_cells().end_cells().end_qr_clustered_row();
+    return _memory_accounter.update_and_check(rows_wr._out.size() - start);
+}
+
 stop_iteration mutation_querier::consume(clustering_row&& cr, row_tombstone current_tombstone) {
     prepare_writers();
 
     const query::partition_slice& slice = _pw.slice();
 
+    // A row which fails the column filters is not sent, but it still counts
+    // towards the limits, so that paging works the same way as when the
+    // coordinator does all the filtering.
+    static const query::column_id_vector no_columns;
+    const bool filtered_out = !slice.column_filters().empty() && !matches_column_filters(_schema, slice, cr.cells());
+    const auto& columns = filtered_out ? no_columns : slice.regular_columns;
+
     if (_pw.requested_digest()) {
         _pw.digest().feed_hash(cr.key(), _schema);
         _pw.digest().feed_hash(current_tombstone);
         max_timestamp max_ts{_pw.last_modified()};
         max_ts.update(current_tombstone.tomb().timestamp);
-        _pw.digest().feed_hash(cr.cells(), _schema, column_kind::regular_column, slice.regular_columns, max_ts);
+        _pw.digest().feed_hash(cr.cells(), _schema, column_kind::regular_column, columns, max_ts);
         _pw.last_modified() = max_ts.max;
     }
 
-    auto write_row = [&] (auto& rows_writer) {
-        auto cells_wr = [&] {
-            if (slice.options.contains(query::partition_slice::option::send_clustering_key)) {
-                return rows_writer.add().write_key(cr.key()).start_cells().start_cells();
-            } else {
-                return rows_writer.add().skip_key().start_cells().start_cells();
-            }
-        }();
+    _live_clustering_rows++;
+    if (filtered_out) {
+        ++_pw.filtered_out_row_count();
+        _last_filtered_out_key = cr.key();
+        return stop_iteration::no;
+    }
+    _last_filtered_out_key.reset();
+
+    auto write_cells = [&] (auto& cells_wr) {
         get_compacted_row_slice(_schema, slice, column_kind::regular_column, cr.cells(), slice.regular_columns, cells_wr);
-        std::move(cells_wr).end_cells().end_cells().end_qr_clustered_row();
     };
-
-    auto stop = stop_iteration::no;
     if (_pw.requested_result()) {
-        auto start = _rows_wr->_out.size();
-        write_row(*_rows_wr);
-        stop = _memory_accounter.update_and_check(_rows_wr->_out.size() - start);
+        return write_row(*_rows_wr, cr.key(), write_cells);
     } else {
         seastar::measuring_output_stream stream;
         ser::qr_partition__rows<seastar::measuring_output_stream> out(stream, { });
-        auto start = stream.size();
-        write_row(out);
-        stop = _memory_accounter.update_and_check(stream.size() - start);
+        return write_row(out, cr.key(), write_cells);
     }
-
-    _live_clustering_rows++;
-    return stop;
 }
 
 uint64_t mutation_querier::consume_end_of_stream() {
@@ -2100,6 +2183,15 @@ uint64_t mutation_querier::consume_end_of_stream() {
         _pw.retract();
         return 0;
     } else {
+        // The coordinator pages from the last row it receives, so if the last
+        // row was filtered out, its key is still sent, without any cells.
+        if (_last_filtered_out_key && _pw.requested_result()) {
+            write_row(*_rows_wr, *_last_filtered_out_key, [&] (auto& cells_wr) {
+                for (size_t i = 0; i < _pw.slice().regular_columns.size(); ++i) {
+                    cells_wr.add().skip();
+                }
+            });
+        }
         auto live_rows = std::max(_live_clustering_rows, uint64_t(1));
         _pw.row_count() += live_rows;
         _pw.partition_count() += 1;
@@ -2113,12 +2205,20 @@ class query_result_builder {
     query::result::builder& _rb;
     std::optional<mutation_querier> _mutation_consumer;
     stop_iteration _stop;
+    abort_source* _abort;
+private:
+    void check_abort() const {
+        if (_abort && _abort->abort_requested()) {
+            throw abort_requested_exception();
+        }
+    }
 public:
-    query_result_builder(const schema& s, query::result::builder& rb)
-        : _schema(s), _rb(rb)
+    query_result_builder(const schema& s, query::result::builder& rb, abort_source* as = nullptr)
+        : _schema(s), _rb(rb), _abort(as)
     { }
 
     void consume_new_partition(const dht::decorated_key& dk) {
+        check_abort();
         _mutation_consumer.emplace(mutation_querier(_schema, _rb.add_partition(_schema, dk.key()), _rb.memory_accounter()));
     }
 
@@ -2130,6 +2230,7 @@ class query_result_builder {
         return _stop;
     }
     stop_iteration consume(clustering_row&& cr, row_tombstone t,  bool) {
+        check_abort();
         _stop = _mutation_consumer->consume(std::move(cr), t);
         return _stop;
     }
@@ -2177,7 +2278,7 @@ future<> data_query(
             : query::data_querier(source, s, class_config.semaphore.make_permit(), range, slice, service::get_local_sstable_query_read_priority(), trace_ptr);
 
     return do_with(std::move(q), [=, &builder, trace_ptr = std::move(trace_ptr), cache_ctx = std::move(cache_ctx)] (query::data_querier& q) mutable {
-        auto qrb = query_result_builder(*s, builder);
+        auto qrb = query_result_builder(*s, builder, class_config.abort);
         return q.consume_page(std::move(qrb), row_limit, partition_limit, query_time, timeout, class_config.max_memory_for_unlimited_query).then(
                 [=, &builder, &q, trace_ptr = std::move(trace_ptr), cache_ctx = std::move(cache_ctx)] () mutable {
             if (q.are_limits_reached() || builder.is_short_read()) {
@@ -184,7 +184,14 @@ class row {
     size_t size() const { return _size; }
     bool empty() const { return _size == 0; }
 
-    void reserve(column_id);
+    // Makes room for cells up to and including last_column.
+    void reserve(column_id last_column);
+
+    // Number of cells the row can hold before its storage is reallocated.
+    // Rows which keep their cells in a set allocate each cell separately.
+    size_t capacity() const {
+        return _type == storage_type::vector ? _storage.vector.v.capacity() : _size;
+    }
 
     const atomic_cell_or_collection& cell_at(column_id id) const;
 
@@ -242,6 +249,9 @@ class row {
 
     void vector_to_set();
 
+    // Makes room in the vector storage for the cell of the given column.
+    void grow_vector(column_id id);
+
     template<typename Func>
     void consume_with(Func&&);
 
@@ -1023,7 +1033,12 @@ class rows_entry {
         // Marks a dummy entry which is after_all_clustered_rows() position.
         // Needed so that eviction, which can't use comparators, can check if it's dealing with it.
         bool _last_dummy : 1;
-        flags() : _before_ck(0), _after_ck(0), _continuous(true), _dummy(false), _last_dummy(false) { }
+        // Saturating count of recent reads of the row, see cache_tracker::touch().
+        uint8_t _hits : 2;
+        // Set when the row is cached or read, cleared when eviction passes over it,
+        // see cache_tracker::evict_cold_neighbours().
+        bool _referenced : 1;
+        flags() : _before_ck(0), _after_ck(0), _continuous(true), _dummy(false), _last_dummy(false), _hits(0), _referenced(false) { }
     } _flags{};
     friend class mutation_partition;
 public:
@@ -1086,6 +1101,19 @@ class rows_entry {
     bool is_last_dummy() const { return _flags._last_dummy; }
     void set_dummy(bool value) { _flags._dummy = value; }
     void set_dummy(is_dummy value) { _flags._dummy = bool(value); }
+    // Number of reads of the row since it was cached, or since it was last spared
+    // from eviction, saturating at max_hits.
+    static constexpr unsigned max_hits = 3;
+    unsigned hits() const { return _flags._hits; }
+    void on_hit() {
+        if (_flags._hits < max_hits) {
+            ++_flags._hits;
+        }
+    }
+    void decay_hits() { _flags._hits >>= 1; }
+    // Whether the row was cached or read since eviction last passed over it.
+    bool referenced() const { return _flags._referenced; }
+    void set_referenced(bool value) { _flags._referenced = value; }
     void apply(row_tombstone t) {
         _row.apply(t);
     }
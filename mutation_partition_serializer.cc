@@ -280,3 +280,26 @@ frozen_mutation_fragment freeze(const schema& s, const mutation_fragment& mf)
     )).end_mutation_fragment();
     return frozen_mutation_fragment(std::move(out));
 }
+
+frozen_mutation_fragment pack_frozen_mutation_fragments(const std::vector<frozen_mutation_fragment>& fragments)
+{
+    bytes_ostream out;
+    ser::serialize(out, uint32_t(fragments.size()));
+    for (auto& fmf : fragments) {
+        ser::serialize(out, fmf.representation());
+    }
+    return frozen_mutation_fragment(std::move(out));
+}
+
+std::vector<frozen_mutation_fragment> unpack_frozen_mutation_fragments(const frozen_mutation_fragment& batch)
+{
+    auto in = ser::as_input_stream(batch.representation());
+    auto count = ser::deserialize(in, boost::type<uint32_t>());
+    std::vector<frozen_mutation_fragment> fragments;
+    fragments.reserve(count);
+    while (count--) {
+        bytes_ostream b = ser::deserialize(in, boost::type<bytes>());
+        fragments.emplace_back(std::move(b));
+    }
+    return fragments;
+}
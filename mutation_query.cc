@@ -77,7 +77,11 @@ to_data_query_result(const reconcilable_result& r, schema_ptr s, const query::pa
     if (r.is_short_read()) {
         builder.mark_as_short_read();
     }
-    return builder.build();
+    auto result = builder.build();
+    if (slice.group_by() && opts.request != query::result_request::only_digest) {
+        result.group_rows(*s, slice);
+    }
+    return result;
 }
 
 std::ostream& operator<<(std::ostream& out, const reconcilable_result::printer& pr) {
@@ -224,6 +224,11 @@ class querier : public querier_base {
             gc_clock::time_point query_time,
             db::timeout_clock::time_point timeout,
             query::max_result_size max_size) {
+        // A single partition can't return more rows than the page, so don't read
+        // ahead more of them, like for PER PARTITION LIMIT.
+        if (_range->is_singular()) {
+            _reader.limit_partition_readahead(*_slice, row_limit);
+        }
         return ::query::consume_page(_reader, _compaction_state, *_slice, std::move(consumer), row_limit, partition_limit, query_time,
                 timeout, max_size).then([this] (auto&& results) {
             _last_ckey = std::get<std::optional<clustering_key>>(std::move(results));
@@ -121,6 +121,68 @@ constexpr auto max_rows = std::numeric_limits<uint64_t>::max();
 constexpr auto partition_max_rows = std::numeric_limits<uint64_t>::max();
 constexpr auto max_rows_if_set = std::numeric_limits<uint32_t>::max();
 
+// A restriction on the value of a regular, non-collection column, evaluated
+// by replicas so that rows which can't satisfy an ALLOW FILTERING query are
+// not sent back to the coordinator. A row matches when the column is live
+// and its value is one of `values`, if engaged, or otherwise lies in
+// `range`. Non-matching rows are left out of the result, but still count
+// towards its row count and limits, see sends_fewer_rows_than_read(). The
+// last row of a partition is sent without cells if it doesn't match, so
+// that the coordinator can page from it. The coordinator filters the rows
+// again, so it's fine for the filter to be less selective than the
+// original restriction.
+struct column_filter {
+    column_id id;
+    std::optional<std::vector<bytes>> values;
+    nonwrapping_range<bytes> range;
+
+    // The value of the column is given as the serialized form of the column type.
+    bool matches(const abstract_type& type, bytes_view value) const;
+};
+
+std::ostream& operator<<(std::ostream& out, const column_filter& f);
+
+enum class group_aggregate_kind : uint8_t {
+    count_rows,
+    count,
+    min,
+    max,
+    sum,
+};
+
+// An aggregate of a regular column computed by replicas for each group of a
+// GROUP BY query. The column is ignored by count_rows.
+struct group_aggregate {
+    group_aggregate_kind kind;
+    column_id id;
+};
+
+std::ostream& operator<<(std::ostream& out, const group_aggregate& a);
+
+// Asks replicas to send a single row for each group of consecutive rows
+// sharing the partition key and the first clustering_prefix_length
+// clustering key components, instead of the rows themselves. Its cells hold
+// the partial states of the aggregates, in order:
+//   - count_rows and count: the number of rows, or of live cells, as a bigint,
+//   - min and max: the smallest or largest live value, missing if there is none,
+//   - sum: the sum of the live values, as a 16-byte big-endian integer.
+// The row has the clustering key of the last row of the group, so that
+// paging resumes after it, and the result's row count is the count of the
+// rows which were grouped, so that row limits and short reads work the same
+// way as without grouping. A group may be split between pages, or between
+// the results of different replicas, so the coordinator merges the states
+// of consecutive rows of the same group.
+struct group_by_spec {
+    uint32_t clustering_prefix_length;
+    std::vector<group_aggregate> aggregates;
+};
+
+std::ostream& operator<<(std::ostream& out, const group_by_spec& g);
+
+// The encoding of the partial state of a sum.
+bytes serialize_group_sum(__int128 sum);
+__int128 deserialize_group_sum(bytes_view v);
+
 // Specifies subset of rows, columns and cell attributes to be returned in a query.
 // Can be accessed across cores.
 // Schema-dependent.
@@ -142,6 +204,9 @@ class partition_slice {
         // key restrictions and the partition doesn't have any rows matching
         // the restrictions, see #589. This flag overrides this behavior.
         always_return_static_content,
+        // Populate the row cache only with partitions which were read
+        // frequently of late, see caching_options::frequent_admission().
+        filtered_cache_admission,
     };
     using option_set = enum_set<super_enum<option,
         option::send_clustering_key,
@@ -155,7 +220,8 @@ class partition_slice {
         option::allow_short_read,
         option::with_digest,
         option::bypass_cache,
-        option::always_return_static_content>>;
+        option::always_return_static_content,
+        option::filtered_cache_admission>>;
     clustering_row_ranges _row_ranges;
 public:
     column_id_vector static_columns; // TODO: consider using bitmap
@@ -166,13 +232,17 @@ class partition_slice {
     cql_serialization_format _cql_format;
     uint32_t _partition_row_limit_low_bits;
     uint32_t _partition_row_limit_high_bits;
+    std::vector<column_filter> _column_filters;
+    std::optional<group_by_spec> _group_by;
 public:
     partition_slice(clustering_row_ranges row_ranges, column_id_vector static_columns,
         column_id_vector regular_columns, option_set options,
         std::unique_ptr<specific_ranges> specific_ranges,
         cql_serialization_format,
         uint32_t partition_row_limit_low_bits,
-        uint32_t partition_row_limit_high_bits);
+        uint32_t partition_row_limit_high_bits,
+        std::vector<column_filter> column_filters = {},
+        std::optional<group_by_spec> group_by = {});
     partition_slice(clustering_row_ranges row_ranges, column_id_vector static_columns,
         column_id_vector regular_columns, option_set options,
         std::unique_ptr<specific_ranges> specific_ranges = nullptr,
@@ -216,6 +286,23 @@ class partition_slice {
         _partition_row_limit_low_bits = static_cast<uint64_t>(limit);
         _partition_row_limit_high_bits = static_cast<uint64_t>(limit >> 32);
     }
+    const std::vector<column_filter>& column_filters() const {
+        return _column_filters;
+    }
+    void set_column_filters(std::vector<column_filter> filters) {
+        _column_filters = std::move(filters);
+    }
+    const std::optional<group_by_spec>& group_by() const {
+        return _group_by;
+    }
+    void set_group_by(group_by_spec group_by) {
+        _group_by = std::move(group_by);
+    }
+    // Whether replicas send fewer rows than they read, as they group them or leave out
+    // those which fail the column filters. Their row counts are those of the rows read.
+    bool sends_fewer_rows_than_read() const {
+        return _group_by || !_column_filters.empty();
+    }
 
     friend std::ostream& operator<<(std::ostream& out, const partition_slice& ps);
     friend std::ostream& operator<<(std::ostream& out, const specific_ranges& ps);
@@ -151,6 +151,7 @@ concept ResultVisitor = requires(Visitor visitor, const partition_key& pkey,
 class result_view {
     ser::query_result_view _v;
     friend class result_merger;
+    friend class result;
 public:
     result_view(const bytes_ostream& v) : _v(ser::query_result_view{ser::as_input_stream(v)}) {}
     result_view(ser::query_result_view v) : _v(v) {}
@@ -52,6 +52,7 @@ class result::partition_writer {
     digester _digest_pos;
     uint64_t& _row_count;
     uint32_t& _partition_count;
+    uint64_t& _filtered_out_row_count;
     api::timestamp_type& _last_modified;
 public:
     partition_writer(
@@ -64,6 +65,7 @@ class result::partition_writer {
         digester& digest,
         uint64_t& row_count,
         uint32_t& partition_count,
+        uint64_t& filtered_out_row_count,
         api::timestamp_type& last_modified)
         : _request(request)
         , _w(std::move(w))
@@ -75,6 +77,7 @@ class result::partition_writer {
         , _digest_pos(digest)
         , _row_count(row_count)
         , _partition_count(partition_count)
+        , _filtered_out_row_count(filtered_out_row_count)
         , _last_modified(last_modified)
     { }
 
@@ -113,6 +116,10 @@ class result::partition_writer {
     uint32_t& partition_count() {
         return _partition_count;
     }
+    // Rows counted in row_count(), which were not sent as they failed the column filters of the slice.
+    uint64_t& filtered_out_row_count() {
+        return _filtered_out_row_count;
+    }
     api::timestamp_type& last_modified() {
         return _last_modified;
     }
@@ -126,6 +133,7 @@ class result::builder {
     result_request _request;
     uint64_t _row_count = 0;
     uint32_t _partition_count = 0;
+    uint64_t _filtered_out_row_count = 0;
     api::timestamp_type _last_modified = api::missing_timestamp;
     short_read _short_read;
     digester _digest;
@@ -172,22 +180,28 @@ class result::builder {
             _digest.feed_hash(key, s);
         }
         return partition_writer(_request, _slice, ranges, _w, std::move(pos), std::move(after_key), _digest, _row_count,
-                                _partition_count, _last_modified);
+                                _partition_count, _filtered_out_row_count, _last_modified);
     }
 
     result build() {
         std::move(_w).end_partitions().end_query_result();
         switch (_request) {
-        case result_request::only_result:
-            return result(std::move(_out), _short_read, _row_count, _partition_count, std::move(_memory_accounter).done());
+        case result_request::only_result: {
+            auto r = result(std::move(_out), _short_read, _row_count, _partition_count, std::move(_memory_accounter).done());
+            r.set_filtered_out_row_count(_filtered_out_row_count);
+            return r;
+        }
         case result_request::only_digest: {
             bytes_ostream buf;
             ser::writer_of_query_result<bytes_ostream>(buf).start_partitions().end_partitions().end_query_result();
             return result(std::move(buf), result_digest(_digest.finalize_array()), _last_modified, _short_read, {}, {});
         }
-        case result_request::result_and_digest:
-            return result(std::move(_out), result_digest(_digest.finalize_array()),
+        case result_request::result_and_digest: {
+            auto r = result(std::move(_out), result_digest(_digest.finalize_array()),
                           _last_modified, _short_read, _row_count, _partition_count, std::move(_memory_accounter).done());
+            r.set_filtered_out_row_count(_filtered_out_row_count);
+            return r;
+        }
         }
         abort();
     }
@@ -329,6 +329,8 @@ class result {
     query::result_memory_tracker _memory_tracker;
     std::optional<uint32_t> _partition_count;
     std::optional<uint32_t> _row_count_high_bits;
+    // Not serialized, only known to the replica which built the result.
+    uint64_t _filtered_out_row_count = 0;
 public:
     class builder;
     class partition_writer;
@@ -433,8 +435,23 @@ class result {
         return _partition_count;
     }
 
+    // Rows counted in row_count(), which were left out of the result as they
+    // failed the column filters of the slice.
+    uint64_t filtered_out_row_count() const {
+        return _filtered_out_row_count;
+    }
+
+    void set_filtered_out_row_count(uint64_t count) {
+        _filtered_out_row_count = count;
+    }
+
     void ensure_counts();
 
+    // Replaces the rows of each group with a single row of partial aggregates,
+    // as asked for by the slice's group_by(). The counts, the digest and the
+    // short read flag are kept, as they describe the rows which were read.
+    void group_rows(const schema& s, const partition_slice& slice);
+
     struct printer {
         schema_ptr s;
         const query::partition_slice& slice;
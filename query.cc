@@ -20,6 +20,7 @@
  */
 
 #include <limits>
+#include <boost/range/algorithm/find.hpp>
 #include "query-request.hh"
 #include "query-result.hh"
 #include "query-result-writer.hh"
@@ -29,6 +30,8 @@
 #include "mutation_partition_serializer.hh"
 #include "query-result-reader.hh"
 #include "query_result_merger.hh"
+#include "schema.hh"
+#include "types.hh"
 
 namespace query {
 
@@ -55,9 +58,64 @@ std::ostream& operator<<(std::ostream& out, const partition_slice& ps) {
     out << ", options=" << format("{:x}", ps.options.mask()); // FIXME: pretty print options
     out << ", cql_format=" << ps.cql_format();
     out << ", partition_row_limit=" << ps._partition_row_limit_low_bits;
+    if (!ps._column_filters.empty()) {
+        out << ", column_filters=[" << join(", ", ps._column_filters) << "]";
+    }
+    if (ps._group_by) {
+        out << ", group_by=" << *ps._group_by;
+    }
     return out << "}";
 }
 
+bool column_filter::matches(const abstract_type& type, bytes_view value) const {
+    if (values) {
+        return std::any_of(values->begin(), values->end(), [&] (const bytes& v) {
+            return type.equal(v, value);
+        });
+    }
+    if (auto& start = range.start()) {
+        auto c = type.compare(value, start->value());
+        if (c < 0 || (c == 0 && !start->is_inclusive())) {
+            return false;
+        }
+    }
+    if (auto& end = range.end()) {
+        auto c = type.compare(value, end->value());
+        if (c > 0 || (c == 0 && !end->is_inclusive())) {
+            return false;
+        }
+    }
+    return true;
+}
+
+std::ostream& operator<<(std::ostream& out, const column_filter& f) {
+    out << "{id=" << f.id;
+    if (f.values) {
+        return out << ", values=[" << join(", ", *f.values) << "]}";
+    }
+    return out << ", range=" << f.range << "}";
+}
+
+static std::string_view to_string(group_aggregate_kind kind) {
+    switch (kind) {
+    case group_aggregate_kind::count_rows: return "count_rows";
+    case group_aggregate_kind::count: return "count";
+    case group_aggregate_kind::min: return "min";
+    case group_aggregate_kind::max: return "max";
+    case group_aggregate_kind::sum: return "sum";
+    }
+    abort();
+}
+
+std::ostream& operator<<(std::ostream& out, const group_aggregate& a) {
+    return out << to_string(a.kind) << "(" << a.id << ")";
+}
+
+std::ostream& operator<<(std::ostream& out, const group_by_spec& g) {
+    return out << "{clustering_prefix_length=" << g.clustering_prefix_length
+               << ", aggregates=[" << join(", ", g.aggregates) << "]}";
+}
+
 std::ostream& operator<<(std::ostream& out, const read_command& r) {
     return out << "read_command{"
         << "cf_id=" << r.cf_id
@@ -117,7 +175,9 @@ partition_slice::partition_slice(clustering_row_ranges row_ranges,
     std::unique_ptr<specific_ranges> specific_ranges,
     cql_serialization_format cql_format,
     uint32_t partition_row_limit_low_bits,
-    uint32_t partition_row_limit_high_bits)
+    uint32_t partition_row_limit_high_bits,
+    std::vector<column_filter> column_filters,
+    std::optional<group_by_spec> group_by)
     : _row_ranges(std::move(row_ranges))
     , static_columns(std::move(static_columns))
     , regular_columns(std::move(regular_columns))
@@ -126,6 +186,8 @@ partition_slice::partition_slice(clustering_row_ranges row_ranges,
     , _cql_format(std::move(cql_format))
     , _partition_row_limit_low_bits(partition_row_limit_low_bits)
     , _partition_row_limit_high_bits(partition_row_limit_high_bits)
+    , _column_filters(std::move(column_filters))
+    , _group_by(std::move(group_by))
 {}
 
 partition_slice::partition_slice(clustering_row_ranges row_ranges,
@@ -168,6 +230,9 @@ partition_slice::partition_slice(const partition_slice& s)
     , _specific_ranges(s._specific_ranges ? std::make_unique<specific_ranges>(*s._specific_ranges) : nullptr)
     , _cql_format(s._cql_format)
     , _partition_row_limit_low_bits(s._partition_row_limit_low_bits)
+    , _partition_row_limit_high_bits(s._partition_row_limit_high_bits)
+    , _column_filters(s._column_filters)
+    , _group_by(s._group_by)
 {}
 
 partition_slice::~partition_slice()
@@ -242,6 +307,202 @@ void result::ensure_counts() {
     }
 }
 
+bytes serialize_group_sum(__int128 sum) {
+    bytes b(bytes::initialized_later(), 16);
+    auto v = static_cast<unsigned __int128>(sum);
+    for (int i = 15; i >= 0; --i) {
+        b[i] = static_cast<int8_t>(v & 0xff);
+        v >>= 8;
+    }
+    return b;
+}
+
+__int128 deserialize_group_sum(bytes_view b) {
+    if (b.size() != 16) {
+        throw std::runtime_error(format("Invalid size of a partial sum: {}", b.size()));
+    }
+    unsigned __int128 v = 0;
+    for (auto c : b) {
+        v = (v << 8) | static_cast<uint8_t>(c);
+    }
+    return static_cast<__int128>(v);
+}
+
+static __int128 integer_value(const abstract_type& type, bytes_view v) {
+    switch (type.get_kind()) {
+    case abstract_type::kind::byte: return value_cast<int8_t>(type.deserialize(v));
+    case abstract_type::kind::short_kind: return value_cast<int16_t>(type.deserialize(v));
+    case abstract_type::kind::int32: return value_cast<int32_t>(type.deserialize(v));
+    case abstract_type::kind::long_kind: return value_cast<int64_t>(type.deserialize(v));
+    default:
+        throw std::runtime_error(format("Cannot compute a partial sum of {} values", type.name()));
+    }
+}
+
+namespace {
+
+// Accumulates the partial aggregates of a group of rows, see group_by_spec.
+class group_accumulator {
+    struct state {
+        int64_t count = 0;
+        bytes_opt value;
+        __int128 sum = 0;
+    };
+    const group_by_spec& _spec;
+    // For each aggregate, its column and the position of its cells in the rows.
+    std::vector<const column_definition*> _columns;
+    std::vector<size_t> _positions;
+    std::vector<state> _states;
+public:
+    group_accumulator(const schema& s, const partition_slice& slice)
+            : _spec(*slice.group_by())
+            , _states(_spec.aggregates.size()) {
+        for (auto& a : _spec.aggregates) {
+            if (a.kind == group_aggregate_kind::count_rows) {
+                _columns.push_back(nullptr);
+                _positions.push_back(0);
+                continue;
+            }
+            auto it = boost::find(slice.regular_columns, a.id);
+            if (it == slice.regular_columns.end()) {
+                throw std::runtime_error(format("Aggregated column {} isn't queried", a.id));
+            }
+            _columns.push_back(&s.regular_column_at(a.id));
+            _positions.push_back(std::distance(slice.regular_columns.begin(), it));
+        }
+    }
+
+    void add(const std::vector<std::optional<ser::qr_cell_view>>& cells) {
+        for (size_t i = 0; i < _states.size(); ++i) {
+            auto& st = _states[i];
+            auto kind = _spec.aggregates[i].kind;
+            if (kind == group_aggregate_kind::count_rows) {
+                ++st.count;
+                continue;
+            }
+            auto& cell = cells[_positions[i]];
+            if (!cell) {
+                continue;
+            }
+            auto value = cell->value().view().linearize();
+            auto& type = *_columns[i]->type;
+            switch (kind) {
+            case group_aggregate_kind::count_rows:
+            case group_aggregate_kind::count:
+                ++st.count;
+                break;
+            case group_aggregate_kind::min:
+                if (!st.value || type.less(value, *st.value)) {
+                    st.value = std::move(value);
+                }
+                break;
+            case group_aggregate_kind::max:
+                if (!st.value || type.less(*st.value, value)) {
+                    st.value = std::move(value);
+                }
+                break;
+            case group_aggregate_kind::sum:
+                if (!value.empty()) {
+                    st.sum += integer_value(type, value);
+                }
+                break;
+            }
+        }
+    }
+
+    // Writes the partial aggregates and resets them.
+    template<typename Writer>
+    void write(Writer& wr) {
+        auto write_value = [&wr] (bytes_view v) {
+            wr.add().write().skip_timestamp().skip_expiry().write_value(v).skip_ttl().end_qr_cell();
+        };
+        for (size_t i = 0; i < _states.size(); ++i) {
+            auto& st = _states[i];
+            switch (_spec.aggregates[i].kind) {
+            case group_aggregate_kind::count_rows:
+            case group_aggregate_kind::count:
+                write_value(long_type->decompose(st.count));
+                break;
+            case group_aggregate_kind::min:
+            case group_aggregate_kind::max:
+                if (st.value) {
+                    write_value(*st.value);
+                } else {
+                    wr.add().skip();
+                }
+                break;
+            case group_aggregate_kind::sum:
+                write_value(serialize_group_sum(st.sum));
+                break;
+            }
+            st = state();
+        }
+    }
+};
+
+}
+
+void result::group_rows(const schema& s, const partition_slice& slice) {
+    const auto prefix_length = slice.group_by()->clustering_prefix_length;
+    group_accumulator acc(s, slice);
+
+    auto same_group = [&] (const std::optional<clustering_key>& a, const std::optional<clustering_key>& b) {
+        if (!prefix_length) {
+            return true;
+        }
+        if (!a || !b) {
+            throw std::runtime_error("Grouping by clustering columns requires clustering keys");
+        }
+        auto ac = a->components(s);
+        auto bc = b->components(s);
+        auto ai = ac.begin();
+        auto bi = bc.begin();
+        for (uint32_t i = 0; i < prefix_length && ai != ac.end() && bi != bc.end(); ++i, ++ai, ++bi) {
+            if (*ai != *bi) {
+                return false;
+            }
+        }
+        return true;
+    };
+
+    bytes_ostream w;
+    auto partitions = ser::writer_of_query_result<bytes_ostream>(w).start_partitions();
+    result_view::do_with(*this, [&] (result_view rv) {
+        for (auto&& pv : rv._v.partitions()) {
+            auto key = pv.key();
+            auto static_cells_wr = (key ? partitions.add().write_key(*key) : partitions.add().skip_key())
+                    .start_static_row()
+                    .start_cells();
+            for (auto&& cell : pv.static_row().cells()) {
+                static_cells_wr.add(cell);
+            }
+            auto rows_wr = std::move(static_cells_wr)
+                    .end_cells()
+                    .end_static_row()
+                    .start_rows();
+            auto rows = pv.rows();
+            for (auto it = rows.begin(); it != rows.end();) {
+                auto row = *it;
+                acc.add(row.cells().cells());
+                auto row_key = row.key();
+                ++it;
+                if (it != rows.end() && same_group(row_key, (*it).key())) {
+                    continue;
+                }
+                auto cells_wr = (row_key ? rows_wr.add().write_key(*row_key) : rows_wr.add().skip_key())
+                        .start_cells()
+                        .start_cells();
+                acc.write(cells_wr);
+                std::move(cells_wr).end_cells().end_cells().end_qr_clustered_row();
+            }
+            std::move(rows_wr).end_rows().end_qr_partition();
+        }
+    });
+    std::move(partitions).end_partitions().end_query_result();
+    _w = std::move(w);
+    _w.reduce_chunk_count();
+}
+
 result::result()
     : result([] {
         bytes_ostream out;
@@ -271,10 +532,50 @@ static void write_partial_partition(ser::writer_of_qr_partition<bytes_ostream>&&
     std::move(rows_wr).end_rows().end_qr_partition();
 }
 
+// A grouped row stands for a whole group, and replicas leave out rows which
+// fail the column filters, so such results can't be trimmed to the row limit.
+// They are kept whole instead, which is fine, as the paging state then points
+// after the last row of the last group, or the last row read. The row count
+// is that of the rows which were read, capped at the limit so that callers
+// accounting for the rows still left to read don't go below zero.
+foreign_ptr<lw_shared_ptr<query::result>> result_merger::get_reduced() {
+    bytes_ostream w;
+    auto partitions = ser::writer_of_query_result<bytes_ostream>(w).start_partitions();
+    uint64_t row_count = 0;
+    short_read is_short_read;
+    uint32_t partition_count = 0;
+
+    for (auto&& r : _partial) {
+        result_view::do_with(*r, [&] (result_view rv) {
+            auto [partitions_in_result, rows_in_result] = rv.count_partitions_and_rows();
+            row_count += r->row_count().value_or(rows_in_result);
+            partition_count += r->partition_count().value_or(partitions_in_result);
+            for (auto&& pv : rv._v.partitions()) {
+                partitions.add(pv);
+            }
+        });
+        if (r->is_short_read()) {
+            is_short_read = short_read::yes;
+            break;
+        }
+        if (row_count >= _max_rows || partition_count >= _max_partitions) {
+            break;
+        }
+    }
+
+    std::move(partitions).end_partitions().end_query_result();
+
+    return make_foreign(make_lw_shared<query::result>(std::move(w), is_short_read,
+            std::min(row_count, _max_rows), std::min(partition_count, _max_partitions)));
+}
+
 foreign_ptr<lw_shared_ptr<query::result>> result_merger::get() {
     if (_partial.size() == 1) {
         return std::move(_partial[0]);
     }
+    if (_reduced) {
+        return get_reduced();
+    }
 
     bytes_ostream w;
     auto partitions = ser::writer_of_query_result<bytes_ostream>(w).start_partitions();
@@ -25,6 +25,10 @@
 
 class reader_concurrency_semaphore;
 
+namespace seastar {
+class abort_source;
+}
+
 namespace query {
 
 struct max_result_size {
@@ -39,6 +43,9 @@ struct max_result_size {
 struct query_class_config {
     reader_concurrency_semaphore& semaphore;
     max_result_size max_memory_for_unlimited_query;
+    // When set, the read fails with seastar::abort_requested_exception soon
+    // after an abort is requested, instead of completing.
+    seastar::abort_source* abort = nullptr;
 };
 
 }
@@ -32,10 +32,15 @@ class result_merger {
     std::vector<foreign_ptr<lw_shared_ptr<query::result>>> _partial;
     const uint64_t _max_rows;
     const uint32_t _max_partitions;
+    // Whether the results hold fewer rows than they count, see partition_slice::sends_fewer_rows_than_read().
+    const bool _reduced;
+private:
+    foreign_ptr<lw_shared_ptr<query::result>> get_reduced();
 public:
-    explicit result_merger(uint64_t max_rows, uint32_t max_partitions)
+    explicit result_merger(uint64_t max_rows, uint32_t max_partitions, bool reduced = false)
             : _max_rows(max_rows)
             , _max_partitions(max_partitions)
+            , _reduced(reduced)
     { }
 
     void reserve(size_t size) {
@@ -127,6 +127,7 @@ class read_context final : public enable_lw_shared_from_this<read_context> {
     tracing::trace_state_ptr _trace_state;
     mutation_reader::forwarding _fwd_mr;
     bool _range_query;
+    bool _filtered_admission;
     // When reader enters a partition, it must be set up for reading that
     // partition from the underlying mutation source (_underlying) in one of two ways:
     //
@@ -160,6 +161,8 @@ class read_context final : public enable_lw_shared_from_this<read_context> {
         , _trace_state(std::move(trace_state))
         , _fwd_mr(fwd_mr)
         , _range_query(!range.is_singular() || !range.start()->value().has_key())
+        , _filtered_admission(_schema->caching_options().frequent_admission()
+                || slice.options.contains<query::partition_slice::option::filtered_cache_admission>())
         , _underlying(_cache, *this)
     {
         ++_cache._tracker._stats.reads;
@@ -191,6 +194,8 @@ class read_context final : public enable_lw_shared_from_this<read_context> {
     const dht::decorated_key& key() const { return *_key; }
     void on_underlying_created() { ++_underlying_created; }
     bool digest_requested() const { return _slice.options.contains<query::partition_slice::option::with_digest>(); }
+    // Tells if the partition, read from the underlying source, should be populated into the cache.
+    bool should_admit(const dht::decorated_key& dk) { return !_filtered_admission || _cache._tracker.should_admit(dk); }
 public:
     future<> ensure_underlying(db::timeout_clock::time_point timeout) {
         if (_underlying_snapshot) {
@@ -55,9 +55,15 @@ cache_tracker::cache_tracker()
     : cache_tracker(dummy_app_stats)
 {}
 
+// Partitions read at least that many times of late are admitted into the cache
+// by reads with filtered admission. The read being admitted counts.
+static constexpr unsigned admission_min_frequency = 2;
+
 cache_tracker::cache_tracker(mutation_application_stats& app_stats)
     : _garbage(_region, this, app_stats)
     , _memtable_cleaner(_region, nullptr, app_stats)
+    // Enough counters for the partitions of a full cache, if they are 4KiB on average.
+    , _admission_sketch(memory::stats().total_memory() / 4096)
 {
     setup_metrics();
 
@@ -78,7 +84,7 @@ cache_tracker::cache_tracker(mutation_application_stats& app_stats)
             if (_lru.empty()) {
                 return memory::reclaiming_result::reclaimed_nothing;
             }
-            _lru.back().on_evicted(*this);
+            evict_from_lru();
             return memory::reclaiming_result::reclaimed_something;
            } catch (std::bad_alloc&) {
             // Bad luck, linearization during partition removal caused us to
@@ -120,6 +126,9 @@ cache_tracker::setup_metrics() {
         sm::make_derive("partition_evictions", sm::description("total number of evicted partitions"), _stats.partition_evictions),
         sm::make_derive("partition_removals", sm::description("total number of invalidated partitions"), _stats.partition_removals),
         sm::make_derive("mispopulations", sm::description("number of entries not inserted by reads"), _stats.mispopulations),
+        sm::make_derive("row_eviction_second_chances", sm::description("number of times a frequently read row was moved back to the front of the LRU instead of being evicted"), _stats.row_eviction_second_chances),
+        sm::make_derive("row_range_evictions", sm::description("number of rows evicted together with a neighbour which was at the end of the LRU"), _stats.row_range_evictions),
+        sm::make_derive("partitions_not_admitted", sm::description("number of partitions read on a miss and not admitted into the cache because they were not read frequently"), _stats.partitions_not_admitted),
         sm::make_gauge("partitions", sm::description("total number of cached partitions"), _stats.partitions),
         sm::make_gauge("rows", sm::description("total number of cached rows"), _stats.rows),
         sm::make_derive("reads", sm::description("number of started reads"), _stats.reads),
@@ -155,7 +164,100 @@ void cache_tracker::clear() {
     allocator().invalidate_references();
 }
 
+// Rows of a partition with a single version can be evicted in any order,
+// otherwise the rows of older versions must be evicted first.
+// Returns the rows of the partition, or nullptr if it has more than one version.
+static mutation_partition::rows_type* rows_evictable_in_any_order(rows_entry& e) noexcept {
+    auto& rows = mutation_partition::rows_type::container_of(e);
+    partition_version& pv = partition_version::container_of(mutation_partition::container_of(rows));
+    if (!pv.is_referenced_from_entry() || !pv.is_single()) {
+        return nullptr;
+    }
+    return &rows;
+}
+
+// Bounds the work done by a single eviction step, for the sake of latency.
+static constexpr unsigned max_second_chances_per_eviction = 8;
+static constexpr unsigned max_cold_range_rows = 16;
+
+void cache_tracker::evict_from_lru() noexcept {
+    // A row read repeatedly since it was cached is not evicted when it reaches the end
+    // of the LRU. It is moved back to the front instead, with its count of reads halved,
+    // so that it is evicted unless it is read again. That keeps the frequently read rows
+    // of wide partitions, like the head of a time series, from being evicted by reads
+    // which scan many rows once.
+    for (unsigned i = 0; i < max_second_chances_per_eviction; ++i) {
+        rows_entry& e = _lru.back();
+        if (e.hits() < 2 || e.is_last_dummy() || !rows_evictable_in_any_order(e)) {
+            break;
+        }
+        e.decay_hits();
+        _lru.erase(_lru.iterator_to(e));
+        _lru.push_front(e);
+        ++_stats.row_eviction_second_chances;
+    }
+    rows_entry& victim = _lru.back();
+    evict_cold_neighbours(victim);
+    victim.on_evicted(*this);
+}
+
+// Evicts the neighbours of the row, which is about to be evicted, which were read at
+// most as many times, so that the cold parts of a partition are evicted as ranges.
+// Every evicted row makes the range which ends at it incomplete, so evicting the
+// rows one by one, in LRU order, would leave the partition fragmented into short
+// continuous ranges, which reads can no longer serve from cache, while taking as
+// much memory as the rows would.
+//
+// Neighbours must also be old by recency, as a freshly populated row wasn't read
+// yet only because it had no chance to. Like in CLOCK, a row is referenced when it's
+// cached or read, and it's only old once eviction has passed over it since. Passing
+// over a referenced row clears its bit and ends the range, but the rows behind it
+// are passed over as well, so that a range cached at once is evicted on the next
+// eviction which reaches it.
+void cache_tracker::evict_cold_neighbours(rows_entry& victim) noexcept {
+    if (victim.is_last_dummy()) {
+        return;
+    }
+    auto rows = rows_evictable_in_any_order(victim);
+    if (!rows) {
+        return;
+    }
+    auto hits = victim.hits();
+    unsigned visited = 0;
+    unsigned evicted = 0;
+    auto it = std::next(mutation_partition::rows_type::iterator_to(victim));
+    bool in_range = true;
+    while (visited < max_cold_range_rows && !it->is_last_dummy() && it->hits() <= hits) {
+        rows_entry& e = *it++;
+        ++visited;
+        if (e.referenced()) {
+            e.set_referenced(false);
+            in_range = false;
+        } else if (in_range) {
+            e.on_evicted(*this);
+            ++evicted;
+        }
+    }
+    it = mutation_partition::rows_type::iterator_to(victim);
+    in_range = true;
+    while (visited < max_cold_range_rows && it != rows->begin() && std::prev(it)->hits() <= hits) {
+        rows_entry& e = *--it;
+        ++visited;
+        if (e.referenced()) {
+            e.set_referenced(false);
+            in_range = false;
+        } else if (in_range) {
+            ++it;
+            e.on_evicted(*this);
+            ++evicted;
+        }
+    }
+    _stats.row_range_evictions += evicted;
+}
+
 void cache_tracker::touch(rows_entry& e) {
+    e.on_hit();
+    e.set_referenced(true);
     if (e._lru_link.is_linked()) { // last dummy may not be linked if evicted.
         _lru.erase(_lru.iterator_to(e));
     }
@@ -214,6 +316,28 @@ void cache_tracker::on_mispopulate() noexcept {
     ++_stats.mispopulations;
 }
 
+void cache_tracker::on_partition_access(const dht::decorated_key& dk) noexcept {
+    _admission_sketch.record(dk.token().raw());
+}
+
+bool cache_tracker::should_admit(const dht::decorated_key& dk) noexcept {
+    auto evictions = _stats.partition_evictions + _stats.row_evictions;
+    if (_admission_window != _admission_sketch.resets()) {
+        _admission_window = _admission_sketch.resets();
+        _evictions_at_admission_window_start = evictions;
+    }
+    if (evictions == _evictions_at_admission_window_start
+            || _admission_sketch.estimate(dk.token().raw()) >= admission_min_frequency) {
+        return true;
+    }
+    ++_stats.partitions_not_admitted;
+    return false;
+}
+
+unsigned cache_tracker::partition_frequency(const dht::decorated_key& dk) const noexcept {
+    return _admission_sketch.estimate(dk.token().raw());
+}
+
 void cache_tracker::on_miss_already_populated() noexcept {
     ++_stats.concurrent_misses_same_key;
 }
@@ -370,7 +494,9 @@ class single_partition_populating_reader final : public flat_mutation_reader::im
         return _read_context->create_underlying(false, timeout).then([this, phase, timeout] {
           return _read_context->underlying().underlying()(timeout).then([this, phase] (auto&& mfopt) {
             if (!mfopt) {
-                if (phase == _cache.phase_of(_read_context->range().start()->value())) {
+                if (phase != _cache.phase_of(_read_context->range().start()->value())) {
+                    _cache._tracker.on_mispopulate();
+                } else if (_read_context->should_admit(_read_context->key())) {
                     _cache._read_section(_cache._tracker.region(), [this] {
                         with_allocator(_cache._tracker.allocator(), [this] {
                             dht::decorated_key dk = _read_context->range().start()->value().as_decorated_key();
@@ -387,11 +513,14 @@ class single_partition_populating_reader final : public flat_mutation_reader::im
                             });
                         });
                     });
-                } else {
-                    _cache._tracker.on_mispopulate();
                 }
                 _end_of_stream = true;
             } else if (phase == _cache.phase_of(_read_context->range().start()->value())) {
+                if (!_read_context->should_admit(mfopt->as_partition_start().key())) {
+                    _reader = read_directly_from_underlying(*_read_context);
+                    this->push_mutation_fragment(std::move(*mfopt));
+                    return;
+                }
                 _reader = _cache._read_section(_cache._tracker.region(), [&] {
                     cache_entry& e = _cache.find_or_create(mfopt->as_partition_start().key(), mfopt->as_partition_start().partition_tombstone(), phase);
                     return e.read(_cache, *_read_context, phase);
@@ -540,6 +669,12 @@ class range_populating_reader {
                 _cache.on_partition_miss();
                 const partition_start& ps = mfopt->as_partition_start();
                 const dht::decorated_key& key = ps.key();
+                _cache._tracker.on_partition_access(key);
+                if (!_read_context.should_admit(key)) {
+                    _last_key = row_cache::previous_entry_pointer(key);
+                    return make_ready_future<read_result>(
+                            read_result(read_directly_from_underlying(_read_context), std::move(mfopt)));
+                }
                 if (_reader.creation_phase() == _cache.phase_of(key)) {
                     return _cache._read_section(_cache._tracker.region(), [&] {
                         cache_entry& e = _cache.find_or_create(key,
@@ -589,6 +724,7 @@ class scanning_and_populating_reader final : public flat_mutation_reader::impl {
     flat_mutation_reader read_from_entry(cache_entry& ce) {
         _cache.upgrade_entry(ce);
         _cache.on_partition_hit();
+        _cache._tracker.on_partition_access(ce.key());
         return ce.read(_cache, *_read_context);
     }
 
@@ -758,6 +894,7 @@ row_cache::make_reader(schema_ptr s,
             return with_linearized_managed_bytes([&] {
                 dht::ring_position_comparator cmp(*_schema);
                 auto&& pos = ctx->range().start()->value();
+                _tracker.on_partition_access(pos.as_decorated_key());
                 auto i = _partitions.lower_bound(pos, cmp);
                 if (i != _partitions.end() && cmp(pos, i->position()) >= 0) {
                     cache_entry& e = *i;
@@ -773,6 +910,7 @@ row_cache::make_reader(schema_ptr s,
                 }
             });
         });
+        mr.limit_partition_readahead(slice);
 
         if (fwd == streamed_mutation::forwarding::yes) {
             return make_forwardable(std::move(mr));
@@ -784,6 +922,7 @@ row_cache::make_reader(schema_ptr s,
     tracing::trace(trace_state, "Scanning cache for range {} and slice {}",
             range, seastar::value_of([&slice] { return slice.get_all_ranges(); }));
     auto mr = make_scanning_reader(range, std::move(ctx));
+    mr.limit_partition_readahead(slice);
     if (fwd == streamed_mutation::forwarding::yes) {
         return make_forwardable(std::move(mr));
     } else {
@@ -1087,6 +1226,62 @@ void row_cache::touch(const dht::decorated_key& dk) {
  });
 }
 
+future<std::vector<dht::decorated_key>> row_cache::get_hottest_keys(size_t max_keys) {
+    struct hot_key {
+        unsigned frequency;
+        dht::decorated_key key;
+    };
+    struct state {
+        // A min-heap on frequency while it holds max_keys keys.
+        std::vector<hot_key> keys;
+        std::optional<dht::decorated_key> last;
+    };
+    auto hotter = [] (const hot_key& a, const hot_key& b) {
+        return a.frequency > b.frequency;
+    };
+    return do_with(state(), [this, max_keys, hotter] (state& st) {
+        return repeat([this, &st, max_keys, hotter] {
+            // Partitions may come and go between the batches, so each batch
+            // continues after the last key of the previous one.
+            return _read_section(_tracker.region(), [&] {
+              return with_linearized_managed_bytes([&] {
+                dht::ring_position_comparator cmp(*_schema);
+                auto it = st.last ? _partitions.lower_bound(dht::ring_position_view::for_after_key(*st.last), cmp) : _partitions.begin();
+                for (; it != _partitions.end() && !it->is_dummy_entry(); ++it) {
+                    const dht::decorated_key& dk = it->key();
+                    auto frequency = _tracker.partition_frequency(dk);
+                    if (!max_keys || st.keys.size() < max_keys) {
+                        st.keys.push_back(hot_key{frequency, dk});
+                        if (st.keys.size() == max_keys) {
+                            std::make_heap(st.keys.begin(), st.keys.end(), hotter);
+                        }
+                    } else if (frequency > st.keys.front().frequency) {
+                        std::pop_heap(st.keys.begin(), st.keys.end(), hotter);
+                        st.keys.back() = hot_key{frequency, dk};
+                        std::push_heap(st.keys.begin(), st.keys.end(), hotter);
+                    }
+                    // Also keeps the keys seen so far from being added again if
+                    // the section is retried.
+                    st.last = dk;
+                    if (need_preempt()) {
+                        return stop_iteration::no;
+                    }
+                }
+                return stop_iteration::yes;
+              });
+            });
+        }).then([&st, hotter] {
+            std::stable_sort(st.keys.begin(), st.keys.end(), hotter);
+            std::vector<dht::decorated_key> keys;
+            keys.reserve(st.keys.size());
+            for (auto& k : st.keys) {
+                keys.push_back(std::move(k.key));
+            }
+            return keys;
+        });
+    });
+}
+
 void row_cache::unlink_from_lru(const dht::decorated_key& dk) {
     _read_section(_tracker.region(), [&] {
         with_linearized_managed_bytes([&] {
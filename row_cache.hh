@@ -39,6 +39,7 @@
 #include <seastar/core/metrics_registration.hh>
 #include "mutation_cleaner.hh"
 #include "utils/double-decker.hh"
+#include "utils/frequency_sketch.hh"
 
 namespace bi = boost::intrusive;
 
@@ -197,6 +198,9 @@ class cache_tracker final {
         uint64_t reads_with_misses;
         uint64_t reads_done;
         uint64_t pinned_dirty_memory_overload;
+        uint64_t partitions_not_admitted;
+        uint64_t row_eviction_second_chances;
+        uint64_t row_range_evictions;
 
         uint64_t active_reads() const {
             return reads - reads_done;
@@ -209,8 +213,17 @@ class cache_tracker final {
     lru_type _lru;
     mutation_cleaner _garbage;
     mutation_cleaner _memtable_cleaner;
+    // Frequency of recent partition reads, consulted by reads which only admit
+    // frequently read partitions into the cache. The admission is filtered only
+    // once the cache has evicted in the current window of the sketch, so that
+    // the cache still fills up freely.
+    utils::frequency_sketch _admission_sketch;
+    uint64_t _admission_window = 0;
+    uint64_t _evictions_at_admission_window_start = 0;
 private:
     void setup_metrics();
+    void evict_from_lru() noexcept;
+    void evict_cold_neighbours(rows_entry&) noexcept;
 public:
     cache_tracker(mutation_application_stats&);
     cache_tracker();
@@ -234,6 +247,13 @@ class cache_tracker final {
     void on_row_miss() noexcept;
     void on_miss_already_populated() noexcept;
     void on_mispopulate() noexcept;
+    // Records a read of the partition, hit or miss.
+    void on_partition_access(const dht::decorated_key&) noexcept;
+    // Tells if the partition, read on a miss, should be admitted into the cache
+    // by a read which only admits frequently read partitions.
+    bool should_admit(const dht::decorated_key&) noexcept;
+    // Estimated number of recent reads of the partition.
+    unsigned partition_frequency(const dht::decorated_key&) const noexcept;
     void on_row_processed_from_memtable() noexcept { ++_stats.rows_processed_from_memtable; }
     void on_row_dropped_from_memtable() noexcept { ++_stats.rows_dropped_from_memtable; }
     void on_row_merged_from_memtable() noexcept { ++_stats.rows_merged_from_memtable; }
@@ -258,6 +278,7 @@ inline
 void cache_tracker::insert(rows_entry& entry) noexcept {
     ++_stats.row_insertions;
     ++_stats.rows;
+    entry.set_referenced(true);
     _lru.push_front(entry);
 }
 
@@ -504,6 +525,11 @@ class row_cache final {
     // Moves given partition to the front of LRU if present in cache.
     void touch(const dht::decorated_key&);
 
+    // Returns the keys of at most max_keys cached partitions, the most frequently
+    // read ones, ordered by decreasing frequency of reads. Returns the keys of all
+    // cached partitions if max_keys is 0.
+    future<std::vector<dht::decorated_key>> get_hottest_keys(size_t max_keys);
+
     // Detaches current contents of given partition from LRU, so
     // that they are not evicted by memory reclaimer.
     void unlink_from_lru(const dht::decorated_key&);
@@ -41,6 +41,7 @@
 #include "dht/token-sharding.hh"
 #include "cdc/cdc_extension.hh"
 #include "db/paxos_grace_seconds_extension.hh"
+#include "db/result_cache_extension.hh"
 
 constexpr int32_t schema::NAME_LENGTH;
 
@@ -491,6 +492,7 @@ bool operator==(const schema& x, const schema& y)
         && x._raw._type == y._raw._type
         && x._raw._gc_grace_seconds == y._raw._gc_grace_seconds
         && x.paxos_grace_seconds() == y.paxos_grace_seconds()
+        && x._raw._result_cache_ttl_ms == y._raw._result_cache_ttl_ms
         && x._raw._dc_local_read_repair_chance == y._raw._dc_local_read_repair_chance
         && x._raw._read_repair_chance == y._raw._read_repair_chance
         && x._raw._min_compaction_threshold == y._raw._min_compaction_threshold
@@ -1195,6 +1197,10 @@ schema_ptr schema_builder::build() {
         new_raw._paxos_grace_seconds =
             dynamic_pointer_cast<db::paxos_grace_seconds_extension>(it->second)->get_paxos_grace_seconds();
     }
+    if (auto it = new_raw._extensions.find(db::result_cache_extension::NAME); it != new_raw._extensions.end()) {
+        new_raw._result_cache_ttl_ms =
+            dynamic_pointer_cast<db::result_cache_extension>(it->second)->get_ttl_ms();
+    }
 
     return make_lw_shared<schema>(schema(new_raw, _view_info));
 }
@@ -1219,6 +1225,18 @@ schema_builder& schema_builder::set_paxos_grace_seconds(int32_t seconds) {
     return *this;
 }
 
+schema_builder& schema_builder::set_result_cache_ttl(int32_t ttl_ms) {
+    add_extension(db::result_cache_extension::NAME, ::make_shared<db::result_cache_extension>(ttl_ms));
+    return *this;
+}
+
+std::optional<std::chrono::milliseconds> schema::result_cache_ttl() const {
+    if (!_raw._result_cache_ttl_ms || *_raw._result_cache_ttl_ms <= 0) {
+        return std::nullopt;
+    }
+    return std::chrono::milliseconds(*_raw._result_cache_ttl_ms);
+}
+
 gc_clock::duration schema::paxos_grace_seconds() const {
     return std::chrono::duration_cast<gc_clock::duration>(
         std::chrono::seconds(
@@ -620,6 +620,7 @@ class schema final : public enable_lw_shared_from_this<schema> {
         cf_type _type = cf_type::standard;
         int32_t _gc_grace_seconds = DEFAULT_GC_GRACE_SECONDS;
         std::optional<int32_t> _paxos_grace_seconds;
+        std::optional<int32_t> _result_cache_ttl_ms;
         double _dc_local_read_repair_chance = 0.0;
         double _read_repair_chance = 0.0;
         double _crc_check_chance = 1;
@@ -769,6 +770,10 @@ class schema final : public enable_lw_shared_from_this<schema> {
 
     gc_clock::duration paxos_grace_seconds() const;
 
+    // How long the coordinator may serve cached results of this table,
+    // or std::nullopt if the table doesn't use the result cache.
+    std::optional<std::chrono::milliseconds> result_cache_ttl() const;
+
     double dc_local_read_repair_chance() const {
         return _raw._dc_local_read_repair_chance;
     }
@@ -90,6 +90,7 @@ struct schema_builder {
     }
 
     schema_builder& set_paxos_grace_seconds(int32_t seconds);
+    schema_builder& set_result_cache_ttl(int32_t ttl_ms);
 
     schema_builder& set_dc_local_read_repair_chance(double chance) {
         _raw._dc_local_read_repair_chance = chance;
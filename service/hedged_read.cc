@@ -0,0 +1,55 @@
+/*
+ * Copyright (C) 2020 ScyllaDB
+ */
+
+/*
+ * This file is part of Scylla.
+ *
+ * Scylla is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Affero General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Scylla is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU Affero General Public License
+ * along with Scylla.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <algorithm>
+
+#include "service/hedged_read.hh"
+
+namespace service {
+
+void hedge_budget::earn(double percent) {
+    _available = std::min(_available + percent / 100, _max);
+}
+
+bool hedge_budget::consume() {
+    if (_available < 1) {
+        return false;
+    }
+    _available -= 1;
+    return true;
+}
+
+void hedged_read_requests::sent(gms::inet_address ep) {
+    _pending.push_back(ep);
+}
+
+void hedged_read_requests::completed(gms::inet_address ep) {
+    auto it = std::find(_pending.begin(), _pending.end(), ep);
+    if (it != _pending.end()) {
+        _pending.erase(it);
+    }
+}
+
+bool hedged_read_requests::is_cancelled(gms::inet_address ep) const {
+    return std::find(_cancelled.begin(), _cancelled.end(), ep) != _cancelled.end();
+}
+
+}
@@ -0,0 +1,89 @@
+/*
+ * Copyright (C) 2020 ScyllaDB
+ */
+
+/*
+ * This file is part of Scylla.
+ *
+ * Scylla is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Affero General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Scylla is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU Affero General Public License
+ * along with Scylla.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#pragma once
+
+#include <utility>
+#include <vector>
+
+#include "gms/inet_address.hh"
+#include "utils/UUID.hh"
+
+namespace service {
+
+/// Bounds the speculative requests of hedged reads to a share of the reads
+/// which may be hedged. Each such read earns that share of a request, and each
+/// speculative request takes a whole one, so that speculation can't multiply
+/// the load when all replicas are slow. Up to \p max requests can be saved, for
+/// short bursts, when a replica starts stalling.
+class hedge_budget {
+    double _available = 0;
+    double _max;
+public:
+    explicit hedge_budget(double max = 100) : _max(max) { }
+
+    /// Adds \p percent percent of a request.
+    void earn(double percent);
+
+    /// Returns true, and takes a request from the budget, if there is one.
+    bool consume();
+
+    double available() const {
+        return _available;
+    }
+};
+
+/// Tracks the requests of a hedged read, from the moment they are sent until
+/// they complete, so that the ones which didn't complete once the read got
+/// its result can be cancelled on their replicas.
+class hedged_read_requests {
+    utils::UUID _id;
+    std::vector<gms::inet_address> _pending;
+    std::vector<gms::inet_address> _cancelled;
+public:
+    explicit hedged_read_requests(utils::UUID id) : _id(id) { }
+
+    /// The id the replicas register the read under.
+    const utils::UUID& id() const {
+        return _id;
+    }
+
+    void sent(gms::inet_address ep);
+    /// Called when the request completes, successfully or not.
+    void completed(gms::inet_address ep);
+
+    /// Whether the request was cancelled, its response is then ignored.
+    bool is_cancelled(gms::inet_address ep) const;
+
+    /// Cancels the requests which didn't complete, calling \p cancel with the
+    /// replica and the read id for each of them, and returns their number.
+    template<typename Func>
+    size_t cancel_pending(Func&& cancel) {
+        auto pending = std::exchange(_pending, {});
+        for (auto ep : pending) {
+            _cancelled.push_back(ep);
+            cancel(ep, _id);
+        }
+        return pending.size();
+    }
+};
+
+}
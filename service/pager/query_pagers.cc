@@ -255,8 +255,9 @@ class filtering_query_pager : public query_pager {
             _query_read_repair_decision = qr.read_repair_decision;
             qr.query_result->ensure_counts();
             _stats.rows_read_total += *qr.query_result->row_count();
-            handle_result(cql3::selection::result_set_builder::visitor(builder, *_schema, *_selection,
-                          cql3::selection::result_set_builder::restrictions_filter(_filtering_restrictions, _options, _max, _schema, _per_partition_limit, _last_pkey, _rows_fetched_for_last_partition)),
+            auto filter = cql3::selection::result_set_builder::restrictions_filter(_filtering_restrictions, _options, _max, _schema, _per_partition_limit, _last_pkey, _rows_fetched_for_last_partition);
+            filter.evaluate_batch(*qr.query_result, _cmd->slice, *_selection);
+            handle_result(cql3::selection::result_set_builder::visitor(builder, *_schema, *_selection, std::move(filter)),
                           std::move(qr.query_result), page_size, now);
         });
     }
@@ -338,9 +339,12 @@ class query_pager::query_result_visitor : public Base {
                 update_slice(*_last_pkey);
             }
 
-            row_count = v.total_rows - v.dropped_rows;
+            // Replicas grouping the rows send a row per group, and replicas filtering them leave out
+            // those which don't match, but both count the rows they read.
+            auto total_rows = _cmd->slice.sends_fewer_rows_than_read() && results->row_count() ? *results->row_count() : v.total_rows;
+            row_count = (_cmd->slice.group_by() ? total_rows : v.total_rows) - v.dropped_rows;
             _max = _max - row_count;
-            _exhausted = (v.total_rows < page_size && !results->is_short_read() && v.dropped_rows == 0) || _max == 0;
+            _exhausted = (total_rows < page_size && !results->is_short_read() && v.dropped_rows == 0) || _max == 0;
             // If per partition limit is defined, we need to accumulate rows fetched for last partition key if the key matches
             if (_cmd->slice.partition_row_limit() < query::max_rows_if_set) {
                 if (_last_pkey && v.last_pkey && _last_pkey->equal(*_schema, *v.last_pkey)) {
@@ -0,0 +1,141 @@
+/*
+ * Copyright (C) 2020 ScyllaDB
+ */
+
+/*
+ * This file is part of Scylla.
+ *
+ * Scylla is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Affero General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Scylla is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU Affero General Public License
+ * along with Scylla.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <algorithm>
+
+#include "service/replica_selector.hh"
+
+namespace service {
+
+replica_selector::request::request(replica_selector& selector, gms::inet_address ep)
+        : _selector(&selector)
+        , _ep(ep)
+        , _start(clock_type::now()) {
+    _selector->on_request(_ep);
+}
+
+replica_selector::request::request(request&& o) noexcept
+        : _selector(std::exchange(o._selector, nullptr))
+        , _ep(o._ep)
+        , _start(o._start) {
+}
+
+replica_selector::request::~request() {
+    if (_selector) {
+        // A failed request, timed out most likely, still tells how long the
+        // replica kept us waiting.
+        _selector->on_response(_ep, clock_type::now() - _start, std::nullopt);
+    }
+}
+
+void replica_selector::request::complete(std::optional<uint32_t> queue_length) {
+    if (auto selector = std::exchange(_selector, nullptr)) {
+        selector->on_response(_ep, clock_type::now() - _start, queue_length);
+    }
+}
+
+replica_selector::replica_selector(config cfg)
+        : _cfg(std::move(cfg))
+        , _next_sweep(lowres_clock::now() + _cfg.forget_after) {
+}
+
+void replica_selector::sweep() {
+    auto now = lowres_clock::now();
+    for (auto it = _loads.begin(); it != _loads.end();) {
+        if (!it->second.in_flight && now - it->second.last_request > _cfg.forget_after) {
+            it = _loads.erase(it);
+        } else {
+            ++it;
+        }
+    }
+    _next_sweep = now + _cfg.forget_after;
+}
+
+void replica_selector::on_request(gms::inet_address ep) {
+    auto now = lowres_clock::now();
+    if (now >= _next_sweep) {
+        sweep();
+    }
+    auto& load = _loads[ep];
+    ++load.in_flight;
+    load.last_request = now;
+}
+
+void replica_selector::on_response(gms::inet_address ep, clock_type::duration latency, std::optional<uint32_t> queue_length) {
+    auto it = _loads.find(ep);
+    if (it == _loads.end()) {
+        // The replica was removed while the request was in flight.
+        return;
+    }
+    auto& load = it->second;
+    if (load.in_flight) {
+        --load.in_flight;
+    }
+    auto update = [this] (double avg, double sample) {
+        return avg + _cfg.alpha * (sample - avg);
+    };
+    // Don't let a response faster than the clock resolution make the replica look idle.
+    double latency_us = std::max<int64_t>(std::chrono::duration_cast<std::chrono::microseconds>(latency).count(), 1);
+    bool first = !load.latency_us;
+    load.latency_us = first ? latency_us : update(*load.latency_us, latency_us);
+    if (queue_length) {
+        load.queue_length = first ? *queue_length : update(load.queue_length, *queue_length);
+    }
+    load.last_response = lowres_clock::now();
+}
+
+std::optional<double> replica_selector::score(gms::inet_address ep) const {
+    auto it = _loads.find(ep);
+    if (it == _loads.end() || !it->second.latency_us) {
+        return std::nullopt;
+    }
+    auto& load = it->second;
+    if (!load.in_flight && lowres_clock::now() - load.last_response > _cfg.probe_interval) {
+        return std::nullopt;
+    }
+    double q = 1 + double(load.in_flight) * _cfg.concurrency + load.queue_length;
+    return *load.latency_us * q * q * q;
+}
+
+void replica_selector::sort(std::vector<gms::inet_address>::iterator begin, std::vector<gms::inet_address>::iterator end) const {
+    if (std::distance(begin, end) < 2) {
+        return;
+    }
+    std::vector<std::pair<gms::inet_address, std::optional<double>>> scored;
+    scored.reserve(std::distance(begin, end));
+    std::transform(begin, end, std::back_inserter(scored), [this] (gms::inet_address ep) {
+        return std::make_pair(ep, score(ep));
+    });
+    // std::nullopt compares less than any score.
+    std::stable_sort(scored.begin(), scored.end(), [] (const auto& a, const auto& b) {
+        return a.second < b.second;
+    });
+    std::transform(scored.begin(), scored.end(), begin, [] (const auto& p) {
+        return p.first;
+    });
+}
+
+const replica_selector::endpoint_load* replica_selector::get_load(gms::inet_address ep) const {
+    auto it = _loads.find(ep);
+    return it == _loads.end() ? nullptr : &it->second;
+}
+
+}
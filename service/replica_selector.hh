@@ -0,0 +1,131 @@
+/*
+ * Copyright (C) 2020 ScyllaDB
+ */
+
+/*
+ * This file is part of Scylla.
+ *
+ * Scylla is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Affero General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Scylla is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU Affero General Public License
+ * along with Scylla.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#pragma once
+
+#include <chrono>
+#include <optional>
+#include <unordered_map>
+#include <vector>
+
+#include <seastar/core/lowres_clock.hh>
+
+#include "gms/inet_address.hh"
+#include "seastarx.hh"
+
+namespace service {
+
+/// Ranks the replicas of a read by how soon they are expected to respond,
+/// from what this shard observed of them: the latency of their responses, the
+/// number of requests still in flight to them, and the length of the read
+/// queue they report in their responses.
+///
+/// The score follows the ranking function of C3 (Suresh et al., NSDI '15):
+///
+///     score = latency * (1 + in_flight * concurrency + queue_length)^3
+///
+/// where latency and queue_length are exponentially weighted moving averages,
+/// and concurrency is the number of coordinators, here shards, sending requests
+/// to the replica. The cubic term penalizes replicas with long queues much more
+/// than the latency alone would, so that reads quickly move away from a replica
+/// which is compacting heavily, or whose disk stalls, and come back to it once
+/// its queue drains.
+///
+/// Replicas without a response for a while are scored as unknown, so that they
+/// are probed again instead of being avoided forever because of a past spike.
+class replica_selector {
+public:
+    using clock_type = std::chrono::steady_clock;
+
+    struct config {
+        // Weight of a new sample in the moving averages.
+        double alpha = 0.1;
+        // Number of coordinators sending requests to each replica.
+        unsigned concurrency = 1;
+        // Replicas without a response for that long are probed again.
+        lowres_clock::duration probe_interval = std::chrono::seconds(1);
+        // Replicas without a request for that long are forgotten.
+        lowres_clock::duration forget_after = std::chrono::minutes(10);
+    };
+
+    struct endpoint_load {
+        // Moving averages, unset until the first response.
+        std::optional<double> latency_us;
+        double queue_length = 0;
+        uint32_t in_flight = 0;
+        lowres_clock::time_point last_response;
+        lowres_clock::time_point last_request;
+    };
+
+    /// Tracks a request to a replica, from the moment it is sent until it
+    /// completes, or fails, if destroyed without being completed.
+    class request {
+        replica_selector* _selector;
+        gms::inet_address _ep;
+        clock_type::time_point _start;
+    public:
+        request(replica_selector& selector, gms::inet_address ep);
+        request(request&& o) noexcept;
+        request& operator=(request&&) = delete;
+        ~request();
+
+        /// Records the response, with the length of the read queue of the
+        /// replica, if it reported it.
+        void complete(std::optional<uint32_t> queue_length);
+    };
+private:
+    config _cfg;
+    std::unordered_map<gms::inet_address, endpoint_load> _loads;
+    lowres_clock::time_point _next_sweep;
+private:
+    void on_request(gms::inet_address ep);
+    void on_response(gms::inet_address ep, clock_type::duration latency, std::optional<uint32_t> queue_length);
+    // Forgets the replicas which weren't sent a request for a while.
+    void sweep();
+public:
+    explicit replica_selector(config cfg);
+
+    /// Starts tracking a request sent to the replica.
+    request start_request(gms::inet_address ep) {
+        return request(*this, ep);
+    }
+
+    /// Returns the score of the replica, the lower the better, or std::nullopt
+    /// if it is unknown.
+    std::optional<double> score(gms::inet_address ep) const;
+
+    /// Sorts the replicas by their score. Replicas with an unknown score go first,
+    /// in their original order, so that they are probed.
+    void sort(std::vector<gms::inet_address>::iterator begin, std::vector<gms::inet_address>::iterator end) const;
+
+    const endpoint_load* get_load(gms::inet_address ep) const;
+
+    /// Forgets the replica, which left the cluster.
+    void remove(gms::inet_address ep) {
+        _loads.erase(ep);
+    }
+
+    size_t size() const {
+        return _loads.size();
+    }
+};
+
+}
@@ -835,7 +835,12 @@ paxos_response_handler::begin_and_repair_paxos(client_state& cs, unsigned& conte
 
                 // If we have an in-progress accepted ballot greater than the most recent commit
                 // we know, then it's an in-progress round that needs to be completed, so do it.
-                if (in_progress &&
+                // One special case is an empty update, proposed by serial reads and by writes
+                // whose condition is not met. Completing its round would not change any data,
+                // so we neither replay it here nor learn it in storage_proxy::cas(). It is safe
+                // because the coordinator of the empty proposal completed any round it found in
+                // progress before proposing it, so no older proposal can be left to complete.
+                if (in_progress && !is_empty_update(*in_progress) &&
                         (!summary.most_recent_commit ||
                          (summary.most_recent_commit &&
                          in_progress->ballot.timestamp() > summary.most_recent_commit->ballot.timestamp()))) {
@@ -906,6 +911,15 @@ paxos_response_handler::begin_and_repair_paxos(client_state& cs, unsigned& conte
     });
 }
 
+bool paxos_response_handler::is_empty_update(const paxos::proposal& proposal) const {
+    // The update can be unfrozen only with the schema version it was created with.
+    // Updates of other versions are assumed not to be empty, so that they are replayed.
+    if (proposal.update.schema_version() != _schema->version()) {
+        return false;
+    }
+    return proposal.update.unfreeze(_schema).partition().empty();
+}
+
 template<class T> struct dependent_false : std::false_type {};
 
 // This function implement prepare stage of Paxos protocol and collects metadata needed to repair
@@ -930,7 +944,11 @@ future<paxos::prepare_summary> paxos_response_handler::prepare_ballot(utils::UUI
         }
     } request_tracker;
 
-    auto f = request_tracker.p->get_future();
+    utils::latency_counter lc;
+    lc.start();
+    auto f = request_tracker.p->get_future().finally([this, lc] () mutable {
+        _proxy->get_stats().estimated_cas_prepare.add(lc.stop().latency());
+    });
 
     // We may continue collecting prepare responses in the background after the reply is ready
     (void)do_with(paxos::prepare_summary(_live_endpoints.size()), std::move(request_tracker), shared_from_this(),
@@ -1093,7 +1111,11 @@ future<bool> paxos_response_handler::accept_proposal(lw_shared_ptr<paxos::propos
         }
     } request_tracker;
 
-    auto f = request_tracker.p->get_future();
+    utils::latency_counter lc;
+    lc.start();
+    auto f = request_tracker.p->get_future().finally([this, lc] () mutable {
+        _proxy->get_stats().estimated_cas_accept.add(lc.stop().latency());
+    });
 
     // We may continue collecting propose responses in the background after the reply is ready
     (void)do_with(std::move(request_tracker), shared_from_this(), [this, timeout_if_partially_accepted, proposal = std::move(proposal)]
@@ -1210,6 +1232,8 @@ std::ostream& operator<<(std::ostream& os, const paxos_response_handler& h) {
 future<> paxos_response_handler::learn_decision(lw_shared_ptr<paxos::proposal> decision, bool allow_hints) {
     tracing::trace(tr_state, "learn_decision: committing {} with cl={}", *decision, _cl_for_learn);
     paxos::paxos_state::logger.trace("CAS[{}] learn_decision: committing {} with cl={}", _id, *decision, _cl_for_learn);
+    utils::latency_counter lc;
+    lc.start();
     // FIXME: allow_hints is ignored. Consider if we should follow it and remove if not.
     // Right now we do not store hints for when committing decisions.
 
@@ -1245,7 +1269,9 @@ future<> paxos_response_handler::learn_decision(lw_shared_ptr<paxos::proposal> d
     std::array<std::tuple<lw_shared_ptr<paxos::proposal>, schema_ptr, shared_ptr<paxos_response_handler>, dht::token>, 1> m{std::make_tuple(std::move(decision), _schema, shared_from_this(), _key.token())};
     future<> f_lwt = _proxy->mutate_internal(std::move(m), _cl_for_learn, false, tr_state, _permit, _timeout);
 
-    return when_all_succeed(std::move(f_cdc), std::move(f_lwt)).discard_result();
+    return when_all_succeed(std::move(f_cdc), std::move(f_lwt)).discard_result().finally([this, lc] () mutable {
+        _proxy->get_stats().estimated_cas_learn.add(lc.stop().latency());
+    });
 }
 
 void paxos_response_handler::prune(utils::UUID ballot) {
@@ -1590,6 +1616,14 @@ void storage_proxy_stats::stats::register_stats() {
                        sm::description("number of speculative data read requests that were sent"),
                        {storage_proxy_stats::current_scheduling_group_label()}),
 
+        sm::make_total_operations("hedged_reads_cancelled", hedged_reads_cancelled,
+                       sm::description("number of read requests cancelled on their replicas because another replica responded first"),
+                       {storage_proxy_stats::current_scheduling_group_label()}),
+
+        sm::make_total_operations("hedged_reads_over_budget", hedged_reads_over_budget,
+                       sm::description("number of speculative read requests that were not sent because of the hedged reads budget"),
+                       {storage_proxy_stats::current_scheduling_group_label()}),
+
         sm::make_histogram("cas_read_latency", sm::description("Transactional read latency histogram"),
                 {storage_proxy_stats::current_scheduling_group_label()},
                 [this]{ return to_metrics_histogram(estimated_cas_read);}),
@@ -1598,6 +1632,18 @@ void storage_proxy_stats::stats::register_stats() {
                 {storage_proxy_stats::current_scheduling_group_label()},
                 [this]{return to_metrics_histogram(estimated_cas_write);}),
 
+        sm::make_histogram("cas_prepare_latency", sm::description("Latency histogram of the prepare round of transactional requests, as seen by the coordinator"),
+                {storage_proxy_stats::current_scheduling_group_label()},
+                [this]{return to_metrics_histogram(estimated_cas_prepare);}),
+
+        sm::make_histogram("cas_accept_latency", sm::description("Latency histogram of the accept round of transactional requests, as seen by the coordinator"),
+                {storage_proxy_stats::current_scheduling_group_label()},
+                [this]{return to_metrics_histogram(estimated_cas_accept);}),
+
+        sm::make_histogram("cas_learn_latency", sm::description("Latency histogram of the learn round of transactional requests, as seen by the coordinator"),
+                {storage_proxy_stats::current_scheduling_group_label()},
+                [this]{return to_metrics_histogram(estimated_cas_learn);}),
+
         sm::make_total_operations("cas_write_timeouts", cas_write_timeouts._count,
                        sm::description("number of transactional write request failed due to a timeout"),
                        {storage_proxy_stats::current_scheduling_group_label()}),
@@ -1655,6 +1701,10 @@ void storage_proxy_stats::stats::register_stats() {
                        sm::description("number of total paxos operations executed (reads and writes)"),
                        {storage_proxy_stats::current_scheduling_group_label()}),
 
+        sm::make_total_operations("cas_skipped_empty_learn", cas_skipped_empty_learn,
+                       sm::description("number of empty paxos decisions, of serial reads and of writes with unmet conditions, which were not learned"),
+                       {storage_proxy_stats::current_scheduling_group_label()}),
+
         sm::make_gauge("cas_foreground", cas_foreground,
                         sm::description("how many paxos operations that did not yet produce a result are running"),
                         {storage_proxy_stats::current_scheduling_group_label()}),
@@ -1697,6 +1747,10 @@ void storage_proxy_stats::stats::register_stats() {
                        sm::description("number of operations that crossed a shard boundary"),
                        {storage_proxy_stats::current_scheduling_group_label()}),
 
+        sm::make_total_operations("cancelled_reads", replica_cancelled_reads,
+                       sm::description("number of read requests aborted because their coordinator cancelled them"),
+                       {storage_proxy_stats::current_scheduling_group_label()}),
+
         sm::make_total_operations("cas_dropped_prune", cas_replica_dropped_prune,
                        sm::description("how many times a coordinator did not perfom prune after cas"),
                        {storage_proxy_stats::current_scheduling_group_label()}),
@@ -1789,6 +1843,7 @@ storage_proxy::storage_proxy(distributed<database>& db, storage_proxy::config cf
     , _background_write_throttle_threahsold(cfg.available_memory / 10)
     , _mutate_stage{"storage_proxy_mutate", &storage_proxy::do_mutate}
     , _max_view_update_backlog(max_view_update_backlog)
+    , _replica_selector(replica_selector::config{.concurrency = smp::count})
     , _view_update_handlers_list(std::make_unique<view_update_handlers_list>()) {
     namespace sm = seastar::metrics;
     _metrics.add_group(storage_proxy_stats::COORDINATOR_STATS_CATEGORY, {
@@ -2879,6 +2934,14 @@ class digest_read_resolver : public abstract_read_resolver {
     void add_wait_targets(size_t targets_count) {
         _targets_count += targets_count;
     }
+    // Stops waiting for targets whose requests were cancelled.
+    void remove_wait_targets(size_t targets_count) {
+        _targets_count -= targets_count;
+        if (!_request_failed && is_completed()) {
+            _timeout.cancel();
+            _done_promise.set_value();
+        }
+    }
     bool is_completed() {
         return response_count() == _targets_count;
     }
@@ -3376,6 +3439,8 @@ class abstract_read_executor : public enable_shared_from_this<abstract_read_exec
     std::vector<gms::inet_address> _targets;
     // Targets that were succesfully used for a data or digest request
     std::vector<gms::inet_address> _used_targets;
+    // Set for hedged reads, so that their requests can be cancelled on the replicas.
+    std::optional<hedged_read_requests> _hedged;
     promise<foreign_ptr<lw_shared_ptr<query::result>>> _result_promise;
     tracing::trace_state_ptr _trace_state;
     lw_shared_ptr<column_family> _cf;
@@ -3412,13 +3477,19 @@ class abstract_read_executor : public enable_shared_from_this<abstract_read_exec
 protected:
     future<rpc::tuple<foreign_ptr<lw_shared_ptr<reconcilable_result>>, cache_temperature>> make_mutation_data_request(lw_shared_ptr<query::read_command> cmd, gms::inet_address ep, clock_type::time_point timeout) {
         ++_proxy->get_stats().mutation_data_read_attempts.get_ep_stat(ep);
+        auto load_request = _proxy->_replica_selector.start_request(ep);
         if (fbu::is_me(ep)) {
             tracing::trace(_trace_state, "read_mutation_data: querying locally");
-            return _proxy->query_mutations_locally(_schema, cmd, _partition_range, timeout, _trace_state);
+            return _proxy->query_mutations_locally(_schema, cmd, _partition_range, timeout, _trace_state).then([load_request = std::move(load_request)] (rpc::tuple<foreign_ptr<lw_shared_ptr<reconcilable_result>>, cache_temperature, uint32_t> result_and_hit_rate) mutable {
+                auto&& [result, hit_rate, queue_length] = result_and_hit_rate;
+                load_request.complete(queue_length);
+                return rpc::tuple<foreign_ptr<lw_shared_ptr<reconcilable_result>>, cache_temperature>(std::move(result), hit_rate);
+            });
         } else {
             tracing::trace(_trace_state, "read_mutation_data: sending a message to /{}", ep);
-            return _proxy->_messaging.send_read_mutation_data(netw::messaging_service::msg_addr{ep, 0}, timeout, *cmd, _partition_range).then([this, ep](rpc::tuple<reconcilable_result, rpc::optional<cache_temperature>> result_and_hit_rate) {
-                auto&& [result, hit_rate] = result_and_hit_rate;
+            return _proxy->_messaging.send_read_mutation_data(netw::messaging_service::msg_addr{ep, 0}, timeout, *cmd, _partition_range).then([this, ep, load_request = std::move(load_request)] (rpc::tuple<reconcilable_result, rpc::optional<cache_temperature>, rpc::optional<uint32_t>> result_and_hit_rate) mutable {
+                auto&& [result, hit_rate, queue_length] = result_and_hit_rate;
+                load_request.complete(queue_length);
                 tracing::trace(_trace_state, "read_mutation_data: got response from /{}", ep);
                 return make_ready_future<rpc::tuple<foreign_ptr<lw_shared_ptr<reconcilable_result>>, cache_temperature>>(rpc::tuple(make_foreign(::make_lw_shared<reconcilable_result>(std::move(result))), hit_rate.value_or(cache_temperature::invalid())));
             });
@@ -3429,13 +3500,19 @@ class abstract_read_executor : public enable_shared_from_this<abstract_read_exec
         auto opts = want_digest
                   ? query::result_options{query::result_request::result_and_digest, digest_algorithm(*_proxy)}
                   : query::result_options{query::result_request::only_result, query::digest_algorithm::none};
+        auto load_request = _proxy->_replica_selector.start_request(ep);
         if (fbu::is_me(ep)) {
             tracing::trace(_trace_state, "read_data: querying locally");
-            return _proxy->query_result_local(_schema, _cmd, _partition_range, opts, _trace_state, timeout);
+            return _proxy->query_result_local(_schema, _cmd, _partition_range, opts, _trace_state, timeout, read_id()).then([load_request = std::move(load_request)] (rpc::tuple<foreign_ptr<lw_shared_ptr<query::result>>, cache_temperature, uint32_t> result_hit_rate) mutable {
+                auto&& [result, hit_rate, queue_length] = result_hit_rate;
+                load_request.complete(queue_length);
+                return rpc::tuple<foreign_ptr<lw_shared_ptr<query::result>>, cache_temperature>(std::move(result), hit_rate);
+            });
         } else {
             tracing::trace(_trace_state, "read_data: sending a message to /{}", ep);
-            return _proxy->_messaging.send_read_data(netw::messaging_service::msg_addr{ep, 0}, timeout, *_cmd, _partition_range, opts.digest_algo).then([this, ep](rpc::tuple<query::result, rpc::optional<cache_temperature>> result_hit_rate) {
-                auto&& [result, hit_rate] = result_hit_rate;
+            return _proxy->_messaging.send_read_data(netw::messaging_service::msg_addr{ep, 0}, timeout, *_cmd, _partition_range, opts.digest_algo, read_id()).then([this, ep, load_request = std::move(load_request)] (rpc::tuple<query::result, rpc::optional<cache_temperature>, rpc::optional<uint32_t>> result_hit_rate) mutable {
+                auto&& [result, hit_rate, queue_length] = result_hit_rate;
+                load_request.complete(queue_length);
                 tracing::trace(_trace_state, "read_data: got response from /{}", ep);
                 return make_ready_future<rpc::tuple<foreign_ptr<lw_shared_ptr<query::result>>, cache_temperature>>(rpc::tuple(make_foreign(::make_lw_shared<query::result>(std::move(result))), hit_rate.value_or(cache_temperature::invalid())));
             });
@@ -3443,16 +3520,23 @@ class abstract_read_executor : public enable_shared_from_this<abstract_read_exec
     }
     future<rpc::tuple<query::result_digest, api::timestamp_type, cache_temperature>> make_digest_request(gms::inet_address ep, clock_type::time_point timeout) {
         ++_proxy->get_stats().digest_read_attempts.get_ep_stat(ep);
+        auto load_request = _proxy->_replica_selector.start_request(ep);
         if (fbu::is_me(ep)) {
             tracing::trace(_trace_state, "read_digest: querying locally");
             return _proxy->query_result_local_digest(_schema, _cmd, _partition_range, _trace_state,
-                        timeout, digest_algorithm(*_proxy));
+                        timeout, digest_algorithm(*_proxy), read_id()).then([load_request = std::move(load_request)] (
+                    rpc::tuple<query::result_digest, api::timestamp_type, cache_temperature, uint32_t> digest_timestamp_hit_rate) mutable {
+                auto&& [digest, last_modified, hit_rate, queue_length] = digest_timestamp_hit_rate;
+                load_request.complete(queue_length);
+                return rpc::tuple<query::result_digest, api::timestamp_type, cache_temperature>(digest, last_modified, hit_rate);
+            });
         } else {
             tracing::trace(_trace_state, "read_digest: sending a message to /{}", ep);
             return _proxy->_messaging.send_read_digest(netw::messaging_service::msg_addr{ep, 0}, timeout, *_cmd,
-                        _partition_range, digest_algorithm(*_proxy)).then([this, ep] (
-                    rpc::tuple<query::result_digest, rpc::optional<api::timestamp_type>, rpc::optional<cache_temperature>> digest_timestamp_hit_rate) {
-                auto&& [d, t, hit_rate] = digest_timestamp_hit_rate;
+                        _partition_range, digest_algorithm(*_proxy), read_id()).then([this, ep, load_request = std::move(load_request)] (
+                    rpc::tuple<query::result_digest, rpc::optional<api::timestamp_type>, rpc::optional<cache_temperature>, rpc::optional<uint32_t>> digest_timestamp_hit_rate) mutable {
+                auto&& [d, t, hit_rate, queue_length] = digest_timestamp_hit_rate;
+                load_request.complete(queue_length);
                 tracing::trace(_trace_state, "read_digest: got response from /{}", ep);
                 return make_ready_future<rpc::tuple<query::result_digest, api::timestamp_type, cache_temperature>>(rpc::tuple(d, t ? t.value() : api::missing_timestamp, hit_rate.value_or(cache_temperature::invalid())));
             });
@@ -3475,7 +3559,14 @@ class abstract_read_executor : public enable_shared_from_this<abstract_read_exec
     }
     future<> make_data_requests(digest_resolver_ptr resolver, targets_iterator begin, targets_iterator end, clock_type::time_point timeout, bool want_digest) {
         return parallel_for_each(begin, end, [this, resolver = std::move(resolver), timeout, want_digest] (gms::inet_address ep) {
+            if (_hedged) {
+                _hedged->sent(ep);
+            }
             return make_data_request(ep, timeout, want_digest).then_wrapped([this, resolver, ep] (future<rpc::tuple<foreign_ptr<lw_shared_ptr<query::result>>, cache_temperature>> f) {
+                if (hedged_request_cancelled(ep)) {
+                    f.ignore_ready_future();
+                    return;
+                }
                 try {
                     auto v = f.get0();
                     _cf->set_hit_rate(ep, std::get<1>(v));
@@ -3491,7 +3582,14 @@ class abstract_read_executor : public enable_shared_from_this<abstract_read_exec
     }
     future<> make_digest_requests(digest_resolver_ptr resolver, targets_iterator begin, targets_iterator end, clock_type::time_point timeout) {
         return parallel_for_each(begin, end, [this, resolver = std::move(resolver), timeout] (gms::inet_address ep) {
+            if (_hedged) {
+                _hedged->sent(ep);
+            }
             return make_digest_request(ep, timeout).then_wrapped([this, resolver, ep] (future<rpc::tuple<query::result_digest, api::timestamp_type, cache_temperature>> f) {
+                if (hedged_request_cancelled(ep)) {
+                    f.ignore_ready_future();
+                    return;
+                }
                 try {
                     auto v = f.get0();
                     _cf->set_hit_rate(ep, std::get<2>(v));
@@ -3513,6 +3611,21 @@ class abstract_read_executor : public enable_shared_from_this<abstract_read_exec
         return when_all_succeed(std::move(f_data), std::move(f_digest)).discard_result().handle_exception([] (auto&&) { });
     }
     virtual void got_cl() {}
+    utils::UUID read_id() const {
+        return _hedged ? _hedged->id() : utils::UUID();
+    }
+    // Marks the request of a hedged read completed, and returns true if it
+    // was cancelled before.
+    bool hedged_request_cancelled(gms::inet_address ep) {
+        if (!_hedged) {
+            return false;
+        }
+        if (_hedged->is_cancelled(ep)) {
+            return true;
+        }
+        _hedged->completed(ep);
+        return false;
+    }
     uint64_t original_row_limit() const {
         return _cmd->get_row_limit();
     }
@@ -3711,11 +3824,39 @@ class always_speculating_read_executor : public abstract_read_executor {
 // this executor sends request to an additional replica after some time below timeout
 class speculating_read_executor : public abstract_read_executor {
     timer<storage_proxy::clock_type> _speculate_timer;
+    // Set for hedged reads, to stop waiting for the cancelled requests.
+    digest_resolver_ptr _hedged_resolver;
+private:
+    // Cancels the requests of a hedged read which didn't respond yet, once
+    // the others were enough for the consistency level.
+    void cancel_pending_requests() {
+        if (!_hedged_resolver) {
+            return;
+        }
+        auto cancelled = _hedged->cancel_pending([this] (gms::inet_address ep, utils::UUID read_id) {
+            _proxy->cancel_read(ep, read_id);
+        });
+        if (cancelled) {
+            _hedged_resolver->remove_wait_targets(cancelled);
+        }
+        _hedged_resolver = nullptr;
+    }
 public:
     using abstract_read_executor::abstract_read_executor;
     virtual future<> make_requests(digest_resolver_ptr resolver, storage_proxy::clock_type::time_point timeout) {
+        // Only reads from a single replica, with a single extra one, are hedged:
+        // the first response is the result.
+        if (_proxy->hedges_reads(_cl) && _block_for == 1 && _targets.size() == 2) {
+            _hedged.emplace(utils::make_random_uuid());
+            _hedged_resolver = resolver;
+            _proxy->earn_hedge_budget();
+        }
         _speculate_timer.set_callback([this, resolver, timeout] {
             if (!resolver->is_completed()) { // at the time the callback runs request may be completed already
+                if (_hedged_resolver && !_proxy->_hedge_budget.consume()) {
+                    _proxy->get_stats().hedged_reads_over_budget++;
+                    return;
+                }
                 resolver->add_wait_targets(1); // we send one more request so wait for it too
                 // FIXME: consider disabling for CL=*ONE
                 auto send_request = [&] (bool has_data) {
@@ -3757,6 +3898,7 @@ class speculating_read_executor : public abstract_read_executor {
     }
     virtual void got_cl() override {
         _speculate_timer.cancel();
+        cancel_pending_requests();
     }
     virtual void adjust_targets_for_reconciliation() override {
         _targets = used_targets();
@@ -3809,6 +3951,10 @@ ::shared_ptr<abstract_read_executor> storage_proxy::get_read_executor(lw_shared_
     // orders the list by proximity to the local endpoint.
     is_read_non_local |= !all_replicas.empty() && all_replicas.front() != utils::fb_utilities::get_broadcast_address();
 
+    if (_db.local().get_config().adaptive_replica_selection()) {
+        sort_endpoints_by_load(all_replicas);
+    }
+
     auto cf = _db.local().find_column_family(schema).shared_from_this();
     std::vector<gms::inet_address> target_replicas = db::filter_for_query(cl, ks, all_replicas, preferred_endpoints, repair_decision,
             retry_type == speculative_retry::type::NONE ? nullptr : &extra_replica,
@@ -3863,38 +4009,69 @@ ::shared_ptr<abstract_read_executor> storage_proxy::get_read_executor(lw_shared_
     }
 }
 
-future<rpc::tuple<query::result_digest, api::timestamp_type, cache_temperature>>
-storage_proxy::query_result_local_digest(schema_ptr s, lw_shared_ptr<query::read_command> cmd, const dht::partition_range& pr, tracing::trace_state_ptr trace_state, storage_proxy::clock_type::time_point timeout, query::digest_algorithm da) {
-    return query_result_local(std::move(s), std::move(cmd), pr, query::result_options::only_digest(da), std::move(trace_state), timeout).then([] (rpc::tuple<foreign_ptr<lw_shared_ptr<query::result>>, cache_temperature> result_and_hit_rate) {
-        auto&& [result, hit_rate] = result_and_hit_rate;
-        return make_ready_future<rpc::tuple<query::result_digest, api::timestamp_type, cache_temperature>>(rpc::tuple(*result->digest(), result->last_modified(), hit_rate));
+future<rpc::tuple<query::result_digest, api::timestamp_type, cache_temperature, uint32_t>>
+storage_proxy::query_result_local_digest(schema_ptr s, lw_shared_ptr<query::read_command> cmd, const dht::partition_range& pr, tracing::trace_state_ptr trace_state, storage_proxy::clock_type::time_point timeout, query::digest_algorithm da,
+        utils::UUID read_id) {
+    return query_result_local(std::move(s), std::move(cmd), pr, query::result_options::only_digest(da), std::move(trace_state), timeout, read_id).then([] (rpc::tuple<foreign_ptr<lw_shared_ptr<query::result>>, cache_temperature, uint32_t> result_and_hit_rate) {
+        auto&& [result, hit_rate, queue_length] = result_and_hit_rate;
+        return make_ready_future<rpc::tuple<query::result_digest, api::timestamp_type, cache_temperature, uint32_t>>(rpc::tuple(*result->digest(), result->last_modified(), hit_rate, queue_length));
     });
 }
 
-future<rpc::tuple<foreign_ptr<lw_shared_ptr<query::result>>, cache_temperature>>
+future<rpc::tuple<foreign_ptr<lw_shared_ptr<query::result>>, cache_temperature, uint32_t>>
 storage_proxy::query_result_local(schema_ptr s, lw_shared_ptr<query::read_command> cmd, const dht::partition_range& pr, query::result_options opts,
-                                  tracing::trace_state_ptr trace_state, storage_proxy::clock_type::time_point timeout) {
+                                  tracing::trace_state_ptr trace_state, storage_proxy::clock_type::time_point timeout, utils::UUID read_id) {
     cmd->slice.options.set_if<query::partition_slice::option::with_digest>(opts.request != query::result_request::only_result);
     if (pr.is_singular()) {
         unsigned shard = dht::shard_of(*s, pr.start()->value().token());
         get_stats().replica_cross_shard_ops += shard != this_shard_id();
-        return _db.invoke_on(shard, _read_smp_service_group, [gs = global_schema_ptr(s), prv = dht::partition_range_vector({pr}) /* FIXME: pr is copied */, cmd, opts, timeout, gt = tracing::global_trace_state_ptr(std::move(trace_state))] (database& db) mutable {
+        const bool cancellable = read_id != utils::UUID();
+        bool cancelled = false;
+        if (cancellable) {
+            _cancellable_read_shards.emplace(read_id, shard);
+            cancelled = take_cancelled_read(read_id);
+        }
+        auto f = container().invoke_on(shard, _read_smp_service_group, [gs = global_schema_ptr(s), prv = dht::partition_range_vector({pr}) /* FIXME: pr is copied */, cmd, opts, timeout, gt = tracing::global_trace_state_ptr(std::move(trace_state)), read_id, cancelled] (storage_proxy& sp) mutable {
             auto trace_state = gt.get();
             tracing::trace(trace_state, "Start querying singular range {}", prv.front());
-            return db.query(gs, *cmd, opts, prv, trace_state, timeout).then([trace_state](std::tuple<lw_shared_ptr<query::result>, cache_temperature>&& f_ht) {
+            // Registered on the shard running the read, where the abort_source can be used.
+            lw_shared_ptr<abort_source> as;
+            if (read_id != utils::UUID()) {
+                as = make_lw_shared<abort_source>();
+                sp._cancellable_reads.emplace(read_id, as);
+                // The cancellation overtook the read, on either shard.
+                if (sp.take_cancelled_read(read_id) || cancelled) {
+                    as->request_abort();
+                    sp.get_stats().replica_cancelled_reads++;
+                }
+            }
+            return sp._db.local().query(gs, *cmd, opts, prv, trace_state, timeout, as.get()).then([&sp, trace_state](std::tuple<lw_shared_ptr<query::result>, cache_temperature>&& f_ht) {
                 auto&& [f, ht] = f_ht;
                 tracing::trace(trace_state, "Querying is done");
-                return make_ready_future<rpc::tuple<foreign_ptr<lw_shared_ptr<query::result>>, cache_temperature>>(rpc::tuple(make_foreign(std::move(f)), ht));
+                return make_ready_future<rpc::tuple<foreign_ptr<lw_shared_ptr<query::result>>, cache_temperature, uint32_t>>(rpc::tuple(make_foreign(std::move(f)), ht, sp.get_read_queue_length()));
+            }).finally([&sp, read_id, as] {
+                if (as) {
+                    sp._cancellable_reads.erase(read_id);
+                }
             });
         });
+        if (!cancellable) {
+            return f;
+        }
+        return f.finally([this, read_id] {
+            _cancellable_read_shards.erase(read_id);
+        });
     } else {
         // FIXME: adjust multishard_mutation_query to accept an smp_service_group and propagate it there
         tracing::trace(trace_state, "Start querying token range {}", pr);
-        return query_nonsingular_mutations_locally(s, cmd, {pr}, trace_state, timeout).then([s, cmd, opts, trace_state = std::move(trace_state)] (rpc::tuple<foreign_ptr<lw_shared_ptr<reconcilable_result>>, cache_temperature>&& r_ht) {
+        return query_nonsingular_mutations_locally(s, cmd, {pr}, trace_state, timeout).then([this, s, cmd, opts, trace_state = std::move(trace_state)] (rpc::tuple<foreign_ptr<lw_shared_ptr<reconcilable_result>>, cache_temperature>&& r_ht) {
             auto&& [r, ht] = r_ht;
             tracing::trace(trace_state, "Querying is done");
-            return make_ready_future<rpc::tuple<foreign_ptr<lw_shared_ptr<query::result>>, cache_temperature>>(
-                    rpc::tuple(::make_foreign(::make_lw_shared<query::result>(to_data_query_result(*r, s, cmd->slice,  cmd->get_row_limit(), cmd->partition_limit, opts))), ht));
+            auto result = ::make_lw_shared<query::result>(to_data_query_result(*r, s, cmd->slice,  cmd->get_row_limit(), cmd->partition_limit, opts));
+            _db.local().account_filtered_rows(cmd->slice, *result);
+            // The read ran on all shards, report the queue of this one.
+            return make_ready_future<rpc::tuple<foreign_ptr<lw_shared_ptr<query::result>>, cache_temperature, uint32_t>>(
+                    rpc::tuple(::make_foreign(std::move(result)), ht, get_read_queue_length()));
         });
     }
 }
@@ -3951,7 +4128,7 @@ storage_proxy::query_singular(lw_shared_ptr<query::read_command> cmd,
         get_stats().reads_coordinator_outside_replica_set++;
     }
 
-    query::result_merger merger(cmd->get_row_limit(), cmd->partition_limit);
+    query::result_merger merger(cmd->get_row_limit(), cmd->partition_limit, cmd->slice.sends_fewer_rows_than_read());
     merger.reserve(exec.size());
 
     auto used_replicas = make_lw_shared<replicas_per_token_range>();
@@ -4106,7 +4283,7 @@ storage_proxy::query_partition_key_range_concurrent(storage_proxy::clock_type::t
         ranges_per_exec.emplace(exec.back().get(), std::move(merged_ranges));
     }
 
-    query::result_merger merger(cmd->get_row_limit(), cmd->partition_limit);
+    query::result_merger merger(cmd->get_row_limit(), cmd->partition_limit, cmd->slice.sends_fewer_rows_than_read());
     merger.reserve(exec.size());
 
     auto f = ::map_reduce(exec.begin(), exec.end(), [timeout] (::shared_ptr<abstract_read_executor>& rex) {
@@ -4189,6 +4366,7 @@ storage_proxy::query_partition_key_range(lw_shared_ptr<query::read_command> cmd,
     // to the lambda below.
     const auto row_limit = cmd->get_row_limit();
     const auto partition_limit = cmd->partition_limit;
+    const bool reduced = cmd->slice.sends_fewer_rows_than_read();
 
     return query_partition_key_range_concurrent(query_options.timeout(*this),
             std::move(results),
@@ -4200,12 +4378,12 @@ storage_proxy::query_partition_key_range(lw_shared_ptr<query::read_command> cmd,
             cmd->get_row_limit(),
             cmd->partition_limit,
             std::move(query_options.preferred_replicas),
-            std::move(query_options.permit)).then([row_limit, partition_limit] (
+            std::move(query_options.permit)).then([row_limit, partition_limit, reduced] (
                     query_partition_key_range_concurrent_result result) {
         std::vector<foreign_ptr<lw_shared_ptr<query::result>>>& results = result.result;
         replicas_per_token_range& used_replicas = result.replicas;
 
-        query::result_merger merger(row_limit, partition_limit);
+        query::result_merger merger(row_limit, partition_limit, reduced);
         merger.reserve(results.size());
 
         for (auto&& r: results) {
@@ -4471,6 +4649,7 @@ future<bool> storage_proxy::cas(schema_ptr schema, shared_ptr<cas_request> reque
                     return f.then([this, handler, schema, cmd, request, ballot = v.ballot, &contentions, write] (auto&& qr) {
                         auto mutation = request->apply(std::move(qr), cmd->slice, utils::UUID_gen::micros_timestamp(ballot));
                         bool condition_met = true;
+                        bool empty_proposal = !mutation;
                         if (!mutation) {
                             if (write) {
                                 paxos::paxos_state::logger.debug("CAS[{}] precondition does not match current values", handler->id());
@@ -4483,8 +4662,6 @@ future<bool> storage_proxy::cas(schema_ptr schema, shared_ptr<cas_request> reque
                             // in https://github.com/scylladb/scylla/issues/6299
                             // Let's use empty mutation as a value and proceed
                             mutation.emplace(handler->schema(), handler->key());
-                            // since the value we are writing is dummy we may use minimal consistency level for learn
-                            handler->set_cl_for_learn(db::consistency_level::ANY);
                         } else {
                             paxos::paxos_state::logger.debug("CAS[{}] precondition is met; proposing client-requested updates for {}",
                                 handler->id(), ballot);
@@ -4493,7 +4670,17 @@ future<bool> storage_proxy::cas(schema_ptr schema, shared_ptr<cas_request> reque
 
                         auto proposal = make_lw_shared<paxos::proposal>(ballot, freeze(*mutation));
 
-                        return handler->accept_proposal(proposal).then([handler, proposal, &contentions, condition_met] (bool is_accepted) mutable {
+                        return handler->accept_proposal(proposal).then([this, handler, proposal, &contentions, condition_met, empty_proposal] (bool is_accepted) mutable {
+                            if (is_accepted && empty_proposal) {
+                                // Learning an empty decision would not change any data, so we skip it,
+                                // together with the prune which would follow it, and reply to the client
+                                // right after the accept round. This is safe because begin_and_repair_paxos()
+                                // doesn't replay accepted empty proposals either.
+                                paxos::paxos_state::logger.debug("CAS[{}] successful, the empty decision is not learned", handler->id());
+                                tracing::trace(handler->tr_state, "CAS successful, the empty decision is not learned");
+                                ++get_stats().cas_skipped_empty_learn;
+                                return make_ready_future<std::optional<bool>>(condition_met);
+                            }
                             if (is_accepted) {
                                 // The majority (aka a QUORUM) has promised the coordinator to
                                 // accept the action associated with the computed ballot.
@@ -4581,6 +4768,87 @@ void storage_proxy::sort_endpoints_by_proximity(std::vector<gms::inet_address>&
     }
 }
 
+void storage_proxy::sort_endpoints_by_load(std::vector<gms::inet_address>& eps) const {
+    // Keep the proximity order of datacenters, only reorder the replicas within each.
+    auto& snitch = locator::i_endpoint_snitch::get_local_snitch_ptr();
+    auto begin = eps.begin();
+    while (begin != eps.end()) {
+        auto dc = snitch->get_datacenter(*begin);
+        auto end = std::find_if(begin, eps.end(), [&] (gms::inet_address ep) {
+            return snitch->get_datacenter(ep) != dc;
+        });
+        _replica_selector.sort(begin, end);
+        begin = end;
+    }
+}
+
+bool storage_proxy::hedges_reads(db::consistency_level cl) const {
+    return (cl == db::consistency_level::ONE || cl == db::consistency_level::LOCAL_ONE)
+            && _db.local().get_config().hedged_reads_budget_percent() > 0
+            && _features.cluster_supports_read_cancel();
+}
+
+void storage_proxy::earn_hedge_budget() {
+    _hedge_budget.earn(_db.local().get_config().hedged_reads_budget_percent());
+}
+
+void storage_proxy::cancel_read(gms::inet_address ep, utils::UUID read_id) {
+    get_stats().hedged_reads_cancelled++;
+    if (fbu::is_me(ep)) {
+        cancel_local_read(read_id);
+    } else {
+        // Waited on indirectly.
+        (void)_messaging.send_read_cancel(netw::messaging_service::msg_addr{ep, 0}, read_id).handle_exception([ep] (std::exception_ptr eptr) {
+            slogger.debug("Failed to cancel a read on {}: {}", ep, eptr);
+        });
+    }
+}
+
+void storage_proxy::cancel_local_read(utils::UUID read_id) {
+    auto it = _cancellable_read_shards.find(read_id);
+    if (it == _cancellable_read_shards.end()) {
+        // Completed already, or not received yet.
+        add_cancelled_read(read_id);
+        return;
+    }
+    // Waited on indirectly.
+    (void)container().invoke_on(it->second, _read_smp_service_group, [read_id] (storage_proxy& sp) {
+        sp.abort_local_read(read_id);
+    });
+}
+
+void storage_proxy::abort_local_read(utils::UUID read_id) {
+    auto it = _cancellable_reads.find(read_id);
+    if (it == _cancellable_reads.end()) {
+        // Completed already, or not registered yet.
+        add_cancelled_read(read_id);
+    } else if (!it->second->abort_requested()) {
+        it->second->request_abort();
+        get_stats().replica_cancelled_reads++;
+    }
+}
+
+void storage_proxy::add_cancelled_read(utils::UUID read_id) {
+    auto now = clock_type::now();
+    auto ttl = std::chrono::milliseconds(_db.local().get_config().read_request_timeout_in_ms());
+    while (!_cancelled_reads_expiry.empty() && _cancelled_reads_expiry.front().first + ttl < now) {
+        _cancelled_reads.erase(_cancelled_reads_expiry.front().second);
+        _cancelled_reads_expiry.pop_front();
+    }
+    if (_cancelled_reads.insert(read_id).second) {
+        _cancelled_reads_expiry.emplace_back(now, read_id);
+    }
+}
+
+bool storage_proxy::take_cancelled_read(utils::UUID read_id) {
+    // The id stays in the expiry queue, and is dropped from it in time.
+    return _cancelled_reads.erase(read_id);
+}
+
+uint32_t storage_proxy::get_read_queue_length() {
+    return _db.local().get_reader_concurrency_semaphore().waiters();
+}
+
 std::vector<gms::inet_address> storage_proxy::get_live_sorted_endpoints(keyspace& ks, const dht::token& token) const {
     auto eps = get_live_endpoints(ks, token);
     sort_endpoints_by_proximity(eps);
@@ -4917,7 +5185,7 @@ void storage_proxy::init_messaging_service() {
             return netw::messaging_service::no_wait();
         });
     });
-    ms.register_read_data([] (const rpc::client_info& cinfo, rpc::opt_time_point t, query::read_command cmd, ::compat::wrapping_partition_range pr, rpc::optional<query::digest_algorithm> oda) {
+    ms.register_read_data([] (const rpc::client_info& cinfo, rpc::opt_time_point t, query::read_command cmd, ::compat::wrapping_partition_range pr, rpc::optional<query::digest_algorithm> oda, rpc::optional<utils::UUID> read_id) {
         tracing::trace_state_ptr trace_state_ptr;
         auto src_addr = netw::messaging_service::get_source(cinfo);
         if (cmd.trace_info) {
@@ -4929,10 +5197,10 @@ void storage_proxy::init_messaging_service() {
         if (!cmd.max_result_size) {
             cmd.max_result_size.emplace(cinfo.retrieve_auxiliary<uint64_t>("max_result_size"));
         }
-        return do_with(std::move(pr), get_local_shared_storage_proxy(), std::move(trace_state_ptr), [&cinfo, cmd = make_lw_shared<query::read_command>(std::move(cmd)), src_addr = std::move(src_addr), da, t] (::compat::wrapping_partition_range& pr, shared_ptr<storage_proxy>& p, tracing::trace_state_ptr& trace_state_ptr) mutable {
+        return do_with(std::move(pr), get_local_shared_storage_proxy(), std::move(trace_state_ptr), [&cinfo, cmd = make_lw_shared<query::read_command>(std::move(cmd)), src_addr = std::move(src_addr), da, t, read_id = read_id.value_or(utils::UUID())] (::compat::wrapping_partition_range& pr, shared_ptr<storage_proxy>& p, tracing::trace_state_ptr& trace_state_ptr) mutable {
             p->get_stats().replica_data_reads++;
             auto src_ip = src_addr.addr;
-            return get_schema_for_read(cmd->schema_version, std::move(src_addr), p->_messaging).then([cmd, da, &pr, &p, &trace_state_ptr, t] (schema_ptr s) {
+            return get_schema_for_read(cmd->schema_version, std::move(src_addr), p->_messaging).then([cmd, da, &pr, &p, &trace_state_ptr, t, read_id] (schema_ptr s) {
                 auto pr2 = ::compat::unwrap(std::move(pr), *s);
                 if (pr2.second) {
                     // this function assumes singular queries but doesn't validate
@@ -4942,7 +5210,7 @@ void storage_proxy::init_messaging_service() {
                 opts.digest_algo = da;
                 opts.request = da == query::digest_algorithm::none ? query::result_request::only_result : query::result_request::result_and_digest;
                 auto timeout = t ? *t : db::no_timeout;
-                return p->query_result_local(std::move(s), cmd, std::move(pr2.first), opts, trace_state_ptr, timeout);
+                return p->query_result_local(std::move(s), cmd, std::move(pr2.first), opts, trace_state_ptr, timeout, read_id);
             }).finally([&trace_state_ptr, src_ip] () mutable {
                 tracing::trace(trace_state_ptr, "read_data handling is done, sending a response to /{}", src_ip);
             });
@@ -4979,7 +5247,7 @@ void storage_proxy::init_messaging_service() {
             });
         });
     });
-    ms.register_read_digest([] (const rpc::client_info& cinfo, rpc::opt_time_point t, query::read_command cmd, ::compat::wrapping_partition_range pr, rpc::optional<query::digest_algorithm> oda) {
+    ms.register_read_digest([] (const rpc::client_info& cinfo, rpc::opt_time_point t, query::read_command cmd, ::compat::wrapping_partition_range pr, rpc::optional<query::digest_algorithm> oda, rpc::optional<utils::UUID> read_id) {
         tracing::trace_state_ptr trace_state_ptr;
         auto src_addr = netw::messaging_service::get_source(cinfo);
         if (cmd.trace_info) {
@@ -4991,22 +5259,28 @@ void storage_proxy::init_messaging_service() {
         if (!cmd.max_result_size) {
             cmd.max_result_size.emplace(cinfo.retrieve_auxiliary<uint64_t>("max_result_size"));
         }
-        return do_with(std::move(pr), get_local_shared_storage_proxy(), std::move(trace_state_ptr), [&cinfo, cmd = make_lw_shared<query::read_command>(std::move(cmd)), src_addr = std::move(src_addr), da, t] (::compat::wrapping_partition_range& pr, shared_ptr<storage_proxy>& p, tracing::trace_state_ptr& trace_state_ptr) mutable {
+        return do_with(std::move(pr), get_local_shared_storage_proxy(), std::move(trace_state_ptr), [&cinfo, cmd = make_lw_shared<query::read_command>(std::move(cmd)), src_addr = std::move(src_addr), da, t, read_id = read_id.value_or(utils::UUID())] (::compat::wrapping_partition_range& pr, shared_ptr<storage_proxy>& p, tracing::trace_state_ptr& trace_state_ptr) mutable {
             p->get_stats().replica_digest_reads++;
             auto src_ip = src_addr.addr;
-            return get_schema_for_read(cmd->schema_version, std::move(src_addr), p->_messaging).then([cmd, &pr, &p, &trace_state_ptr, t, da] (schema_ptr s) {
+            return get_schema_for_read(cmd->schema_version, std::move(src_addr), p->_messaging).then([cmd, &pr, &p, &trace_state_ptr, t, da, read_id] (schema_ptr s) {
                 auto pr2 = ::compat::unwrap(std::move(pr), *s);
                 if (pr2.second) {
                     // this function assumes singular queries but doesn't validate
                     throw std::runtime_error("READ_DIGEST called with wrapping range");
                 }
                 auto timeout = t ? *t : db::no_timeout;
-                return p->query_result_local_digest(std::move(s), cmd, std::move(pr2.first), trace_state_ptr, timeout, da);
+                return p->query_result_local_digest(std::move(s), cmd, std::move(pr2.first), trace_state_ptr, timeout, da, read_id);
             }).finally([&trace_state_ptr, src_ip] () mutable {
                 tracing::trace(trace_state_ptr, "read_digest handling is done, sending a response to /{}", src_ip);
             });
         });
     });
+    ms.register_read_cancel([this] (const rpc::client_info& cinfo, utils::UUID read_id) {
+        // Sent over the same connection as the read, so it is received by the
+        // shard which dispatched it to the shard owning its partition.
+        cancel_local_read(read_id);
+        return make_ready_future<seastar::rpc::no_wait_type>(netw::messaging_service::no_wait());
+    });
     ms.register_truncate([this](sstring ksname, sstring cfname) {
         return do_with(utils::make_joinpoint([] { return db_clock::now();}),
                         [this, ksname, cfname](auto& tsf) {
@@ -5130,6 +5404,7 @@ future<> storage_proxy::uninit_messaging_service() {
         ms.unregister_read_data(),
         ms.unregister_read_mutation_data(),
         ms.unregister_read_digest(),
+        ms.unregister_read_cancel(),
         ms.unregister_truncate(),
         ms.unregister_paxos_prepare(),
         ms.unregister_paxos_accept(),
@@ -5139,32 +5414,39 @@ future<> storage_proxy::uninit_messaging_service() {
 
 }
 
-future<rpc::tuple<foreign_ptr<lw_shared_ptr<reconcilable_result>>, cache_temperature>>
+future<rpc::tuple<foreign_ptr<lw_shared_ptr<reconcilable_result>>, cache_temperature, uint32_t>>
 storage_proxy::query_mutations_locally(schema_ptr s, lw_shared_ptr<query::read_command> cmd, const dht::partition_range& pr,
                                        storage_proxy::clock_type::time_point timeout,
                                        tracing::trace_state_ptr trace_state) {
     if (pr.is_singular()) {
         unsigned shard = dht::shard_of(*s, pr.start()->value().token());
         get_stats().replica_cross_shard_ops += shard != this_shard_id();
-        return _db.invoke_on(shard, _read_smp_service_group, [cmd, &pr, gs=global_schema_ptr(s), timeout, gt = tracing::global_trace_state_ptr(std::move(trace_state))] (database& db) mutable {
-            return db.query_mutations(gs, *cmd, pr, gt, timeout).then([] (std::tuple<reconcilable_result, cache_temperature> result_ht) {
+        return container().invoke_on(shard, _read_smp_service_group, [cmd, &pr, gs=global_schema_ptr(s), timeout, gt = tracing::global_trace_state_ptr(std::move(trace_state))] (storage_proxy& sp) mutable {
+            return sp._db.local().query_mutations(gs, *cmd, pr, gt, timeout).then([&sp] (std::tuple<reconcilable_result, cache_temperature> result_ht) {
                 auto&& [result, ht] = result_ht;
-                return make_ready_future<rpc::tuple<foreign_ptr<lw_shared_ptr<reconcilable_result>>, cache_temperature>>(rpc::tuple(make_foreign(make_lw_shared<reconcilable_result>(std::move(result))), ht));
+                return make_ready_future<rpc::tuple<foreign_ptr<lw_shared_ptr<reconcilable_result>>, cache_temperature, uint32_t>>(rpc::tuple(make_foreign(make_lw_shared<reconcilable_result>(std::move(result))), ht, sp.get_read_queue_length()));
             });
         });
     } else {
-        return query_nonsingular_mutations_locally(std::move(s), std::move(cmd), {pr}, std::move(trace_state), timeout);
+        return query_nonsingular_mutations_locally(std::move(s), std::move(cmd), {pr}, std::move(trace_state), timeout).then([this] (rpc::tuple<foreign_ptr<lw_shared_ptr<reconcilable_result>>, cache_temperature> result_ht) {
+            auto&& [result, ht] = result_ht;
+            // The read ran on all shards, report the queue of this one.
+            return rpc::tuple<foreign_ptr<lw_shared_ptr<reconcilable_result>>, cache_temperature, uint32_t>(std::move(result), ht, get_read_queue_length());
+        });
     }
 }
 
-future<rpc::tuple<foreign_ptr<lw_shared_ptr<reconcilable_result>>, cache_temperature>>
+future<rpc::tuple<foreign_ptr<lw_shared_ptr<reconcilable_result>>, cache_temperature, uint32_t>>
 storage_proxy::query_mutations_locally(schema_ptr s, lw_shared_ptr<query::read_command> cmd, const ::compat::one_or_two_partition_ranges& pr,
                                        storage_proxy::clock_type::time_point timeout,
                                        tracing::trace_state_ptr trace_state) {
     if (!pr.second) {
         return query_mutations_locally(std::move(s), std::move(cmd), pr.first, timeout, std::move(trace_state));
     } else {
-        return query_nonsingular_mutations_locally(std::move(s), std::move(cmd), pr, std::move(trace_state), timeout);
+        return query_nonsingular_mutations_locally(std::move(s), std::move(cmd), pr, std::move(trace_state), timeout).then([this] (rpc::tuple<foreign_ptr<lw_shared_ptr<reconcilable_result>>, cache_temperature> result_ht) {
+            auto&& [result, ht] = result_ht;
+            return rpc::tuple<foreign_ptr<lw_shared_ptr<reconcilable_result>>, cache_temperature, uint32_t>(std::move(result), ht, get_read_queue_length());
+        });
     }
 }
 
@@ -5192,7 +5474,9 @@ void storage_proxy::allow_replaying_hints() noexcept {
 
 void storage_proxy::on_join_cluster(const gms::inet_address& endpoint) {};
 
-void storage_proxy::on_leave_cluster(const gms::inet_address& endpoint) {};
+void storage_proxy::on_leave_cluster(const gms::inet_address& endpoint) {
+    _replica_selector.remove(endpoint);
+}
 
 void storage_proxy::on_up(const gms::inet_address& endpoint) {};
 
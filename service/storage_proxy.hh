@@ -41,6 +41,9 @@
 
 #pragma once
 
+#include <deque>
+#include <unordered_set>
+
 #include "database_fwd.hh"
 #include "query-request.hh"
 #include "query-result.hh"
@@ -48,12 +51,15 @@
 #include <seastar/core/distributed.hh>
 #include <seastar/core/execution_stage.hh>
 #include <seastar/core/scheduling_specific.hh>
+#include <seastar/core/abort_source.hh>
 #include "db/consistency_level_type.hh"
 #include "db/read_repair_decision.hh"
 #include "db/write_type.hh"
 #include "db/hints/manager.hh"
 #include "db/view/view_update_backlog.hh"
 #include "db/view/node_view_update_backlog.hh"
+#include "service/replica_selector.hh"
+#include "service/hedged_read.hh"
 #include "utils/histogram.hh"
 #include "utils/estimated_histogram.hh"
 #include "tracing/trace_state.hh"
@@ -289,6 +295,18 @@ class storage_proxy : public seastar::async_sharded_service<storage_proxy>, publ
             lw_shared_ptr<cdc::operation_result_tracker>> _mutate_stage;
     db::view::node_update_backlog& _max_view_update_backlog;
     std::unordered_map<gms::inet_address, view_update_backlog_timestamped> _view_update_backlogs;
+    // Observed load of the replicas, to pick the ones to read from.
+    replica_selector _replica_selector;
+    // Hedged requests this shard may send, earned by reads which may be hedged.
+    hedge_budget _hedge_budget;
+    // Reads which their coordinator may cancel, by the read id it sent with them.
+    std::unordered_map<utils::UUID, lw_shared_ptr<abort_source>> _cancellable_reads;
+    // Shards running the cancellable reads this shard received, by read id.
+    std::unordered_map<utils::UUID, unsigned> _cancellable_read_shards;
+    // Reads cancelled before they were registered above, aborted as soon as
+    // they are. Kept for the read timeout, in the order they were cancelled.
+    std::unordered_set<utils::UUID> _cancelled_reads;
+    std::deque<std::pair<clock_type::time_point, utils::UUID>> _cancelled_reads_expiry;
 
     //NOTICE(sarna): This opaque pointer is here just to avoid moving write handler class definitions from .cc to .hh. It's slow path.
     class view_update_handlers_list;
@@ -357,14 +375,18 @@ class storage_proxy : public seastar::async_sharded_service<storage_proxy>, publ
             const std::vector<gms::inet_address>& preferred_endpoints,
             bool& is_bounced_read,
             service_permit permit);
-    future<rpc::tuple<foreign_ptr<lw_shared_ptr<query::result>>, cache_temperature>> query_result_local(schema_ptr, lw_shared_ptr<query::read_command> cmd, const dht::partition_range& pr,
+    // The local query functions also return the length of the read queue of the shard
+    // which ran the read (see get_read_queue_length()).
+    future<rpc::tuple<foreign_ptr<lw_shared_ptr<query::result>>, cache_temperature, uint32_t>> query_result_local(schema_ptr, lw_shared_ptr<query::read_command> cmd, const dht::partition_range& pr,
                                                                            query::result_options opts,
                                                                            tracing::trace_state_ptr trace_state,
-                                                                           clock_type::time_point timeout);
-    future<rpc::tuple<query::result_digest, api::timestamp_type, cache_temperature>> query_result_local_digest(schema_ptr, lw_shared_ptr<query::read_command> cmd, const dht::partition_range& pr,
+                                                                           clock_type::time_point timeout,
+                                                                           utils::UUID read_id = {});
+    future<rpc::tuple<query::result_digest, api::timestamp_type, cache_temperature, uint32_t>> query_result_local_digest(schema_ptr, lw_shared_ptr<query::read_command> cmd, const dht::partition_range& pr,
                                                                                                    tracing::trace_state_ptr trace_state,
                                                                                                    clock_type::time_point timeout,
-                                                                                                   query::digest_algorithm da);
+                                                                                                   query::digest_algorithm da,
+                                                                                                   utils::UUID read_id = {});
     future<coordinator_query_result> query_partition_key_range(lw_shared_ptr<query::read_command> cmd,
             dht::partition_range_vector partition_ranges,
             db::consistency_level cl,
@@ -432,6 +454,28 @@ class storage_proxy : public seastar::async_sharded_service<storage_proxy>, publ
 
     db::view::update_backlog get_backlog_of(gms::inet_address) const;
 
+    // The length of the read queue this replica reports to coordinators: the number
+    // of reads waiting for this shard's reader concurrency semaphore.
+    uint32_t get_read_queue_length();
+
+    // Orders the replicas of each datacenter by their observed load.
+    void sort_endpoints_by_load(std::vector<gms::inet_address>& eps) const;
+
+    // Whether reads at the consistency level are hedged: their speculative requests
+    // are bounded by the hedge budget, and the losing requests are cancelled.
+    bool hedges_reads(db::consistency_level cl) const;
+    // Adds the share of a hedged request a read which may be hedged is allowed.
+    void earn_hedge_budget();
+    // Asks the replica to abort the read with the given id, if it didn't complete yet.
+    void cancel_read(gms::inet_address ep, utils::UUID read_id);
+    // Aborts the read with the given id received by this shard, on the shard running it.
+    void cancel_local_read(utils::UUID read_id);
+    // Aborts the read with the given id running on this shard, if any.
+    void abort_local_read(utils::UUID read_id);
+    void add_cancelled_read(utils::UUID read_id);
+    // Whether the read was cancelled before it was registered. Forgets the cancellation.
+    bool take_cancelled_read(utils::UUID read_id);
+
     template<typename Range>
     future<> mutate_counters(Range&& mutations, db::consistency_level cl, tracing::trace_state_ptr tr_state, service_permit permit, clock_type::time_point timeout);
 public:
@@ -555,13 +599,15 @@ class storage_proxy : public seastar::async_sharded_service<storage_proxy>, publ
         db::consistency_level cl,
         coordinator_query_options optional_params);
 
-    future<rpc::tuple<foreign_ptr<lw_shared_ptr<reconcilable_result>>, cache_temperature>> query_mutations_locally(
+    // Also returns the length of the read queue of the shard which ran the read, or of
+    // this shard, for reads of several shards (see get_read_queue_length()).
+    future<rpc::tuple<foreign_ptr<lw_shared_ptr<reconcilable_result>>, cache_temperature, uint32_t>> query_mutations_locally(
         schema_ptr, lw_shared_ptr<query::read_command> cmd, const dht::partition_range&,
         clock_type::time_point timeout,
         tracing::trace_state_ptr trace_state = nullptr);
 
 
-    future<rpc::tuple<foreign_ptr<lw_shared_ptr<reconcilable_result>>, cache_temperature>> query_mutations_locally(
+    future<rpc::tuple<foreign_ptr<lw_shared_ptr<reconcilable_result>>, cache_temperature, uint32_t>> query_mutations_locally(
         schema_ptr, lw_shared_ptr<query::read_command> cmd, const ::compat::one_or_two_partition_ranges&,
         clock_type::time_point timeout,
         tracing::trace_state_ptr trace_state = nullptr);
@@ -668,6 +714,11 @@ class paxos_response_handler : public enable_shared_from_this<paxos_response_han
     // max pruning operations to run in parralel
     static constexpr uint16_t pruning_limit = 1000;
 
+private:
+    // Whether the update of the proposal changes nothing, like the ones proposed
+    // by serial reads and by writes whose condition is not met.
+    bool is_empty_update(const paxos::proposal& proposal) const;
+
 public:
     tracing::trace_state_ptr tr_state;
 
@@ -728,9 +779,6 @@ class paxos_response_handler : public enable_shared_from_this<paxos_response_han
     const partition_key& key() const {
         return _key.key();
     }
-    void set_cl_for_learn(db::consistency_level cl) {
-        _cl_for_learn = cl;
-    }
     // this is called with an id of a replica that replied to learn request
     // adn returns true when quorum of such requests are accumulated
     bool learned(gms::inet_address ep);
@@ -167,6 +167,9 @@ struct stats : public write_stats {
 
     uint64_t replica_cross_shard_ops = 0;
 
+    // number of reads aborted as a replica because the coordinator cancelled them
+    uint64_t replica_cancelled_reads = 0;
+
     utils::timed_rate_moving_average_and_histogram read;
     utils::timed_rate_moving_average_and_histogram range;
     utils::time_estimated_histogram estimated_read;
@@ -175,16 +178,24 @@ struct stats : public write_stats {
     utils::timed_rate_moving_average_and_histogram cas_read;
     utils::time_estimated_histogram estimated_cas_read;
 
+    // Latency of each round of the Paxos protocol, as seen by the coordinator
+    utils::time_estimated_histogram estimated_cas_prepare;
+    utils::time_estimated_histogram estimated_cas_accept;
+    utils::time_estimated_histogram estimated_cas_learn;
+
     uint64_t reads = 0;
     uint64_t foreground_reads = 0; // client still waits for the read
     uint64_t read_retries = 0; // read is retried with new limit
     uint64_t speculative_digest_reads = 0;
     uint64_t speculative_data_reads = 0;
+    uint64_t hedged_reads_cancelled = 0; // requests cancelled on replicas after another one responded
+    uint64_t hedged_reads_over_budget = 0; // speculative requests not sent because of the hedge budget
 
     uint64_t cas_read_unfinished_commit = 0;
     uint64_t cas_foreground = 0;
     uint64_t cas_total_running = 0;
     uint64_t cas_total_operations = 0;
+    uint64_t cas_skipped_empty_learn = 0;
 
     // Data read attempts
     split_stats data_read_attempts;
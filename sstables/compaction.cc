@@ -1346,7 +1346,12 @@ class resharding_compaction final : public compaction {
 
     }
 
+    // Output is segregated by shard first and then by the strategy itself, so that strategies
+    // like TWCS get their resharded SSTables already split by time window.
     reader_consumer make_interposer_consumer(reader_consumer end_consumer) override {
+        if (_cf.get_compaction_strategy().use_interposer_consumer()) {
+            end_consumer = _cf.get_compaction_strategy().make_interposer_consumer(_ms_metadata, std::move(end_consumer));
+        }
         return [this, end_consumer = std::move(end_consumer)] (flat_mutation_reader reader) mutable -> future<> {
             return mutation_writer::segregate_by_shard(std::move(reader), std::move(end_consumer));
         };
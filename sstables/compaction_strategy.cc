@@ -473,6 +473,13 @@ compaction_strategy_impl::get_reshaping_job(std::vector<shared_sstable> input, s
     return compaction_descriptor();
 }
 
+compaction_descriptor
+compaction_strategy_impl::get_resharding_job(std::vector<shared_sstable> input, const ::io_priority_class& iop, bool whole_group) {
+    compaction_descriptor desc(std::move(input), std::optional<sstables::sstable_set>(), iop);
+    desc.options = compaction_options::make_reshard();
+    return desc;
+}
+
 std::optional<sstring> compaction_strategy_impl::get_value(const std::map<sstring, sstring>& options, const sstring& name) {
     auto it = options.find(name);
     if (it == options.end()) {
@@ -1048,6 +1055,19 @@ compaction_strategy::get_reshaping_job(std::vector<shared_sstable> input, schema
     return _compaction_strategy_impl->get_reshaping_job(std::move(input), schema, iop, mode);
 }
 
+sstables::compaction_descriptor
+compaction_strategy::get_resharding_job(std::vector<shared_sstable> input, const ::io_priority_class& iop, bool whole_group) {
+    return _compaction_strategy_impl->get_resharding_job(std::move(input), iop, whole_group);
+}
+
+uint32_t compaction_strategy::resharding_group(const shared_sstable& sst) const {
+    return _compaction_strategy_impl->resharding_group(sst->get_sstable_level());
+}
+
+uint32_t compaction_strategy::resharding_group(const foreign_sstable_open_info& info) const {
+    return _compaction_strategy_impl->resharding_group(info.sstable_level);
+}
+
 uint64_t compaction_strategy::adjust_partition_estimate(const mutation_source_metadata& ms_meta, uint64_t partition_estimate) {
     return _compaction_strategy_impl->adjust_partition_estimate(ms_meta, partition_estimate);
 }
@@ -87,5 +87,11 @@ class compaction_strategy_impl {
     }
 
     virtual compaction_descriptor get_reshaping_job(std::vector<shared_sstable> input, schema_ptr schema, const ::io_priority_class& iop, reshape_mode mode);
+
+    virtual compaction_descriptor get_resharding_job(std::vector<shared_sstable> input, const ::io_priority_class& iop, bool whole_group);
+
+    virtual uint32_t resharding_group(uint32_t sstable_level) const {
+        return 0;
+    }
 };
 }
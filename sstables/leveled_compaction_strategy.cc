@@ -212,4 +212,23 @@ leveled_compaction_strategy::get_reshaping_job(std::vector<shared_sstable> input
    return compaction_descriptor();
 }
 
+compaction_descriptor
+leveled_compaction_strategy::get_resharding_job(std::vector<shared_sstable> input, const ::io_priority_class& iop, bool whole_group) {
+    // Input is grouped by level, so the output for each shard is a run made of disjoint fragments
+    // of the input level. Keep the level and emit properly sized fragments, so that the run can
+    // stay where it is instead of being recompacted from level 0.
+    // The whole level is resharded by a single shard (see compaction_strategy::resharding_group()),
+    // but if it was split into several jobs there, each of them emits a run for the same shard and
+    // those runs overlap, which levels above 0 don't allow, so the output goes to level 0.
+    uint32_t level = 0;
+    if (whole_group) {
+        for (auto& sst : input) {
+            level = std::max(level, resharding_group(sst->get_sstable_level()));
+        }
+    }
+    compaction_descriptor desc(std::move(input), std::optional<sstables::sstable_set>(), iop, level, _max_sstable_size_in_mb * 1024 * 1024);
+    desc.options = compaction_options::make_reshard();
+    return desc;
+}
+
 }
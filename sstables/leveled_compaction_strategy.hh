@@ -63,6 +63,12 @@ class leveled_compaction_strategy : public compaction_strategy_impl {
     }
 
     virtual compaction_descriptor get_reshaping_job(std::vector<shared_sstable> input, schema_ptr schema, const ::io_priority_class& iop, reshape_mode mode) override;
+
+    virtual compaction_descriptor get_resharding_job(std::vector<shared_sstable> input, const ::io_priority_class& iop, bool whole_group) override;
+
+    virtual uint32_t resharding_group(uint32_t sstable_level) const override {
+        return std::min(sstable_level, uint32_t(leveled_manifest::MAX_LEVELS - 1));
+    }
 };
 
 }
@@ -61,6 +61,7 @@ struct foreign_sstable_open_info {
     sstable_version_types version;
     sstable_format_types format;
     uint64_t uncompressed_data_size;
+    uint32_t sstable_level;
 };
 
 }
@@ -178,7 +178,9 @@ class sstable_mutation_reader : public mp_row_consumer_reader {
             });
         })
         , _fwd(fwd)
-        , _monitor(mon) { }
+        , _monitor(mon) {
+        limit_partition_readahead(slice);
+    }
     sstable_mutation_reader(shared_sstable sst,
                             schema_ptr schema,
                             reader_permit permit,
@@ -215,7 +217,9 @@ class sstable_mutation_reader : public mp_row_consumer_reader {
             });
         })
         , _fwd(fwd)
-        , _monitor(mon) { }
+        , _monitor(mon) {
+        limit_partition_readahead(slice);
+    }
 
     // Reference to _consumer is passed to data_consume_rows() in the constructor so we must not allow move/copy
     sstable_mutation_reader(sstable_mutation_reader&&) = delete;
@@ -0,0 +1,269 @@
+/*
+ * Copyright (C) 2020 ScyllaDB
+ *
+ */
+
+/*
+ * This file is part of Scylla.
+ *
+ * Scylla is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Affero General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Scylla is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Scylla.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <boost/range/algorithm/find.hpp>
+
+#include <seastar/core/thread.hh>
+#include <seastar/util/defer.hh>
+
+#include "log.hh"
+#include "reader_concurrency_semaphore.hh"
+#include "sstables/partition_locator.hh"
+#include "sstables/sstables.hh"
+#include "service/priority_manager.hh"
+
+namespace sstables {
+
+static logging::logger pllogger("partition_locator");
+
+bool partition_locator::candidates::contains(slot_id slot) const {
+    return boost::find(_slots, slot) != _slots.end();
+}
+
+uint64_t partition_locator::fingerprint(const utils::hashed_key& hk) {
+    return hk.hash()[0] >> slot_bits;
+}
+
+void partition_locator::do_insert(utils::chunked_vector<uint64_t>& entries, uint64_t entry) {
+    auto mask = entries.size() - 1;
+    auto pos = (entry >> slot_bits) & mask;
+    while (entries[pos]) {
+        pos = (pos + 1) & mask;
+    }
+    entries[pos] = entry;
+}
+
+// Capacity of a table holding the entries, at least the given capacity.
+size_t partition_locator::capacity_for(size_t entries, size_t capacity) {
+    // Keep the load factor at or below 3/4, so that probe sequences stay short
+    while (entries * 4 > capacity * 3) {
+        capacity *= 2;
+    }
+    return capacity;
+}
+
+size_t partition_locator::bookkeeping_memory() const {
+    // Nodes of _slots hold the value and the pointer to the next node.
+    return _slots.bucket_count() * sizeof(void*)
+        + _slots.size() * (sizeof(std::pair<const sstable*, slot_id>) + sizeof(void*))
+        + _slot_entries.capacity() * sizeof(uint32_t)
+        + _released.capacity() / 8
+        + _free_slots.capacity() * sizeof(slot_id)
+        + _pending.bucket_count() * sizeof(void*)
+        + _pending.size() * (sizeof(const sstable*) + sizeof(void*));
+}
+
+// Must be called from a seastar thread.
+bool partition_locator::reserve(size_t new_entries) {
+    auto capacity = capacity_for(_used - _dead + new_entries, std::max(min_capacity, _entries.size()));
+    if (!fits(capacity)) {
+        return false;
+    }
+    if (capacity != _entries.size() || (_used + new_entries) * 4 > capacity * 3) {
+        rebuild(capacity);
+    }
+    return true;
+}
+
+bool partition_locator::fits(size_t capacity) const {
+    return capacity * sizeof(uint64_t) + bookkeeping_memory() <= _memory_limit;
+}
+
+// Must be called from a seastar thread. Lookups keep using the old table
+// until the new one is built. Only the slots released before the rebuild
+// starts are dropped; the ones released while it yields keep their entries
+// until the next rebuild.
+void partition_locator::rebuild(size_t capacity) {
+    auto dropped = _released;
+    utils::chunked_vector<uint64_t> entries;
+    entries.reserve(capacity);
+    _transient_memory += entries.memory_size();
+    auto reset_transient_memory = defer([this, size = entries.memory_size()] { _transient_memory -= size; });
+    while (entries.size() < capacity) {
+        entries.push_back(0);
+        seastar::thread::maybe_yield();
+    }
+    size_t used = 0;
+    for (size_t i = 0; i < _entries.size(); ++i) {
+        auto entry = _entries[i];
+        if (entry && !dropped[entry & (max_slots - 1)]) {
+            do_insert(entries, entry);
+            ++used;
+        }
+        seastar::thread::maybe_yield();
+    }
+    _entries = std::move(entries);
+    _used = used;
+    for (slot_id slot = 1; slot < dropped.size(); ++slot) {
+        if (dropped[slot]) {
+            _dead -= _slot_entries[slot];
+            _released[slot] = false;
+            _slot_entries[slot] = 0;
+            _free_slots.push_back(slot);
+        }
+    }
+}
+
+std::optional<partition_locator::slot_id> partition_locator::allocate_slot() {
+    if (!_free_slots.empty()) {
+        auto slot = _free_slots.back();
+        _free_slots.pop_back();
+        return slot;
+    }
+    if (_slot_entries.empty()) {
+        // Slot 0 is never used, so that an entry is never 0, which marks empty entries.
+        _slot_entries.push_back(0);
+        _released.push_back(false);
+    }
+    if (_slot_entries.size() == max_slots) {
+        return std::nullopt;
+    }
+    _slot_entries.push_back(0);
+    _released.push_back(false);
+    return slot_id(_slot_entries.size() - 1);
+}
+
+future<> partition_locator::insert(shared_sstable sst, utils::chunked_vector<utils::hashed_key> hashes) {
+    return seastar::async([this, sst = std::move(sst), hashes = std::move(hashes)] {
+        _transient_memory += hashes.memory_size();
+        auto reset_transient_memory = defer([this, size = hashes.memory_size()] { _transient_memory -= size; });
+        if (!reserve(hashes.size())) {
+            pllogger.debug("Not indexing {}: {} keys don't fit in the memory limit of {} bytes", sst->get_filename(), hashes.size(), _memory_limit);
+            ++_stats.rejected_sstables;
+            return;
+        }
+        auto slot = allocate_slot();
+        if (!slot) {
+            pllogger.debug("Not indexing {}: all slots are in use", sst->get_filename());
+            ++_stats.rejected_sstables;
+            return;
+        }
+        // The slot isn't registered until all entries are in, so lookups
+        // racing with the insertion keep consulting the sstable's filter.
+        for (auto& hk : hashes) {
+            do_insert(_entries, (fingerprint(hk) << slot_bits) | *slot);
+            ++_used;
+            seastar::thread::maybe_yield();
+        }
+        _slot_entries[*slot] = hashes.size();
+        _slots.emplace(sst.get(), *slot);
+        ++_stats.indexed_sstables;
+    });
+}
+
+void partition_locator::set_memory_limit(size_t memory_limit) {
+    _memory_limit = memory_limit;
+    if (!_entries.empty() && !fits(_entries.size())) {
+        shrink();
+    }
+}
+
+void partition_locator::shrink() {
+    std::vector<std::pair<const sstable*, slot_id>> slots(_slots.begin(), _slots.end());
+    std::sort(slots.begin(), slots.end(), [this] (const auto& a, const auto& b) {
+        return _slot_entries[a.second] > _slot_entries[b.second];
+    });
+    for (auto& [sst, slot] : slots) {
+        if (fits(capacity_for(_used - _dead))) {
+            break;
+        }
+        pllogger.debug("Evicting {} to fit in the memory limit of {} bytes", sst->get_filename(), _memory_limit);
+        _slots.erase(sst);
+        release(slot);
+    }
+    // Registered as background job.
+    (void)with_semaphore(_indexing_sem, 1, [this] {
+        return seastar::async([this] {
+            // Drops the entries of the evicted sstables, and the whole table if none are left.
+            auto live = _used - _dead;
+            rebuild(live ? capacity_for(live) : 0);
+        });
+    }).handle_exception([op = background_jobs().start()] (std::exception_ptr ep) {
+        pllogger.warn("Failed to shrink the partition locator: {}", ep);
+    });
+}
+
+void partition_locator::add(shared_sstable sst, reader_concurrency_semaphore& sem) {
+    if (!enabled() || sst->is_shared() || _slots.contains(sst.get()) || _pending.contains(sst.get())) {
+        return;
+    }
+    // Don't bother reading the index of an sstable which won't fit anyway.
+    if ((_used - _dead + sst->get_estimated_key_count()) * sizeof(uint64_t) * 4 / 3 > _memory_limit) {
+        ++_stats.rejected_sstables;
+        return;
+    }
+    _pending.insert(sst.get());
+    // Registered as background job.
+    (void)with_semaphore(_indexing_sem, 1, [this, sst, permit = sem.make_permit()] () mutable {
+        return sst->get_partition_key_hashes(std::move(permit), service::get_local_compaction_priority()).then([this, sst] (utils::chunked_vector<utils::hashed_key> hashes) {
+            _pending.erase(sst.get());
+            return insert(sst, std::move(hashes));
+        });
+    }).handle_exception([this, sst, op = background_jobs().start()] (std::exception_ptr ep) {
+        _pending.erase(sst.get());
+        pllogger.warn("Failed to index {}: {}", sst->get_filename(), ep);
+    });
+}
+
+void partition_locator::remove(const sstable& sst) noexcept {
+    auto it = _slots.find(&sst);
+    if (it == _slots.end()) {
+        return;
+    }
+    auto slot = it->second;
+    _slots.erase(it);
+    release(slot);
+}
+
+void partition_locator::release(slot_id slot) noexcept {
+    _released[slot] = true;
+    _dead += _slot_entries[slot];
+    --_stats.indexed_sstables;
+}
+
+partition_locator::candidates partition_locator::lookup(const utils::hashed_key& hk) {
+    candidates c;
+    ++_stats.lookups;
+    if (_entries.empty()) {
+        return c;
+    }
+    auto fp = fingerprint(hk);
+    auto mask = _entries.size() - 1;
+    for (auto pos = fp & mask; _entries[pos]; pos = (pos + 1) & mask) {
+        auto entry = _entries[pos];
+        auto slot = slot_id(entry & (max_slots - 1));
+        if ((entry >> slot_bits) == fp && !_released[slot]) {
+            c._slots.push_back(slot);
+        }
+    }
+    return c;
+}
+
+std::optional<bool> partition_locator::may_contain(const candidates& c, const sstable& sst) const {
+    auto it = _slots.find(&sst);
+    if (it == _slots.end()) {
+        return std::nullopt;
+    }
+    return c.contains(it->second);
+}
+
+}
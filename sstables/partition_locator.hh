@@ -0,0 +1,153 @@
+/*
+ * Copyright (C) 2020 ScyllaDB
+ *
+ */
+
+/*
+ * This file is part of Scylla.
+ *
+ * Scylla is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Affero General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Scylla is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Scylla.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#pragma once
+
+#include <cstdint>
+#include <optional>
+#include <unordered_map>
+#include <unordered_set>
+#include <vector>
+
+#include <seastar/core/semaphore.hh>
+
+#include "seastarx.hh"
+#include "sstables/shared_sstable.hh"
+#include "utils/chunked_vector.hh"
+#include "utils/i_filter.hh"
+#include "utils/small_vector.hh"
+
+class reader_concurrency_semaphore;
+
+namespace sstables {
+
+// Maps partition key hashes to the sstables of this shard which may contain
+// the key, so that a single-partition read finds its candidates with one
+// lookup instead of probing the filter of every overlapping sstable.
+//
+// Each indexed sstable gets a slot. The index is an open addressing table
+// of 64-bit entries, each holding a 48-bit fingerprint of the key hash and
+// the 16-bit slot of an sstable containing the key. The position of an
+// entry is derived from its fingerprint, so the table can be rebuilt
+// without the original keys. Lookups may return false positives
+// (fingerprint collisions), never false negatives.
+//
+// Sstables are indexed in the background by reading their partition index.
+// Until that is done, or when indexing them would exceed the memory limit,
+// they are not indexed and callers fall back to the sstable's own filter.
+// Entries of released sstables stay in the table, ignored, until enough
+// of them accumulate to be worth a rebuild. Lowering the memory limit evicts
+// sstables, largest first, until the table fits, and shrinks it.
+//
+// Inserting the keys of an sstable and rebuilding the table yield, and the
+// table is stored in chunks, so that indexing a large sstable neither stalls
+// the reactor nor needs a large contiguous allocation.
+class partition_locator {
+public:
+    using slot_id = uint16_t;
+
+    // Slots of the sstables which may contain a key, as returned by lookup().
+    class candidates {
+        utils::small_vector<slot_id, 4> _slots;
+        friend class partition_locator;
+    public:
+        bool contains(slot_id slot) const;
+    };
+
+    struct stats {
+        uint64_t indexed_sstables = 0;
+        uint64_t rejected_sstables = 0;
+        uint64_t lookups = 0;
+    };
+private:
+    static constexpr unsigned slot_bits = 16;
+    static constexpr size_t max_slots = size_t(1) << slot_bits;
+    static constexpr size_t min_capacity = 1024;
+
+    size_t _memory_limit;
+    utils::chunked_vector<uint64_t> _entries;
+    // Entries in _entries, including the ones of released slots.
+    size_t _used = 0;
+    // Entries of released slots.
+    size_t _dead = 0;
+    std::unordered_map<const sstable*, slot_id> _slots;
+    // Number of entries per slot, used to account released entries.
+    std::vector<uint32_t> _slot_entries;
+    std::vector<bool> _released;
+    std::vector<slot_id> _free_slots;
+    // Sstables whose index is being read.
+    std::unordered_set<const sstable*> _pending;
+    // Serializes indexing, so that only one insert() modifies the table at a time.
+    semaphore _indexing_sem{1};
+    // Memory of the keys being inserted and of the table being rebuilt.
+    size_t _transient_memory = 0;
+    stats _stats;
+private:
+    static uint64_t fingerprint(const utils::hashed_key& hk);
+    static void do_insert(utils::chunked_vector<uint64_t>& entries, uint64_t entry);
+    static size_t capacity_for(size_t entries, size_t capacity = min_capacity);
+    size_t bookkeeping_memory() const;
+    bool fits(size_t capacity) const;
+    void release(slot_id slot) noexcept;
+    void shrink();
+    bool reserve(size_t new_entries);
+    void rebuild(size_t capacity);
+    std::optional<slot_id> allocate_slot();
+    future<> insert(shared_sstable sst, utils::chunked_vector<utils::hashed_key> hashes);
+public:
+    explicit partition_locator(size_t memory_limit = 0) : _memory_limit(memory_limit) { }
+
+    bool enabled() const {
+        return _memory_limit != 0;
+    }
+    // Evicts sstables right away if the table doesn't fit in the new limit,
+    // and shrinks the table in the background.
+    void set_memory_limit(size_t memory_limit);
+
+    // Starts indexing the sstable in the background, if it isn't indexed
+    // already, reading its partition index under the semaphore. The sstable
+    // is indexed once, regardless of how many tables' sstable sets it
+    // belongs to.
+    void add(shared_sstable sst, reader_concurrency_semaphore& sem);
+
+    // Releases the slot of the sstable. Called when the sstable is destroyed.
+    void remove(const sstable& sst) noexcept;
+
+    candidates lookup(const utils::hashed_key& hk);
+
+    // Returns whether the sstable may contain the key, or std::nullopt
+    // if the sstable isn't indexed and its filter has to be consulted.
+    std::optional<bool> may_contain(const candidates& c, const sstable& sst) const;
+
+    // Memory of the table, of the slot bookkeeping and of an indexing in progress.
+    size_t memory_used() const {
+        return _entries.memory_size() + bookkeeping_memory() + _transient_memory;
+    }
+    size_t memory_limit() const {
+        return _memory_limit;
+    }
+    const stats& get_stats() const {
+        return _stats;
+    }
+};
+
+}
@@ -371,29 +371,48 @@ sstable_directory::reshard(sstable_info_vector shared_info, compaction_manager&
     auto num_jobs = (shared_info.size() + max_sstables_per_job - 1) / max_sstables_per_job;
     auto sstables_per_job = shared_info.size() / num_jobs;
 
-    using reshard_buckets = std::vector<std::vector<sstables::shared_sstable>>;
-    return do_with(reshard_buckets(1), [this, &cm, &table, sstables_per_job, iop, num_jobs, creator = std::move(creator), shared_info = std::move(shared_info)] (reshard_buckets& buckets) mutable {
-        return parallel_for_each(shared_info, [this, sstables_per_job, num_jobs, &buckets] (sstables::foreign_sstable_open_info& info) {
+    struct reshard_job {
+        std::vector<sstables::shared_sstable> sstables;
+        // Whether the job holds all SSTables of its resharding group.
+        bool whole_group = true;
+    };
+    using reshard_buckets = std::vector<reshard_job>;
+    using sstable_groups = std::map<uint32_t, std::vector<sstables::shared_sstable>>;
+    return do_with(reshard_buckets(), sstable_groups(), [this, &cm, &table, sstables_per_job, iop, creator = std::move(creator), shared_info = std::move(shared_info)] (reshard_buckets& buckets, sstable_groups& groups) mutable {
+        return parallel_for_each(shared_info, [this, &table, &groups] (sstables::foreign_sstable_open_info& info) {
             auto sst = _sstable_object_from_existing_sstable(_sstable_dir, info.generation, info.version, info.format);
-            return sst->load(std::move(info)).then([this, &buckets, sstables_per_job, num_jobs, sst = std::move(sst)] () mutable {
-                // Last bucket gets leftover SSTables
-                if ((buckets.back().size() >= sstables_per_job) && (buckets.size() < num_jobs)) {
-                    buckets.emplace_back();
-                }
-                buckets.back().push_back(std::move(sst));
+            return sst->load(std::move(info)).then([&table, &groups, sst = std::move(sst)] () mutable {
+                // SSTables are only resharded together with SSTables of the same group, so that the
+                // compaction strategy can emit the output directly in its final layout.
+                groups[table.get_compaction_strategy().resharding_group(sst)].push_back(std::move(sst));
             });
-        }).then([this, &cm, &table, &buckets, iop, creator = std::move(creator)] () mutable {
+        }).then([this, &cm, &table, &buckets, &groups, sstables_per_job, iop, creator = std::move(creator)] () mutable {
+            for (auto& [group, sstlist] : groups) {
+                dirlog.debug("Resharding group {} has {} SSTables", group, sstlist.size());
+                auto first = buckets.size();
+                buckets.emplace_back();
+                for (auto& sst : sstlist) {
+                    if (buckets.back().sstables.size() >= sstables_per_job) {
+                        buckets.emplace_back();
+                    }
+                    buckets.back().sstables.push_back(std::move(sst));
+                }
+                if (buckets.size() - first > 1) {
+                    for (auto i = first; i < buckets.size(); ++i) {
+                        buckets[i].whole_group = false;
+                    }
+                }
+            }
             // There is a semaphore inside the compaction manager in run_resharding_jobs. So we
             // parallel_for_each so the statistics about pending jobs are updated to reflect all
             // jobs. But only one will run in parallel at a time
-            return parallel_for_each(buckets, [this, iop, &cm, &table, creator = std::move(creator)] (std::vector<sstables::shared_sstable>& sstlist) mutable {
-                return cm.run_custom_job(&table, "resharding", [this, iop, &cm, &table, creator, &sstlist] () {
-                    sstables::compaction_descriptor desc(sstlist, {}, iop);
-                    desc.options = sstables::compaction_options::make_reshard();
+            return parallel_for_each(buckets, [this, iop, &cm, &table, creator = std::move(creator)] (reshard_job& job) mutable {
+                return cm.run_custom_job(&table, "resharding", [this, iop, &cm, &table, creator, &job] () {
+                    auto desc = table.get_compaction_strategy().get_resharding_job(job.sstables, iop, job.whole_group);
                     desc.creator = std::move(creator);
 
-                    return sstables::compact_sstables(std::move(desc), table).then([this, &sstlist] (sstables::compaction_info result) {
-                        return when_all_succeed(collect_output_sstables_from_resharding(std::move(result.new_sstables)), remove_input_sstables_from_resharding(sstlist)).discard_result();
+                    return sstables::compact_sstables(std::move(desc), table).then([this, &job] (sstables::compaction_info result) {
+                        return when_all_succeed(collect_output_sstables_from_resharding(std::move(result.new_sstables)), remove_input_sstables_from_resharding(job.sstables)).discard_result();
                     });
                 });
             });
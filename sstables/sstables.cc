@@ -1471,7 +1471,7 @@ future<> sstable::load(sstables::foreign_sstable_open_info info) noexcept {
 future<foreign_sstable_open_info> sstable::get_open_info() & {
     return _components.copy().then([this] (auto c) mutable {
         return foreign_sstable_open_info{std::move(c), this->get_shards_for_this_sstable(), _data_file.dup(), _index_file.dup(),
-            _generation, _version, _format, data_size()};
+            _generation, _version, _format, data_size(), get_sstable_level()};
     });
 }
 
@@ -2980,6 +2980,7 @@ int sstable::compare_by_max_timestamp(const sstable& other) const {
 }
 
 sstable::~sstable() {
+    _manager.get_partition_locator().remove(*this);
     if (_index_file) {
         // Registered as background job.
         (void)_index_file.close().handle_exception([save = _index_file, op = background_jobs().start()] (auto ep) {
@@ -3317,6 +3318,34 @@ future<bool> sstable::has_partition_key(const utils::hashed_key& hk, const dht::
     });
 }
 
+future<utils::chunked_vector<utils::hashed_key>> sstable::get_partition_key_hashes(reader_permit permit, const io_priority_class& pc) {
+    shared_sstable s = shared_from_this();
+    auto index_ptr = std::make_unique<sstables::index_reader>(s, std::move(permit), pc, tracing::trace_state_ptr());
+    auto& index = *index_ptr;
+    utils::chunked_vector<utils::hashed_key> hashes;
+    hashes.reserve(get_estimated_key_count());
+    return do_with(std::move(hashes), [&index] (utils::chunked_vector<utils::hashed_key>& hashes) {
+        return index.advance_to(dht::ring_position_view::min()).then([&index, &hashes] {
+            return repeat([&index, &hashes] {
+                if (index.eof()) {
+                    return make_ready_future<stop_iteration>(stop_iteration::yes);
+                }
+                auto f = index.partition_data_ready() ? make_ready_future<>() : index.read_partition_data();
+                return f.then([&index, &hashes] {
+                    hashes.push_back(utils::make_hashed_key(bytes_view(index.partition_key())));
+                    return index.advance_to_next_partition();
+                }).then([] {
+                    return stop_iteration::no;
+                });
+            });
+        }).then([&hashes] {
+            return std::move(hashes);
+        });
+    }).finally([index_ptr = std::move(index_ptr), s] () mutable {
+        return index_ptr->close().finally([index_ptr = std::move(index_ptr)] {});
+    });
+}
+
 utils::hashed_key sstable::make_hashed_key(const schema& s, const partition_key& key) {
     return utils::make_hashed_key(static_cast<bytes_view>(key::from_partition_key(s, key)));
 }
@@ -740,6 +740,12 @@ class sstable : public enable_lw_shared_from_this<sstable> {
      */
     future<bool> has_partition_key(const utils::hashed_key& hk, const dht::decorated_key& dk);
 
+    /*!
+     * \brief hashes of all partition keys in the sstable, read from the
+     * partition index, in the same form the filter uses.
+     */
+    future<utils::chunked_vector<utils::hashed_key>> get_partition_key_hashes(reader_permit permit, const io_priority_class& pc);
+
     bool filter_has_key(utils::hashed_key key) const {
         return _components->filter->is_present(key);
     }
@@ -32,6 +32,7 @@
 #include "sstables/shared_sstable.hh"
 #include "sstables/version.hh"
 #include "sstables/component_type.hh"
+#include "sstables/partition_locator.hh"
 
 namespace db {
 
@@ -60,6 +61,7 @@ class sstables_manager {
     // if an sstable format was chosen earlier (and this choice was persisted
     // in the system table).
     sstable_version_types _format = sstable_version_types::mc;
+    partition_locator _partition_locator;
 
 public:
     explicit sstables_manager(db::large_data_handler& large_data_handler, const db::config& dbcfg, gms::feature_service& feat);
@@ -80,6 +82,8 @@ class sstables_manager {
     void set_format(sstable_version_types format) { _format = format; }
     sstables::sstable::version_types get_highest_supported_format() const { return _format; }
 
+    partition_locator& get_partition_locator() { return _partition_locator; }
+
 private:
     db::large_data_handler& get_large_data_handler() const {
         return _large_data_handler;
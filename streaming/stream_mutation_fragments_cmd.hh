@@ -29,6 +29,8 @@ enum class stream_mutation_fragments_cmd : uint8_t {
     error,
     mutation_fragment_data,
     end_of_stream,
+    // Several fragments packed with pack_frozen_mutation_fragments()
+    mutation_fragment_batch,
 };
 
 
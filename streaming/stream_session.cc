@@ -67,6 +67,9 @@
 #include "../db/view/view_update_generator.hh"
 #include "mutation_source_metadata.hh"
 #include "streaming/stream_mutation_fragments_cmd.hh"
+#include "streaming/stream_sstable_files_cmd.hh"
+#include "streaming/stream_sstable_files.hh"
+#include <deque>
 
 namespace streaming {
 
@@ -140,9 +143,16 @@ void stream_session::init_messaging_service_handler(netw::messaging_service& ms)
             struct stream_mutation_fragments_cmd_status {
                 bool got_cmd = false;
                 bool got_end_of_stream = false;
+                // Remaining fragments of the last received mutation_fragment_batch
+                std::deque<frozen_mutation_fragment> batched;
             };
             auto cmd_status = make_lw_shared<stream_mutation_fragments_cmd_status>();
             auto get_next_mutation_fragment = [source, plan_id, from, s, cmd_status] () mutable {
+                if (!cmd_status->batched.empty()) {
+                    auto mf = cmd_status->batched.front().unfreeze(*s);
+                    cmd_status->batched.pop_front();
+                    return make_ready_future<mutation_fragment_opt>(std::move(mf));
+                }
                 return source().then([plan_id, from, s, cmd_status] (std::optional<std::tuple<frozen_mutation_fragment, rpc::optional<stream_mutation_fragments_cmd>>> opt) mutable {
                     if (opt) {
                         auto cmd = std::get<1>(*opt);
@@ -151,6 +161,17 @@ void stream_session::init_messaging_service_handler(netw::messaging_service& ms)
                             switch (*cmd) {
                             case stream_mutation_fragments_cmd::mutation_fragment_data:
                                 break;
+                            case stream_mutation_fragments_cmd::mutation_fragment_batch: {
+                                frozen_mutation_fragment& batch = std::get<0>(*opt);
+                                streaming::get_local_stream_manager().update_progress(plan_id, from.addr, progress_info::direction::IN, batch.representation().size());
+                                auto fragments = unpack_frozen_mutation_fragments(batch);
+                                if (fragments.empty()) {
+                                    return make_exception_future<mutation_fragment_opt>(std::runtime_error("Sender sent empty mutation_fragment_batch"));
+                                }
+                                auto mf = fragments.front().unfreeze(*s);
+                                std::move(fragments.begin() + 1, fragments.end(), std::back_inserter(cmd_status->batched));
+                                return make_ready_future<mutation_fragment_opt>(std::move(mf));
+                            }
                             case stream_mutation_fragments_cmd::error:
                                 return make_exception_future<mutation_fragment_opt>(std::runtime_error("Sender failed"));
                             case stream_mutation_fragments_cmd::end_of_stream:
@@ -233,6 +254,59 @@ void stream_session::init_messaging_service_handler(netw::messaging_service& ms)
             return make_ready_future<rpc::sink<int>>(sink);
         });
     });
+    ms.register_stream_sstable_files([&ms] (const rpc::client_info& cinfo, UUID plan_id, UUID schema_id, UUID cf_id, unsigned dst_shard, sstring sstable_version, stream_reason reason, rpc::source<sstring, bytes, stream_sstable_files_cmd> source) {
+        auto from = netw::messaging_service::get_source(cinfo);
+        sslog.trace("Got stream_sstable_files from {} reason {}", from, int(reason));
+        if (!_sys_dist_ks->local_is_initialized() || !_view_update_generator->local_is_initialized()) {
+            return make_exception_future<rpc::sink<int>>(std::runtime_error(format("Node {} is not fully initialized for streaming, try again later",
+                    utils::fb_utilities::get_broadcast_address())));
+        }
+        return futurize_invoke([&sstable_version] {
+            return sstables::from_string(sstable_version);
+        }).then([plan_id, from] (sstables::sstable_version_types version) {
+            // The receiving stream is registered on the shard which handled PREPARE_MESSAGE.
+            return get_stream_manager().map_reduce0([plan_id] (stream_manager& sm) {
+                return bool(sm.get_receiving_stream(plan_id));
+            }, false, std::logical_or<bool>()).then([plan_id, from, version] (bool found) {
+                if (!found) {
+                    auto err = format("[Stream #{}] GOT STREAM_SSTABLE_FILES from {}: Can not find receiving stream", plan_id, from.addr);
+                    sslog.debug(err.c_str());
+                    return make_exception_future<sstables::sstable_version_types>(std::runtime_error(err));
+                }
+                return make_ready_future<sstables::sstable_version_types>(version);
+            });
+        }).then([&ms, from, plan_id, schema_id, cf_id, reason] (sstables::sstable_version_types version) {
+            return service::get_schema_for_write(schema_id, from, ms).then([cf_id, reason, version] (schema_ptr s) {
+                auto& cf = get_local_db().find_column_family(cf_id);
+                return db::view::check_needs_view_update_path(_sys_dist_ks->local(), cf, reason).then([s, version] (bool use_view_update_path) {
+                    return std::make_tuple(s, version, use_view_update_path);
+                });
+            });
+        }).then_unpack([from, plan_id, cf_id, dst_shard, source] (schema_ptr s, sstables::sstable_version_types version, bool use_view_update_path) mutable {
+            auto sink = stream_session::ms().make_sink_for_stream_sstable_files(source);
+            auto on_progress = [plan_id, from] (size_t size) {
+                streaming::get_local_stream_manager().update_progress(plan_id, from.addr, progress_info::direction::IN, size);
+            };
+            auto view_update_generator = use_view_update_path ? _view_update_generator : nullptr;
+            //FIXME: discarded future.
+            (void)write_received_sstable_files(get_db(), s, cf_id, dst_shard, version, view_update_generator,
+                    [source] () mutable { return source(); }, std::move(on_progress)).then_wrapped([s, plan_id, from, sink] (future<> f) mutable {
+                int32_t status = 0;
+                if (f.failed()) {
+                    sslog.error("[Stream #{}] Failed to handle STREAM_SSTABLE_FILES (receive phase) for ks={}, cf={}, peer={}: {}",
+                            plan_id, s->ks_name(), s->cf_name(), from.addr, f.get_exception());
+                    status = -1;
+                }
+                return sink(status).finally([sink] () mutable {
+                    return sink.close();
+                });
+            }).handle_exception([s, plan_id, from, sink] (std::exception_ptr ep) {
+                sslog.error("[Stream #{}] Failed to handle STREAM_SSTABLE_FILES (respond phase) for ks={}, cf={}, peer={}: {}",
+                        plan_id, s->ks_name(), s->cf_name(), from.addr, ep);
+            });
+            return make_ready_future<rpc::sink<int>>(sink);
+        });
+    });
     ms.register_stream_mutation_done([] (const rpc::client_info& cinfo, UUID plan_id, dht::token_range_vector ranges, UUID cf_id, unsigned dst_cpu_id) {
         const auto& from = cinfo.retrieve_auxiliary<gms::inet_address>("baddr");
         return smp::submit_to(dst_cpu_id, [ranges = std::move(ranges), plan_id, cf_id, from] () mutable {
@@ -285,6 +359,7 @@ future<> stream_session::uninit_messaging_service_handler(netw::messaging_servic
         ms.unregister_prepare_message(),
         ms.unregister_prepare_done_message(),
         ms.unregister_stream_mutation_fragments(),
+        ms.unregister_stream_sstable_files(),
         ms.unregister_stream_mutation_done(),
         ms.unregister_complete_message()).discard_result();
 }
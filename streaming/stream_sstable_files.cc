@@ -0,0 +1,212 @@
+/*
+ * Copyright (C) 2020 ScyllaDB
+ */
+
+/*
+ * This file is part of Scylla.
+ *
+ * Scylla is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Affero General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Scylla is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Scylla.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <algorithm>
+#include <seastar/core/file.hh>
+#include <seastar/core/fstream.hh>
+#include <seastar/core/seastar.hh>
+#include "streaming/stream_sstable_files.hh"
+#include "database.hh"
+#include "db/view/view_update_generator.hh"
+#include "service/priority_manager.hh"
+#include "sstables/sstables.hh"
+
+namespace streaming {
+
+static constexpr auto sstable_format = sstables::sstable::format_types::big;
+
+future<> read_sstable_files(sstables::shared_sstable sst, sstable_files_consumer consumer) {
+    auto components = sst->all_components();
+    std::stable_partition(components.begin(), components.end(), [] (auto& c) { return c.first == sstables::component_type::TOC; });
+    return do_with(std::move(components), std::move(consumer), [sst] (std::vector<std::pair<sstables::component_type, sstring>>& components, sstable_files_consumer& consumer) {
+        return do_for_each(components, [sst, &consumer] (const std::pair<sstables::component_type, sstring>& component) {
+            return open_file_dma(sst->filename(component.first), open_flags::ro).then([&name = component.second, &consumer] (file f) {
+                file_input_stream_options opts;
+                opts.io_priority_class = service::get_local_streaming_priority();
+                opts.read_ahead = 4;
+                return do_with(make_file_input_stream(std::move(f), 0, opts), [&name, &consumer] (input_stream<char>& in) {
+                    return repeat([&name, &consumer, &in] {
+                        return in.read().then([&name, &consumer] (temporary_buffer<char> buf) {
+                            if (buf.empty()) {
+                                return make_ready_future<stop_iteration>(stop_iteration::yes);
+                            }
+                            return consumer(name, bytes(reinterpret_cast<const int8_t*>(buf.get()), buf.size())).then([] {
+                                return stop_iteration::no;
+                            });
+                        });
+                    }).finally([&in] {
+                        return in.close();
+                    });
+                });
+            });
+        });
+    });
+}
+
+// The name of a component comes from the peer, so it is only accepted if it names one of
+// the regular components of the sstable version, and can't be used to write anywhere else.
+static sstables::component_type received_component_type(sstables::sstable_version_types version, sstring component) {
+    auto type = sstables::sstable::component_from_sstring(version, component);
+    switch (type) {
+    case sstables::component_type::TemporaryTOC:
+    case sstables::component_type::TemporaryStatistics:
+    case sstables::component_type::Unknown:
+        throw std::runtime_error(format("Sender sent an invalid sstable component: {}", component));
+    default:
+        return type;
+    }
+}
+
+future<> write_received_sstable_files(distributed<database>& db, schema_ptr s, utils::UUID cf_id, unsigned dst_shard,
+        sstables::sstable_version_types version, sharded<db::view::view_update_generator>* view_update_generator,
+        sstable_files_source source, noncopyable_function<void (size_t)> on_progress) {
+    if (dst_shard >= smp::count) {
+        return make_exception_future<>(std::runtime_error(format("Sender shard {} does not exist on this node", dst_shard)));
+    }
+    bool use_view_update_path = view_update_generator;
+    return db.invoke_on(dst_shard, [cf_id, use_view_update_path] (database& db) {
+        auto& cf = db.find_column_family(cf_id);
+        auto dir = use_view_update_path ? cf.dir() + "/staging" : cf.dir();
+        return std::make_tuple(std::move(dir), int64_t(cf.calculate_generation_for_new_table()));
+    }).then_unpack([&db, s, cf_id, dst_shard, version, view_update_generator, source = std::move(source), on_progress = std::move(on_progress)] (sstring dir, int64_t generation) mutable {
+        struct receive_state {
+            sstable_files_source source;
+            noncopyable_function<void (size_t)> on_progress;
+            std::optional<sstables::component_type> component;
+            file f;
+            std::optional<output_stream<char>> out;
+            bool got_end_of_stream = false;
+
+            future<> close_component() {
+                if (!out) {
+                    return make_ready_future<>();
+                }
+                return out->flush().then([this] {
+                    return f.flush();
+                }).finally([this] {
+                    return out->close().finally([this] {
+                        out = std::nullopt;
+                    });
+                });
+            }
+        };
+        auto component_filename = [s, dir, generation, version] (sstables::component_type component) {
+            if (component == sstables::component_type::TOC) {
+                component = sstables::component_type::TemporaryTOC;
+            }
+            return sstables::sstable::filename(dir, s->ks_name(), s->cf_name(), version, generation, sstable_format, component);
+        };
+        return do_with(receive_state{std::move(source), std::move(on_progress)}, [version, component_filename = std::move(component_filename)] (receive_state& st) mutable {
+            return repeat([&st, version, component_filename] () mutable {
+                return st.source().then([&st, version, component_filename] (std::optional<std::tuple<sstring, bytes, stream_sstable_files_cmd>> opt) mutable {
+                    if (!opt) {
+                        if (!st.got_end_of_stream) {
+                            return make_exception_future<stop_iteration>(std::runtime_error("Sender did not sent end_of_stream"));
+                        }
+                        return make_ready_future<stop_iteration>(stop_iteration::yes);
+                    }
+                    auto& [name, data, cmd] = *opt;
+                    switch (cmd) {
+                    case stream_sstable_files_cmd::component_data:
+                        break;
+                    case stream_sstable_files_cmd::error:
+                        return make_exception_future<stop_iteration>(std::runtime_error("Sender failed"));
+                    case stream_sstable_files_cmd::end_of_stream:
+                        st.got_end_of_stream = true;
+                        return st.close_component().then([] { return stop_iteration::no; });
+                    default:
+                        return make_exception_future<stop_iteration>(std::runtime_error("Sender sent wrong cmd"));
+                    }
+                    auto component = received_component_type(version, name);
+                    if (!st.component && component != sstables::component_type::TOC) {
+                        throw std::runtime_error(format("Sender sent component {} before TOC", name));
+                    }
+                    auto f = make_ready_future<>();
+                    if (component != st.component) {
+                        // A component which was already written can't be opened again, since the file is created exclusively.
+                        f = st.close_component().then([&st, component, component_filename] {
+                            st.component = component;
+                            return open_file_dma(component_filename(component), open_flags::wo | open_flags::create | open_flags::exclusive).then([&st] (file f) {
+                                file_output_stream_options opts;
+                                opts.io_priority_class = service::get_local_streaming_priority();
+                                st.f = f;
+                                st.out = make_file_output_stream(std::move(f), opts);
+                            });
+                        });
+                    }
+                    return f.then([&st, data = std::move(data)] {
+                        st.on_progress(data.size());
+                        return st.out->write(reinterpret_cast<const char*>(data.data()), data.size());
+                    }).then([] {
+                        return stop_iteration::no;
+                    });
+                });
+            }).handle_exception([&st] (std::exception_ptr ep) {
+                return st.close_component().then_wrapped([ep = std::move(ep)] (future<> f) mutable {
+                    f.ignore_ready_future();
+                    return make_exception_future<>(std::move(ep));
+                });
+            });
+        }).then([s, dir, generation, version] {
+            auto temp_toc = sstables::sstable::filename(dir, s->ks_name(), s->cf_name(), version, generation, sstable_format, sstables::component_type::TemporaryTOC);
+            auto toc = sstables::sstable::filename(dir, s->ks_name(), s->cf_name(), version, generation, sstable_format, sstables::component_type::TOC);
+            return sync_directory(dir).then([temp_toc, toc] {
+                return rename_file(temp_toc, toc);
+            }).then([dir] {
+                return sync_directory(dir);
+            });
+        }).handle_exception([s, dir, generation, version] (std::exception_ptr ep) {
+            // Nothing was written if the sender failed before sending TOC.
+            auto temp_toc = sstables::sstable::filename(dir, s->ks_name(), s->cf_name(), version, generation, sstable_format, sstables::component_type::TemporaryTOC);
+            return file_exists(temp_toc).then([s, dir, generation, version] (bool exists) {
+                if (!exists) {
+                    return make_ready_future<>();
+                }
+                return sstables::sstable::remove_sstable_with_temp_toc(s->ks_name(), s->cf_name(), dir, generation, version, sstable_format);
+            }).then_wrapped([ep = std::move(ep)] (future<> f) mutable {
+                f.ignore_ready_future();
+                return make_exception_future<>(std::move(ep));
+            });
+        }).then([&db, cf_id, dst_shard, dir, generation, version, view_update_generator] {
+            return db.invoke_on(dst_shard, [cf_id, dir, generation, version, view_update_generator] (database& db) {
+                auto& cf = db.find_column_family(cf_id);
+                auto sst = cf.make_sstable(dir, generation, version, sstable_format);
+                return sst->load().then([cf = cf.shared_from_this(), sst] {
+                    return cf->add_sstable_and_update_cache(sst);
+                }).handle_exception([sst] (std::exception_ptr ep) {
+                    // The components are sealed by now, so they would be picked up on boot
+                    // if they were left behind.
+                    return sst->unlink().then_wrapped([ep = std::move(ep)] (future<> f) mutable {
+                        f.ignore_ready_future();
+                        return make_exception_future<>(std::move(ep));
+                    });
+                }).then([cf = cf.shared_from_this(), sst, view_update_generator] () mutable {
+                    if (!view_update_generator) {
+                        return make_ready_future<>();
+                    }
+                    return view_update_generator->local().register_staging_sstable(sst, std::move(cf));
+                });
+            });
+        });
+    });
+}
+
+}
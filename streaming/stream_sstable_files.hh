@@ -0,0 +1,66 @@
+/*
+ * Copyright (C) 2020 ScyllaDB
+ */
+
+/*
+ * This file is part of Scylla.
+ *
+ * Scylla is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Affero General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Scylla is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Scylla.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#pragma once
+
+#include <optional>
+#include <tuple>
+#include <seastar/core/future.hh>
+#include <seastar/core/sharded.hh>
+#include <seastar/core/sstring.hh>
+#include <seastar/util/noncopyable_function.hh>
+#include "bytes.hh"
+#include "database_fwd.hh"
+#include "schema_fwd.hh"
+#include "sstables/shared_sstable.hh"
+#include "sstables/version.hh"
+#include "streaming/stream_sstable_files_cmd.hh"
+#include "utils/UUID.hh"
+
+namespace db::view {
+class view_update_generator;
+}
+
+namespace streaming {
+
+// Consumes the content of the sstable components, in the order in which they are read.
+using sstable_files_consumer = noncopyable_function<future<> (const sstring& component, bytes data)>;
+
+// Produces what the sender of the sstable components sent, or std::nullopt once the sender closed the stream.
+using sstable_files_source = noncopyable_function<future<std::optional<std::tuple<sstring, bytes, stream_sstable_files_cmd>>> ()>;
+
+// Reads the components of the sstable and passes their content to the consumer. TOC is read first, so
+// that the receiver can write it as TemporaryTOC and have the partially received sstable cleaned up if
+// it fails midway.
+future<> read_sstable_files(sstables::shared_sstable sst, sstable_files_consumer consumer);
+
+// Writes the components of a single sstable received from the source into the directory of the table
+// and adds the sstable to the table on dst_shard. Only the components of the sstable version are
+// accepted, and TOC has to come first. It is written as TemporaryTOC until all components are written,
+// so that an sstable which was not received in full is removed on boot.
+// If view_update_generator is not null, the sstable is written to the staging directory and registered
+// with it, so that view updates are generated from its content.
+// on_progress is called with the size of each received piece of data.
+future<> write_received_sstable_files(distributed<database>& db, schema_ptr s, utils::UUID cf_id, unsigned dst_shard,
+        sstables::sstable_version_types version, sharded<db::view::view_update_generator>* view_update_generator,
+        sstable_files_source source, noncopyable_function<void (size_t)> on_progress);
+
+}
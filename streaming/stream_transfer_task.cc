@@ -43,6 +43,8 @@
 #include "streaming/stream_manager.hh"
 #include "streaming/stream_reason.hh"
 #include "streaming/stream_mutation_fragments_cmd.hh"
+#include "streaming/stream_sstable_files_cmd.hh"
+#include "streaming/stream_sstable_files.hh"
 #include "mutation_reader.hh"
 #include "flat_mutation_reader.hh"
 #include "frozen_mutation.hh"
@@ -55,9 +57,13 @@
 #include <boost/range/irange.hpp>
 #include <boost/icl/interval.hpp>
 #include <boost/icl/interval_set.hpp>
+#include <boost/algorithm/cxx11/any_of.hpp>
 #include "sstables/sstables.hh"
 #include "database.hh"
 #include "gms/feature_service.hh"
+#include "gms/gossiper.hh"
+#include "db/config.hh"
+#include <seastar/core/timer.hh>
 
 namespace streaming {
 
@@ -85,6 +91,8 @@ struct send_info {
     column_family& cf;
     dht::token_range_vector ranges;
     dht::partition_range_vector prs;
+    // SSTables streamed as whole files, see select_sstables_for_file_streaming().
+    std::vector<sstables::shared_sstable> whole_sstables;
     flat_mutation_reader reader;
     send_info(database& db_, netw::messaging_service& ms_, utils::UUID plan_id_, utils::UUID cf_id_,
               dht::token_range_vector ranges_, netw::messaging_service::msg_addr id_,
@@ -99,7 +107,67 @@ struct send_info {
         , cf(db.find_column_family(cf_id))
         , ranges(std::move(ranges_))
         , prs(dht::to_partition_ranges(ranges))
-        , reader(cf.make_streaming_reader(cf.schema(), prs)) {
+        , whole_sstables(select_sstables_for_file_streaming())
+        , reader(make_reader()) {
+    }
+    // Returns the sstables which can be streamed as whole files: they have to be owned
+    // by this shard only and be fully contained in one of the streamed ranges, and the
+    // peer has to have the same shard layout, so that they are owned by the same shard
+    // on the receiving side. Tables with views are excluded, since the receiver has to
+    // push the streamed data through the view update path.
+    std::vector<sstables::shared_sstable> select_sstables_for_file_streaming() const {
+        std::vector<sstables::shared_sstable> ret;
+        if (!db.features().cluster_supports_stream_sstable_files() || !db.get_config().enable_sstable_file_streaming() || !cf.views().empty()) {
+            return ret;
+        }
+        if (!peer_has_same_shard_layout()) {
+            return ret;
+        }
+        for (auto& sst : *cf.get_sstables()) {
+            auto& shards = sst->get_shards_for_this_sstable();
+            if (shards.size() != 1 || shards.front() != this_shard_id()) {
+                continue;
+            }
+            auto first = sst->get_first_decorated_key().token();
+            auto last = sst->get_last_decorated_key().token();
+            auto contains = [&] (const dht::token_range& r) {
+                return r.contains(first, dht::token_comparator()) && r.contains(last, dht::token_comparator());
+            };
+            if (boost::algorithm::any_of(ranges, contains)) {
+                ret.push_back(sst);
+            }
+        }
+        return ret;
+    }
+    bool peer_has_same_shard_layout() const {
+        auto& gossiper = gms::get_local_gossiper();
+        auto* shard_count = gossiper.get_application_state_ptr(id.addr, gms::application_state::SHARD_COUNT);
+        auto* ignore_msb = gossiper.get_application_state_ptr(id.addr, gms::application_state::IGNORE_MSB_BITS);
+        if (!shard_count || !ignore_msb) {
+            return false;
+        }
+        try {
+            auto& sharder = cf.schema()->get_sharder();
+            return std::stoul(shard_count->value) == sharder.shard_count() && std::stoul(ignore_msb->value) == sharder.sharding_ignore_msb();
+        } catch (...) {
+            return false;
+        }
+    }
+    flat_mutation_reader make_reader() const {
+        if (whole_sstables.empty()) {
+            return cf.make_streaming_reader(cf.schema(), prs);
+        }
+        auto sstables = make_lw_shared<sstables::sstable_set>(cf.get_sstable_set());
+        for (auto& sst : whole_sstables) {
+            sstables->erase(sst);
+        }
+        return cf.make_streaming_reader(cf.schema(), prs, std::move(sstables));
+    }
+    size_t batch_size_limit() const {
+        if (!db.features().cluster_supports_stream_fragment_batches()) {
+            return 0;
+        }
+        return size_t(db.get_config().stream_fragment_batch_size_in_kb()) * 1024;
     }
     future<bool> has_relevant_range_on_this_shard() {
         return do_with(false, ranges.begin(), [this] (bool& found_relevant_range, dht::token_range_vector::iterator& ranges_it) {
@@ -132,6 +200,70 @@ struct send_info {
     }
 };
 
+// Coalesces frozen fragments until the batch reaches its size limit, or until it
+// has been open for max_batch_delay, so that they are framed and compressed
+// together instead of one by one.
+class fragment_batcher {
+    static constexpr auto max_batch_delay = std::chrono::milliseconds(10);
+    rpc::sink<frozen_mutation_fragment, stream_mutation_fragments_cmd>& _sink;
+    size_t _size_limit;
+    size_t _size = 0;
+    std::vector<frozen_mutation_fragment> _fragments;
+    // Sends the batch once it has been open for max_batch_delay, even if the
+    // reader is slow to produce the next fragment.
+    timer<lowres_clock> _timer;
+    // The batch sent by the timer. The next flush waits for it and reports its failure.
+    future<> _timer_flush = make_ready_future<>();
+private:
+    future<> send(std::vector<frozen_mutation_fragment> fragments) {
+        if (fragments.empty()) {
+            return make_ready_future<>();
+        }
+        if (fragments.size() == 1) {
+            return _sink(std::move(fragments.front()), stream_mutation_fragments_cmd::mutation_fragment_data);
+        }
+        return _sink(pack_frozen_mutation_fragments(fragments), stream_mutation_fragments_cmd::mutation_fragment_batch);
+    }
+    std::vector<frozen_mutation_fragment> take() {
+        _timer.cancel();
+        _size = 0;
+        return std::exchange(_fragments, {});
+    }
+    void on_timer() {
+        _timer_flush = _timer_flush.then([this, fragments = take()] () mutable {
+            return send(std::move(fragments));
+        });
+    }
+public:
+    fragment_batcher(rpc::sink<frozen_mutation_fragment, stream_mutation_fragments_cmd>& sink, size_t size_limit)
+        : _sink(sink)
+        , _size_limit(size_limit)
+        , _timer([this] { on_timer(); })
+    { }
+    bool enabled() const {
+        return _size_limit != 0;
+    }
+    // Returns true when the batch should be flushed.
+    bool add(frozen_mutation_fragment fmf) {
+        if (_fragments.empty()) {
+            _timer.arm(max_batch_delay);
+        }
+        _size += fmf.representation().size();
+        _fragments.push_back(std::move(fmf));
+        return _size >= _size_limit;
+    }
+    future<> flush() {
+        return std::exchange(_timer_flush, make_ready_future<>()).then([this, fragments = take()] () mutable {
+            return send(std::move(fragments));
+        });
+    }
+    // Drops the open batch and waits for the one sent by the timer, if any.
+    future<> stop() {
+        take();
+        return std::exchange(_timer_flush, make_ready_future<>());
+    }
+};
+
 future<> send_mutation_fragments(lw_shared_ptr<send_info> si) {
  return si->reader.peek(db::no_timeout).then([si] (mutation_fragment* mfp) {
   if (!mfp) {
@@ -166,9 +298,12 @@ future<> send_mutation_fragments(lw_shared_ptr<send_info> si) {
 
         auto sink_op = [sink, si, got_error_from_peer] () mutable -> future<> {
             mutation_fragment_stream_validator validator(*(si->reader.schema()));
-            return do_with(std::move(sink), std::move(validator), [si, got_error_from_peer] (rpc::sink<frozen_mutation_fragment, stream_mutation_fragments_cmd>& sink, mutation_fragment_stream_validator& validator) {
-                return repeat([&sink, &validator, si, got_error_from_peer] () mutable {
-                    return si->reader(db::no_timeout).then([&sink, &validator, si, s = si->reader.schema(), got_error_from_peer] (mutation_fragment_opt mf) mutable {
+            return do_with(std::move(sink), std::move(validator), std::unique_ptr<fragment_batcher>(),
+                    [si, got_error_from_peer] (rpc::sink<frozen_mutation_fragment, stream_mutation_fragments_cmd>& sink, mutation_fragment_stream_validator& validator, std::unique_ptr<fragment_batcher>& batcher_ptr) {
+                batcher_ptr = std::make_unique<fragment_batcher>(sink, si->batch_size_limit());
+                auto& batcher = *batcher_ptr;
+                return repeat([&sink, &validator, &batcher, si, got_error_from_peer] () mutable {
+                    return si->reader(db::no_timeout).then([&sink, &validator, &batcher, si, s = si->reader.schema(), got_error_from_peer] (mutation_fragment_opt mf) mutable {
                         if (*got_error_from_peer) {
                             return make_exception_future<stop_iteration>(std::runtime_error("Got status error code from peer"));
                         }
@@ -180,7 +315,13 @@ future<> send_mutation_fragments(lw_shared_ptr<send_info> si) {
                             frozen_mutation_fragment fmf = freeze(*s, *mf);
                             auto size = fmf.representation().size();
                             streaming::get_local_stream_manager().update_progress(si->plan_id, si->id.addr, streaming::progress_info::direction::OUT, size);
-                            return sink(fmf, stream_mutation_fragments_cmd::mutation_fragment_data).then([] { return stop_iteration::no; });
+                            if (!batcher.enabled()) {
+                                return sink(fmf, stream_mutation_fragments_cmd::mutation_fragment_data).then([] { return stop_iteration::no; });
+                            }
+                            if (!batcher.add(std::move(fmf))) {
+                                return make_ready_future<stop_iteration>(stop_iteration::no);
+                            }
+                            return batcher.flush().then([] { return stop_iteration::no; });
                         } else {
                             if (!validator.on_end_of_stream()) {
                                 return make_exception_future<stop_iteration>(std::runtime_error(format("Stream reader mutation_fragment validator failed on end_of_stream, previous={}, current=end_of_stream",
@@ -189,12 +330,17 @@ future<> send_mutation_fragments(lw_shared_ptr<send_info> si) {
                             return make_ready_future<stop_iteration>(stop_iteration::yes);
                         }
                     });
+                }).then([&batcher] {
+                    return batcher.flush();
                 }).then([&sink] () mutable {
                     return sink(frozen_mutation_fragment(bytes_ostream()), stream_mutation_fragments_cmd::end_of_stream);
-                }).handle_exception([&sink] (std::exception_ptr ep) mutable {
-                    // Notify the receiver the sender has failed
-                    return sink(frozen_mutation_fragment(bytes_ostream()), stream_mutation_fragments_cmd::error).then([ep = std::move(ep)] () mutable {
-                        return make_exception_future<>(std::move(ep));
+                }).handle_exception([&sink, &batcher] (std::exception_ptr ep) mutable {
+                    return batcher.stop().then_wrapped([&sink, ep = std::move(ep)] (future<> f) mutable {
+                        f.ignore_ready_future();
+                        // Notify the receiver the sender has failed
+                        return sink(frozen_mutation_fragment(bytes_ostream()), stream_mutation_fragments_cmd::error).then([ep = std::move(ep)] () mutable {
+                            return make_exception_future<>(std::move(ep));
+                        });
                     });
                 }).finally([&sink] () mutable {
                     return sink.close();
@@ -212,6 +358,69 @@ future<> send_mutation_fragments(lw_shared_ptr<send_info> si) {
  });
 }
 
+// Streams the components of a single sstable as raw bytes. TOC is sent first, so
+// that the receiver can write it as TemporaryTOC and have the partially received
+// sstable cleaned up if it fails midway.
+future<> send_sstable_files(lw_shared_ptr<send_info> si, sstables::shared_sstable sst) {
+    sslog.debug("[Stream #{}] Start sending sstable {} as files to {}, ks={}, cf={}", si->plan_id, sst->get_filename(), si->id.addr, si->cf.schema()->ks_name(), si->cf.schema()->cf_name());
+    return si->ms.make_sink_and_source_for_stream_sstable_files(si->plan_id, si->cf.schema()->version(), si->cf_id, this_shard_id(), sstables::to_string(sst->get_version()), si->reason, si->id).then_unpack(
+            [si, sst] (rpc::sink<sstring, bytes, stream_sstable_files_cmd> sink, rpc::source<int32_t> source) mutable {
+        auto got_error_from_peer = make_lw_shared<bool>(false);
+
+        auto source_op = [source, got_error_from_peer, si] () mutable -> future<> {
+            return repeat([source, got_error_from_peer, si] () mutable {
+                return source().then([source, got_error_from_peer, si] (std::optional<std::tuple<int32_t>> status_opt) mutable {
+                    if (status_opt) {
+                        auto status = std::get<0>(*status_opt);
+                        *got_error_from_peer = status == -1;
+                        sslog.debug("Got status code from peer={}, plan_id={}, cf_id={}, status={}", si->id.addr, si->plan_id, si->cf_id, status);
+                        return stop_iteration::no;
+                    } else {
+                        return stop_iteration::yes;
+                    }
+                });
+            });
+        }();
+
+        auto sink_op = [sink, si, sst, got_error_from_peer] () mutable -> future<> {
+            return do_with(std::move(sink), [si, sst, got_error_from_peer] (rpc::sink<sstring, bytes, stream_sstable_files_cmd>& sink) {
+                return read_sstable_files(sst, [&sink, si, got_error_from_peer] (const sstring& name, bytes data) {
+                    if (*got_error_from_peer) {
+                        return make_exception_future<>(std::runtime_error("Got status error code from peer"));
+                    }
+                    streaming::get_local_stream_manager().update_progress(si->plan_id, si->id.addr, streaming::progress_info::direction::OUT, data.size());
+                    return sink(name, std::move(data), stream_sstable_files_cmd::component_data);
+                }).then([&sink] () mutable {
+                    return sink(sstring(), bytes(), stream_sstable_files_cmd::end_of_stream);
+                }).handle_exception([&sink] (std::exception_ptr ep) mutable {
+                    // Notify the receiver the sender has failed
+                    return sink(sstring(), bytes(), stream_sstable_files_cmd::error).then([ep = std::move(ep)] () mutable {
+                        return make_exception_future<>(std::move(ep));
+                    });
+                }).finally([&sink] () mutable {
+                    return sink.close();
+                });
+            });
+        }();
+
+        return when_all_succeed(std::move(source_op), std::move(sink_op)).then_unpack([got_error_from_peer, si, sst] {
+            if (*got_error_from_peer) {
+                throw std::runtime_error(format("Peer failed to process sstable {} peer={}, plan_id={}, cf_id={}", sst->get_filename(), si->id.addr, si->plan_id, si->cf_id));
+            }
+        });
+    });
+}
+
+future<> send_whole_sstables(lw_shared_ptr<send_info> si) {
+    if (si->whole_sstables.empty()) {
+        return make_ready_future<>();
+    }
+    sslog.info("[Stream #{}] Start sending ks={}, cf={}, {} sstables as whole files", si->plan_id, si->cf.schema()->ks_name(), si->cf.schema()->cf_name(), si->whole_sstables.size());
+    return do_for_each(si->whole_sstables, [si] (sstables::shared_sstable& sst) {
+        return send_sstable_files(si, sst);
+    });
+}
+
 future<> stream_transfer_task::execute() {
     auto plan_id = session->plan_id();
     auto cf_id = this->cf_id;
@@ -229,7 +438,9 @@ future<> stream_transfer_task::execute() {
                 return make_ready_future<>();
             }
             if (si->db.features().cluster_supports_stream_with_rpc_stream()) {
-                return send_mutation_fragments(std::move(si));
+                return send_whole_sstables(si).then([si] {
+                    return send_mutation_fragments(std::move(si));
+                });
             } else {
                 throw std::runtime_error("cluster does not support STREAM_WITH_RPC_STREAM feature");
             }
@@ -40,8 +40,10 @@
 #include "query-result-writer.hh"
 #include "db/view/view.hh"
 #include <seastar/core/seastar.hh>
+#include <seastar/core/abort_source.hh>
 #include <boost/range/adaptor/transformed.hpp>
 #include <boost/range/adaptor/map.hpp>
+#include <boost/range/irange.hpp>
 #include "utils/error_injection.hh"
 #include "utils/histogram_metrics_helper.hh"
 
@@ -52,15 +54,29 @@ static seastar::metrics::label keyspace_label("ks");
 
 using namespace std::chrono_literals;
 
-// Filter out sstables for reader using bloom filter
+// Filter out sstables for reader using the partition locator, and the bloom
+// filter of sstables the locator doesn't index
 static std::vector<sstables::shared_sstable>
 filter_sstable_for_reader_by_pk(std::vector<sstables::shared_sstable>&& sstables, column_family& cf, const schema_ptr& schema,
         const dht::partition_range& pr, const sstables::key& key) {
     const dht::ring_position& pr_key = pr.start()->value();
+    auto hk = utils::make_hashed_key(bytes_view(key));
+    auto& locator = cf.get_sstables_manager().get_partition_locator();
+    std::optional<sstables::partition_locator::candidates> candidates;
+    if (locator.enabled()) {
+        candidates = locator.lookup(hk);
+    }
     auto sstable_has_not_key = [&, cmp = dht::ring_position_comparator(*schema)] (const sstables::shared_sstable& sst) {
-        return cmp(pr_key, sst->get_first_decorated_key()) < 0 ||
-               cmp(pr_key, sst->get_last_decorated_key()) > 0 ||
-               !sst->filter_has_key(key);
+        if (cmp(pr_key, sst->get_first_decorated_key()) < 0 ||
+               cmp(pr_key, sst->get_last_decorated_key()) > 0) {
+            return true;
+        }
+        if (candidates) {
+            if (auto located = locator.may_contain(*candidates, *sst)) {
+                return !*located;
+            }
+        }
+        return !sst->filter_has_key(hk);
     };
     sstables.erase(boost::remove_if(sstables, sstable_has_not_key), sstables.end());
     return sstables;
@@ -222,7 +238,9 @@ create_single_key_sstable_reader(column_family* cf,
         readers.push_back(flat_mutation_reader_from_mutations({mutation(schema, *pk)}, slice, fwd));
     }
     sstable_histogram.add(num_readers);
-    return make_combined_reader(schema, std::move(readers), fwd, fwd_mr);
+    auto rd = make_combined_reader(schema, std::move(readers), fwd, fwd_mr);
+    rd.limit_partition_readahead(slice);
+    return rd;
 }
 
 flat_mutation_reader make_range_sstable_reader(schema_ptr s,
@@ -240,13 +258,15 @@ flat_mutation_reader make_range_sstable_reader(schema_ptr s,
             (sstables::shared_sstable& sst, const dht::partition_range& pr) mutable {
         return sst->read_range_rows_flat(s, permit, pr, slice, pc, trace_state, fwd, fwd_mr, monitor_generator(sst));
     };
-    return make_combined_reader(s, std::make_unique<incremental_reader_selector>(s,
+    auto rd = make_combined_reader(s, std::make_unique<incremental_reader_selector>(s,
                     std::move(sstables),
                     pr,
                     std::move(trace_state),
                     std::move(reader_factory_fn)),
             fwd,
             fwd_mr);
+    rd.limit_partition_readahead(slice);
+    return rd;
 }
 
 flat_mutation_reader make_restricted_range_sstable_reader(schema_ptr s,
@@ -420,6 +440,7 @@ table::make_reader(schema_ptr s,
     }
 
     auto comb_reader = make_combined_reader(s, std::move(readers), fwd, fwd_mr);
+    comb_reader.limit_partition_readahead(slice);
     if (_config.data_listeners && !_config.data_listeners->empty()) {
         return _config.data_listeners->on_read(s, range, slice, std::move(comb_reader));
     } else {
@@ -440,18 +461,24 @@ sstables::shared_sstable table::make_streaming_sstable_for_write(std::optional<s
 flat_mutation_reader
 table::make_streaming_reader(schema_ptr s,
                            const dht::partition_range_vector& ranges) const {
+    return make_streaming_reader(std::move(s), ranges, nullptr);
+}
+
+flat_mutation_reader
+table::make_streaming_reader(schema_ptr s,
+                           const dht::partition_range_vector& ranges, lw_shared_ptr<sstables::sstable_set> sstables) const {
     auto permit = _config.streaming_read_concurrency_semaphore->make_permit();
     auto& slice = s->full_slice();
     auto& pc = service::get_local_streaming_priority();
 
-    auto source = mutation_source([this] (schema_ptr s, reader_permit permit, const dht::partition_range& range, const query::partition_slice& slice,
+    auto source = mutation_source([this, sstables = std::move(sstables)] (schema_ptr s, reader_permit permit, const dht::partition_range& range, const query::partition_slice& slice,
                                       const io_priority_class& pc, tracing::trace_state_ptr trace_state, streamed_mutation::forwarding fwd, mutation_reader::forwarding fwd_mr) {
         std::vector<flat_mutation_reader> readers;
         readers.reserve(_memtables->size() + 1);
         for (auto&& mt : *_memtables) {
             readers.emplace_back(mt->make_flat_reader(s, permit, range, slice, pc, trace_state, fwd, fwd_mr));
         }
-        readers.emplace_back(make_sstable_reader(s, permit, _sstables, range, slice, pc, std::move(trace_state), fwd, fwd_mr));
+        readers.emplace_back(make_sstable_reader(s, permit, sstables ? sstables : _sstables, range, slice, pc, std::move(trace_state), fwd, fwd_mr));
         return make_combined_reader(s, std::move(readers), fwd, fwd_mr);
     });
 
@@ -542,13 +569,15 @@ flat_mutation_reader make_local_shard_sstable_reader(schema_ptr s,
         }
         return reader;
     };
-    return make_combined_reader(s, std::make_unique<incremental_reader_selector>(s,
+    auto rd = make_combined_reader(s, std::make_unique<incremental_reader_selector>(s,
                     std::move(sstables),
                     pr,
                     std::move(trace_state),
                     std::move(reader_factory_fn)),
             fwd,
             fwd_mr);
+    rd.limit_partition_readahead(slice);
+    return rd;
 }
 
 sstables::shared_sstable table::make_sstable(sstring dir, int64_t generation, sstables::sstable_version_types v, sstables::sstable_format_types f,
@@ -604,6 +633,7 @@ void table::add_sstable(sstables::shared_sstable sstable) {
     auto new_sstables = make_lw_shared<sstables::sstable_set>(*_sstables);
     new_sstables->insert(sstable);
     _sstables = std::move(new_sstables);
+    get_sstables_manager().get_partition_locator().add(sstable, compaction_concurrency_semaphore());
     update_stats_for_new_sstable(sstable->bytes_on_disk());
     if (sstable->requires_view_building()) {
         _sstables_staging.emplace(sstable->generation(), sstable);
@@ -614,20 +644,33 @@ void table::add_sstable(sstables::shared_sstable sstable) {
 
 future<>
 table::add_sstable_and_update_cache(sstables::shared_sstable sst) {
+    auto range = dht::partition_range::make({sst->get_first_decorated_key(), true}, {sst->get_last_decorated_key(), true});
     return get_row_cache().invalidate([this, sst] () noexcept {
         // FIXME: this is not really noexcept, but we need to provide strong exception guarantees.
         // atomically load all opened sstables into column family.
         add_sstable(sst);
         trigger_compaction();
-    }, dht::partition_range::make({sst->get_first_decorated_key(), true}, {sst->get_last_decorated_key(), true}));
+    }, range).then([this, range] {
+        notify_invalidated(range);
+    });
+}
+
+void table::notify_invalidated(const dht::partition_range& range) {
+    if (_config.data_listeners && !_config.data_listeners->empty()) {
+        _config.data_listeners->on_invalidate(_schema, range);
+    }
 }
 
 future<>
-table::update_cache(lw_shared_ptr<memtable> m, sstables::shared_sstable sst) {
-    auto adder = [this, m, sst] {
-        auto newtab_ms = sst->as_mutation_source();
-        add_sstable(sst);
-        m->mark_flushed(std::move(newtab_ms));
+table::update_cache(lw_shared_ptr<memtable> m, std::vector<sstables::shared_sstable> ssts) {
+    auto adder = [this, m, ssts = std::move(ssts)] {
+        std::vector<mutation_source> sources;
+        sources.reserve(ssts.size());
+        for (auto& sst : ssts) {
+            sources.push_back(sst->as_mutation_source());
+            add_sstable(sst);
+        }
+        m->mark_flushed(sources.size() == 1 ? std::move(sources.front()) : make_combined_mutation_source(std::move(sources)));
         try_trigger_compaction();
     };
     if (cache_enabled()) {
@@ -640,19 +683,24 @@ table::update_cache(lw_shared_ptr<memtable> m, sstables::shared_sstable sst) {
 // Handles permit management only, used for situations where we don't want to inform
 // the compaction manager about backlogs (i.e., tests)
 class permit_monitor : public sstables::write_monitor {
-    sstable_write_permit _permit;
+    // Shared by the monitors of all sstables a flush is split into.
+    lw_shared_ptr<sstable_write_permit> _permit;
 public:
-    permit_monitor(sstable_write_permit&& permit)
+    permit_monitor(lw_shared_ptr<sstable_write_permit> permit)
             : _permit(std::move(permit)) {
     }
+    permit_monitor(sstable_write_permit&& permit)
+            : permit_monitor(make_lw_shared<sstable_write_permit>(std::move(permit))) {
+    }
 
     virtual void on_write_started(const sstables::writer_offset_tracker& t) override { }
     virtual void on_data_write_completed() override {
         // We need to start a flush before the current one finishes, otherwise
         // we'll have a period without significant disk activity when the current
         // SSTable is being sealed, the caches are being updated, etc. To do that,
-        // we ensure the permit doesn't outlive this continuation.
-        _permit = sstable_write_permit::unconditional();
+        // we ensure the permit doesn't outlive this continuation, or the data
+        // write of the last sstable of the flush.
+        _permit = {};
     }
 };
 
@@ -665,7 +713,7 @@ class database_sstable_write_monitor : public permit_monitor, public backlog_wri
     uint64_t _progress_seen = 0;
     api::timestamp_type _maximum_timestamp;
 public:
-    database_sstable_write_monitor(sstable_write_permit&& permit, sstables::shared_sstable sst, compaction_manager& manager,
+    database_sstable_write_monitor(lw_shared_ptr<sstable_write_permit> permit, sstables::shared_sstable sst, compaction_manager& manager,
                                    sstables::compaction_strategy& strategy, api::timestamp_type max_timestamp)
             : permit_monitor(std::move(permit))
             , _sst(std::move(sst))
@@ -766,48 +814,108 @@ table::seal_active_memtable(flush_permit&& permit) {
     // FIXME: provide back-pressure to upper layers
 }
 
+// Splits the token ring into n ranges of equal width. As the partitioner
+// hashes keys uniformly, each holds about the same share of a memtable.
+static dht::partition_range_vector split_for_flush(size_t n) {
+    dht::partition_range_vector ranges;
+    ranges.reserve(n);
+    std::optional<dht::partition_range::bound> start;
+    for (size_t i = 1; i < n; ++i) {
+        auto offset = uint64_t((static_cast<unsigned __int128>(1) << 64) * i / n);
+        auto t = dht::token(dht::token::kind::key, int64_t(uint64_t(std::numeric_limits<int64_t>::min()) + offset));
+        auto end = dht::partition_range::bound(dht::ring_position::starting_at(t), false);
+        ranges.emplace_back(std::move(start), end);
+        start = dht::partition_range::bound(dht::ring_position::starting_at(t), true);
+    }
+    ranges.emplace_back(std::move(start), std::nullopt);
+    return ranges;
+}
+
+dht::partition_range_vector table::flush_ranges(const memtable& mt) const {
+    auto n = std::min<size_t>(_config.memtable_flush_parallelism(), mt.occupancy().total_space() / _config.min_split_flush_size);
+    if (n < 2) {
+        return {query::full_partition_range};
+    }
+    auto ranges = split_for_flush(n);
+    ranges.erase(std::remove_if(ranges.begin(), ranges.end(), [&mt] (const dht::partition_range& r) {
+        return mt.empty(r);
+    }), ranges.end());
+    return ranges;
+}
+
 future<stop_iteration>
 table::try_flush_memtable_to_sstable(lw_shared_ptr<memtable> old, sstable_write_permit&& permit) {
   return with_scheduling_group(_config.memtable_scheduling_group, [this, old = std::move(old), permit = std::move(permit)] () mutable {
-    auto newtab = make_sstable();
-
-    tlogger.debug("Flushing to {}", newtab->get_filename());
-    // Note that due to our sharded architecture, it is possible that
-    // in the face of a value change some shards will backup sstables
-    // while others won't.
-    //
-    // This is, in theory, possible to mitigate through a rwlock.
-    // However, this doesn't differ from the situation where all tables
-    // are coming from a single shard and the toggle happens in the
-    // middle of them.
-    //
-    // The code as is guarantees that we'll never partially backup a
-    // single sstable, so that is enough of a guarantee.
-    database_sstable_write_monitor monitor(std::move(permit), newtab, _compaction_manager, _compaction_strategy, old->get_max_timestamp());
-    return do_with(std::move(monitor), [this, old, newtab] (auto& monitor) {
+    // A large memtable is split by token range into several sstables, written
+    // in parallel under the same permit. They share a run identifier, as they
+    // don't overlap.
+    auto ranges = flush_ranges(*old);
+    std::vector<sstables::shared_sstable> newtabs;
+    newtabs.reserve(ranges.size());
+    for (size_t i = 0; i < ranges.size(); ++i) {
+        newtabs.push_back(make_sstable());
+    }
+    auto run_id = utils::make_random_uuid();
+    auto shared_permit = make_lw_shared<sstable_write_permit>(std::move(permit));
+    std::vector<std::unique_ptr<database_sstable_write_monitor>> monitors;
+    monitors.reserve(newtabs.size());
+    for (auto& newtab : newtabs) {
+        tlogger.debug("Flushing to {}", newtab->get_filename());
+        monitors.push_back(std::make_unique<database_sstable_write_monitor>(shared_permit, newtab, _compaction_manager, _compaction_strategy, old->get_max_timestamp()));
+    }
+    shared_permit = {};
+    return do_with(std::move(ranges), std::move(newtabs), std::move(monitors), [this, old, run_id] (auto& ranges, auto& newtabs, auto& monitors) {
         auto&& priority = service::get_local_memtable_flush_priority();
-        sstables::sstable_writer_config cfg = get_sstables_manager().configure_writer();
-        cfg.backup = incremental_backups_enabled();
-        auto f = write_memtable_to_sstable(*old, newtab, monitor, cfg, priority);
-        // Switch back to default scheduling group for post-flush actions, to avoid them being staved by the memtable flush
-        // controller. Cache update does not affect the input of the memtable cpu controller, so it can be subject to
-        // priority inversion.
-        return with_scheduling_group(default_scheduling_group(), [this, old = std::move(old), newtab = std::move(newtab), f = std::move(f)] () mutable {
-            return f.then([this, newtab, old] {
-                return newtab->open_data().then([this, old, newtab] () {
-                    tlogger.debug("Flushing to {} done", newtab->get_filename());
-                    return with_scheduling_group(_config.memtable_to_cache_scheduling_group, [this, old, newtab] {
-                        return update_cache(old, newtab);
+        auto estimated_partitions = old->partition_count() / ranges.size();
+        auto f = parallel_for_each(boost::irange<size_t>(0, ranges.size()), [&, this, old, run_id, estimated_partitions] (size_t i) {
+            sstables::sstable_writer_config cfg = get_sstables_manager().configure_writer();
+            // Note that due to our sharded architecture, it is possible that
+            // in the face of a value change some shards will backup sstables
+            // while others won't.
+            //
+            // This is, in theory, possible to mitigate through a rwlock.
+            // However, this doesn't differ from the situation where all tables
+            // are coming from a single shard and the toggle happens in the
+            // middle of them.
+            //
+            // The code as is guarantees that we'll never partially backup a
+            // single sstable, so that is enough of a guarantee.
+            cfg.backup = incremental_backups_enabled();
+            cfg.run_identifier = run_id;
+            auto newtab = newtabs[i];
+            auto f = write_memtable_to_sstable(*old, newtab, *monitors[i], cfg, priority, ranges[i], estimated_partitions).then([] {
+                return utils::get_local_injector().inject("table_flush_memtable_write", [] {
+                    return std::make_exception_ptr(std::runtime_error("table_flush_memtable_write"));
+                });
+            });
+            // Switch back to default scheduling group for post-flush actions, to avoid them being staved by the memtable flush
+            // controller. Cache update does not affect the input of the memtable cpu controller, so it can be subject to
+            // priority inversion.
+            return with_scheduling_group(default_scheduling_group(), [f = std::move(f), newtab] () mutable {
+                return f.then([newtab] {
+                    return newtab->open_data().then([newtab] {
+                        tlogger.debug("Flushing to {} done", newtab->get_filename());
                     });
-                }).then([this, old, newtab] () noexcept {
+                });
+            });
+        });
+        return with_scheduling_group(default_scheduling_group(), [this, old, &newtabs, f = std::move(f)] () mutable {
+            return f.then([this, old, &newtabs] {
+                return with_scheduling_group(_config.memtable_to_cache_scheduling_group, [this, old, &newtabs] {
+                    return update_cache(old, newtabs);
+                }).then([this, old, &newtabs] () noexcept {
                     _memtables->erase(old);
-                    tlogger.debug("Memtable for {} replaced", newtab->get_filename());
+                    for (auto& newtab : newtabs) {
+                        tlogger.debug("Memtable for {} replaced", newtab->get_filename());
+                    }
                     return stop_iteration::yes;
                 });
-            }).handle_exception([this, old, newtab] (auto e) {
-                newtab->mark_for_deletion();
+            }).handle_exception([this, old, &newtabs] (auto e) {
+                for (auto& newtab : newtabs) {
+                    newtab->mark_for_deletion();
+                    tlogger.error("failed to write sstable {}: {}", newtab->get_filename(), e);
+                }
                 _config.cf_stats->failed_memtables_flushes_count++;
-                tlogger.error("failed to write sstable {}: {}", newtab->get_filename(), e);
                 // If we failed this write we will try the write again and that will create a new flush reader
                 // that will decrease dirty memory again. So we need to reset the accounting.
                 old->revert_flushed_memory();
@@ -955,6 +1063,9 @@ table::rebuild_sstable_list(const std::vector<sstables::shared_sstable>& new_sst
         }
     }
     _sstables = make_lw_shared<sstables::sstable_set>(std::move(new_sstable_list));
+    for (auto& sst : new_sstables) {
+        get_sstables_manager().get_partition_locator().add(sst, compaction_concurrency_semaphore());
+    }
 }
 
 // Note: must run in a seastar thread
@@ -1240,6 +1351,7 @@ table::table(schema_ptr schema, config config, db::commitlog* cl, compaction_man
     , _compaction_manager(compaction_manager)
     , _index_manager(*this)
     , _counter_cell_locks(_schema->is_counter() ? std::make_unique<cell_locker>(_schema, cl_stats) : nullptr)
+    , _counter_update_batches(dht::decorated_key::less_comparator(_schema))
     , _row_locker(_schema)
 {
     if (!_config.enable_disk_writes) {
@@ -1547,7 +1659,9 @@ future<> table::clear() {
     }
     _memtables->clear();
     _memtables->add_memtable();
-    return _cache.invalidate([] { /* There is no underlying mutation source */ });
+    return _cache.invalidate([] { /* There is no underlying mutation source */ }).then([this] {
+        notify_invalidated(query::full_partition_range);
+    });
 }
 
 // NOTE: does not need to be futurized, but might eventually, depending on
@@ -1586,6 +1700,7 @@ future<db::replay_position> table::discard_sstables(db_clock::time_point truncat
         tlogger.debug("cleaning out row cache");
     }).then([this, p]() mutable {
         rebuild_statistics();
+        notify_invalidated(query::full_partition_range);
 
         return parallel_for_each(p->remove, [this](sstables::shared_sstable s) {
             remove_sstable_from_backlog_tracker(_compaction_strategy.get_backlog_tracker(), s);
@@ -1904,9 +2019,19 @@ write_memtable_to_sstable(memtable& mt, sstables::shared_sstable sst,
                           sstables::write_monitor& monitor,
                           sstables::sstable_writer_config& cfg,
                           const io_priority_class& pc) {
+    return write_memtable_to_sstable(mt, std::move(sst), monitor, cfg, pc, query::full_partition_range, mt.partition_count());
+}
+
+future<>
+write_memtable_to_sstable(memtable& mt, sstables::shared_sstable sst,
+                          sstables::write_monitor& monitor,
+                          sstables::sstable_writer_config& cfg,
+                          const io_priority_class& pc,
+                          const dht::partition_range& range,
+                          uint64_t estimated_partitions) {
     cfg.replay_position = mt.replay_position();
     cfg.monitor = &monitor;
-    return sst->write_components(mt.make_flush_reader(mt.schema(), pc), mt.partition_count(),
+    return sst->write_components(mt.make_flush_reader(mt.schema(), pc, range), estimated_partitions,
         mt.schema(), cfg, mt.get_encoding_stats(), pc);
 }
 
@@ -1971,12 +2096,18 @@ table::query(schema_ptr s,
         auto qs_ptr = std::make_unique<query_state>(std::move(s), cmd, opts, partition_ranges, std::move(accounter));
         auto& qs = *qs_ptr;
         return do_until(std::bind(&query_state::done, &qs), [this, &qs, class_config, trace_state = std::move(trace_state), timeout, cache_ctx = std::move(cache_ctx)] {
+            if (class_config.abort && class_config.abort->abort_requested()) {
+                return make_exception_future<>(abort_requested_exception());
+            }
             auto&& range = *qs.current_partition_range++;
             return data_query(qs.schema, as_mutation_source(), range, qs.cmd.slice, qs.remaining_rows(),
                               qs.remaining_partitions(), qs.cmd.timestamp, qs.builder, timeout, class_config, trace_state, cache_ctx);
-        }).then([qs_ptr = std::move(qs_ptr), &qs] {
-            return make_ready_future<lw_shared_ptr<query::result>>(
-                    make_lw_shared<query::result>(qs.builder.build()));
+        }).then([qs_ptr = std::move(qs_ptr), &qs, opts] {
+            auto result = make_lw_shared<query::result>(qs.builder.build());
+            if (qs.cmd.slice.group_by() && opts.request != query::result_request::only_digest) {
+                result->group_rows(*qs.schema, qs.cmd.slice);
+            }
+            return make_ready_future<lw_shared_ptr<query::result>>(std::move(result));
         }).finally([lc, this]() mutable {
             _stats.reads.mark(lc);
             if (lc.is_start()) {
@@ -47,4 +47,12 @@ BOOST_AUTO_TEST_CASE(test_caching_options) {
         sstring in_str = "{\"keys\": \"NONE, }";
         BOOST_REQUIRE_THROW(caching_options::from_sstring(in_str), std::exception);
     }
+    {
+        string_map in_map = { {"keys", "ALL"}, {"rows_per_partition", "ALL"}, {"admission", "FREQUENT"}};
+        caching_options co = caching_options::from_map(in_map);
+        BOOST_REQUIRE(co.frequent_admission());
+        BOOST_REQUIRE(in_map == co.to_map());
+        BOOST_REQUIRE(!caching_options::from_map(string_map{{"admission", "ALL"}}).frequent_admission());
+        BOOST_REQUIRE_THROW(caching_options::from_map(string_map{{"admission", "SOME"}}), std::exception);
+    }
 }
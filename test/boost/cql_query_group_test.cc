@@ -199,6 +199,74 @@ SEASTAR_TEST_CASE(test_group_by_aggregate_clustering) {
     });
 }
 
+SEASTAR_TEST_CASE(test_group_by_partial_aggregates) {
+    return do_with_cql_env_thread([] (cql_test_env& e) {
+        cquery_nofail(e, "create table t (p int, c1 int, c2 int, v int, w text, primary key(p, c1, c2))");
+        cquery_nofail(e, "insert into t (p, c1, c2, v, w) values (1, 1, 1, 10, 'b')");
+        cquery_nofail(e, "insert into t (p, c1, c2, v) values (1, 1, 2, -5)");
+        cquery_nofail(e, "insert into t (p, c1, c2, w) values (1, 2, 1, 'a')");
+        cquery_nofail(e, "insert into t (p, c1, c2, v, w) values (2, 1, 1, 7, 'c')");
+        // Replicas send the partial aggregates of each group, which the coordinator merges.
+        require_rows(e, "select p, count(*), count(v), min(v), max(w), sum(v) from t group by p",
+                     {{I(1), L(3), L(2), I(-5), T("b"), I(5)}, {I(2), L(1), L(1), I(7), T("c"), I(7)}});
+        require_rows(e, "select p, c1, count(*), min(w), sum(v) from t group by p, c1",
+                     {{I(1), I(1), L(2), T("b"), I(5)}, {I(1), I(2), L(1), T("a"), I(0)},
+                      {I(2), I(1), L(1), T("c"), I(7)}});
+        require_rows(e, "select count(*), min(v), max(v) from t", {{L(4), I(-5), I(10)}});
+        require_rows(e, "select count(*), sum(v) from t where p = 3", {{L(0), I(0)}});
+        // Partial sums are wider than the column, but the result must still fit it.
+        cquery_nofail(e, "insert into t (p, c1, c2, v) values (3, 1, 1, 2147483647)");
+        cquery_nofail(e, "insert into t (p, c1, c2, v) values (3, 1, 2, 1)");
+        BOOST_REQUIRE_EXCEPTION(e.execute_cql("select sum(v) from t where p = 3").get(),
+                exceptions::overflow_error_exception, exception_predicate::message_contains("overflow"));
+        return make_ready_future<>();
+    });
+}
+
+SEASTAR_TEST_CASE(test_group_by_partial_aggregates_across_pages_and_shards) {
+    return do_with_cql_env_thread([] (cql_test_env& e) {
+        cquery_nofail(e, "create table t (p int, c1 int, c2 int, v int, primary key(p, c1, c2))");
+        std::vector<std::vector<bytes_opt>> by_partition, by_group;
+        int64_t total_count = 0;
+        int32_t total_sum = 0;
+        for (int32_t p = 0; p < 10; ++p) {
+            int32_t partition_max = 0;
+            for (int32_t c1 = 0; c1 < 3; ++c1) {
+                int32_t group_sum = 0;
+                for (int32_t c2 = 0; c2 < 5; ++c2) {
+                    auto v = p + c1 + c2;
+                    cquery_nofail(e, format("insert into t (p, c1, c2, v) values ({}, {}, {}, {})", p, c1, c2, v));
+                    group_sum += v;
+                    partition_max = std::max(partition_max, v);
+                    ++total_count;
+                }
+                total_sum += group_sum;
+                by_group.push_back({I(p), I(c1), L(5), I(group_sum)});
+            }
+            by_partition.push_back({I(p), L(15), I(partition_max)});
+        }
+
+        // Pages end inside groups, so the partial aggregates of a group come in several
+        // pages. The whole table aggregate is a single group spread over all shards and
+        // token ranges, whose partial results are merged by the coordinator.
+        for (int32_t page_size : {1, 2, 7, 16, 1000}) {
+            auto query = [&] (const char* q) {
+                auto qo = std::make_unique<cql3::query_options>(db::consistency_level::LOCAL_ONE, infinite_timeout_config, std::vector<cql3::raw_value>{},
+                        cql3::query_options::specific_options{page_size, nullptr, {}, api::new_timestamp()});
+                return e.execute_cql(q, std::move(qo)).get0();
+            };
+            assert_that(query("select count(*), sum(v), min(v), max(v) from t"))
+                .is_rows().with_rows({{L(total_count), I(total_sum), I(0), I(9 + 2 + 4)}});
+            assert_that(query("select p, c1, count(*), sum(v) from t group by p, c1"))
+                .is_rows().with_rows_ignore_order(by_group);
+            assert_that(query("select p, count(*), max(v) from t group by p"))
+                .is_rows().with_rows_ignore_order(by_partition);
+            assert_that(query("select p, c1, count(*), sum(v) from t where p = 3 group by p, c1"))
+                .is_rows().with_rows({by_group[9], by_group[10], by_group[11]});
+        }
+    });
+}
+
 SEASTAR_TEST_CASE(test_group_by_text_key) {
     return do_with_cql_env_thread([] (cql_test_env& e) {
         cquery_nofail(e, "create table t (p text, c text, v int, primary key(p, c))");
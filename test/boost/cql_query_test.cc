@@ -38,6 +38,7 @@
 
 #include <seastar/core/future-util.hh>
 #include <seastar/core/sleep.hh>
+#include <seastar/util/defer.hh>
 #include "transport/messages/result_message.hh"
 #include "utils/big_decimal.hh"
 #include "types/user.hh"
@@ -54,6 +55,8 @@
 #include <regex>
 #include "gms/feature.hh"
 #include "db/query_context.hh"
+#include "db/row_cache_saver.hh"
+#include "test/lib/tmpdir.hh"
 
 using namespace std::literals::chrono_literals;
 
@@ -158,6 +161,39 @@ SEASTAR_TEST_CASE(test_list_elements_validation) {
     });
 }
 
+SEASTAR_TEST_CASE(test_prepared_single_partition_statements) {
+    return do_with_cql_env_thread([](cql_test_env& e) {
+        e.execute_cql("CREATE TABLE t (pk1 int, pk2 text, ck int, v int, PRIMARY KEY ((pk1, pk2), ck))").get();
+        auto insert = e.prepare("INSERT INTO t (pk1, pk2, ck, v) VALUES (?, ?, ?, ?)").get0();
+        auto select = e.prepare("SELECT ck, v FROM t WHERE pk2 = ? AND pk1 = ?").get0();
+        auto select_const = e.prepare("SELECT ck, v FROM t WHERE pk1 = 1 AND pk2 = ?").get0();
+        auto value = [] (auto type, auto v) {
+            return cql3::raw_value::make_value(type->decompose(v));
+        };
+        for (int32_t pk1 : {1, 2}) {
+            for (int32_t ck : {1, 2}) {
+                e.execute_prepared(insert, {value(int32_type, pk1), value(utf8_type, sstring("a")), value(int32_type, ck), value(int32_type, pk1 * 10 + ck)}).get();
+            }
+        }
+        assert_that(e.execute_prepared(select, {value(utf8_type, sstring("a")), value(int32_type, int32_t(2))}).get0())
+            .is_rows().with_rows({
+                {int32_type->decompose(int32_t(1)), int32_type->decompose(int32_t(21))},
+                {int32_type->decompose(int32_t(2)), int32_type->decompose(int32_t(22))},
+            });
+        assert_that(e.execute_prepared(select_const, {value(utf8_type, sstring("a"))}).get0())
+            .is_rows().with_rows({
+                {int32_type->decompose(int32_t(1)), int32_type->decompose(int32_t(11))},
+                {int32_type->decompose(int32_t(2)), int32_type->decompose(int32_t(12))},
+            });
+        assert_that(e.execute_prepared(select, {value(utf8_type, sstring("b")), value(int32_type, int32_t(2))}).get0())
+            .is_rows().is_empty();
+        BOOST_REQUIRE_THROW(e.execute_prepared(select, {cql3::raw_value::make_null(), value(int32_type, int32_t(2))}).get(),
+                exceptions::invalid_request_exception);
+        BOOST_REQUIRE_THROW(e.execute_prepared(insert, {value(int32_type, int32_t(1)), cql3::raw_value::make_null(), value(int32_type, int32_t(1)), value(int32_type, int32_t(1))}).get(),
+                exceptions::invalid_request_exception);
+    });
+}
+
 SEASTAR_TEST_CASE(test_set_elements_validation) {
     return do_with_cql_env_thread([](cql_test_env& e) {
         auto test_inline = [&] (sstring value, bool should_throw) {
@@ -3508,6 +3544,125 @@ SEASTAR_TEST_CASE(test_cache_bypass) {
     });
 }
 
+SEASTAR_TEST_CASE(test_filtered_cache_admission) {
+    return do_with_cql_env_thread([] (cql_test_env& e) {
+        e.execute_cql("CREATE TABLE t1 (k int PRIMARY KEY)").get();
+        e.execute_cql("CREATE TABLE t2 (k text PRIMARY KEY)").get();
+        for (int k = 0; k < 100; ++k) {
+            e.execute_cql(format("INSERT INTO t1 (k) VALUES ({})", k)).get();
+        }
+        e.execute_cql("INSERT INTO t2 (k) VALUES ('a')").get();
+        // Make every shard evict, so that admission is filtered.
+        e.db().invoke_on_all([] (database& db) {
+            return db.flush_all_memtables().then([&db] {
+                db.find_column_family("ks", "t1").get_row_cache().evict();
+            });
+        }).get();
+        auto not_admitted = [&] {
+            return e.db().map_reduce0([] (database& db) {
+                return db.find_column_family("ks", "t1").get_row_cache().get_cache_tracker().get_stats().partitions_not_admitted;
+            }, uint64_t(0), std::plus<uint64_t>()).get0();
+        };
+        auto before = not_admitted();
+
+        // Read once of late, the partition isn't admitted.
+        auto msg = e.execute_cql("SELECT * FROM t2 WHERE k = 'a' FILTER CACHE ADMISSION").get0();
+        assert_that(msg).is_rows().with_rows({{utf8_type->decompose("a")}});
+        BOOST_REQUIRE_EQUAL(not_admitted(), before + 1);
+
+        // Read twice, it is.
+        msg = e.execute_cql("SELECT * FROM t2 WHERE k = 'a' FILTER CACHE ADMISSION").get0();
+        assert_that(msg).is_rows().with_rows({{utf8_type->decompose("a")}});
+        BOOST_REQUIRE_EQUAL(not_admitted(), before + 1);
+
+        BOOST_REQUIRE_THROW(e.execute_cql("SELECT * FROM t2 BYPASS CACHE FILTER CACHE ADMISSION").get(), exceptions::syntax_exception);
+    });
+}
+
+SEASTAR_TEST_CASE(test_row_cache_saver_round_trip) {
+    return do_with_cql_env_thread([] (cql_test_env& e) {
+        e.execute_cql("CREATE TABLE t (k int PRIMARY KEY)").get();
+        constexpr int nr_keys = 100;
+        for (int k = 0; k < nr_keys; ++k) {
+            e.execute_cql(format("INSERT INTO t (k) VALUES ({})", k)).get();
+        }
+        e.db().invoke_on_all([] (database& db) {
+            return db.flush_all_memtables();
+        }).get();
+        for (int k = 0; k < nr_keys; ++k) {
+            e.execute_cql(format("SELECT * FROM t WHERE k = {}", k)).get();
+        }
+
+        tmpdir dir;
+        db::row_cache_saver::config cfg;
+        cfg.directory = dir.path().string();
+        cfg.save_period = std::chrono::seconds(1);
+        cfg.keys_to_save = 0;
+
+        // Files of shards which no longer exist and of dropped tables are removed on save.
+        auto t_id = e.local_db().find_schema("ks", "t")->id();
+        std::vector<sstring> stale_files = {
+            format("{}/ks-t-{}-{}.keys", cfg.directory, t_id, smp::count),
+            format("{}/ks-dropped-{}-0.keys", cfg.directory, utils::make_random_uuid()),
+        };
+        for (auto& name : stale_files) {
+            open_file_dma(name, open_flags::create).get0().close().get();
+        }
+
+        // Every shard saves the keys it owns into its own file.
+        {
+            sharded<db::row_cache_saver> saver;
+            saver.start(std::ref(e.db()), cfg).get();
+            auto stop_saver = defer([&saver] { saver.stop().get(); });
+            saver.invoke_on_all(&db::row_cache_saver::start).get();
+            while (!saver.map_reduce0([] (db::row_cache_saver& s) {
+                return s.get_stats().saved_partitions > 0;
+            }, true, std::logical_and<bool>()).get0()) {
+                sleep(100ms).get();
+            }
+        }
+        for (auto& name : stale_files) {
+            BOOST_REQUIRE(!file_exists(name).get0());
+        }
+
+        // Counts the keys of t in the caches, requiring each to be cached by its owner.
+        auto cached_keys = [&] {
+            auto [owned, foreign] = e.db().map_reduce0([] (database& db) {
+                auto& t = db.find_column_family("ks", "t");
+                return t.get_row_cache().get_hottest_keys(0).then([s = t.schema()] (std::vector<dht::decorated_key> keys) {
+                    auto owned = boost::count_if(keys, [&] (const dht::decorated_key& dk) {
+                        return dht::shard_of(*s, dk.token()) == this_shard_id();
+                    });
+                    return std::make_pair(size_t(owned), keys.size() - owned);
+                });
+            }, std::make_pair(size_t(0), size_t(0)), [] (std::pair<size_t, size_t> a, std::pair<size_t, size_t> b) {
+                return std::make_pair(a.first + b.first, a.second + b.second);
+            }).get0();
+            BOOST_REQUIRE_EQUAL(foreign, size_t(0));
+            return owned;
+        };
+        e.db().invoke_on_all([] (database& db) {
+            db.find_column_family("ks", "t").get_row_cache().evict();
+        }).get();
+        BOOST_REQUIRE_EQUAL(cached_keys(), size_t(0));
+
+        // Every shard reads the keys it owns from the files of all shards, which
+        // also hold the keys of the other shards.
+        sharded<db::row_cache_saver> saver;
+        saver.start(std::ref(e.db()), cfg).get();
+        auto stop_saver = defer([&saver] { saver.stop().get(); });
+        saver.invoke_on_all(&db::row_cache_saver::start).get();
+        saver.invoke_on_all([] (db::row_cache_saver& s) {
+            return s.wait_for_warm_up();
+        }).get();
+        // The saved partitions of other tables are loaded as well.
+        BOOST_REQUIRE_GE(saver.map_reduce0([] (db::row_cache_saver& s) {
+            return s.get_stats().warmup_partitions_loaded;
+        }, uint64_t(0), std::plus<uint64_t>()).get0(), uint64_t(nr_keys));
+        BOOST_REQUIRE_EQUAL(cached_keys(), size_t(nr_keys));
+    });
+}
+
 SEASTAR_TEST_CASE(test_describe_varchar) {
    // Test that, like cassandra, a varchar column is represented as a text column.
    return do_with_cql_env_thread([] (cql_test_env& e) {
@@ -20,13 +20,17 @@
  */
 
 
+#include <boost/range/irange.hpp>
+#include <deque>
 #include <seastar/core/seastar.hh>
 #include <seastar/core/thread.hh>
+#include <seastar/core/abort_source.hh>
 #include <seastar/testing/test_case.hh>
 #include <seastar/testing/thread_test_case.hh>
 
 #include "test/lib/cql_test_env.hh"
 #include "test/lib/result_set_assertions.hh"
+#include "test/lib/cql_assertions.hh"
 #include "test/lib/reader_permit.hh"
 #include "test/lib/log.hh"
 
@@ -42,6 +46,7 @@
 #include "test/lib/tmpdir.hh"
 #include "db/data_listeners.hh"
 #include "multishard_mutation_query.hh"
+#include "streaming/stream_sstable_files.hh"
 
 using namespace std::chrono_literals;
 
@@ -129,6 +134,55 @@ SEASTAR_TEST_CASE(test_querying_with_limits) {
     });
 }
 
+SEASTAR_THREAD_TEST_CASE(test_batched_counter_updates) {
+    auto cfg = make_shared<db::config>();
+    cfg->counter_update_batching_window_in_us(10000);
+    do_with_cql_env_thread([] (cql_test_env& e) {
+        e.execute_cql("create table ks.cf (p int primary key, c1 counter, c2 counter);").get();
+        // Concurrent updates of the same partition are merged.
+        parallel_for_each(boost::irange(0, 100), [&e] (int i) {
+            return e.execute_cql(format("update ks.cf set c1 = c1 + 1, c2 = c2 + {} where p = 0;", i)).discard_result();
+        }).get();
+        auto batched = e.db().map_reduce0([] (database& db) {
+            return db.get_stats().counter_updates_batched;
+        }, uint64_t(0), std::plus<uint64_t>()).get0();
+        BOOST_REQUIRE_GT(batched, 0U);
+        e.execute_cql("update ks.cf set c1 = c1 - 100 where p = 1;").get();
+
+        assert_that(e.execute_cql("select p, c1, c2 from ks.cf;").get0())
+            .is_rows().with_rows_ignore_order({
+                {int32_type->decompose(0), long_type->decompose(int64_t(100)), long_type->decompose(int64_t(4950))},
+                {int32_type->decompose(1), long_type->decompose(int64_t(-100)), {}},
+            });
+    }, cfg).get();
+}
+
+SEASTAR_TEST_CASE(test_aborting_query) {
+    return do_with_cql_env_thread([] (cql_test_env& e) {
+        e.execute_cql("create table ks.cf (k text, v int, primary key (k));").get();
+        auto& db = e.local_db();
+        auto s = db.find_schema("ks", "cf");
+        dht::partition_range_vector pranges;
+        for (uint32_t i = 1; i <= 10; ++i) {
+            auto pkey = partition_key::from_single_value(*s, to_bytes(format("key{:d}", i)));
+            mutation m(s, pkey);
+            m.set_clustered_cell(clustering_key_prefix::make_empty(), "v", int32_t(42), 1);
+            db.apply(s, freeze(m), tracing::trace_state_ptr(), db::commitlog::force_sync::no, db::no_timeout).get();
+            pranges.emplace_back(dht::partition_range::make_singular(dht::decorate_key(*s, std::move(pkey))));
+        }
+
+        auto max_size = std::numeric_limits<size_t>::max();
+        auto cmd = query::read_command(s->id(), s->version(), partition_slice_builder(*s).build(), query::max_result_size(max_size), query::row_limit(1000));
+
+        abort_source as;
+        auto result = std::get<0>(db.query(s, cmd, query::result_options::only_result(), pranges, nullptr, db::no_timeout, &as).get0());
+        assert_that(query::result_set::from_raw_result(s, cmd.slice, *result)).has_size(10);
+
+        as.request_abort();
+        BOOST_REQUIRE_THROW(db.query(s, cmd, query::result_options::only_result(), pranges, nullptr, db::no_timeout, &as).get(), abort_requested_exception);
+    });
+}
+
 SEASTAR_THREAD_TEST_CASE(test_database_with_data_in_sstables_is_a_mutation_source) {
     do_with_cql_env([] (cql_test_env& e) {
         run_mutation_source_tests([&] (schema_ptr s, const std::vector<mutation>& partitions) -> mutation_source {
@@ -557,3 +611,89 @@ SEASTAR_THREAD_TEST_CASE(read_max_size) {
         return make_ready_future<>();
     }).get();
 }
+
+SEASTAR_THREAD_TEST_CASE(test_sstable_files_round_trip) {
+    using sstable_files_message = std::tuple<sstring, bytes, streaming::stream_sstable_files_cmd>;
+    auto make_source = [] (std::deque<sstable_files_message> messages) -> streaming::sstable_files_source {
+        return [messages = std::move(messages)] () mutable {
+            if (messages.empty()) {
+                return make_ready_future<std::optional<sstable_files_message>>(std::nullopt);
+            }
+            auto m = std::move(messages.front());
+            messages.pop_front();
+            return make_ready_future<std::optional<sstable_files_message>>(std::move(m));
+        };
+    };
+
+    do_with_cql_env_thread([&make_source] (cql_test_env& e) {
+        e.execute_cql("create table ks.src (p int primary key, v int);").get();
+        e.execute_cql("create table ks.dst (p int primary key, v int);").get();
+        for (int i = 0; i < 100; ++i) {
+            e.execute_cql(format("insert into ks.src (p, v) values ({}, {});", i, i)).get();
+        }
+        e.db().invoke_on_all([] (database& db) {
+            return db.find_column_family("ks", "src").flush();
+        }).get();
+
+        auto& src = e.local_db().find_column_family("ks", "src");
+        auto& dst = e.local_db().find_column_family("ks", "dst");
+        BOOST_REQUIRE_GT(src.sstables_count(), 0);
+        auto version = (*src.get_sstables()->begin())->get_version();
+        auto receive = [&] (std::deque<sstable_files_message> messages) {
+            size_t received = 0;
+            return streaming::write_received_sstable_files(e.db(), dst.schema(), dst.schema()->id(), this_shard_id(), version, nullptr,
+                    make_source(std::move(messages)), [&received] (size_t size) { received += size; }).then([&received] {
+                return received;
+            });
+        };
+
+        // A component which is not one of those of the sstable version is rejected.
+        BOOST_REQUIRE_THROW(receive({
+            {"../../x", to_bytes("x"), streaming::stream_sstable_files_cmd::component_data},
+            {sstring(), bytes(), streaming::stream_sstable_files_cmd::end_of_stream},
+        }).get(), std::runtime_error);
+        // So is a component sent before TOC.
+        BOOST_REQUIRE_THROW(receive({
+            {"Data.db", to_bytes("x"), streaming::stream_sstable_files_cmd::component_data},
+            {sstring(), bytes(), streaming::stream_sstable_files_cmd::end_of_stream},
+        }).get(), std::runtime_error);
+        // And an sstable which was not received in full is not added.
+        BOOST_REQUIRE_THROW(receive({
+            {"TOC.txt", to_bytes("x"), streaming::stream_sstable_files_cmd::component_data},
+            {sstring(), bytes(), streaming::stream_sstable_files_cmd::error},
+        }).get(), std::runtime_error);
+        BOOST_REQUIRE_EQUAL(dst.sstables_count(), 0);
+
+        size_t sent = 0;
+        for (auto& sst : *src.get_sstables()) {
+            std::deque<sstable_files_message> messages;
+            std::vector<sstring> components;
+            streaming::read_sstable_files(sst, [&] (const sstring& component, bytes data) {
+                if (components.empty() || components.back() != component) {
+                    components.push_back(component);
+                }
+                sent += data.size();
+                messages.emplace_back(component, std::move(data), streaming::stream_sstable_files_cmd::component_data);
+                return make_ready_future<>();
+            }).get();
+            BOOST_REQUIRE(!components.empty());
+            BOOST_REQUIRE_EQUAL(components.front(), "TOC.txt");
+            messages.emplace_back(sstring(), bytes(), streaming::stream_sstable_files_cmd::end_of_stream);
+            receive(std::move(messages)).get();
+        }
+        BOOST_REQUIRE_GT(sent, 0);
+        BOOST_REQUIRE_EQUAL(dst.sstables_count(), src.sstables_count());
+
+        // The destination holds the partitions of the source owned by this shard.
+        std::vector<std::vector<bytes_opt>> expected;
+        for (int i = 0; i < 100; ++i) {
+            auto key = partition_key::from_single_value(*src.schema(), int32_type->decompose(i));
+            if (dht::shard_of(*src.schema(), dht::decorate_key(*src.schema(), key).token()) == this_shard_id()) {
+                expected.push_back({int32_type->decompose(i), int32_type->decompose(i)});
+            }
+        }
+        BOOST_REQUIRE(!expected.empty());
+        assert_that(e.execute_cql("select p, v from ks.dst;").get0())
+            .is_rows().with_rows_ignore_order(expected);
+    }).get();
+}
@@ -25,12 +25,14 @@
 #include <boost/range/algorithm.hpp>
 #include <boost/test/unit_test.hpp>
 #include <boost/multiprecision/cpp_int.hpp>
+#include <set>
 
 #include <seastar/net/inet_address.hh>
 
 #include <seastar/testing/test_case.hh>
 #include "test/lib/cql_test_env.hh"
 #include "test/lib/cql_assertions.hh"
+#include "database.hh"
 
 #include "seastar/core/future-util.hh"
 #include "seastar/core/sleep.hh"
@@ -1035,6 +1037,41 @@ SEASTAR_TEST_CASE(test_allow_filtering_per_partition_limit) {
     });
 }
 
+SEASTAR_TEST_CASE(test_per_partition_limit_with_paging) {
+    return do_with_cql_env_thread([] (cql_test_env& e) {
+        e.execute_cql("CREATE TABLE t (pk1 int, pk2 text, c int, v int, PRIMARY KEY ((pk1, pk2), c));").get();
+        std::set<std::vector<bytes_opt>> expected;
+        for (int pk = 0; pk < 4; ++pk) {
+            for (int c = 0; c < 5; ++c) {
+                e.execute_cql(format("INSERT INTO t (pk1, pk2, c, v) VALUES ({}, 'key{}', {}, {});", pk, pk, c, pk * 10 + c)).get();
+                if (c < 2) {
+                    expected.insert({int32_type->decompose(pk), utf8_type->decompose(format("key{}", pk)), int32_type->decompose(c), int32_type->decompose(pk * 10 + c)});
+                }
+            }
+        }
+
+        // Pages end in the middle of partitions, and the limit has to carry over to the next page.
+        for (int pg = 1; pg < 12; ++pg) {
+            lw_shared_ptr<service::pager::paging_state> paging_state = nullptr;
+            std::set<std::vector<bytes_opt>> fetched;
+            size_t rows_fetched = 0;
+            do {
+                auto qo = std::make_unique<cql3::query_options>(db::consistency_level::LOCAL_ONE, infinite_timeout_config, std::vector<cql3::raw_value>{},
+                        cql3::query_options::specific_options{pg, paging_state, {}, api::new_timestamp()});
+                auto msg = e.execute_cql("SELECT pk1, pk2, c, v FROM t PER PARTITION LIMIT 2;", std::move(qo)).get0();
+                auto rows = dynamic_pointer_cast<cql_transport::messages::result_message::rows>(msg);
+                for (auto& row : rows->rs().result_set().rows()) {
+                    fetched.insert(row);
+                }
+                rows_fetched += count_rows_fetched(msg);
+                paging_state = extract_paging_state(msg);
+            } while (paging_state);
+            BOOST_REQUIRE_EQUAL(rows_fetched, expected.size());
+            BOOST_REQUIRE(fetched == expected);
+        }
+    });
+}
+
 SEASTAR_TEST_CASE(test_allow_filtering_with_in_on_regular_column) {
     return do_with_cql_env_thread([] (cql_test_env& e) {
         e.execute_cql("CREATE TABLE t (k int, c int, v int, PRIMARY KEY (k, c));").get();
@@ -1083,6 +1120,80 @@ SEASTAR_TEST_CASE(test_allow_filtering_with_in_on_regular_column) {
     });
 }
 
+// Rows which replicas find not to match the filter are sent without their cells,
+// check that they are still dropped and that unselected filtering columns work.
+SEASTAR_TEST_CASE(test_allow_filtering_evaluated_on_replicas) {
+    return do_with_cql_env_thread([] (cql_test_env& e) {
+        cquery_nofail(e, "CREATE TABLE t (k int, c int, v int, w text, PRIMARY KEY (k, c));");
+        cquery_nofail(e, "INSERT INTO t (k, c, v, w) VALUES (1, 1, 1, 'a');");
+        cquery_nofail(e, "INSERT INTO t (k, c, v, w) VALUES (1, 2, 2, 'b');");
+        cquery_nofail(e, "INSERT INTO t (k, c, w) VALUES (1, 3, 'c');");
+        cquery_nofail(e, "INSERT INTO t (k, c, v, w) VALUES (1, 4, 3, 'd');");
+        cquery_nofail(e, "INSERT INTO t (k, c, v) VALUES (2, 1, 4);");
+
+        auto msg = cquery_nofail(e, "SELECT c FROM t WHERE v > 1 AND v <= 3 ALLOW FILTERING;");
+        assert_that(msg).is_rows().with_rows({
+            { int32_type->decompose(2) },
+            { int32_type->decompose(4) },
+        });
+
+        // The rows which don't match are counted as read, but left out of the results.
+        auto sum_stats = [&e] (auto get) {
+            return e.db().map_reduce0([get] (database& db) { return get(db.get_stats()); }, uint64_t(0), std::plus<uint64_t>()).get0();
+        };
+        BOOST_REQUIRE_EQUAL(sum_stats([] (auto& stats) { return stats.filtered_rows_read; }), 5U);
+        BOOST_REQUIRE_EQUAL(sum_stats([] (auto& stats) { return stats.filtered_rows_dropped; }), 3U);
+
+        msg = cquery_nofail(e, "SELECT k, c FROM t WHERE v IN (1, 4) AND w = 'a' ALLOW FILTERING;");
+        assert_that(msg).is_rows().with_rows({
+            { int32_type->decompose(1), int32_type->decompose(1) },
+        });
+
+        auto qo = std::make_unique<cql3::query_options>(db::consistency_level::LOCAL_ONE, infinite_timeout_config, std::vector<cql3::raw_value>{},
+                cql3::query_options::specific_options{1, nullptr, {}, api::new_timestamp()});
+        msg = cquery_nofail(e, "SELECT c FROM t WHERE k = 1 AND v >= 2 ALLOW FILTERING;", std::move(qo));
+        size_t rows_fetched = count_rows_fetched(msg);
+        auto paging_state = extract_paging_state(msg);
+        while (paging_state) {
+            qo = std::make_unique<cql3::query_options>(db::consistency_level::LOCAL_ONE, infinite_timeout_config, std::vector<cql3::raw_value>{},
+                    cql3::query_options::specific_options{1, paging_state, {}, api::new_timestamp()});
+            msg = cquery_nofail(e, "SELECT c FROM t WHERE k = 1 AND v >= 2 ALLOW FILTERING;", std::move(qo));
+            rows_fetched += count_rows_fetched(msg);
+            paging_state = extract_paging_state(msg);
+        }
+        BOOST_REQUIRE_EQUAL(rows_fetched, 2U);
+    });
+}
+
+// Exercises the typed comparisons used when the restrictions are evaluated for a whole page at once.
+SEASTAR_TEST_CASE(test_allow_filtering_typed_comparisons) {
+    return do_with_cql_env_thread([] (cql_test_env& e) {
+        cquery_nofail(e, "CREATE TABLE t (p int, c int, i int, b bigint, ts timestamp, t text, s int static, PRIMARY KEY (p, c));");
+        cquery_nofail(e, "INSERT INTO t (p, c, i, b, ts, t, s) VALUES (1, 1, -5, 10000000000, '2020-01-01 00:00:00+0000', 'abc', 1);");
+        cquery_nofail(e, "INSERT INTO t (p, c, i, b, ts, t) VALUES (1, 2, 7, -1, '2019-01-01 00:00:00+0000', 'abd');");
+        cquery_nofail(e, "INSERT INTO t (p, c, t) VALUES (1, 3, 'xyz');");
+        cquery_nofail(e, "INSERT INTO t (p, c, i) VALUES (1, 4, blobAsInt(0x));");
+        cquery_nofail(e, "INSERT INTO t (p, s) VALUES (2, 2);");
+
+        const auto c1 = int32_type->decompose(1);
+        const auto c2 = int32_type->decompose(2);
+        const auto c3 = int32_type->decompose(3);
+        const auto c4 = int32_type->decompose(4);
+        require_rows(e, "SELECT c, i FROM t WHERE i < 0 ALLOW FILTERING;", {{c1, int32_type->decompose(-5)}, {c4, bytes()}});
+        require_rows(e, "SELECT c, i FROM t WHERE i >= 0 ALLOW FILTERING;", {{c2, int32_type->decompose(7)}});
+        require_rows(e, "SELECT c, b FROM t WHERE b > 0 ALLOW FILTERING;", {{c1, long_type->decompose(int64_t(10000000000))}});
+        require_rows(e, "SELECT c, ts FROM t WHERE ts < '2019-06-01 00:00:00+0000' ALLOW FILTERING;",
+                {{c2, timestamp_type->decompose(db_clock::time_point(std::chrono::milliseconds(1546300800000)))}});
+        require_rows(e, "SELECT c, t FROM t WHERE t > 'abc' ALLOW FILTERING;", {{c2, utf8_type->decompose("abd")}, {c3, utf8_type->decompose("xyz")}});
+        require_rows(e, "SELECT c, t FROM t WHERE t LIKE 'ab%' ALLOW FILTERING;", {{c1, utf8_type->decompose("abc")}, {c2, utf8_type->decompose("abd")}});
+        require_rows(e, "SELECT c, t FROM t WHERE t LIKE '_b_' ALLOW FILTERING;", {{c1, utf8_type->decompose("abc")}, {c2, utf8_type->decompose("abd")}});
+        require_rows(e, "SELECT c, i FROM t WHERE i IN (1, 2, 3, 4, 5, 6, 7, 8, 9, 10) ALLOW FILTERING;", {{c2, int32_type->decompose(7)}});
+        require_rows(e, "SELECT c, i, t FROM t WHERE i IN (-5, 7) AND t = 'abd' ALLOW FILTERING;",
+                {{c2, int32_type->decompose(7), utf8_type->decompose("abd")}});
+        require_rows(e, "SELECT p, c, s FROM t WHERE s = 2 ALLOW FILTERING;", {{int32_type->decompose(2), std::nullopt, int32_type->decompose(2)}});
+    });
+}
+
 SEASTAR_TEST_CASE(test_filtering_on_empty_partition_with_a_static_row) {
     return do_with_cql_env_thread([](cql_test_env& e) {
         cquery_nofail(e, "CREATE TABLE t (p int, c int, s int static, PRIMARY KEY(p, c));");
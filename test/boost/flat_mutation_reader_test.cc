@@ -842,3 +842,92 @@ SEASTAR_THREAD_TEST_CASE(test_reverse_reader_memory_limit) {
     test_with_partition(true);
     test_with_partition(false);
 }
+
+SEASTAR_THREAD_TEST_CASE(test_reverse_reader_keeps_last_rows) {
+    simple_schema schema;
+    auto s = schema.schema();
+
+    // Collects the keys of the first rows it gets, and stops.
+    struct limited_consumer {
+        size_t limit;
+        std::vector<clustering_key>& keys;
+
+        void consume_new_partition(const dht::decorated_key&) { }
+        void consume(tombstone) { }
+        stop_iteration consume(static_row&&) { return stop_iteration::no; }
+        stop_iteration consume(clustering_row&& cr) {
+            keys.push_back(cr.key());
+            return stop_iteration(keys.size() == limit);
+        }
+        stop_iteration consume(range_tombstone&&) { return stop_iteration::no; }
+        stop_iteration consume_end_of_partition() { return stop_iteration::no; }
+        void consume_end_of_stream() { }
+    };
+
+    auto mut = schema.new_mutation("pk1");
+    schema.add_static_row(mut, "s1");
+    const uint32_t nr_rows = 100;
+    for (uint32_t i = 0; i < nr_rows; ++i) {
+        schema.add_row(mut, schema.make_ckey(i), sstring(100, 'v'));
+    }
+    schema.delete_range(mut, query::clustering_range::make({schema.make_ckey(90)}, {schema.make_ckey(95)}));
+
+    // The hard limit only fits a handful of rows.
+    const auto max_size = query::max_result_size(size_t(1) << 12, size_t(1) << 13);
+    const size_t limit = 5;
+
+    auto reader = flat_mutation_reader_from_mutations({mut});
+    auto reverse_reader = make_reversing_reader(reader, max_size);
+    std::vector<clustering_key> keys;
+    reverse_reader.consume(limited_consumer{limit, keys}, db::no_timeout).get();
+
+    BOOST_REQUIRE_EQUAL(keys.size(), limit);
+    clustering_key::equality eq(*s);
+    for (size_t i = 0; i < limit; ++i) {
+        BOOST_REQUIRE(eq(keys[i], schema.make_ckey(nr_rows - 1 - i)));
+    }
+
+    // Consumers getting past the rows kept fail.
+    auto reader2 = flat_mutation_reader_from_mutations({mut});
+    auto reverse_reader2 = make_reversing_reader(reader2, max_size);
+    keys.clear();
+    BOOST_REQUIRE_THROW(reverse_reader2.consume(limited_consumer{nr_rows, keys}, db::no_timeout).get(), std::runtime_error);
+    BOOST_REQUIRE_GT(keys.size(), limit);
+    BOOST_REQUIRE_LT(keys.size(), nr_rows);
+}
+
+SEASTAR_THREAD_TEST_CASE(test_reverse_reader_range_tombstones_memory_limit) {
+    simple_schema schema;
+
+    struct phony_consumer {
+        void consume_new_partition(const dht::decorated_key&) { }
+        void consume(tombstone) { }
+        stop_iteration consume(static_row&&) { return stop_iteration::no; }
+        stop_iteration consume(clustering_row&&) { return stop_iteration::no; }
+        stop_iteration consume(range_tombstone&&) { return stop_iteration::no; }
+        stop_iteration consume_end_of_partition() { return stop_iteration::no; }
+        void consume_end_of_stream() { }
+    };
+
+    // Range tombstones are kept until the end of the partition, and count against the limit.
+    const auto pk = "pk1";
+    auto mut = schema.new_mutation(pk);
+    for (uint32_t i = 0; i < 1000; ++i) {
+        schema.delete_range(mut, query::clustering_range::make_singular(schema.make_ckey(2 * i)));
+    }
+    schema.add_row(mut, schema.make_ckey(2001), "v");
+
+    const uint64_t hard_limit = size_t(1) << 13;
+    auto reader = flat_mutation_reader_from_mutations({mut});
+    auto reverse_reader = make_reversing_reader(reader, query::max_result_size(size_t(1) << 12, hard_limit));
+    try {
+        reverse_reader.consume(phony_consumer{}, db::no_timeout).get();
+        BOOST_FAIL("No exception thrown for reversing a partition with too many range tombstones");
+    } catch (const std::runtime_error& e) {
+        const auto expected_str = format(
+                "Memory usage of range tombstones of reversed read exceeds hard limit of {} (configured via max_memory_for_unlimited_query_hard_limit), while reading partition {}",
+                hard_limit,
+                pk);
+        BOOST_REQUIRE_EQUAL(sstring(e.what()).find(expected_str), 0);
+    }
+}
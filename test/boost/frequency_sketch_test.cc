@@ -0,0 +1,67 @@
+/*
+ * Copyright (C) 2020 ScyllaDB
+ */
+
+/*
+ * This file is part of Scylla.
+ *
+ * Scylla is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Affero General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Scylla is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Scylla.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#define BOOST_TEST_MODULE core
+
+#include <boost/test/unit_test.hpp>
+
+#include "utils/frequency_sketch.hh"
+
+BOOST_AUTO_TEST_CASE(test_estimates_frequency) {
+    utils::frequency_sketch sketch(1024);
+    BOOST_REQUIRE_EQUAL(sketch.capacity(), 1024);
+
+    for (uint64_t key = 0; key < 100; ++key) {
+        for (uint64_t i = 0; i < key % 4; ++i) {
+            sketch.record(key);
+        }
+    }
+    for (uint64_t key = 0; key < 100; ++key) {
+        // Collisions may only make the estimate higher.
+        BOOST_REQUIRE_GE(sketch.estimate(key), key % 4);
+    }
+    BOOST_REQUIRE_EQUAL(sketch.estimate(1000), 0);
+}
+
+BOOST_AUTO_TEST_CASE(test_saturates) {
+    utils::frequency_sketch sketch(16);
+    for (int i = 0; i < 100; ++i) {
+        sketch.record(7);
+    }
+    BOOST_REQUIRE_EQUAL(sketch.estimate(7), utils::frequency_sketch::max_frequency);
+    BOOST_REQUIRE_EQUAL(sketch.resets(), 0);
+}
+
+BOOST_AUTO_TEST_CASE(test_ages) {
+    utils::frequency_sketch sketch(16);
+    for (int i = 0; i < 8; ++i) {
+        sketch.record(7);
+    }
+    BOOST_REQUIRE_EQUAL(sketch.estimate(7), 8);
+
+    uint64_t key = 1000;
+    while (!sketch.resets()) {
+        sketch.record(key++);
+    }
+    // Other keys may have collided with 7, but the counters were halved.
+    BOOST_REQUIRE_GE(sketch.estimate(7), 4);
+    BOOST_REQUIRE_LE(sketch.estimate(7), utils::frequency_sketch::max_frequency / 2);
+}
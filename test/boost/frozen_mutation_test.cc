@@ -122,6 +122,32 @@ SEASTAR_THREAD_TEST_CASE(test_frozen_mutation_fragment) {
     });
 }
 
+SEASTAR_THREAD_TEST_CASE(test_packed_frozen_mutation_fragments) {
+    storage_service_for_tests ssft;
+    for_each_mutation([] (const mutation& m) {
+        auto& s = *m.schema();
+        std::vector<mutation_fragment> mfs;
+        auto rd = flat_mutation_reader_from_mutations({ m });
+        rd.consume_pausable([&] (mutation_fragment mf) {
+            mfs.emplace_back(std::move(mf));
+            return stop_iteration::no;
+        }, db::no_timeout).get();
+
+        std::vector<frozen_mutation_fragment> fmfs;
+        for (auto&& mf : mfs) {
+            fmfs.push_back(freeze(s, mf));
+        }
+        auto unpacked = unpack_frozen_mutation_fragments(pack_frozen_mutation_fragments(fmfs));
+        BOOST_REQUIRE_EQUAL(unpacked.size(), mfs.size());
+        for (size_t i = 0; i < mfs.size(); ++i) {
+            auto refrozen_mf = unpacked[i].unfreeze(s);
+            if (!mfs[i].equal(s, refrozen_mf)) {
+                BOOST_FAIL("Expected " << mutation_fragment::printer(s, mfs[i]) << " got " << mutation_fragment::printer(s, refrozen_mf));
+            }
+        }
+    });
+}
+
 SEASTAR_TEST_CASE(test_deserialization_using_wrong_schema_throws) {
     return seastar::async([] {
         storage_service_for_tests ssft;
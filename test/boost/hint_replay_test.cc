@@ -0,0 +1,221 @@
+/*
+ * Copyright (C) 2020 ScyllaDB
+ */
+
+/*
+ * This file is part of Scylla.
+ *
+ * Scylla is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Affero General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Scylla is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Scylla.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <seastar/testing/test_case.hh>
+#include <seastar/testing/thread_test_case.hh>
+#include <seastar/core/shared_ptr.hh>
+#include <list>
+#include <set>
+#include <vector>
+
+#include "db/hints/send_window.hh"
+#include "db/hints/segment_replay.hh"
+
+using namespace db::hints;
+using namespace std::chrono_literals;
+
+static const auto fast = send_window::latency_target / 2;
+static const auto slow = send_window::latency_target * 2;
+
+SEASTAR_THREAD_TEST_CASE(test_send_window_grows_by_one_per_window) {
+    send_window w(128);
+    auto now = send_window::clock::time_point(1h);
+    BOOST_REQUIRE_EQUAL(w.size(), send_window::initial_size);
+
+    for (size_t i = 0; i < send_window::initial_size - 1; ++i) {
+        BOOST_REQUIRE(!w.on_send_complete(true, fast, now));
+    }
+    BOOST_REQUIRE(w.on_send_complete(true, fast, now));
+    BOOST_REQUIRE_EQUAL(w.size(), send_window::initial_size + 1);
+    BOOST_REQUIRE_EQUAL(w.available(), ssize_t(send_window::initial_size + 1));
+
+    // The next increase takes a whole window of the new size.
+    for (size_t i = 0; i < send_window::initial_size; ++i) {
+        BOOST_REQUIRE(!w.on_send_complete(true, fast, now));
+    }
+    BOOST_REQUIRE(w.on_send_complete(true, fast, now));
+    BOOST_REQUIRE_EQUAL(w.size(), send_window::initial_size + 2);
+}
+
+SEASTAR_THREAD_TEST_CASE(test_send_window_is_capped) {
+    send_window w(send_window::initial_size + 1);
+    auto now = send_window::clock::time_point(1h);
+
+    for (size_t i = 0; i < 10 * send_window::initial_size; ++i) {
+        w.on_send_complete(true, fast, now);
+    }
+    BOOST_REQUIRE_EQUAL(w.size(), send_window::initial_size + 1);
+}
+
+SEASTAR_THREAD_TEST_CASE(test_send_window_halves_on_failure_once_per_target) {
+    send_window w(128);
+    auto now = send_window::clock::time_point(1h);
+
+    BOOST_REQUIRE(w.on_send_complete(false, fast, now));
+    BOOST_REQUIRE_EQUAL(w.size(), send_window::initial_size / 2);
+
+    // Hints sent before the decrease don't decrease the window again.
+    BOOST_REQUIRE(!w.on_send_complete(false, fast, now + send_window::latency_target / 2));
+    BOOST_REQUIRE_EQUAL(w.size(), send_window::initial_size / 2);
+
+    // A slow send counts as a failure.
+    now += send_window::latency_target;
+    BOOST_REQUIRE(w.on_send_complete(true, slow, now));
+    BOOST_REQUIRE_EQUAL(w.size(), send_window::initial_size / 4);
+
+    // The window doesn't go below its minimum.
+    for (int i = 0; i < 10; ++i) {
+        now += send_window::latency_target;
+        w.on_send_complete(false, fast, now);
+    }
+    BOOST_REQUIRE_EQUAL(w.size(), send_window::min_size);
+    BOOST_REQUIRE_EQUAL(w.available(), ssize_t(send_window::min_size));
+
+    // A failure resets the progress towards the next increase.
+    for (size_t i = 0; i < send_window::min_size - 1; ++i) {
+        w.on_send_complete(true, fast, now);
+    }
+    now += send_window::latency_target;
+    w.on_send_complete(false, fast, now);
+    BOOST_REQUIRE(!w.on_send_complete(true, fast, now));
+    BOOST_REQUIRE_EQUAL(w.size(), send_window::min_size);
+}
+
+SEASTAR_THREAD_TEST_CASE(test_send_window_limits_hints_in_flight) {
+    send_window w(128);
+    auto now = send_window::clock::time_point(1h);
+
+    std::vector<semaphore_units<>> in_flight;
+    for (size_t i = 0; i < send_window::initial_size; ++i) {
+        in_flight.push_back(w.get_units().get0());
+    }
+    auto next = w.get_units();
+    BOOST_REQUIRE(!next.available());
+
+    // A decrease takes effect even though the hints are already in flight.
+    w.on_send_complete(false, fast, now);
+    BOOST_REQUIRE_EQUAL(w.available(), -ssize_t(send_window::initial_size / 2));
+    for (size_t i = 0; i < send_window::initial_size / 2; ++i) {
+        in_flight.pop_back();
+    }
+    BOOST_REQUIRE_EQUAL(w.available(), 0);
+    BOOST_REQUIRE(!next.available());
+
+    in_flight.pop_back();
+    in_flight.push_back(next.get0());
+    BOOST_REQUIRE_EQUAL(w.available(), 0);
+}
+
+namespace {
+
+// Replays segments named after the outcome of their replay.
+struct fake_replayer {
+    struct context {
+        sstring segment;
+        bool resume;
+    };
+    using context_ptr = lw_shared_ptr<context>;
+
+    std::set<sstring> failing;
+    std::set<sstring> failing_to_read;
+    size_t max_in_flight_seen = 0;
+    size_t in_flight = 0;
+    std::vector<sstring> started;
+    std::vector<sstring> resumed;
+    std::vector<sstring> finished;
+    std::vector<sstring> abandoned;
+
+    bool replay_allowed() {
+        return true;
+    }
+    context_ptr start(const sstring& segment, bool resume) {
+        started.push_back(segment);
+        if (resume) {
+            resumed.push_back(segment);
+        }
+        max_in_flight_seen = std::max(max_in_flight_seen, ++in_flight);
+        return make_lw_shared<context>(context{segment, resume});
+    }
+    bool should_stop_reading(const context_ptr& ctx) {
+        return failing_to_read.contains(ctx->segment);
+    }
+    bool finish(context_ptr ctx, bool resumed) {
+        BOOST_REQUIRE_EQUAL(resumed, ctx->resume);
+        --in_flight;
+        finished.push_back(ctx->segment);
+        return !failing.contains(ctx->segment) && !failing_to_read.contains(ctx->segment);
+    }
+    void abandon(context_ptr ctx) {
+        --in_flight;
+        abandoned.push_back(ctx->segment);
+    }
+};
+
+}
+
+SEASTAR_THREAD_TEST_CASE(test_segments_are_replayed_in_order_with_overlap) {
+    std::list<sstring> segments{"s0", "s1", "s2", "s3", "s4"};
+    fake_replayer r;
+
+    BOOST_REQUIRE_EQUAL(replay_segments_in_order(segments, 2, r), 5);
+    BOOST_REQUIRE(segments.empty());
+    BOOST_REQUIRE_EQUAL(r.max_in_flight_seen, 2);
+    BOOST_REQUIRE_EQUAL(r.in_flight, 0);
+    BOOST_REQUIRE(r.started == std::vector<sstring>({"s0", "s1", "s2", "s3", "s4"}));
+    BOOST_REQUIRE(r.finished == r.started);
+    // Only the segment at the front of the queue may be resumed from the middle.
+    BOOST_REQUIRE(r.resumed == std::vector<sstring>({"s0"}));
+    BOOST_REQUIRE(r.abandoned.empty());
+}
+
+SEASTAR_THREAD_TEST_CASE(test_failed_segment_stays_at_front) {
+    std::list<sstring> segments{"s0", "s1", "s2", "s3", "s4"};
+    fake_replayer r;
+    r.failing.insert("s1");
+
+    BOOST_REQUIRE_EQUAL(replay_segments_in_order(segments, 3, r), 1);
+    BOOST_REQUIRE(segments == std::list<sstring>({"s1", "s2", "s3", "s4"}));
+    BOOST_REQUIRE_EQUAL(r.in_flight, 0);
+    // s1 failed when s0, s1 and s2 were read, and s3 was read after s0 completed.
+    BOOST_REQUIRE(r.started == std::vector<sstring>({"s0", "s1", "s2", "s3"}));
+    BOOST_REQUIRE(r.finished == std::vector<sstring>({"s0", "s1"}));
+    // The segments following the failed one are going to be replayed from the beginning.
+    BOOST_REQUIRE(r.abandoned == std::vector<sstring>({"s2", "s3"}));
+
+    // The next replay resumes the failed segment.
+    r = fake_replayer();
+    BOOST_REQUIRE_EQUAL(replay_segments_in_order(segments, 3, r), 4);
+    BOOST_REQUIRE(r.resumed == std::vector<sstring>({"s1"}));
+    BOOST_REQUIRE(segments.empty());
+}
+
+SEASTAR_THREAD_TEST_CASE(test_read_failure_stops_reading_segments) {
+    std::list<sstring> segments{"s0", "s1", "s2", "s3"};
+    fake_replayer r;
+    r.failing_to_read.insert("s1");
+
+    BOOST_REQUIRE_EQUAL(replay_segments_in_order(segments, 4, r), 1);
+    BOOST_REQUIRE(segments == std::list<sstring>({"s1", "s2", "s3"}));
+    BOOST_REQUIRE(r.started == std::vector<sstring>({"s0", "s1"}));
+    BOOST_REQUIRE(r.finished == std::vector<sstring>({"s0", "s1"}));
+    BOOST_REQUIRE(r.abandoned.empty());
+    BOOST_REQUIRE_EQUAL(r.in_flight, 0);
+}
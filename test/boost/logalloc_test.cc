@@ -25,6 +25,10 @@
 #include <algorithm>
 #include <chrono>
 #include <random>
+#include <array>
+#include <map>
+#include <optional>
+#include <set>
 
 #include <seastar/core/print.hh>
 #include <seastar/core/thread.hh>
@@ -1366,3 +1370,136 @@ SEASTAR_THREAD_TEST_CASE(test_can_reclaim_contiguous_memory_with_mixed_allocatio
     }
 }
 #endif
+
+SEASTAR_THREAD_TEST_CASE(test_segments_allocated_together_share_huge_pages) {
+    prime_segment_pool(memory::stats().total_memory(), memory::min_free_memory()).get();
+
+    auto cfg = tracker::config{};
+    cfg.lsa_reclamation_step = shard_tracker().reclamation_step();
+    cfg.lsa_huge_pages = true;
+    shard_tracker().configure(cfg);
+
+    using object = managed_ref<std::array<char, 4000>>;
+    auto segment_of = [] (object& o) {
+        return reinterpret_cast<uintptr_t>(o.get()) & ~uintptr_t(segment_size - 1);
+    };
+
+    // Interleave the segments of three regions over the same huge pages.
+    region a, b, d;
+    std::deque<object> a_objs, b_objs, d_objs;
+    auto clean_up = defer([&] {
+        with_allocator(a.allocator(), [&] { a_objs.clear(); });
+        with_allocator(b.allocator(), [&] { b_objs.clear(); });
+        with_allocator(d.allocator(), [&] { d_objs.clear(); });
+    });
+    for (int i = 0; i < 64; ++i) {
+        for (auto [r, objs] : {std::make_pair(&a, &a_objs), std::make_pair(&b, &b_objs), std::make_pair(&d, &d_objs)}) {
+            with_allocator(r->allocator(), [&] {
+                for (int j = 0; j < 32; ++j) {
+                    objs->push_back(make_managed<std::array<char, 4000>>());
+                }
+            });
+        }
+    }
+
+    // Segments freed by b and d, which c can take, by huge page.
+    std::set<uintptr_t> free_segments;
+    std::map<size_t, size_t> free_in_huge_page;
+    auto release = [&] (region& r, std::deque<object>& objs) {
+        std::set<uintptr_t> segments;
+        for (auto& o : objs) {
+            segments.insert(segment_of(o));
+        }
+        for (auto seg : segments) {
+            free_segments.insert(seg);
+            ++free_in_huge_page[shard_tracker().huge_page_of(reinterpret_cast<void*>(seg))];
+        }
+        with_allocator(r.allocator(), [&] { objs.clear(); });
+    };
+    release(b, b_objs);
+
+    // Once c starts allocating in a huge page, it takes all its free segments
+    // before moving to another one, even if segments are freed in other
+    // huge pages in the meantime.
+    region c;
+    std::deque<object> c_objs;
+    auto clean_up_c = defer([&] {
+        with_allocator(c.allocator(), [&] { c_objs.clear(); });
+    });
+    std::optional<uintptr_t> current_segment;
+    std::optional<size_t> current_huge_page;
+    size_t huge_page_changes = 0;
+    size_t segments = 0;
+    bool d_released = false;
+    while (segments < free_segments.size() / 2) {
+        with_allocator(c.allocator(), [&] {
+            c_objs.push_back(make_managed<std::array<char, 4000>>());
+        });
+        auto seg = segment_of(c_objs.back());
+        if (seg == current_segment) {
+            continue;
+        }
+        current_segment = seg;
+        ++segments;
+        auto huge_page = shard_tracker().huge_page_of(c_objs.back().get());
+        if (huge_page != current_huge_page) {
+            if (current_huge_page) {
+                BOOST_REQUIRE_EQUAL(free_in_huge_page[*current_huge_page], 0);
+                ++huge_page_changes;
+            }
+            current_huge_page = huge_page;
+        }
+        if (free_segments.erase(seg)) {
+            --free_in_huge_page[huge_page];
+        }
+        if (huge_page_changes == 2 && !d_released) {
+            release(d, d_objs);
+            d_released = true;
+        }
+    }
+    BOOST_REQUIRE(d_released);
+}
+
+#ifndef SEASTAR_DEFAULT_ALLOCATOR // Because we need memory::stats().free_memory();
+SEASTAR_THREAD_TEST_CASE(test_background_reclaim_does_not_evict_when_memory_is_free) {
+    region evictable;
+    std::deque<managed_ref<std::array<char, 4000>>> objs;
+    size_t evictions = 0;
+    auto clean_up = defer([&] {
+        with_allocator(evictable.allocator(), [&] { objs.clear(); });
+    });
+
+    with_allocator(evictable.allocator(), [&] {
+        for (int i = 0; i < 1024; ++i) {
+            objs.push_back(make_managed<std::array<char, 4000>>());
+        }
+    });
+    evictable.make_evictable([&] () -> memory::reclaiming_result {
+        if (objs.empty()) {
+            return memory::reclaiming_result::reclaimed_nothing;
+        }
+        with_allocator(evictable.allocator(), [&] {
+            objs.pop_front();
+        });
+        ++evictions;
+        return memory::reclaiming_result::reclaimed_something;
+    });
+
+    // Memory is free in seastar, not in the segment pool.
+    shard_tracker().reclaim_all_free_segments();
+    const size_t goal = 64;
+    BOOST_REQUIRE_GT(memory::stats().free_memory(), goal * segment_size);
+
+    auto cfg = tracker::config{};
+    cfg.lsa_reclamation_step = shard_tracker().reclamation_step();
+    cfg.lsa_background_reclaim_segments = goal;
+    cfg.background_reclaim_scheduling_group = default_scheduling_group();
+    shard_tracker().configure(cfg);
+    auto stop = defer([] { shard_tracker().stop().get(); });
+
+    // Several polls of the background reclaimer.
+    sleep(std::chrono::milliseconds(100)).get();
+    BOOST_REQUIRE_EQUAL(evictions, 0);
+    BOOST_REQUIRE_EQUAL(objs.size(), 1024);
+}
+#endif
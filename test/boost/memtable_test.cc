@@ -38,6 +38,7 @@
 #include "test/lib/random_utils.hh"
 #include "test/lib/log.hh"
 #include "test/lib/reader_permit.hh"
+#include "test/lib/simple_schema.hh"
 
 static api::timestamp_type next_timestamp() {
     static thread_local api::timestamp_type next_timestamp = 1;
@@ -169,6 +170,22 @@ SEASTAR_TEST_CASE(test_memtable_flush_reader) {
                     .produces_partition_start(muts[3].decorated_key(), muts[3].partition().partition_tombstone())
                     .next_partition()
                     .produces_end_of_stream();
+
+                testlog.info("Read split by token range");
+                mt = make_memtable(mgr, tbl_stats, muts);
+                auto split = dht::ring_position::starting_at(muts[2].token());
+                auto first_half = dht::partition_range::make_ending_with({split, false});
+                auto second_half = dht::partition_range::make_starting_with({split, true});
+                BOOST_REQUIRE(!mt->empty(first_half));
+                BOOST_REQUIRE(mt->empty(dht::partition_range::make_ending_with({dht::ring_position::starting_at(muts[0].token()), false})));
+                assert_that(mt->make_flush_reader(gen.schema(), default_priority_class(), first_half))
+                    .produces_compacted(compacted_muts[0], now)
+                    .produces_compacted(compacted_muts[1], now)
+                    .produces_end_of_stream();
+                assert_that(mt->make_flush_reader(gen.schema(), default_priority_class(), second_half))
+                    .produces_compacted(compacted_muts[2], now)
+                    .produces_compacted(compacted_muts[3], now)
+                    .produces_end_of_stream();
             }
         };
 
@@ -614,3 +631,55 @@ SEASTAR_THREAD_TEST_CASE(test_collecting_encoding_stats) {
     BOOST_CHECK_EQUAL(stats.min_timestamp, -10);
     BOOST_CHECK(stats.min_ttl == md2_ttl);
 }
+
+SEASTAR_THREAD_TEST_CASE(test_partition_readahead_is_limited_by_partition_row_limit) {
+    simple_schema ss;
+    auto s = ss.schema();
+    auto mt = make_lw_shared<memtable>(s);
+
+    auto m = ss.new_mutation("pk");
+    for (uint32_t i = 0; i < 20; ++i) {
+        ss.add_row(m, ss.make_ckey(i), "v");
+    }
+    mt->apply(m);
+
+    auto slice = s->full_slice();
+    slice.set_partition_row_limit(2);
+    auto pr = dht::partition_range::make_singular(m.decorated_key());
+
+    auto count_buffered_rows = [] (flat_mutation_reader& rd) {
+        rd.fill_buffer(db::no_timeout).get();
+        size_t rows = 0;
+        while (!rd.is_buffer_empty()) {
+            rows += rd.pop_mutation_fragment().is_clustering_row();
+        }
+        return rows;
+    };
+
+    // The limit is read ahead first, then twice as many rows each time the buffer is drained.
+    auto rd = mt->make_flat_reader(s, tests::make_permit(), pr, slice);
+    BOOST_REQUIRE_EQUAL(count_buffered_rows(rd), 2);
+    BOOST_REQUIRE_EQUAL(count_buffered_rows(rd), 4);
+    BOOST_REQUIRE_EQUAL(count_buffered_rows(rd), 8);
+    BOOST_REQUIRE_EQUAL(count_buffered_rows(rd), 6);
+
+    // The row limit bounds the read-ahead too, and so does taking the whole buffer.
+    auto count_detached_rows = [] (flat_mutation_reader& rd) {
+        rd.fill_buffer(db::no_timeout).get();
+        size_t rows = 0;
+        for (auto& mf : rd.detach_buffer()) {
+            rows += mf.is_clustering_row();
+        }
+        return rows;
+    };
+    rd = mt->make_flat_reader(s, tests::make_permit(), pr, s->full_slice());
+    rd.limit_partition_readahead(s->full_slice(), 3);
+    BOOST_REQUIRE_EQUAL(count_detached_rows(rd), 3);
+    BOOST_REQUIRE_EQUAL(count_detached_rows(rd), 6);
+    BOOST_REQUIRE_EQUAL(count_detached_rows(rd), 11);
+
+    // The limit doesn't change what the reader produces.
+    assert_that(mt->make_flat_reader(s, tests::make_permit(), pr, slice))
+        .produces(m)
+        .produces_end_of_stream();
+}
@@ -21,9 +21,11 @@
 
 
 #include <random>
+#include <filesystem>
 #include <boost/range/adaptor/transformed.hpp>
 #include <boost/range/algorithm/copy.hpp>
 #include <boost/range/algorithm_ext/push_back.hpp>
+#include <boost/algorithm/string/predicate.hpp>
 #include "mutation_query.hh"
 #include "hashers.hh"
 #include "xx_hasher.hh"
@@ -44,6 +46,7 @@
 #include "test/lib/tmpdir.hh"
 #include "test/lib/reader_permit.hh"
 #include "sstables/compaction_manager.hh"
+#include "utils/error_injection.hh"
 
 #include <seastar/testing/test_case.hh>
 #include <seastar/testing/thread_test_case.hh>
@@ -608,6 +611,102 @@ SEASTAR_TEST_CASE(test_flush_in_the_middle_of_a_scan) {
     }).then([cf_stats] {});
 }
 
+SEASTAR_TEST_CASE(test_split_flush) {
+    auto s = schema_builder("ks", "cf")
+        .with_column("pk", bytes_type, column_kind::partition_key)
+        .with_column("v", bytes_type)
+        .build();
+
+    auto cf_stats = make_lw_shared<::cf_stats>();
+
+    column_family::config cfg = column_family_test_config();
+    cfg.enable_disk_reads = true;
+    cfg.enable_disk_writes = true;
+    cfg.enable_cache = true;
+    cfg.enable_incremental_backups = false;
+    cfg.cf_stats = &*cf_stats;
+    cfg.memtable_flush_parallelism = utils::updateable_value<uint32_t>(4);
+    cfg.min_split_flush_size = 1;
+
+    return with_column_family(s, cfg, [s, cf_stats] (column_family& cf) {
+        return seastar::async([s, &cf, cf_stats] {
+            storage_service_for_tests ssft;
+            auto make_mutations = [&] (const char* value, api::timestamp_type ts) {
+                std::vector<mutation> mutations;
+                for (int i = 0; i < 1000; ++i) {
+                    auto dk = dht::decorate_key(*s, partition_key::from_single_value(*s, to_bytes(format("key{:d}", i))));
+                    mutation m(s, std::move(dk));
+                    m.set_clustered_cell(clustering_key::make_empty(), "v", data_value(to_bytes(value)), ts);
+                    cf.apply(m);
+                    mutations.emplace_back(std::move(m));
+                }
+                std::sort(mutations.begin(), mutations.end(), mutation_decorated_key_less_comparator());
+                return mutations;
+            };
+            auto assert_reads = [&] (const std::vector<mutation>& mutations) {
+                auto rd = assert_that(cf.make_reader(s, tests::make_permit(), query::full_partition_range));
+                for (auto& m : mutations) {
+                    rd.produces(m);
+                }
+                rd.produces_end_of_stream();
+            };
+            auto count_toc_files = [&] {
+                size_t n = 0;
+                for (auto& de : std::filesystem::directory_iterator(cf.dir().c_str())) {
+                    n += boost::algorithm::ends_with(de.path().filename().string(), "TOC.txt");
+                }
+                return n;
+            };
+
+            auto mutations = make_mutations("value", 1);
+
+            // Continues from the sstables through the cache once the memtable is flushed.
+            auto scanner = assert_that(cf.make_reader(s, tests::make_permit(), query::full_partition_range));
+            scanner.produces(mutations[0]);
+            scanner.produces(mutations[1]);
+
+            cf.flush().get();
+
+            for (unsigned i = 2; i < mutations.size(); ++i) {
+                scanner.produces(mutations[i]);
+            }
+            scanner.produces_end_of_stream();
+            assert_reads(mutations);
+
+            auto ssts = boost::copy_range<std::vector<sstables::shared_sstable>>(*cf.get_sstables());
+            BOOST_REQUIRE_EQUAL(ssts.size(), 4);
+            BOOST_REQUIRE_EQUAL(count_toc_files(), 4);
+            std::sort(ssts.begin(), ssts.end(), [&] (const sstables::shared_sstable& a, const sstables::shared_sstable& b) {
+                return a->get_first_decorated_key().less_compare(*s, b->get_first_decorated_key());
+            });
+            for (size_t i = 1; i < ssts.size(); ++i) {
+                BOOST_REQUIRE(ssts[i]->run_identifier() == ssts[0]->run_identifier());
+                BOOST_REQUIRE(ssts[i - 1]->get_last_decorated_key().less_compare(*s, ssts[i]->get_first_decorated_key()));
+            }
+
+#ifdef SCYLLA_ENABLE_ERROR_INJECTION
+            // A single failed write fails the whole flush, which deletes all the
+            // sstables it wrote and retries.
+            mutations = make_mutations("value2", 2);
+            utils::get_local_injector().enable("table_flush_memtable_write", true);
+            auto flushed = cf.flush();
+            while (cf_stats->failed_memtables_flushes_count == 0) {
+                sleep(10ms).get();
+            }
+            sstables::await_background_jobs().get();
+            BOOST_REQUIRE_EQUAL(cf.get_sstables()->size(), 4);
+            BOOST_REQUIRE_EQUAL(count_toc_files(), 4);
+            assert_reads(mutations);
+
+            flushed.get();
+            BOOST_REQUIRE_EQUAL(cf.get_sstables()->size(), 8);
+            BOOST_REQUIRE_EQUAL(count_toc_files(), 8);
+            assert_reads(mutations);
+#endif
+        });
+    }).then([cf_stats] {});
+}
+
 SEASTAR_TEST_CASE(test_multiple_memtables_multiple_partitions) {
     return seastar::async([] {
     auto s = make_shared_schema({}, some_keyspace, some_column_family,
@@ -2072,6 +2171,43 @@ SEASTAR_THREAD_TEST_CASE(test_row_size_is_immune_to_application_order) {
     BOOST_REQUIRE_EQUAL(size1, size2);
 }
 
+SEASTAR_THREAD_TEST_CASE(test_row_capacity) {
+    auto value = to_bytes("value");
+
+    // reserve() makes room for the last column, so filling the row doesn't reallocate.
+    {
+        row r;
+        r.reserve(6);
+        BOOST_REQUIRE_EQUAL(r.capacity(), 7);
+        for (column_id id = 0; id <= 6; ++id) {
+            r.append_cell(id, make_atomic_cell(value));
+        }
+        BOOST_REQUIRE_EQUAL(r.capacity(), 7);
+    }
+
+    // Appending grows the vector by half, in steps of 4 cells, up to max_vector_size.
+    {
+        row r;
+        std::vector<size_t> capacities{r.capacity()};
+        for (column_id id = 0; id < row::max_vector_size; ++id) {
+            r.append_cell(id, make_atomic_cell(value));
+            if (r.capacity() != capacities.back()) {
+                capacities.push_back(r.capacity());
+            }
+        }
+        BOOST_REQUIRE(capacities == std::vector<size_t>({row::internal_count, 8, 12, 20, row::max_vector_size}));
+    }
+
+    // A sparse row gets room for the appended column, rounded up.
+    {
+        row r;
+        r.append_cell(9, make_atomic_cell(value));
+        BOOST_REQUIRE_EQUAL(r.capacity(), 12);
+        r.append_cell(10, make_atomic_cell(value));
+        BOOST_REQUIRE_EQUAL(r.capacity(), 12);
+    }
+}
+
 SEASTAR_THREAD_TEST_CASE(test_schema_changes) {
     for_each_schema_change([] (schema_ptr base, const std::vector<mutation>& base_mutations,
                                schema_ptr changed, const std::vector<mutation>& changed_mutations) {
@@ -0,0 +1,233 @@
+/*
+ * Copyright (C) 2020 ScyllaDB
+ */
+
+/*
+ * This file is part of Scylla.
+ *
+ * Scylla is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Affero General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Scylla is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Scylla.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <deque>
+
+#include <seastar/core/sleep.hh>
+
+#include <seastar/testing/test_case.hh>
+#include "test/lib/cql_test_env.hh"
+#include "test/lib/cql_assertions.hh"
+
+#include "db/extensions.hh"
+#include "db/config.hh"
+#include "db/result_cache_extension.hh"
+#include "db/data_listeners.hh"
+#include "cql3/query_processor.hh"
+#include "cql3/result_cache.hh"
+#include "streaming/stream_sstable_files.hh"
+
+#include "transport/messages/result_message.hh"
+
+static shared_ptr<db::config> make_config() {
+    auto ext = std::make_shared<db::extensions>();
+    ext->add_schema_extension<db::result_cache_extension>(db::result_cache_extension::NAME);
+    return ::make_shared<db::config>(ext);
+}
+
+static cql3::raw_value int_value(int32_t v) {
+    return cql3::raw_value::make_value(int32_type->decompose(v));
+}
+
+// Returns the first partition key at or after the given one which is owned by this shard,
+// the only one caching the results of the partition.
+static int32_t local_partition_key(const schema& s, int32_t pk = 0) {
+    while (dht::shard_of(s, dht::get_token(s, partition_key::from_single_value(s, int32_type->decompose(pk)))) != this_shard_id()) {
+        ++pk;
+    }
+    return pk;
+}
+
+SEASTAR_TEST_CASE(test_result_cache) {
+    return do_with_cql_env_thread([] (cql_test_env& e) {
+        e.execute_cql("CREATE TABLE cf (pk int PRIMARY KEY, v int) WITH result_cache_ttl_in_ms = 600000").get();
+        auto s = e.local_db().find_schema("ks", "cf");
+        BOOST_REQUIRE(!s->extensions().at(db::result_cache_extension::NAME)->is_placeholder());
+        BOOST_REQUIRE(s->result_cache_ttl() == std::chrono::milliseconds(600000));
+
+        auto& cache = e.local_qp().get_result_cache();
+        auto select = e.prepare("SELECT v FROM cf WHERE pk = ?").get0();
+        auto insert = e.prepare("INSERT INTO cf (pk, v) VALUES (?, ?)").get0();
+        auto pk = local_partition_key(*s);
+
+        e.execute_prepared(insert, {int_value(pk), int_value(1)}).get();
+        auto hits = cache.get_stats().hits;
+        for (int i = 0; i < 3; ++i) {
+            assert_that(e.execute_prepared(select, {int_value(pk)}).get0())
+                .is_rows().with_rows({{int32_type->decompose(int32_t(1))}});
+        }
+        BOOST_REQUIRE_EQUAL(cache.get_stats().hits, hits + 2);
+
+        // Writes to the partition invalidate its cached results.
+        e.execute_prepared(insert, {int_value(pk), int_value(2)}).get();
+        assert_that(e.execute_prepared(select, {int_value(pk)}).get0())
+            .is_rows().with_rows({{int32_type->decompose(int32_t(2))}});
+        BOOST_REQUIRE_EQUAL(cache.get_stats().hits, hits + 2);
+        assert_that(e.execute_prepared(select, {int_value(pk)}).get0())
+            .is_rows().with_rows({{int32_type->decompose(int32_t(2))}});
+        BOOST_REQUIRE_EQUAL(cache.get_stats().hits, hits + 3);
+
+        // Tables which don't opt in aren't cached.
+        e.execute_cql("ALTER TABLE cf WITH result_cache_ttl_in_ms = 0").get();
+        auto select_again = e.prepare("SELECT v FROM cf WHERE pk = ?").get0();
+        assert_that(e.execute_prepared(select_again, {int_value(pk)}).get0())
+            .is_rows().with_rows({{int32_type->decompose(int32_t(2))}});
+        assert_that(e.execute_prepared(select_again, {int_value(pk)}).get0())
+            .is_rows().with_rows({{int32_type->decompose(int32_t(2))}});
+        BOOST_REQUIRE_EQUAL(cache.get_stats().hits, hits + 3);
+    }, make_config());
+}
+
+SEASTAR_TEST_CASE(test_result_cache_invalidation) {
+    return do_with_cql_env_thread([] (cql_test_env& e) {
+        e.execute_cql("CREATE TABLE cf (pk int PRIMARY KEY, v int) WITH result_cache_ttl_in_ms = 600000").get();
+        e.execute_cql("CREATE TABLE src (pk int PRIMARY KEY, v int)").get();
+        auto s = e.local_db().find_schema("ks", "cf");
+        auto& cache = e.local_qp().get_result_cache();
+        auto select = e.prepare("SELECT v FROM cf WHERE pk = ?").get0();
+        auto insert = e.prepare("INSERT INTO cf (pk, v) VALUES (?, ?)").get0();
+        auto pk = local_partition_key(*s);
+        // Reads the partition twice, and checks the second read is served from the cache.
+        auto require_cached = [&] (int32_t v) {
+            auto hits = cache.get_stats().hits;
+            for (int i = 0; i < 2; ++i) {
+                assert_that(e.execute_prepared(select, {int_value(pk)}).get0())
+                    .is_rows().with_rows({{int32_type->decompose(v)}});
+            }
+            BOOST_REQUIRE_EQUAL(cache.get_stats().hits, hits + 1);
+        };
+
+        // Writes are seen by the data listeners once they are applied.
+        struct apply_checker : public db::data_listener {
+            database& db;
+            bool applied_before_notification = false;
+            explicit apply_checker(database& db) : db(db) { }
+            virtual void on_write(const schema_ptr& s, const frozen_mutation& m) override {
+                applied_before_notification = db.find_column_family(s->id()).active_memtable().partition_count() > 0;
+            }
+        };
+        apply_checker checker(e.local_db());
+        e.local_db().data_listeners().install(&checker);
+        e.execute_prepared(insert, {int_value(pk), int_value(1)}).get();
+        e.local_db().data_listeners().uninstall(&checker);
+        BOOST_REQUIRE(checker.applied_before_notification);
+        require_cached(1);
+
+        // Truncating the table invalidates its results.
+        e.execute_cql("TRUNCATE cf").get();
+        assert_that(e.execute_prepared(select, {int_value(pk)}).get0()).is_rows().is_empty();
+
+        // So do sstables added to the table, here by streaming them as files.
+        e.execute_prepared(insert, {int_value(pk), int_value(1)}).get();
+        require_cached(1);
+        e.execute_cql(format("INSERT INTO src (pk, v) VALUES ({}, 2)", pk)).get();
+        auto& src = e.local_db().find_column_family("ks", "src");
+        src.flush().get();
+        for (auto& sst : *src.get_sstables()) {
+            auto messages = make_lw_shared<std::deque<std::tuple<sstring, bytes, streaming::stream_sstable_files_cmd>>>();
+            streaming::read_sstable_files(sst, [messages] (const sstring& component, bytes data) {
+                messages->emplace_back(component, std::move(data), streaming::stream_sstable_files_cmd::component_data);
+                return make_ready_future<>();
+            }).get();
+            messages->emplace_back(sstring(), bytes(), streaming::stream_sstable_files_cmd::end_of_stream);
+            streaming::write_received_sstable_files(e.db(), s, s->id(), this_shard_id(), sst->get_version(), nullptr, [messages] {
+                using message = std::tuple<sstring, bytes, streaming::stream_sstable_files_cmd>;
+                if (messages->empty()) {
+                    return make_ready_future<std::optional<message>>(std::nullopt);
+                }
+                auto m = std::move(messages->front());
+                messages->pop_front();
+                return make_ready_future<std::optional<message>>(std::move(m));
+            }, [] (size_t) { }).get();
+        }
+        require_cached(2);
+
+        // Statements calling non-pure functions aren't cached, since their key doesn't capture what the functions return.
+        e.execute_cql("CREATE TABLE events (pk int, t timeuuid, v int, PRIMARY KEY (pk, t)) WITH result_cache_ttl_in_ms = 600000").get();
+        e.execute_cql(format("INSERT INTO events (pk, t, v) VALUES ({}, now(), 1)", pk)).get();
+        auto select_past = e.prepare("SELECT v FROM events WHERE pk = ? AND t < now()").get0();
+        auto hits = cache.get_stats().hits;
+        for (int i = 0; i < 2; ++i) {
+            assert_that(e.execute_prepared(select_past, {int_value(pk)}).get0())
+                .is_rows().with_rows({{int32_type->decompose(int32_t(1))}});
+        }
+        BOOST_REQUIRE_EQUAL(cache.get_stats().hits, hits);
+    }, make_config());
+}
+
+SEASTAR_TEST_CASE(test_result_cache_expiring_cells) {
+    return do_with_cql_env_thread([] (cql_test_env& e) {
+        e.execute_cql("CREATE TABLE cf (pk int PRIMARY KEY, v int) WITH result_cache_ttl_in_ms = 600000").get();
+        auto s = e.local_db().find_schema("ks", "cf");
+        auto& cache = e.local_qp().get_result_cache();
+        auto select = e.prepare("SELECT v FROM cf WHERE pk = ?").get0();
+        auto pk = local_partition_key(*s);
+
+        // Results with expiring cells are only cached until the cells expire.
+        e.execute_prepared(e.prepare("INSERT INTO cf (pk, v) VALUES (?, ?) USING TTL 4").get0(), {int_value(pk), int_value(1)}).get();
+        auto hits = cache.get_stats().hits;
+        for (int i = 0; i < 2; ++i) {
+            assert_that(e.execute_prepared(select, {int_value(pk)}).get0())
+                .is_rows().with_rows({{int32_type->decompose(int32_t(1))}});
+        }
+        BOOST_REQUIRE_EQUAL(cache.get_stats().hits, hits + 1);
+        seastar::sleep(std::chrono::seconds(5)).get();
+        assert_that(e.execute_prepared(select, {int_value(pk)}).get0()).is_rows().is_empty();
+
+        // Rows without any selected cell may be alive only thanks to their row marker, whose
+        // expiry isn't known, so their results aren't cached.
+        e.execute_prepared(e.prepare("INSERT INTO cf (pk) VALUES (?) USING TTL 4").get0(), {int_value(pk)}).get();
+        hits = cache.get_stats().hits;
+        for (int i = 0; i < 2; ++i) {
+            assert_that(e.execute_prepared(select, {int_value(pk)}).get0())
+                .is_rows().with_rows({{bytes_opt()}});
+        }
+        BOOST_REQUIRE_EQUAL(cache.get_stats().hits, hits);
+    }, make_config());
+}
+
+SEASTAR_TEST_CASE(test_result_cache_generation_is_per_partition) {
+    return do_with_cql_env_thread([] (cql_test_env& e) {
+        e.execute_cql("CREATE TABLE cf (pk int PRIMARY KEY, v int) WITH result_cache_ttl_in_ms = 600000").get();
+        auto s = e.local_db().find_schema("ks", "cf");
+        auto& cache = e.local_qp().get_result_cache();
+        auto insert = e.prepare("INSERT INTO cf (pk, v) VALUES (?, ?)").get0();
+        auto token_of = [&] (int32_t pk) {
+            return dht::get_token(*s, partition_key::from_single_value(*s, int32_type->decompose(pk)));
+        };
+        auto pk = local_partition_key(*s);
+        auto other_pk = local_partition_key(*s, pk + 1);
+
+        // A write only fails the insertion of results read concurrently from its own partition.
+        auto generation = cache.generation(token_of(pk));
+        auto other_generation = cache.generation(token_of(other_pk));
+        e.execute_prepared(insert, {int_value(other_pk), int_value(1)}).get();
+        BOOST_REQUIRE_EQUAL(cache.generation(token_of(pk)), generation);
+        BOOST_REQUIRE_NE(cache.generation(token_of(other_pk)), other_generation);
+        e.execute_prepared(insert, {int_value(pk), int_value(1)}).get();
+        BOOST_REQUIRE_NE(cache.generation(token_of(pk)), generation);
+
+        // Invalidations of a range fail all of them.
+        generation = cache.generation(token_of(pk));
+        e.execute_cql("TRUNCATE cf").get();
+        BOOST_REQUIRE_NE(cache.generation(token_of(pk)), generation);
+    }, make_config());
+}
@@ -1795,6 +1795,193 @@ SEASTAR_TEST_CASE(test_lru) {
     });
 }
 
+SEASTAR_TEST_CASE(test_frequent_admission) {
+    return seastar::async([] {
+        auto s = schema_builder(make_schema())
+            .set_caching_options(caching_options::from_map(std::map<sstring, sstring>{{"admission", "FREQUENT"}}))
+            .build();
+        auto mt = make_lw_shared<memtable>(s);
+
+        std::vector<mutation> partitions = make_ring(s, 3);
+        for (auto&& m : partitions) {
+            mt->apply(m);
+        }
+
+        cache_tracker tracker;
+        row_cache cache(s, snapshot_source_from_snapshot(mt->as_data_source()), tracker);
+
+        auto read = [&] (const mutation& m) {
+            auto pr = dht::partition_range::make_singular(m.decorated_key());
+            assert_that(cache.make_reader(s, tests::make_permit(), pr))
+                .produces(m)
+                .produces_end_of_stream();
+        };
+
+        // Nothing was evicted yet, everything is admitted.
+        read(partitions[0]);
+        BOOST_REQUIRE_EQUAL(tracker.partitions(), 1);
+
+        evict_one_partition(tracker);
+
+        read(partitions[1]);
+        BOOST_REQUIRE_EQUAL(tracker.partitions(), 0);
+        BOOST_REQUIRE_EQUAL(tracker.get_stats().partitions_not_admitted, 1);
+
+        read(partitions[1]);
+        BOOST_REQUIRE_EQUAL(tracker.partitions(), 1);
+
+        // partitions[0] was read before, partitions[2] wasn't.
+        assert_that(cache.make_reader(s, tests::make_permit()))
+            .produces(partitions[0])
+            .produces(partitions[1])
+            .produces(partitions[2])
+            .produces_end_of_stream();
+        BOOST_REQUIRE_EQUAL(tracker.partitions(), 2);
+        BOOST_REQUIRE_EQUAL(tracker.get_stats().partitions_not_admitted, 2);
+    });
+}
+
+SEASTAR_TEST_CASE(test_hottest_keys) {
+    return seastar::async([] {
+        auto s = make_schema();
+        auto mt = make_lw_shared<memtable>(s);
+
+        std::vector<mutation> partitions = make_ring(s, 3);
+        for (auto&& m : partitions) {
+            mt->apply(m);
+        }
+
+        cache_tracker tracker;
+        row_cache cache(s, snapshot_source_from_snapshot(mt->as_data_source()), tracker);
+
+        auto read = [&] (const mutation& m) {
+            auto pr = dht::partition_range::make_singular(m.decorated_key());
+            assert_that(cache.make_reader(s, tests::make_permit(), pr))
+                .produces(m)
+                .produces_end_of_stream();
+        };
+
+        for (int i = 0; i < 3; ++i) {
+            read(partitions[2]);
+        }
+        read(partitions[1]);
+        read(partitions[1]);
+        read(partitions[0]);
+
+        auto keys = cache.get_hottest_keys(2).get0();
+        BOOST_REQUIRE_EQUAL(keys.size(), 2);
+        BOOST_REQUIRE(keys[0].equal(*s, partitions[2].decorated_key()));
+        BOOST_REQUIRE(keys[1].equal(*s, partitions[1].decorated_key()));
+
+        keys = cache.get_hottest_keys(0).get0();
+        BOOST_REQUIRE_EQUAL(keys.size(), 3);
+        BOOST_REQUIRE(keys[2].equal(*s, partitions[0].decorated_key()));
+    });
+}
+
+SEASTAR_TEST_CASE(test_cold_rows_are_evicted_as_a_range) {
+    return seastar::async([] {
+        simple_schema s;
+        cache_tracker tracker;
+        memtable_snapshot_source underlying(s.schema());
+
+        auto pk = s.make_pkey();
+        auto pr = dht::partition_range::make_singular(pk);
+        mutation m(s.schema(), pk);
+        for (auto&& ck : s.make_ckeys(10)) {
+            s.add_row(m, ck, "val");
+        }
+        underlying.apply(m);
+
+        row_cache cache(s.schema(), snapshot_source([&] { return underlying(); }), tracker);
+
+        assert_that(cache.make_reader(s.schema(), tests::make_permit(), pr))
+            .produces(m)
+            .produces_end_of_stream();
+        // 10 rows and the last dummy.
+        BOOST_REQUIRE_EQUAL(tracker.get_stats().rows, 11);
+
+        auto slice = partition_slice_builder(*s.schema())
+            .with_range(s.make_ckey_range(0, 2))
+            .build();
+        auto read_head = [&] {
+            assert_that(cache.make_reader(s.schema(), tests::make_permit(), pr, slice))
+                .produces(m, slice.row_ranges(*s.schema(), pk.key()))
+                .produces_end_of_stream();
+        };
+        read_head();
+        read_head();
+
+        // The least recently used row is the first one after the head. The rest of
+        // the cold rows were cached with it, so they are still referenced when it's
+        // evicted, and are only passed over.
+        while (tracker.get_stats().rows == 11) {
+            BOOST_REQUIRE(tracker.region().evict_some() == memory::reclaiming_result::reclaimed_something);
+        }
+        BOOST_REQUIRE_EQUAL(tracker.get_stats().rows, 10);
+        BOOST_REQUIRE_EQUAL(tracker.get_stats().row_range_evictions, 0);
+
+        // The next eviction evicts them together, but not with the head.
+        while (tracker.get_stats().rows == 10) {
+            BOOST_REQUIRE(tracker.region().evict_some() == memory::reclaiming_result::reclaimed_something);
+        }
+        BOOST_REQUIRE_EQUAL(tracker.get_stats().rows, 4);
+        BOOST_REQUIRE_EQUAL(tracker.get_stats().row_range_evictions, 5);
+
+        auto misses = tracker.get_stats().reads_with_misses;
+        read_head();
+        BOOST_REQUIRE_EQUAL(tracker.get_stats().reads_with_misses, misses);
+    });
+}
+
+SEASTAR_TEST_CASE(test_freshly_cached_rows_are_not_evicted_as_cold_neighbours) {
+    return seastar::async([] {
+        simple_schema s;
+        cache_tracker tracker;
+        memtable_snapshot_source underlying(s.schema());
+
+        auto pk = s.make_pkey();
+        auto pr = dht::partition_range::make_singular(pk);
+        mutation m(s.schema(), pk);
+        for (auto&& ck : s.make_ckeys(10)) {
+            s.add_row(m, ck, "val");
+        }
+        underlying.apply(m);
+
+        row_cache cache(s.schema(), snapshot_source([&] { return underlying(); }), tracker);
+
+        auto read = [&] (uint32_t start, uint32_t end) {
+            auto slice = partition_slice_builder(*s.schema())
+                .with_range(s.make_ckey_range(start, end))
+                .build();
+            assert_that(cache.make_reader(s.schema(), tests::make_permit(), pr, slice))
+                .produces(m, slice.row_ranges(*s.schema(), pk.key()))
+                .produces_end_of_stream();
+        };
+        auto evict_a_row = [&] {
+            auto rows = tracker.get_stats().rows;
+            while (tracker.get_stats().rows == rows) {
+                BOOST_REQUIRE(tracker.region().evict_some() == memory::reclaiming_result::reclaimed_something);
+            }
+        };
+
+        // The first eviction passes over the rest of the cold rows.
+        read(0, 4);
+        evict_a_row();
+        BOOST_REQUIRE_EQUAL(tracker.get_stats().row_range_evictions, 0);
+
+        // The next one evicts them together, but not the rows which were cached
+        // next to them in the meantime, though they were never read since.
+        read(5, 9);
+        evict_a_row();
+        BOOST_REQUIRE_GE(tracker.get_stats().row_range_evictions, 3);
+
+        auto misses = tracker.get_stats().reads_with_misses;
+        read(5, 9);
+        BOOST_REQUIRE_EQUAL(tracker.get_stats().reads_with_misses, misses);
+    });
+}
+
 SEASTAR_TEST_CASE(test_update_invalidating) {
     return seastar::async([] {
         simple_schema s;
@@ -38,6 +38,7 @@
 #include <seastar/core/seastar.hh>
 #include <seastar/core/do_with.hh>
 #include "sstables/compaction_manager.hh"
+#include "sstables/partition_locator.hh"
 #include "test/lib/tmpdir.hh"
 #include "dht/i_partitioner.hh"
 #include "dht/murmur3_partitioner.hh"
@@ -6666,3 +6667,92 @@ SEASTAR_TEST_CASE(test_zero_estimated_partitions) {
         return make_ready_future<>();
     });
 }
+
+SEASTAR_TEST_CASE(test_partition_locator) {
+    return test_env::do_with_async([] (test_env& env) {
+        storage_service_for_tests ssft;
+        simple_schema ss;
+        auto s = ss.schema();
+        auto tmp = tmpdir();
+        auto sst_gen = [&env, s, &tmp, gen = make_lw_shared<unsigned>(1)] () mutable {
+            return env.make_sstable(s, tmp.path().string(), (*gen)++, sstables::sstable::version_types::mc, big);
+        };
+
+        auto keys = make_local_keys(8, s);
+        auto make_mutation = [&] (unsigned i) {
+            auto mut = mutation(s, ss.make_pkey(keys[i]));
+            ss.add_row(mut, ss.make_ckey(0), "val");
+            return mut;
+        };
+        // sst1 holds the even keys and sst2 the odd ones.
+        std::vector<mutation> even, odd;
+        for (unsigned i = 0; i < keys.size(); ++i) {
+            (i % 2 ? odd : even).push_back(make_mutation(i));
+        }
+        auto sst1 = make_sstable_containing(sst_gen, even);
+        auto sst2 = make_sstable_containing(sst_gen, odd);
+
+        sstables::partition_locator locator(1 << 20);
+        locator.add(sst1, tests::semaphore());
+        locator.add(sst2, tests::semaphore());
+        sstables::await_background_jobs().get();
+        BOOST_REQUIRE_EQUAL(locator.get_stats().indexed_sstables, 2);
+        BOOST_REQUIRE_GT(locator.memory_used(), 0);
+
+        for (unsigned i = 0; i < keys.size(); ++i) {
+            auto pk = ss.make_pkey(keys[i]);
+            auto candidates = locator.lookup(sstables::sstable::make_hashed_key(*s, pk.key()));
+            BOOST_REQUIRE_EQUAL(*locator.may_contain(candidates, *sst1), i % 2 == 0);
+            BOOST_REQUIRE_EQUAL(*locator.may_contain(candidates, *sst2), i % 2 == 1);
+        }
+
+        locator.remove(*sst1);
+        BOOST_REQUIRE_EQUAL(locator.get_stats().indexed_sstables, 1);
+        auto candidates = locator.lookup(sstables::sstable::make_hashed_key(*s, ss.make_pkey(keys[0]).key()));
+        BOOST_REQUIRE(!locator.may_contain(candidates, *sst1));
+
+        // Indexing more keys than fit in the initial table rebuilds it, drops
+        // the entries of sst1 and keeps those of sst2.
+        auto many_keys = make_local_keys(1000, s);
+        std::vector<mutation> many;
+        for (auto& k : many_keys) {
+            auto mut = mutation(s, ss.make_pkey(k));
+            ss.add_row(mut, ss.make_ckey(0), "val");
+            many.push_back(std::move(mut));
+        }
+        auto sst3 = make_sstable_containing(sst_gen, many);
+        locator.add(sst3, tests::semaphore());
+        sstables::await_background_jobs().get();
+        BOOST_REQUIRE_EQUAL(locator.get_stats().indexed_sstables, 2);
+        BOOST_REQUIRE_GE(locator.memory_used(), 2048 * sizeof(uint64_t));
+        BOOST_REQUIRE_LE(locator.memory_used(), locator.memory_limit());
+        for (auto& k : many_keys) {
+            auto candidates = locator.lookup(sstables::sstable::make_hashed_key(*s, ss.make_pkey(k).key()));
+            BOOST_REQUIRE(*locator.may_contain(candidates, *sst3));
+        }
+        for (unsigned i = 1; i < keys.size(); i += 2) {
+            auto candidates = locator.lookup(sstables::sstable::make_hashed_key(*s, ss.make_pkey(keys[i]).key()));
+            BOOST_REQUIRE(*locator.may_contain(candidates, *sst2));
+        }
+
+        // Lowering the limit below the size of the table evicts sst3, the
+        // largest sstable, right away, and shrinks the table.
+        locator.set_memory_limit(locator.memory_used() - 1);
+        BOOST_REQUIRE_EQUAL(locator.get_stats().indexed_sstables, 1);
+        candidates = locator.lookup(sstables::sstable::make_hashed_key(*s, ss.make_pkey(many_keys[0]).key()));
+        BOOST_REQUIRE(!locator.may_contain(candidates, *sst3));
+        sstables::await_background_jobs().get();
+        BOOST_REQUIRE_LE(locator.memory_used(), locator.memory_limit());
+        for (unsigned i = 1; i < keys.size(); i += 2) {
+            auto candidates = locator.lookup(sstables::sstable::make_hashed_key(*s, ss.make_pkey(keys[i]).key()));
+            BOOST_REQUIRE(*locator.may_contain(candidates, *sst2));
+        }
+
+        // A locator without enough memory for the keys leaves sstables unindexed.
+        sstables::partition_locator small_locator(1);
+        small_locator.add(sst2, tests::semaphore());
+        sstables::await_background_jobs().get();
+        BOOST_REQUIRE_EQUAL(small_locator.get_stats().indexed_sstables, 0);
+        BOOST_REQUIRE_EQUAL(small_locator.get_stats().rejected_sstables, 1);
+    });
+}
@@ -580,3 +580,115 @@ SEASTAR_TEST_CASE(sstable_directory_shared_sstables_reshard_respect_max_threshol
         verify_that_all_sstables_are_local(sstdir, 2 * smp::count * smp::count).get();
     });
 }
+
+// Leveled SSTables have to stay disjoint within each level above 0 after resharding, even though
+// a level holds more data than the even share of a single shard.
+SEASTAR_TEST_CASE(sstable_directory_shared_sstables_reshard_keeps_levels_disjoint) {
+    if (smp::count == 1) {
+        fmt::print("Skipping sstable_directory_shared_sstables_reshard_keeps_levels_disjoint, smp == 1\n");
+        return make_ready_future<>();
+    }
+
+    return do_with_cql_env_thread([] (cql_test_env& e) {
+        e.execute_cql("create table cf (p text PRIMARY KEY, c int) with compaction = {'class': 'LeveledCompactionStrategy'}").get();
+        auto& cf = e.local_db().find_column_family("ks", "cf");
+        auto s = cf.schema();
+        auto upload_path = fs::path(cf.dir()) / "upload";
+
+        e.db().invoke_on_all([] (database& db) {
+            auto& cf = db.find_column_family("ks", "cf");
+            cf.disable_auto_compaction();
+        }).get();
+
+        // Keys of all shards in ring order, cut into consecutive slices, so that each level is
+        // a run of SSTables which are disjoint but most likely shared by neighbouring shards.
+        auto msb = e.local_db().get_config().murmur3_partitioner_ignore_msb_bits();
+        std::vector<mutation> muts;
+        for (shard_id shard = 0; shard < smp::count; ++shard) {
+            for (auto& key_token_pair : token_generation_for_shard(4, shard, msb)) {
+                auto key = partition_key::from_exploded(*s, {to_bytes(key_token_pair.first)});
+                mutation m(s, key);
+                m.set_clustered_cell(clustering_key::make_empty(), bytes("c"), data_value(int32_t(0)), api::timestamp_type(0));
+                muts.push_back(std::move(m));
+            }
+        }
+        std::sort(muts.begin(), muts.end(), mutation_decorated_key_less_comparator());
+
+        auto generation = 0;
+        const unsigned sstables_per_level = smp::count;
+        const unsigned keys_per_sstable = muts.size() / sstables_per_level;
+        for (uint32_t level = 1; level <= 2; ++level) {
+            for (unsigned nr = 0; nr < sstables_per_level; ++nr) {
+                auto mt = make_lw_shared<memtable>(s);
+                for (unsigned i = nr * keys_per_sstable; i < (nr + 1) * keys_per_sstable; ++i) {
+                    mt->apply(muts[i]);
+                }
+                auto gen = generation++;
+                auto sst = cf.make_sstable(upload_path.native(), gen, sstables::sstable_version_types::mc, sstables::sstable::format_types::big);
+                write_memtable_to_sstable(*mt, sst, cf.get_sstables_manager().configure_writer()).get();
+                mt->clear_gently().get();
+                sst = cf.make_sstable(upload_path.native(), gen, sstables::sstable_version_types::mc, sstables::sstable::format_types::big);
+                sst->load().get();
+                sst->mutate_sstable_level(level).get();
+                sstables::test(sst).remove_component(sstables::component_type::Scylla).get();
+                sstables::test(sst).rewrite_toc_without_scylla_component();
+            }
+        }
+
+        sharded<sstable_directory> sstdir;
+        sstdir.start(upload_path, 1,
+                sstable_directory::need_mutate_level::no,
+                sstable_directory::lack_of_toc_fatal::yes,
+                sstable_directory::enable_dangerous_direct_import_of_cassandra_counters::no,
+                sstable_directory::allow_loading_materialized_view::no,
+                [&e] (fs::path dir, int64_t gen, sstables::sstable_version_types v, sstables::sstable_format_types f) {
+                    auto& cf = e.local_db().find_column_family("ks", "cf");
+                    return cf.make_sstable(dir.native(), gen, v, f);
+                }).get();
+
+        auto stop = defer([&sstdir] {
+            sstdir.stop().get();
+        });
+
+        distributed_loader::process_sstable_dir(sstdir).get();
+
+        int64_t max_generation_seen = highest_generation_seen(sstdir).get0();
+        std::atomic<int64_t> generation_for_test = {};
+        generation_for_test.store(max_generation_seen + 1, std::memory_order_relaxed);
+
+        distributed_loader::reshard(sstdir, e.db(), "ks", "cf", [&e, upload_path, &generation_for_test] (shard_id id) {
+            auto generation = generation_for_test.fetch_add(1, std::memory_order_relaxed);
+            auto& cf = e.local_db().find_column_family("ks", "cf");
+            return cf.make_sstable(upload_path.native(), generation, sstables::sstable::version_types::mc, sstables::sstable::format_types::big);
+        }).get();
+
+        auto leveled_sstables = sstdir.map_reduce0([] (sstable_directory& d) {
+            return seastar::async([&d] {
+                std::map<uint32_t, std::vector<sstables::shared_sstable>> levels;
+                d.do_for_each_sstable([&levels] (sstables::shared_sstable sst) {
+                    auto shards = sst->get_shards_for_this_sstable();
+                    BOOST_REQUIRE_EQUAL(shards.size(), 1);
+                    BOOST_REQUIRE_EQUAL(shards[0], this_shard_id());
+                    if (sst->get_sstable_level() > 0) {
+                        levels[sst->get_sstable_level()].push_back(std::move(sst));
+                    }
+                    return make_ready_future<>();
+                }).get();
+
+                size_t count = 0;
+                for (auto& [level, ssts] : levels) {
+                    auto& s = *ssts.front()->get_schema();
+                    std::sort(ssts.begin(), ssts.end(), [&s] (const sstables::shared_sstable& a, const sstables::shared_sstable& b) {
+                        return a->get_first_decorated_key().less_compare(s, b->get_first_decorated_key());
+                    });
+                    for (size_t i = 1; i < ssts.size(); ++i) {
+                        BOOST_REQUIRE(ssts[i - 1]->get_last_decorated_key().less_compare(s, ssts[i]->get_first_decorated_key()));
+                    }
+                    count += ssts.size();
+                }
+                return count;
+            });
+        }, size_t(0), std::plus<size_t>()).get0();
+        BOOST_REQUIRE_GT(leveled_sstables, size_t(0));
+    });
+}
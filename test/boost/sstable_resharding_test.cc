@@ -195,3 +195,43 @@ SEASTAR_TEST_CASE(sstable_is_shared_correctness) {
       }
     });
 }
+
+SEASTAR_TEST_CASE(sstable_resharding_job_follows_strategy_layout) {
+    return test_env::do_with_async([] (test_env& env) {
+        storage_service_for_tests ssft;
+        auto tmp = tmpdir();
+        auto s = get_schema();
+        auto gen = make_lw_shared<unsigned>(1);
+        auto sst_gen = [&env, s, &tmp, gen] () mutable {
+            return env.make_sstable(s, tmp.path().string(), (*gen)++, sstables::sstable::version_types::mc, big);
+        };
+
+        auto key = partition_key::from_exploded(*s, {to_bytes("key")});
+        mutation m(s, key);
+        m.set_clustered_cell(clustering_key::make_empty(), bytes("value"), data_value(int32_t(1)), api::timestamp_type(0));
+        auto sst = make_sstable_containing(sst_gen, {m});
+        sst->set_sstable_level(2);
+
+        std::map<sstring, sstring> options;
+        options.emplace("sstable_size_in_mb", "10");
+        auto lcs = sstables::make_compaction_strategy(sstables::compaction_strategy_type::leveled, options);
+        BOOST_REQUIRE_EQUAL(lcs.resharding_group(sst), 2u);
+        auto desc = lcs.get_resharding_job({sst}, default_priority_class(), true);
+        BOOST_REQUIRE(desc.options.type() == sstables::compaction_type::Reshard);
+        BOOST_REQUIRE_EQUAL(desc.level, 2);
+        BOOST_REQUIRE_EQUAL(desc.max_sstable_bytes, 10u * 1024 * 1024);
+
+        // A level split into several jobs would yield overlapping runs in the level, so its output goes to level 0.
+        desc = lcs.get_resharding_job({sst}, default_priority_class(), false);
+        BOOST_REQUIRE(desc.options.type() == sstables::compaction_type::Reshard);
+        BOOST_REQUIRE_EQUAL(desc.level, 0);
+        BOOST_REQUIRE_EQUAL(desc.max_sstable_bytes, 10u * 1024 * 1024);
+
+        auto stcs = sstables::make_compaction_strategy(sstables::compaction_strategy_type::size_tiered, {});
+        BOOST_REQUIRE_EQUAL(stcs.resharding_group(sst), 0u);
+        desc = stcs.get_resharding_job({sst}, default_priority_class(), true);
+        BOOST_REQUIRE(desc.options.type() == sstables::compaction_type::Reshard);
+        BOOST_REQUIRE_EQUAL(desc.level, 0);
+        BOOST_REQUIRE_EQUAL(desc.max_sstable_bytes, sstables::compaction_descriptor::default_max_sstable_bytes);
+    });
+}
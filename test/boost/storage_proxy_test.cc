@@ -21,6 +21,7 @@
 
 
 #include <seastar/core/thread.hh>
+#include <seastar/core/sleep.hh>
 #include <seastar/testing/test_case.hh>
 #include "query-result-writer.hh"
 
@@ -28,6 +29,8 @@
 #include "test/lib/mutation_source_test.hh"
 #include "test/lib/result_set_assertions.hh"
 #include "service/storage_proxy.hh"
+#include "service/replica_selector.hh"
+#include "service/hedged_read.hh"
 #include "partition_slice_builder.hh"
 #include "schema_builder.hh"
 
@@ -112,3 +115,128 @@ SEASTAR_TEST_CASE(test_get_restricted_ranges) {
         });
     });
 }
+
+SEASTAR_TEST_CASE(test_replica_selector_ranks_by_load) {
+    service::replica_selector selector({.concurrency = 2});
+    gms::inet_address ep1("10.0.0.1");
+    gms::inet_address ep2("10.0.0.2");
+    gms::inet_address ep3("10.0.0.3");
+
+    // Replicas which never responded are probed first.
+    BOOST_REQUIRE(!selector.score(ep1));
+    {
+        auto r1 = selector.start_request(ep1);
+        auto r2 = selector.start_request(ep2);
+        BOOST_REQUIRE_EQUAL(selector.get_load(ep1)->in_flight, 1);
+        r1.complete(0);
+        r2.complete(10);
+    }
+    BOOST_REQUIRE_EQUAL(selector.get_load(ep1)->in_flight, 0);
+    BOOST_REQUIRE(selector.score(ep1));
+    BOOST_REQUIRE(selector.score(ep2));
+
+    std::vector<gms::inet_address> eps{ep2, ep1, ep3};
+    selector.sort(eps.begin(), eps.end());
+    BOOST_REQUIRE(eps == (std::vector<gms::inet_address>{ep3, ep1, ep2}));
+
+    // Requests in flight count against the replica, even without a queue.
+    auto idle_score = *selector.score(ep1);
+    auto r1 = selector.start_request(ep1);
+    auto r2 = selector.start_request(ep1);
+    BOOST_REQUIRE_GT(*selector.score(ep1), idle_score);
+
+    // Failed requests are accounted for as well.
+    {
+        auto r3 = selector.start_request(ep3);
+    }
+    BOOST_REQUIRE(selector.score(ep3));
+    BOOST_REQUIRE_EQUAL(selector.get_load(ep3)->in_flight, 0);
+    r1.complete(std::nullopt);
+    r2.complete(std::nullopt);
+    return make_ready_future<>();
+}
+
+SEASTAR_TEST_CASE(test_replica_selector_forgets_replicas) {
+    return seastar::async([] {
+        service::replica_selector selector({.forget_after = std::chrono::milliseconds(50)});
+        gms::inet_address ep1("10.0.0.1");
+        gms::inet_address ep2("10.0.0.2");
+
+        // Replicas which left the cluster are forgotten, even with requests in flight.
+        auto r1 = selector.start_request(ep1);
+        selector.remove(ep1);
+        r1.complete(0);
+        BOOST_REQUIRE(!selector.get_load(ep1));
+
+        // So are replicas which weren't sent a request for a while, but not those
+        // with requests in flight.
+        selector.start_request(ep1).complete(0);
+        auto r2 = selector.start_request(ep2);
+        BOOST_REQUIRE_EQUAL(selector.size(), 2);
+        seastar::sleep(std::chrono::milliseconds(100)).get();
+        selector.start_request(ep2).complete(0);
+        BOOST_REQUIRE(!selector.get_load(ep1));
+        BOOST_REQUIRE(selector.get_load(ep2));
+        r2.complete(0);
+    });
+}
+
+SEASTAR_TEST_CASE(test_hedged_read_cancels_slow_replica) {
+    gms::inet_address slow("10.0.0.1");
+    gms::inet_address fast("10.0.0.2");
+    auto id = utils::make_random_uuid();
+    service::hedged_read_requests requests(id);
+
+    std::vector<std::pair<gms::inet_address, utils::UUID>> cancels;
+    auto cancel = [&] (gms::inet_address ep, utils::UUID read_id) {
+        cancels.emplace_back(ep, read_id);
+    };
+
+    // The original request is slow, the speculative one wins.
+    requests.sent(slow);
+    requests.sent(fast);
+    requests.completed(fast);
+    BOOST_REQUIRE_EQUAL(requests.cancel_pending(cancel), 1);
+    BOOST_REQUIRE_EQUAL(cancels.size(), 1);
+    BOOST_REQUIRE_EQUAL(cancels[0].first, slow);
+    BOOST_REQUIRE_EQUAL(cancels[0].second, id);
+    BOOST_REQUIRE(requests.is_cancelled(slow));
+    BOOST_REQUIRE(!requests.is_cancelled(fast));
+
+    // Nothing is left to cancel.
+    BOOST_REQUIRE_EQUAL(requests.cancel_pending(cancel), 0);
+    BOOST_REQUIRE_EQUAL(cancels.size(), 1);
+
+    // Reads which completed before speculating cancel nothing.
+    service::hedged_read_requests unhedged(utils::make_random_uuid());
+    unhedged.sent(slow);
+    unhedged.completed(slow);
+    BOOST_REQUIRE_EQUAL(unhedged.cancel_pending(cancel), 0);
+    BOOST_REQUIRE_EQUAL(cancels.size(), 1);
+    return make_ready_future<>();
+}
+
+SEASTAR_TEST_CASE(test_hedge_budget_limits_speculation) {
+    service::hedge_budget budget(5);
+
+    // With a 25% budget, one in four reads may speculate.
+    BOOST_REQUIRE(!budget.consume());
+    size_t speculated = 0;
+    for (int i = 0; i < 100; ++i) {
+        budget.earn(25);
+        speculated += budget.consume();
+    }
+    BOOST_REQUIRE_EQUAL(speculated, 25);
+
+    // Reads which don't speculate save up to the maximum, for bursts.
+    for (int i = 0; i < 1000; ++i) {
+        budget.earn(25);
+    }
+    BOOST_REQUIRE_EQUAL(budget.available(), 5);
+    speculated = 0;
+    while (budget.consume()) {
+        ++speculated;
+    }
+    BOOST_REQUIRE_EQUAL(speculated, 5);
+    return make_ready_future<>();
+}
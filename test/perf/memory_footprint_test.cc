@@ -166,6 +166,8 @@ static mutation make_mutation(schema_ptr s, mutation_settings settings) {
 }
 
 struct sizes {
+    // Size of the keys and values of all partitions, without any metadata
+    size_t raw;
     size_t memtable;
     size_t cache;
     std::map<sstables::sstable::version_types, size_t> sstable;
@@ -192,6 +194,8 @@ static sizes calculate_sizes(cache_tracker& tracker, const mutation_settings& se
     }
 
     mutation& m = muts[0];
+    result.raw = settings.partition_count * (settings.partition_key_size
+            + settings.row_count * (settings.clustering_key_size + settings.column_count * settings.data_size));
     result.memtable = mt->occupancy().used_space();
     result.cache = tracker.region().occupancy().used_space() - cache_initial_occupancy;
     result.frozen = freeze(m).representation().size();
@@ -253,6 +257,7 @@ int main(int argc, char** argv) {
             auto sizes = calculate_sizes(tracker, settings);
 
             std::cout << "mutation footprint:" << "\n";
+            std::cout << " - raw data:     " << sizes.raw << "\n";
             std::cout << " - in cache:     " << sizes.cache << "\n";
             std::cout << " - in memtable:  " << sizes.memtable << "\n";
             std::cout << " - in sstable:\n";
@@ -0,0 +1,146 @@
+/*
+ * Copyright (C) 2020 ScyllaDB
+ */
+
+/*
+ * This file is part of Scylla.
+ *
+ * Scylla is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Affero General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Scylla is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Scylla.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+// Measures the throughput of ALLOW FILTERING scans, where most of the time
+// is spent evaluating the restrictions on the coordinator.
+
+#include "test/lib/cql_test_env.hh"
+#include "test/perf/perf.hh"
+#include <seastar/core/app-template.hh>
+#include "cql3/query_options.hh"
+#include "database.hh"
+
+struct test_config {
+    unsigned partitions;
+    unsigned rows_per_partition;
+    unsigned concurrency;
+    unsigned page_size;
+    unsigned duration_in_seconds;
+    unsigned operations_per_shard = 0;
+    sstring restriction;
+    bool flush_memtables;
+};
+
+std::ostream& operator<<(std::ostream& os, const test_config& cfg) {
+    return os << "{partitions=" << cfg.partitions
+           << ", rows_per_partition=" << cfg.rows_per_partition
+           << ", concurrency=" << cfg.concurrency
+           << ", page_size=" << cfg.page_size
+           << ", restriction=" << cfg.restriction
+           << "}";
+}
+
+static const std::vector<std::pair<sstring, sstring>> restrictions = {
+    {"int", "i > 100 AND i < 200"},
+    {"bigint", "b >= 500"},
+    {"timestamp", "ts < '2020-01-01 00:10:00+0000'"},
+    {"text", "t = 'name-42'"},
+    {"like-prefix", "t LIKE 'name-1%'"},
+    {"like", "t LIKE '%-7_'"},
+    {"in", "i IN (1, 3, 5, 7, 11, 13, 17, 19, 23, 29, 31)"},
+    {"mixed", "i > 100 AND t LIKE 'name-1%' AND b < 900"},
+};
+
+static void create_rows(cql_test_env& env, test_config& cfg) {
+    std::cout << "Creating " << cfg.partitions << " partitions with " << cfg.rows_per_partition << " rows each..." << std::endl;
+    auto id = env.prepare("INSERT INTO t (pk, ck, i, b, ts, t) VALUES (?, ?, ?, ?, ?, ?)").get0();
+    for (unsigned pk = 0; pk < cfg.partitions; ++pk) {
+        for (unsigned ck = 0; ck < cfg.rows_per_partition; ++ck) {
+            const int32_t v = (pk * cfg.rows_per_partition + ck) % 1000;
+            env.execute_prepared(id, {
+                cql3::raw_value::make_value(int32_type->decompose(int32_t(pk))),
+                cql3::raw_value::make_value(int32_type->decompose(int32_t(ck))),
+                cql3::raw_value::make_value(int32_type->decompose(v)),
+                cql3::raw_value::make_value(long_type->decompose(int64_t(v))),
+                cql3::raw_value::make_value(timestamp_type->decompose(db_clock::time_point(std::chrono::seconds(1577836800 + v)))),
+                cql3::raw_value::make_value(utf8_type->decompose(format("name-{}", v))),
+            }).get();
+        }
+    }
+    if (cfg.flush_memtables) {
+        std::cout << "Flushing partitions..." << std::endl;
+        env.db().invoke_on_all(&database::flush_all_memtables).get();
+    }
+}
+
+static std::vector<double> test_filtered_scan(cql_test_env& env, test_config& cfg) {
+    auto query = format("SELECT pk, ck, i FROM t WHERE {} ALLOW FILTERING", cfg.restriction);
+    return time_parallel([&env, &cfg, query] {
+        auto qo = std::make_unique<cql3::query_options>(db::consistency_level::LOCAL_ONE, infinite_timeout_config,
+                std::vector<cql3::raw_value>{}, cql3::query_options::specific_options{int32_t(cfg.page_size), nullptr, {}, api::new_timestamp()});
+        return env.execute_cql(query, std::move(qo)).discard_result();
+    }, cfg.concurrency, cfg.duration_in_seconds, cfg.operations_per_shard);
+}
+
+int main(int argc, char** argv) {
+    namespace bpo = boost::program_options;
+    app_template app;
+    app.add_options()
+        ("partitions", bpo::value<unsigned>()->default_value(100), "number of partitions")
+        ("rows-per-partition", bpo::value<unsigned>()->default_value(100), "number of rows in each partition")
+        ("page-size", bpo::value<unsigned>()->default_value(5000), "page size of the scans")
+        ("restriction", bpo::value<std::string>()->default_value("all"), "restriction to test, one of: all, int, bigint, timestamp, text, like-prefix, like, in, mixed")
+        ("duration", bpo::value<unsigned>()->default_value(5), "test duration in seconds")
+        ("concurrency", bpo::value<unsigned>()->default_value(10), "workers per core")
+        ("operations-per-shard", bpo::value<unsigned>(), "run this many operations per shard (overrides duration)")
+        ("flush", "flush memtables before test")
+        ;
+
+    return app.run(argc, argv, [&app] {
+        return do_with_cql_env_thread([&app] (auto&& env) {
+            auto cfg = test_config();
+            cfg.partitions = app.configuration()["partitions"].as<unsigned>();
+            cfg.rows_per_partition = app.configuration()["rows-per-partition"].as<unsigned>();
+            cfg.page_size = app.configuration()["page-size"].as<unsigned>();
+            cfg.duration_in_seconds = app.configuration()["duration"].as<unsigned>();
+            cfg.concurrency = app.configuration()["concurrency"].as<unsigned>();
+            cfg.flush_memtables = app.configuration().contains("flush");
+            if (app.configuration().contains("operations-per-shard")) {
+                cfg.operations_per_shard = app.configuration()["operations-per-shard"].as<unsigned>();
+            }
+            sstring which = app.configuration()["restriction"].as<std::string>();
+
+            env.execute_cql("CREATE TABLE t (pk int, ck int, i int, b bigint, ts timestamp, t text, PRIMARY KEY (pk, ck))").get();
+            create_rows(env, cfg);
+
+            for (auto&& [name, restriction] : restrictions) {
+                if (which != "all" && which != name) {
+                    continue;
+                }
+                cfg.restriction = restriction;
+                std::cout << "Running test with config: " << cfg << std::endl;
+                auto results = test_filtered_scan(env, cfg);
+
+                std::sort(results.begin(), results.end());
+                auto median = results[results.size() / 2];
+                auto min = results[0];
+                auto max = results[results.size() - 1];
+                for (auto& r : results) {
+                    r = abs(r - median);
+                }
+                std::sort(results.begin(), results.end());
+                auto mad = results[results.size() / 2];
+                std::cout << format("{}: median {:.2f}, median absolute deviation: {:.2f}, maximum: {:.2f}, minimum: {:.2f}\n",
+                        name, median, mad, max, min);
+            }
+        });
+    });
+}
@@ -35,6 +35,7 @@
 #include "types/set.hh"
 #include "db/config.hh"
 #include "db/paxos_grace_seconds_extension.hh"
+#include "db/result_cache_extension.hh"
 #include "cql3/cql_config.hh"
 #include "cql3/type_json.hh"
 #include "test/lib/exception_utils.hh"
@@ -121,6 +122,7 @@ void repl(seastar::app_template& app) {
     ext->add_schema_extension<alternator::tags_extension>(alternator::tags_extension::NAME);
     ext->add_schema_extension<cdc::cdc_extension>(cdc::cdc_extension::NAME);
     ext->add_schema_extension<db::paxos_grace_seconds_extension>(db::paxos_grace_seconds_extension::NAME);
+    ext->add_schema_extension<db::result_cache_extension>(db::result_cache_extension::NAME);
     auto db_cfg = ::make_shared<db::config>(std::move(ext));
     db_cfg->enable_user_defined_functions({true}, db::config::config_source::CommandLine);
     db_cfg->experimental_features(db::experimental_features_t::all(), db::config::config_source::CommandLine);
@@ -0,0 +1,86 @@
+/*
+ * Copyright (C) 2020 ScyllaDB
+ */
+
+/*
+ * This file is part of Scylla.
+ *
+ * Scylla is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Affero General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Scylla is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Scylla.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <algorithm>
+
+#include <seastar/core/bitops.hh>
+
+#include "utils/frequency_sketch.hh"
+
+namespace utils {
+
+static constexpr uint64_t seeds[] = {
+    0xc3a5c85c97cb3127ULL,
+    0xb492b66fbe98f273ULL,
+    0x9ae16a3b2f90404fULL,
+    0xcbf29ce484222325ULL,
+};
+
+// Every counter is 4 bits wide, halving a word halves all of its counters.
+static constexpr uint64_t reset_mask = 0x7777777777777777ULL;
+
+frequency_sketch::frequency_sketch(size_t capacity)
+        : _width(size_t(1) << seastar::log2ceil(std::max<size_t>(capacity, 16)))
+        , _sample_size(10 * _width) {
+    _table.resize(rows * _width / 16);
+}
+
+size_t frequency_sketch::counter_of(uint64_t hash, unsigned row) const noexcept {
+    uint64_t h = (hash + seeds[row]) * seeds[row];
+    h ^= h >> 32;
+    return row * _width + (h & (_width - 1));
+}
+
+unsigned frequency_sketch::get(size_t counter) const noexcept {
+    return (_table[counter / 16] >> ((counter % 16) * 4)) & 0xf;
+}
+
+void frequency_sketch::record(uint64_t hash) noexcept {
+    bool incremented = false;
+    for (unsigned row = 0; row < rows; ++row) {
+        auto counter = counter_of(hash, row);
+        if (get(counter) < max_frequency) {
+            _table[counter / 16] += uint64_t(1) << ((counter % 16) * 4);
+            incremented = true;
+        }
+    }
+    if (incremented && ++_size == _sample_size) {
+        reset();
+    }
+}
+
+unsigned frequency_sketch::estimate(uint64_t hash) const noexcept {
+    unsigned freq = max_frequency;
+    for (unsigned row = 0; row < rows; ++row) {
+        freq = std::min(freq, get(counter_of(hash, row)));
+    }
+    return freq;
+}
+
+void frequency_sketch::reset() noexcept {
+    for (auto& word : _table) {
+        word = (word >> 1) & reset_mask;
+    }
+    _size /= 2;
+    ++_resets;
+}
+
+}
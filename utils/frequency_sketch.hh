@@ -0,0 +1,81 @@
+/*
+ * Copyright (C) 2020 ScyllaDB
+ */
+
+/*
+ * This file is part of Scylla.
+ *
+ * Scylla is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Affero General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Scylla is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Scylla.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+
+#include "utils/chunked_vector.hh"
+
+namespace utils {
+
+/// Approximate access frequency of a large set of keys, in little memory.
+///
+/// This is the count-min sketch of TinyLFU (Einziger et al., "TinyLFU: A Highly
+/// Efficient Cache Admission Policy"): every key maps to one 4-bit counter in each
+/// of 4 rows, and its frequency is estimated as the smallest of them. Counters
+/// saturate at 15, which is enough to tell frequent keys from one-off ones.
+///
+/// To keep up with changes of the working set, all counters are halved once
+/// the number of recorded accesses reaches 10 times the number of counters.
+///
+/// Keys are given as 64-bit hashes, which are assumed to be well distributed.
+class frequency_sketch {
+public:
+    static constexpr unsigned max_frequency = 15;
+private:
+    static constexpr unsigned rows = 4;
+    // The counters of all rows, 16 in each word. Sized for a whole cache, so
+    // it is too large for a contiguous allocation.
+    utils::chunked_vector<uint64_t> _table;
+    // Number of counters in each row, a power of 2.
+    size_t _width;
+    uint64_t _sample_size;
+    uint64_t _size = 0;
+    uint64_t _resets = 0;
+private:
+    size_t counter_of(uint64_t hash, unsigned row) const noexcept;
+    unsigned get(size_t counter) const noexcept;
+    void reset() noexcept;
+public:
+    /// Sizes the sketch for about the given number of distinct keys.
+    explicit frequency_sketch(size_t capacity);
+
+    /// Records an access to the key.
+    void record(uint64_t hash) noexcept;
+
+    /// Returns the estimated number of recent accesses to the key,
+    /// capped at max_frequency.
+    unsigned estimate(uint64_t hash) const noexcept;
+
+    /// Number of counters in each row.
+    size_t capacity() const noexcept {
+        return _width;
+    }
+
+    /// Number of times the counters were halved so far.
+    uint64_t resets() const noexcept {
+        return _resets;
+    }
+};
+
+}
@@ -28,12 +28,14 @@
 #include <boost/intrusive/slist.hpp>
 #include <boost/range/adaptors.hpp>
 #include <stack>
+#include <sys/mman.h>
 
 #include <seastar/core/memory.hh>
 #include <seastar/core/align.hh>
 #include <seastar/core/print.hh>
 #include <seastar/core/metrics.hh>
 #include <seastar/core/reactor.hh>
+#include <seastar/core/timer.hh>
 #include <seastar/util/alloc_failure_injector.hh>
 #include <seastar/util/backtrace.hh>
 
@@ -361,11 +363,14 @@ static thread_local tracker& tracker_instance = get_tracker_instance();
 using clock = std::chrono::steady_clock;
 
 class tracker::impl {
+    class background_reclaimer;
+
     std::vector<region::impl*> _regions;
     seastar::metrics::metric_groups _metrics;
     bool _reclaiming_enabled = true;
     size_t _reclamation_step = 1;
     bool _abort_on_bad_alloc = false;
+    std::unique_ptr<background_reclaimer> _background_reclaimer;
 private:
     // Prevents tracker's reclaimer from running while live. Reclaimer may be
     // invoked synchronously with allocator. This guard ensures that this
@@ -409,6 +414,8 @@ class tracker::impl {
     // Abort on allocation failure from LSA
     void enable_abort_on_bad_alloc() { _abort_on_bad_alloc = true; }
     bool should_abort_on_bad_alloc() const { return _abort_on_bad_alloc; }
+    void start_background_reclaim(scheduling_group sg, size_t free_segments_goal);
+    future<> stop_background_reclaim();
 private:
     // Like compact_and_evict() but assumes that reclaim_lock is held around the operation.
     size_t compact_and_evict_locked(size_t reserve_segments, size_t bytes);
@@ -490,6 +497,11 @@ static constexpr auto max_used_space_ratio_for_compaction = 0.85;
 static constexpr size_t max_used_space_for_compaction = segment_size * max_used_space_ratio_for_compaction;
 static constexpr size_t min_free_space_for_compaction = segment_size - max_used_space_for_compaction;
 
+// With huge pages enabled, LSA memory is advised to be backed by transparent huge
+// pages of that size, see segment_pool::enable_huge_pages().
+static constexpr size_t huge_page_size = size_t(2) << 20;
+static constexpr size_t segments_per_huge_page = huge_page_size / segment_size;
+
 static_assert(min_free_space_for_compaction >= max_managed_object_size,
     "Segments which cannot fit max_managed_object_size must not be considered compactible for the sake of forward progress of compaction");
 
@@ -529,12 +541,31 @@ using segment_descriptor_hist = log_heap<segment_descriptor, segment_descriptor_
 class segment_store {
     memory::memory_layout _layout;
     uintptr_t _segments_base; // The address of the first segment
+    size_t _huge_page_offset; // The number of segments in the first huge page before the first segment
 
 public:
     size_t non_lsa_reserve = 0;
     segment_store()
         : _layout(memory::get_memory_layout())
-        , _segments_base(align_down(_layout.start, (uintptr_t)segment::size)) {
+        , _segments_base(align_down(_layout.start, (uintptr_t)segment::size))
+        , _huge_page_offset((_segments_base & (huge_page_size - 1)) / segment::size) {
+    }
+    size_t huge_page_of(size_t idx) const {
+        return (idx + _huge_page_offset) / segments_per_huge_page;
+    }
+    // Returns the range of indexes of the segments in the given huge page.
+    std::pair<size_t, size_t> huge_page_segments(size_t huge_page) const {
+        auto begin = std::max(huge_page * segments_per_huge_page, _huge_page_offset) - _huge_page_offset;
+        auto end = std::min((huge_page + 1) * segments_per_huge_page - _huge_page_offset, max_segments());
+        return {begin, end};
+    }
+    // Advises the kernel to back the given huge page with a transparent huge page.
+    // Seastar already binds the memory to the NUMA node of the shard.
+    void advise_huge_page(size_t huge_page) {
+        auto start = align_down(_segments_base, (uintptr_t)huge_page_size) + huge_page * huge_page_size;
+        if (::madvise(reinterpret_cast<void*>(start), huge_page_size, MADV_HUGEPAGE)) {
+            llogger.warn("Failed to advise huge pages for LSA memory: {}", std::system_error(errno, std::system_category()).what());
+        }
     }
     segment* segment_from_idx(size_t idx) const {
         return reinterpret_cast<segment*>(_segments_base) + idx;
@@ -580,6 +611,15 @@ class segment_store {
         }
         return i->second;
     }
+    // Segments are allocated one by one, so they don't share huge pages. Group
+    // consecutive indexes as if they did, to exercise the same code.
+    size_t huge_page_of(size_t idx) const {
+        return idx / segments_per_huge_page;
+    }
+    std::pair<size_t, size_t> huge_page_segments(size_t huge_page) const {
+        return {huge_page * segments_per_huge_page, std::min((huge_page + 1) * segments_per_huge_page, _segments.size())};
+    }
+    void advise_huge_page(size_t huge_page) { }
     size_t new_idx_for_segment(segment* seg) {
         auto i = find_empty();
         assert(i != _segments.end());
@@ -625,6 +665,17 @@ class segment_pool {
     utils::dynamic_bitset _lsa_owned_segments_bitmap; // owned by this
     utils::dynamic_bitset _lsa_free_segments_bitmap;  // owned by this, but not in use
     size_t _free_segments = 0;
+    // Number of segments allocated from the pool, in use or in the emergency
+    // reserve, in each huge page, and the number of huge pages they span.
+    std::vector<uint8_t> _huge_page_segments;
+    size_t _huge_pages_in_use = 0;
+    // Number of segments owned by the pool in each huge page. Only huge pages
+    // all of whose segments are owned are advised, so that transparent huge
+    // pages back LSA memory only.
+    std::vector<uint8_t> _huge_page_owned_segments;
+    utils::dynamic_bitset _advised_huge_pages;
+    bool _huge_pages = false;
+    size_t _last_allocated_idx = utils::dynamic_bitset::npos;
     size_t _current_emergency_reserve_goal = 1;
     size_t _emergency_reserve_max = 30;
     bool _allocation_failure_flag = false;
@@ -677,8 +728,49 @@ class segment_pool {
         return _allocation_enabled && _store.can_allocate_more_segments();
     }
     bool compact_segment(segment* seg);
+    size_t find_free_segment() const;
+    void on_segment_allocated(size_t idx) {
+        _last_allocated_idx = idx;
+        if (_huge_page_segments[_store.huge_page_of(idx)]++ == 0) {
+            ++_huge_pages_in_use;
+        }
+    }
+    void on_segment_deallocated(size_t idx) {
+        if (--_huge_page_segments[_store.huge_page_of(idx)] == 0) {
+            --_huge_pages_in_use;
+        }
+    }
+    void maybe_advise_huge_page(size_t huge_page) {
+        auto [begin, end] = _store.huge_page_segments(huge_page);
+        if (_huge_pages && !_advised_huge_pages.test(huge_page)
+                && end - begin == segments_per_huge_page && _huge_page_owned_segments[huge_page] == segments_per_huge_page) {
+            _store.advise_huge_page(huge_page);
+            _advised_huge_pages.set(huge_page);
+        }
+    }
+    void on_segment_owned(size_t idx) {
+        auto huge_page = _store.huge_page_of(idx);
+        ++_huge_page_owned_segments[huge_page];
+        maybe_advise_huge_page(huge_page);
+    }
+    // The huge page stays advised, splitting it would be more expensive than
+    // backing the few non-LSA allocations in it with a huge page.
+    void on_segment_released(size_t idx) {
+        --_huge_page_owned_segments[_store.huge_page_of(idx)];
+    }
 public:
     segment_pool();
+    // Backs LSA memory with transparent huge pages, and allocates segments so that
+    // those allocated one after another, like the segments a region fills, or
+    // compacts its objects into, share huge pages, and so TLB entries.
+    void enable_huge_pages();
+    size_t huge_pages_in_use() const { return _huge_pages_in_use; }
+    size_t huge_page_of(segment* seg) { return _store.huge_page_of(idx_from_segment(seg)); }
+    // Percentage of the space of the huge pages spanned by the segments in use
+    // which the segments occupy.
+    double huge_page_occupancy() const {
+        return _huge_pages_in_use ? double(_segments_in_use) * 100 / (_huge_pages_in_use * segments_per_huge_page) : 0;
+    }
     void prime(size_t available_memory, size_t min_free_memory);
     segment* new_segment(region::impl* r);
     segment_descriptor& descriptor(segment*);
@@ -720,10 +812,23 @@ class segment_pool {
         size_t segments_compacted;
         uint64_t memory_allocated;
         uint64_t memory_compacted;
+        size_t segments_compacted_in_background;
+        uint64_t memory_compacted_in_background;
     };
 private:
     stats _stats{};
+    bool _compacting_in_background = false;
 public:
+    // Accounts compaction done while alive to the background.
+    struct background_compaction {
+        segment_pool& _pool;
+        background_compaction(segment_pool& pool) : _pool(pool) {
+            _pool._compacting_in_background = true;
+        }
+        ~background_compaction() {
+            _pool._compacting_in_background = false;
+        }
+    };
     const stats& statistics() const { return _stats; }
     void on_segment_compaction(size_t used_size);
     void on_memory_allocation(size_t size);
@@ -769,6 +874,7 @@ size_t segment_pool::reclaim_segments(size_t target) {
         }
         _lsa_free_segments_bitmap.clear(src_idx);
         _lsa_owned_segments_bitmap.clear(src_idx);
+        on_segment_released(src_idx);
         _store.free_segment(src);
         src->~segment();
         ::free(src);
@@ -798,10 +904,11 @@ segment* segment_pool::allocate_segment(size_t reserve)
     do {
         tracker_reclaimer_lock rl;
         if (_free_segments > reserve) {
-            auto free_idx = _lsa_free_segments_bitmap.find_last_set();
+            auto free_idx = find_free_segment();
             _lsa_free_segments_bitmap.clear(free_idx);
             auto seg = segment_from_idx(free_idx);
             --_free_segments;
+            on_segment_allocated(free_idx);
             return seg;
         }
         if (can_allocate_more_segments()) {
@@ -814,6 +921,8 @@ segment* segment_pool::allocate_segment(size_t reserve)
             poison(seg, sizeof(segment));
             auto idx = _store.new_idx_for_segment(seg);
             _lsa_owned_segments_bitmap.set(idx);
+            on_segment_owned(idx);
+            on_segment_allocated(idx);
             return seg;
         }
     } while (shard_tracker().get_impl().compact_and_evict(reserve, shard_tracker().reclamation_step() * segment::size));
@@ -822,9 +931,31 @@ segment* segment_pool::allocate_segment(size_t reserve)
 
 void segment_pool::deallocate_segment(segment* seg)
 {
-    assert(_lsa_owned_segments_bitmap.test(idx_from_segment(seg)));
-    _lsa_free_segments_bitmap.set(idx_from_segment(seg));
+    auto idx = idx_from_segment(seg);
+    assert(_lsa_owned_segments_bitmap.test(idx));
+    _lsa_free_segments_bitmap.set(idx);
     _free_segments++;
+    on_segment_deallocated(idx);
+}
+
+size_t segment_pool::find_free_segment() const {
+    if (_huge_pages && _last_allocated_idx != utils::dynamic_bitset::npos) {
+        // Prefer the huge page of the last allocated segment, from its top, as below.
+        auto [begin, end] = _store.huge_page_segments(_store.huge_page_of(_last_allocated_idx));
+        for (auto idx = end; idx != begin; --idx) {
+            if (_lsa_free_segments_bitmap.test(idx - 1)) {
+                return idx - 1;
+            }
+        }
+    }
+    return _lsa_free_segments_bitmap.find_last_set();
+}
+
+void segment_pool::enable_huge_pages() {
+    _huge_pages = true;
+    for (size_t huge_page = 0; huge_page < _huge_page_owned_segments.size(); ++huge_page) {
+        maybe_advise_huge_page(huge_page);
+    }
 }
 
 void segment_pool::refill_emergency_reserve() {
@@ -900,6 +1031,9 @@ segment_pool::segment_pool()
     : _segments(max_segments())
     , _lsa_owned_segments_bitmap(max_segments())
     , _lsa_free_segments_bitmap(max_segments())
+    , _huge_page_segments(_store.huge_page_of(max_segments()) + 1)
+    , _huge_page_owned_segments(_huge_page_segments.size())
+    , _advised_huge_pages(_huge_page_segments.size())
 {
 }
 
@@ -926,6 +1060,10 @@ void segment_pool::prime(size_t available_memory, size_t min_free_memory) {
 void segment_pool::on_segment_compaction(size_t used_size) {
     _stats.segments_compacted++;
     _stats.memory_compacted += used_size;
+    if (_compacting_in_background) {
+        _stats.segments_compacted_in_background++;
+        _stats.memory_compacted_in_background += used_size;
+    }
 }
 
 void segment_pool::on_memory_allocation(size_t size) {
@@ -1659,6 +1797,10 @@ bool tracker::should_abort_on_bad_alloc() {
     return _impl->should_abort_on_bad_alloc();
 }
 
+size_t tracker::huge_page_of(const void* obj) {
+    return shard_segment_pool.huge_page_of(shard_segment_pool.containing_segment(obj));
+}
+
 void tracker::configure(const config& cfg) {
     if (cfg.defragment_on_idle) {
         engine().set_idle_cpu_handler([this] (reactor::work_waiting_on_reactor check_for_work) {
@@ -1670,6 +1812,16 @@ void tracker::configure(const config& cfg) {
     if (cfg.abort_on_lsa_bad_alloc) {
         _impl->enable_abort_on_bad_alloc();
     }
+    if (cfg.lsa_huge_pages) {
+        shard_segment_pool.enable_huge_pages();
+    }
+    if (cfg.lsa_background_reclaim_segments) {
+        _impl->start_background_reclaim(cfg.background_reclaim_scheduling_group, cfg.lsa_background_reclaim_segments);
+    }
+}
+
+future<> tracker::stop() {
+    return _impl->stop_background_reclaim();
 }
 
 memory::reclaiming_result tracker::reclaim(seastar::memory::reclaimer::request r) {
@@ -2038,6 +2190,114 @@ size_t tracker::impl::compact_and_evict_locked(size_t reserve_segments, size_t m
     return mem_released;
 }
 
+// Compacts and evicts in its own scheduling group so that the segment pool keeps
+// free segments ahead of demand, and allocations rarely have to compact and evict
+// synchronously, in the latency-critical path of whatever needed a segment.
+//
+// It only works when memory is short: when the free memory of the shard, plus
+// the free segments of the pool, which the seastar reclaimer releases without
+// compacting, falls below the goal. It then works in steps of reclamation_step()
+// segments, preempted in between, until they reach the goal again. Memory which
+// is free anyway is not made freer by evicting the cache.
+class tracker::impl::background_reclaimer {
+    static constexpr auto poll_interval = std::chrono::milliseconds(10);
+
+    tracker::impl& _tracker;
+    scheduling_group _sg;
+    size_t _goal; // Free memory to keep, in segments, on top of the emergency reserve.
+    timer<lowres_clock> _poll_timer;
+    // Engaged while the main loop waits for work.
+    std::optional<promise<>> _wakeup;
+    // Set when a step released nothing, so that we don't retry until the next poll.
+    bool _backoff = false;
+    bool _stopping = false;
+    future<> _done;
+private:
+    // Returns the number of segments missing to reach the goal.
+    size_t missing_segments() const {
+        auto free = memory::stats().free_memory() / segment::size + shard_segment_pool.unreserved_free_segments();
+        return _goal - std::min(_goal, free);
+    }
+    bool has_work() const {
+        return missing_segments() != 0;
+    }
+    void wake_up() {
+        if (_wakeup) {
+            auto p = std::move(*_wakeup);
+            _wakeup = std::nullopt;
+            p.set_value();
+        }
+    }
+    void poll() {
+        _backoff = false;
+        if (has_work()) {
+            wake_up();
+        }
+    }
+    future<> wait_for_work() {
+        if (_stopping || (!_backoff && has_work())) {
+            return make_ready_future<>();
+        }
+        _wakeup.emplace();
+        return _wakeup->get_future();
+    }
+    // Returns false if nothing could be released.
+    bool reclaim_step() {
+        auto missing = missing_segments();
+        if (!missing) {
+            return true;
+        }
+        auto target = shard_segment_pool.free_segments() + std::min(missing, _tracker.reclamation_step());
+        segment_pool::background_compaction bc(shard_segment_pool);
+        return _tracker.compact_and_evict(target, 0) != 0;
+    }
+    future<> run() {
+        return with_scheduling_group(_sg, [this] {
+            return repeat([this] {
+                return wait_for_work().then([this] {
+                    if (_stopping) {
+                        return stop_iteration::yes;
+                    }
+                    _backoff = !reclaim_step();
+                    return stop_iteration::no;
+                });
+            });
+        });
+    }
+public:
+    background_reclaimer(tracker::impl& tracker, scheduling_group sg, size_t goal)
+            : _tracker(tracker)
+            , _sg(sg)
+            , _goal(goal)
+            , _poll_timer([this] { poll(); })
+            , _done(run()) {
+        _poll_timer.arm_periodic(poll_interval);
+    }
+
+    future<> stop() {
+        _stopping = true;
+        _poll_timer.cancel();
+        wake_up();
+        return std::move(_done);
+    }
+};
+
+void tracker::impl::start_background_reclaim(scheduling_group sg, size_t free_segments_goal) {
+    assert(!_background_reclaimer);
+    llogger.info("Keeping {} free segments by reclaiming in the background", free_segments_goal);
+    _background_reclaimer = std::make_unique<background_reclaimer>(*this, sg, free_segments_goal);
+}
+
+future<> tracker::impl::stop_background_reclaim() {
+    if (!_background_reclaimer) {
+        return make_ready_future<>();
+    }
+    auto f = _background_reclaimer->stop();
+    return f.finally([this] {
+        _background_reclaimer.reset();
+    });
+}
+
 void tracker::impl::register_region(region::impl* r) {
     // If needed, increase capacity of regions before taking the reclaim lock,
     // to avoid failing an allocation when push_back() tries to increase
@@ -2097,6 +2357,18 @@ tracker::impl::impl() {
 
         sm::make_derive("memory_allocated", [this] { return shard_segment_pool.statistics().memory_allocated; },
                         sm::description("Counts number of bytes which were requested from LSA allocator.")),
+
+        sm::make_derive("segments_compacted_in_background", [this] { return shard_segment_pool.statistics().segments_compacted_in_background; },
+                        sm::description("Counts a number of segments compacted in the background, ahead of allocations. The rest of segments_compacted were compacted synchronously.")),
+
+        sm::make_derive("memory_compacted_in_background", [this] { return shard_segment_pool.statistics().memory_compacted_in_background; },
+                        sm::description("Counts number of bytes which were copied as part of segment compaction in the background. The rest of memory_compacted was copied synchronously.")),
+
+        sm::make_gauge("huge_pages_in_use", [this] { return shard_segment_pool.huge_pages_in_use(); },
+                       sm::description("Holds a current number of 2 MiB pages spanned by the segments under lsa control, each one a TLB entry when backed by a huge page.")),
+
+        sm::make_gauge("huge_page_occupancy", [this] { return shard_segment_pool.huge_page_occupancy(); },
+                       sm::description("Holds a current portion (in percents) of the 2 MiB pages spanned by the segments under lsa control which the segments occupy.")),
     });
 }
 
@@ -26,6 +26,7 @@
 #include <seastar/core/idle_cpu_handler.hh>
 #include <seastar/core/condition-variable.hh>
 #include <seastar/core/smp.hh>
+#include <seastar/core/scheduling.hh>
 #include <seastar/core/shared_ptr.hh>
 #include <seastar/core/shared_future.hh>
 #include <seastar/core/gate.hh>
@@ -449,10 +450,19 @@ class tracker {
         bool defragment_on_idle;
         bool abort_on_lsa_bad_alloc;
         size_t lsa_reclamation_step;
+        bool lsa_huge_pages;
+        // Free memory, in segments, to keep ahead of demand by compacting and
+        // evicting in the background, 0 to disable. Free segments and memory
+        // free in the shard both count.
+        size_t lsa_background_reclaim_segments;
+        scheduling_group background_reclaim_scheduling_group;
     };
 
     void configure(const config& cfg);
 
+    // Stops the background reclaim started by configure().
+    future<> stop();
+
 private:
     std::unique_ptr<impl> _impl;
     memory::reclaimer _reclaimer;
@@ -496,6 +506,10 @@ class tracker {
     size_t reclamation_step() const;
 
     bool should_abort_on_bad_alloc();
+
+    // Returns the huge page of the segment holding the given object, which
+    // has to be allocated in a region. Mainly for testing.
+    size_t huge_page_of(const void* obj);
 };
 
 tracker& shard_tracker();